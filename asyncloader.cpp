@@ -0,0 +1,113 @@
+#include "asyncloader.h"
+#include "profiler.h"
+
+#include <chrono>
+#include <algorithm>
+
+AsyncLoader::AsyncLoader(unsigned int num_workers) : stopping_(false){
+    if(num_workers == 0){
+        unsigned int hardware_threads = std::thread::hardware_concurrency();
+        num_workers = hardware_threads > 1 ? hardware_threads - 1 : 1;
+    }
+
+    for(unsigned int i = 0; i < num_workers; ++i){
+        workers_.push_back(std::thread(&AsyncLoader::workerLoop, this));
+    }
+}
+
+AsyncLoader::~AsyncLoader(){
+    {
+        std::lock_guard<std::mutex> lock(worker_mutex_);
+        stopping_ = true;
+        worker_tasks_.clear();
+    }
+
+    worker_condition_.notify_all();
+
+    for(auto& worker : workers_){
+        worker.join();
+    }
+}
+
+void AsyncLoader::workerLoop(){
+    PROFILE_THREAD("Loader worker");
+
+    while(true){
+        std::function<void()> task;
+
+        {
+            std::unique_lock<std::mutex> lock(worker_mutex_);
+            worker_condition_.wait(lock, [this](){return stopping_ || !worker_tasks_.empty();});
+
+            if(stopping_){
+                return;
+            }
+
+            task = std::move(worker_tasks_.front());
+            worker_tasks_.pop_front();
+        }
+
+        PROFILE_ZONE("Load task");
+        task();
+    }
+}
+
+void AsyncLoader::submit(std::function<void()> task){
+    {
+        std::lock_guard<std::mutex> lock(worker_mutex_);
+        worker_tasks_.push_back(std::move(task));
+    }
+
+    worker_condition_.notify_one();
+}
+
+void AsyncLoader::submitGL(std::function<void()> task){
+    std::lock_guard<std::mutex> lock(gl_mutex_);
+    gl_tasks_.push_back(std::move(task));
+}
+
+size_t AsyncLoader::processGLTasks(float budget_ms){
+    PROFILE_ZONE("GL tasks");
+
+    auto start = std::chrono::steady_clock::now();
+    auto budget = std::chrono::duration<float, std::milli>(std::max(budget_ms, 0.f));
+
+    size_t tasks_run = 0;
+
+    while(true){
+        std::function<void()> task;
+
+        {
+            std::lock_guard<std::mutex> lock(gl_mutex_);
+            if(gl_tasks_.empty()){
+                break;
+            }
+
+            task = std::move(gl_tasks_.front());
+            gl_tasks_.pop_front();
+        }
+
+        task();
+        tasks_run++;
+
+        if(std::chrono::steady_clock::now() - start >= budget){
+            break;
+        }
+    }
+
+    return tasks_run;
+}
+
+size_t AsyncLoader::pendingWorkerTasks(){
+    std::lock_guard<std::mutex> lock(worker_mutex_);
+    return worker_tasks_.size();
+}
+
+size_t AsyncLoader::pendingGLTasks(){
+    std::lock_guard<std::mutex> lock(gl_mutex_);
+    return gl_tasks_.size();
+}
+
+unsigned int AsyncLoader::numWorkers(){
+    return (unsigned int)workers_.size();
+}
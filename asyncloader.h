@@ -0,0 +1,85 @@
+#ifndef ASYNCLOADER_H
+#define ASYNCLOADER_H
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <deque>
+#include <vector>
+#include <memory>
+
+/**
+ * @brief The AsyncLoader class runs loading work on a pool of worker threads, and queues up the work that needs the OpenGL context (uploads,
+ * shader compilation, etc.) so that it can be executed on the GL thread a bit at a time, within a per-frame time budget.
+ */
+class AsyncLoader
+{
+private:
+    std::vector<std::thread> workers_;
+    std::deque<std::function<void()> > worker_tasks_;
+    std::mutex worker_mutex_;
+    std::condition_variable worker_condition_;
+    bool stopping_;
+
+    std::deque<std::function<void()> > gl_tasks_;
+    std::mutex gl_mutex_;
+
+private:
+    //main loop of each worker thread, runs tasks until the loader is destroyed
+    void workerLoop();
+
+public:
+    /**
+     * @brief Creates the loader and starts its worker threads
+     * @param num_workers Number of worker threads to start. If 0, one less than the number of hardware threads is used, with a minimum of 1.
+     */
+    AsyncLoader(unsigned int num_workers = 0);
+    AsyncLoader(const AsyncLoader& other) = delete;
+    AsyncLoader& operator = (const AsyncLoader& other) = delete;
+
+    /**
+     * @brief Stops and joins all worker threads. Tasks which have not started yet are discarded.
+     */
+    ~AsyncLoader();
+
+    /**
+     * @brief Queues \p task to be run on one of the worker threads. The task must not make any OpenGL calls, use submitGL() for that instead.
+     * @param task Task to run
+     */
+    void submit(std::function<void()> task);
+
+    /**
+     * @brief Queues \p task to be run on the GL thread the next time processGLTasks() is called. This can be called from any thread.
+     * @param task Task to run
+     */
+    void submitGL(std::function<void()> task);
+
+    /**
+     * @brief Runs queued GL tasks in submission order until either the queue is empty or \p budget_ms has elapsed. At least one task is run per call
+     * if any are queued, so that a single task larger than the budget can not stall the queue. Must be called on the GL thread.
+     * @param budget_ms Time budget in milliseconds
+     * @return the number of tasks run
+     */
+    size_t processGLTasks(float budget_ms);
+
+    /**
+     * @brief Gets the number of tasks that have been queued for the worker threads but have not started yet
+     * @return number of pending worker tasks
+     */
+    size_t pendingWorkerTasks();
+
+    /**
+     * @brief Gets the number of tasks waiting to be run on the GL thread
+     * @return number of pending GL tasks
+     */
+    size_t pendingGLTasks();
+
+    /**
+     * @brief Gets the number of worker threads of the loader
+     * @return number of worker threads
+     */
+    unsigned int numWorkers();
+};
+
+#endif // ASYNCLOADER_H
@@ -58,7 +58,7 @@ Camera::Camera(const Viewport& viewport, ProjectionMode proj_mode, float far, fl
 
     assert(fov < M_PI && fov > 0);
 
-    assert(far < near);
+    assert(far > near);
 }
 
 Camera& Camera::operator = (const Camera& other){
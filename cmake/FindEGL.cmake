@@ -0,0 +1,39 @@
+#
+# Try to find the EGL library and include path.
+# Once done this will define
+#
+# EGL_FOUND
+# EGL_INCLUDE_DIR
+# EGL_LIBRARY
+#
+
+include(FindPackageHandleStandardArgs)
+
+find_path( EGL_INCLUDE_DIR
+    NAMES
+        EGL/egl.h
+    PATHS
+        ${EGL_LOCATION}/include
+        $ENV{EGL_LOCATION}/include
+        /usr/include
+        /usr/local/include
+    DOC "The directory where EGL/egl.h resides" )
+
+find_library( EGL_LIBRARY
+    NAMES
+        EGL
+    PATHS
+        ${EGL_LOCATION}/lib
+        $ENV{EGL_LOCATION}/lib
+        /usr/lib64
+        /usr/lib
+        /usr/local/lib64
+        /usr/local/lib
+    DOC "The EGL library")
+
+find_package_handle_standard_args(EGL DEFAULT_MSG
+    EGL_INCLUDE_DIR
+    EGL_LIBRARY
+)
+
+mark_as_advanced( EGL_FOUND )
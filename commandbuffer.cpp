@@ -0,0 +1,92 @@
+#include "commandbuffer.h"
+
+#include "material.h"
+#include "texture.h"
+#include "mesh.h"
+#include "gpuprofiler.h"
+#include "renderer.h"
+
+#include <cassert>
+
+CommandBuffer::CommandBuffer(){
+}
+
+void CommandBuffer::clear(){
+    commands_.clear();
+    payload_.clear();
+}
+
+void CommandBuffer::uniformMatrix4(GLint location, const float* matrix){
+    push(COMMAND_UNIFORM_MATRIX4, location, (std::int32_t)payload_.size());
+    payload_.insert(payload_.end(), matrix, matrix + 16);
+}
+
+void CommandBuffer::execute(GpuProfiler* profiler, RendererStats& stats){
+    //bit n is set if the zone at depth n was started, as the profiler may skip zones
+    std::uint32_t started_zones = 0;
+    unsigned int zone_depth = 0;
+
+    for(const RenderCommand& command : commands_){
+        switch(command.type){
+        case COMMAND_USE_PROGRAM:
+            glUseProgram((GLuint)command.args[0]);
+            stats.program_binds++;
+            break;
+        case COMMAND_BIND_VERTEX_ARRAY:
+            glBindVertexArray((GLuint)command.args[0]);
+            if(command.args[0] != 0){
+                stats.vertex_array_binds++;
+            }
+            break;
+        case COMMAND_BIND_BUFFER:
+            glBindBuffer((GLenum)command.args[0], (GLuint)command.args[1]);
+            break;
+        case COMMAND_BIND_MATERIAL:
+            ((Material*)command.pointer)->bind();
+            break;
+        case COMMAND_UNIFORM_MATRIX4:
+            glUniformMatrix4fv(command.args[0], 1, GL_FALSE, payload_.data() + command.args[1]);
+            break;
+        case COMMAND_DRAW_ELEMENTS:
+            glDrawElementsBaseVertex(GL_TRIANGLES, command.args[0], GL_UNSIGNED_INT, (GLvoid*)(sizeof(GLuint) * (GLuint)command.args[1]),
+                                     command.args[2]);
+            stats.draw_calls++;
+            stats.triangles += (unsigned int)(command.args[0] / 3);
+            break;
+        case COMMAND_DRAW_MESH:
+            glDrawElementsBaseVertex(GL_TRIANGLES, command.args[0], GL_UNSIGNED_INT, (GLvoid*)(sizeof(GLuint) * (GLuint)command.args[1]),
+                                     ((Mesh*)command.pointer)->getBaseVertex());
+            stats.draw_calls++;
+            stats.triangles += (unsigned int)(command.args[0] / 3);
+            break;
+        case COMMAND_REQUEST_TEXTURE_LEVEL:
+            ((Texture*)command.pointer)->requestLevel((unsigned int)command.args[0]);
+            break;
+        case COMMAND_PUSH_GPU_ZONE:
+            assert(zone_depth < 32);
+            if(profiler != nullptr && profiler->pushZone((const char*)command.pointer)){
+                started_zones |= 1u << zone_depth;
+            }
+            zone_depth++;
+            break;
+        case COMMAND_POP_GPU_ZONE:
+            assert(zone_depth > 0);
+            zone_depth--;
+            if(started_zones & (1u << zone_depth)){
+                profiler->popZone();
+                started_zones &= ~(1u << zone_depth);
+            }
+            break;
+        }
+    }
+
+    assert(zone_depth == 0);
+}
+
+size_t CommandBuffer::size(){
+    return commands_.size();
+}
+
+size_t CommandBuffer::capacityBytes(){
+    return commands_.capacity() * sizeof(RenderCommand) + payload_.capacity() * sizeof(float);
+}
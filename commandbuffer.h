@@ -0,0 +1,166 @@
+#ifndef COMMANDBUFFER_H
+#define COMMANDBUFFER_H
+
+#include "common.h"
+
+#include <cstdint>
+#include <vector>
+
+class Material;
+class Mesh;
+class Texture;
+class GpuProfiler;
+struct RendererStats;
+
+enum RenderCommandType{
+    COMMAND_USE_PROGRAM,
+    COMMAND_BIND_VERTEX_ARRAY,
+    COMMAND_BIND_BUFFER,
+    COMMAND_BIND_MATERIAL,
+    COMMAND_UNIFORM_MATRIX4,
+    COMMAND_DRAW_ELEMENTS,
+    COMMAND_DRAW_MESH,
+    COMMAND_REQUEST_TEXTURE_LEVEL,
+    COMMAND_PUSH_GPU_ZONE,
+    COMMAND_POP_GPU_ZONE
+};
+
+/**
+ * @brief The RenderCommand struct is a command of a CommandBuffer. What the arguments and pointer hold depends on the type, see the recording
+ * functions of CommandBuffer.
+ */
+struct RenderCommand{
+    RenderCommandType type;
+    std::int32_t args[3];
+    const void* pointer;
+};
+
+/**
+ * @brief The CommandBuffer class records the commands of the renderer, so that they can be recorded on any thread and executed in order on the GL
+ * thread later. Commands are fixed size, and data too large for them, such as matrices, goes into a payload stored alongside. Clearing a buffer
+ * keeps its storage, so once a buffer has grown to the size of a frame, recording allocates nothing.
+ *
+ * Recording reads nothing but what is passed in, and makes no GL calls. Materials are bound and texture levels requested when the commands are
+ * executed, as neither is safe to do from other threads.
+ */
+class CommandBuffer
+{
+private:
+    std::vector<RenderCommand> commands_;
+    std::vector<float> payload_;
+
+private:
+    void push(RenderCommandType type, std::int32_t a = 0, std::int32_t b = 0, std::int32_t c = 0, const void* pointer = nullptr){
+        RenderCommand command = {type, {a, b, c}, pointer};
+        commands_.push_back(command);
+    }
+
+public:
+    CommandBuffer();
+    CommandBuffer(const CommandBuffer& other) = delete;
+    CommandBuffer& operator = (const CommandBuffer& other) = delete;
+
+    /**
+     * @brief Removes all commands, keeping the storage for the next recording
+     */
+    void clear();
+
+    /**
+     * @brief Records glUseProgram()
+     */
+    void useProgram(GLuint program){
+        push(COMMAND_USE_PROGRAM, (std::int32_t)program);
+    }
+
+    /**
+     * @brief Records glBindVertexArray()
+     */
+    void bindVertexArray(GLuint vao){
+        push(COMMAND_BIND_VERTEX_ARRAY, (std::int32_t)vao);
+    }
+
+    /**
+     * @brief Records glBindBuffer()
+     */
+    void bindBuffer(GLenum target, GLuint buffer){
+        push(COMMAND_BIND_BUFFER, (std::int32_t)target, (std::int32_t)buffer);
+    }
+
+    /**
+     * @brief Records a call of Material::bind(), made on the GL thread when the buffer is executed. The material has to live until then.
+     */
+    void bindMaterial(Material* material){
+        push(COMMAND_BIND_MATERIAL, 0, 0, 0, material);
+    }
+
+    /**
+     * @brief Records glUniformMatrix4fv() of a single column major matrix, which is copied into the payload
+     * @param location Location of the uniform
+     * @param matrix The 16 floats of the matrix
+     */
+    void uniformMatrix4(GLint location, const float* matrix);
+
+    /**
+     * @brief Records glDrawElementsBaseVertex() of unsigned int triangles
+     * @param count Number of indices
+     * @param first_index Index of the first index in the bound index buffer
+     * @param base_vertex Value added to the indices
+     */
+    void drawElements(GLsizei count, GLuint first_index, GLint base_vertex){
+        push(COMMAND_DRAW_ELEMENTS, (std::int32_t)count, (std::int32_t)first_index, base_vertex);
+    }
+
+    /**
+     * @brief Records glDrawElementsBaseVertex() of unsigned int triangles of a mesh whose base vertex is only known once its data is uploaded,
+     * such as a dynamic mesh, and is read when the buffer is executed
+     * @param mesh The mesh, which has to live until then
+     * @param count Number of indices
+     * @param first_index Index of the first index in the bound index buffer
+     */
+    void drawMesh(Mesh* mesh, GLsizei count, GLuint first_index){
+        push(COMMAND_DRAW_MESH, (std::int32_t)count, (std::int32_t)first_index, 0, mesh);
+    }
+
+    /**
+     * @brief Records a call of Texture::requestLevel(), made when the buffer is executed
+     */
+    void requestTextureLevel(Texture* texture, unsigned int level){
+        push(COMMAND_REQUEST_TEXTURE_LEVEL, (std::int32_t)level, 0, 0, texture);
+    }
+
+    /**
+     * @brief Records the start of a zone of the GPU profiler, which has to be ended in the same buffer
+     * @param name Name of the zone, a string literal
+     */
+    void pushGpuZone(const char* name){
+        push(COMMAND_PUSH_GPU_ZONE, 0, 0, 0, name);
+    }
+
+    /**
+     * @brief Records the end of the last zone started
+     */
+    void popGpuZone(){
+        push(COMMAND_POP_GPU_ZONE);
+    }
+
+    /**
+     * @brief Executes the commands in the order they were recorded. Must be called on the GL thread.
+     * @param profiler Profiler the GPU zones are timed with, or nullptr
+     * @param stats Counters the draws and binds are added to
+     */
+    void execute(GpuProfiler* profiler, RendererStats& stats);
+
+    /**
+     * @brief Gets the number of commands recorded
+     * @return number of commands
+     */
+    size_t size();
+
+    /**
+     * @brief Gets the memory held by the buffer, which is reused by later recordings
+     * @return capacity in bytes
+     */
+    size_t capacityBytes();
+};
+
+#endif // COMMANDBUFFER_H
@@ -11,5 +11,7 @@
 #include <SDL_opengl.h>
 #include <GL/glu.h>
 
+#include "gldispatch.h"
+
 #endif // COMMON
 
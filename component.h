@@ -19,6 +19,10 @@ protected:
     virtual void startup() = 0;
     virtual void shutdown() = 0;
 
+    //called once per fixed simulation step when the timer has a fixed timestep, see Timer::setFixedTimestep(), before frameStart()
+    virtual void fixedFrame(){
+    }
+
 public:
     Component() : priority_(std::numeric_limits<unsigned int>::max()), owner_(nullptr){
     }
@@ -1,7 +1,11 @@
 #include "engine.h"
+#include "renderer.h"
+#include "profiler.h"
 #include <iostream>
 #include <string>
 #include <list>
+#include <chrono>
+#include <algorithm>
 
 bool checkSDLErrors(int code, std::string message){
     if(code < 0){
@@ -48,19 +52,46 @@ bool Engine::startup(std::string title, int width, int height, int x_pos, int y_
         return false;
     }
 
+    initializeSubsystems();
+
+    createWindow(title, width, height, x_pos, y_pos, maximized, fullscreen, resizable, focus);
+
+    return initializeGL(false, RENDER_DEVICE_GL);
+}
+
+bool Engine::startupHeadless(int width, int height, RenderDeviceType device){
+    //only the event queue of SDL is used, which needs no display
+    if(!checkSDLErrors(SDL_Init(SDL_INIT_EVENTS), "SDL unable to initialize")){
+        return false;
+    }
+
+    initializeSubsystems();
+
+    try{
+        window_ = std::unique_ptr<Window>(new Window(width, height, device));
+    }
+    catch(WindowError e){
+        std::cerr << "Error: unable to create headless window, " << e.what() << std::endl;
+        return false;
+    }
+
+    return initializeGL(true, device);
+}
+
+void Engine::initializeSubsystems(){
+    EngineStats::initialize();
     Timer::initialize();
     EventHandler::initialize();
     ResourceManager::initialize();
+}
 
-    createWindow(title, width, height, x_pos, y_pos, maximized, fullscreen, resizable, focus);
-
-    glewExperimental = GL_TRUE;
-    GLenum glew_err = glewInit();
-    if(glew_err != GLEW_OK){
-        std::cerr << "Error initializing GLEW: " << glewGetErrorString(glew_err) << std::endl;
+bool Engine::initializeGL(bool headless, RenderDeviceType device){
+    if(!RenderDevice::initialize(device, headless)){
         return false;
     }
 
+    Renderer::initialize();
+
     glClearColor(0.f, 0.f, 0.f, 1.f);
 
     return true;
@@ -68,24 +99,109 @@ bool Engine::startup(std::string title, int width, int height, int x_pos, int y_
 
 bool Engine::run(){
     EventHandler* event_handler = EventHandler::eventHandler();
-    Timer* timer = Timer::timer();
+
+    PROFILE_THREAD("Main");
 
     while(!event_handler->isQuit()){
-        timer->frame();
-        event_handler->frame();
+        frame();
+    }
+
+    return true;
+}
+
+void Engine::frame(){
+    PROFILE_ZONE("Frame");
+
+    Timer* timer = Timer::timer();
 
+    timer->frame();
+    EventHandler::eventHandler()->frame();
+
+    //the latency of a frame is measured from here until it is presented
+    auto input_time = std::chrono::steady_clock::now();
+
+    //the render thread steps the resource manager along with the frames it renders instead
+    if(render_thread_ == nullptr){
+        ResourceManager::resourceManager()->frame();
+    }
+
+    //the simulation advances in fixed steps, the frame is rendered in between them, see Timer::interpolationAlpha()
+    for(unsigned int i = 0; i < timer->fixedSteps(); ++i){
+        PROFILE_ZONE("Fixed step");
+        window_->fixedFrame();
+    }
+
+    if(render_thread_ != nullptr){
+        FramePacket* packet = render_thread_->acquirePacket();
+        packet->input_time = input_time;
+
+        if(window_->beginFrame(*packet)){
+            render_thread_->submit(packet);
+        }
+        else{
+            render_thread_->releasePacket(packet);
+            render_thread_->submit(nullptr);
+        }
+    }
+    else{
         window_->frame();
+
+        auto latency = std::chrono::steady_clock::now() - input_time;
+        EngineStats::set(COUNTER_INPUT_LATENCY_US, std::chrono::duration_cast<std::chrono::microseconds>(latency).count());
+    }
+
+    EngineStats::set(COUNTER_FRAME_TIME_US, timer->deltaTimeNs() / 1000);
+    EngineStats::engineStats()->frame();
+}
+
+bool Engine::enableRenderThread(unsigned int max_frames_in_flight){
+    if(window_ == nullptr || Renderer::renderer() == nullptr){
+        std::cerr << "Error: the engine has to be started before enabling the render thread" << std::endl;
+        return false;
+    }
+
+    disableRenderThread();
+
+    max_frames_in_flight = std::min(std::max(max_frames_in_flight, 1u), RESOURCE_FREE_DELAY_FRAMES);
+    render_thread_ = std::unique_ptr<RenderThread>(new RenderThread(window_.get(), max_frames_in_flight));
+
+    return true;
+}
+
+void Engine::disableRenderThread(){
+    render_thread_ = nullptr;
+}
+
+bool Engine::renderThreadEnabled(){
+    return render_thread_ != nullptr;
+}
+
+void Engine::runOnGLThread(std::function<void()> task){
+    if(render_thread_ != nullptr){
+        render_thread_->runOnGLThread(std::move(task));
+    }
+    else{
+        task();
     }
 }
 
 bool Engine::shutdown(){
+    //the frames in flight are rendered before anything they use is destroyed
+    disableRenderThread();
+
+    Renderer::shutdown();
     Timer::shutdown();
     EventHandler::shutdown();
     ResourceManager::shutdown();
 
     window_ = nullptr;
 
-    SDL_QuitSubSystem(SDL_INIT_VIDEO);
+    //after the window, whose render target and readback are the last GL objects
+    RenderDevice::shutdown();
+
+    EngineStats::shutdown();
+
+    SDL_QuitSubSystem(SDL_INIT_VIDEO | SDL_INIT_EVENTS);
 
     SDL_Quit();
 
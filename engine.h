@@ -5,11 +5,15 @@
 
 #include <memory>
 #include <unordered_map>
+#include <functional>
 
 #include "eventhandler.h"
 #include "timer.h"
 #include "window.h"
 #include "resourcemanager.h"
+#include "enginestats.h"
+#include "renderdevice.h"
+#include "renderthread.h"
 
 class Engine
 {
@@ -22,6 +26,9 @@ private:
 
     std::unique_ptr<Window> window_;
 
+    //renders the frames built by frame() when enabled, see enableRenderThread()
+    std::unique_ptr<RenderThread> render_thread_;
+
 private:
     Engine();
     Engine(const Engine& other) = delete;
@@ -30,12 +37,68 @@ private:
     Window* createWindow(std::string title, int width, int height, int x_pos, int y_pos, bool maximized,
                          bool fullscreen, bool resizable, bool focus);
 
+    //initializes the subsystems which need no GL context
+    void initializeSubsystems();
+
+    //loads the GL functions, or those of the null device, and initializes the renderer, once the context of the window, if any, is current
+    bool initializeGL(bool headless, RenderDeviceType device);
+
 public:
     static Engine* engine();
 
     bool startup(std::string title = "Mazz's Long Wang", int width = 0, int height = 0, int x_pos = UNDEFINED_WINDOW_POS, int y_pos = UNDEFINED_WINDOW_POS, bool maximized = true,
                  bool fullscreen = true, bool resizable = true, bool focus = true);
+
+    /**
+     * @brief Starts the engine without a display, rendering into an offscreen RenderTarget of a window created through EGL. This works on
+     * machines without a GPU through Mesa's software rasterizer. Needs the engine to be built with the ENGINE_HEADLESS option, unless the null
+     * device is used, which needs no context at all, see RenderDevice.
+     * @param width Width of the frames in pixels
+     * @param height Height of the frames in pixels
+     * @param device Device the GL calls go to
+     * @return true if succeeded, false if no offscreen context could be created
+     */
+    bool startupHeadless(int width, int height, RenderDeviceType device = RENDER_DEVICE_GL);
+
     bool run();
+
+    /**
+     * @brief Runs a single frame, for driving the engine from outside of run(), such as when rendering a set number of frames headless
+     */
+    void frame();
+
+    /**
+     * @brief Moves rendering onto a thread of its own, which owns the GL context, so that frame() builds the next frame while the last one is being
+     * rendered. Raises throughput when both the main thread and rendering take a good part of the frame, at the cost of latency, as a frame is
+     * only presented once those before it are. See RenderThread.
+     *
+     * While enabled, anything making GL calls from the main thread, such as creating resources, renderables or render targets, or resizing a
+     * headless window, has to go through runOnGLThread(). The same goes for Texture::getTextureName(), which may upload or evict textures, whereas
+     * creating and freeing textures through the TextureManager is safe. Materials must not be changed while frames which bind them may still be
+     * in flight.
+     * @param max_frames_in_flight Number of frames which may be built but not yet presented, 1 for double buffering or 2 for triple buffering.
+     * Clamped to between 1 and RESOURCE_FREE_DELAY_FRAMES, as resources freed by the main thread must outlive the frames in flight which use them.
+     * @return true if succeeded, false if the engine has not been started
+     */
+    bool enableRenderThread(unsigned int max_frames_in_flight = 1);
+
+    /**
+     * @brief Renders the frames still in flight, and moves rendering back onto the calling thread
+     */
+    void disableRenderThread();
+
+    /**
+     * @brief Checks if frames are rendered on a render thread, see enableRenderThread()
+     * @return true if there is a render thread, otherwise false
+     */
+    bool renderThreadEnabled();
+
+    /**
+     * @brief Runs \p task on the thread the GL context is current on, and waits for it to finish. Without a render thread, it is run right away.
+     * @param task Task to run
+     */
+    void runOnGLThread(std::function<void()> task);
+
     bool shutdown();
 
     Window* window();
@@ -0,0 +1,181 @@
+#include "enginestats.h"
+
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+
+std::atomic<std::int64_t> EngineStats::counters_[COUNTER_COUNT];
+std::unique_ptr<EngineStats> EngineStats::engine_stats_ = nullptr;
+
+const unsigned int DEFAULT_STATS_WINDOW = 300;
+
+bool EngineStats::initialize(){
+    if(EngineStats::engine_stats_ != nullptr){
+        return false;
+    }
+
+    EngineStats::engine_stats_ = std::unique_ptr<EngineStats>(new EngineStats());
+
+    return true;
+}
+
+bool EngineStats::shutdown(){
+    if(EngineStats::engine_stats_ == nullptr){
+        return false;
+    }
+
+    EngineStats::engine_stats_ = nullptr;
+
+    return true;
+}
+
+EngineStats* EngineStats::engineStats(){
+    return EngineStats::engine_stats_.get();
+}
+
+EngineStats::EngineStats() : history_(DEFAULT_STATS_WINDOW), history_next_(0), history_size_(0), frame_(0), dump_format_(STATS_FORMAT_CSV),
+                             dump_interval_(0){
+}
+
+EngineStats::~EngineStats(){
+}
+
+const char* EngineStats::counterName(EngineCounter counter){
+    switch(counter){
+    case COUNTER_FRAME_TIME_US: return "frame_time_us";
+    case COUNTER_GPU_TIME_US: return "gpu_time_us";
+    case COUNTER_INPUT_LATENCY_US: return "input_latency_us";
+    case COUNTER_SCENE_NODES: return "scene_nodes";
+    case COUNTER_COMPONENTS: return "components";
+    case COUNTER_MESHES: return "meshes";
+    case COUNTER_SHADERS: return "shaders";
+    case COUNTER_TEXTURES: return "textures";
+    case COUNTER_MESH_BYTES: return "mesh_bytes";
+    case COUNTER_TEXTURE_BYTES: return "texture_bytes";
+    case COUNTER_DRAW_CALLS: return "draw_calls";
+    case COUNTER_TRIANGLES: return "triangles";
+    case COUNTER_STATE_CHANGES: return "state_changes";
+    case COUNTER_GPU_ALLOCATIONS: return "gpu_allocations";
+    default: return "unknown";
+    }
+}
+
+bool EngineStats::isPerFrame(EngineCounter counter){
+    return counter >= COUNTER_DRAW_CALLS && counter < COUNTER_COUNT;
+}
+
+void EngineStats::frame(){
+    EngineFrameStats& snapshot = history_[history_next_];
+    snapshot.frame = frame_;
+
+    for(int i = 0; i < COUNTER_COUNT; ++i){
+        EngineCounter counter = (EngineCounter)i;
+        snapshot.values[i] = isPerFrame(counter) ? counters_[i].exchange(0, std::memory_order_relaxed) : counters_[i].load(std::memory_order_relaxed);
+    }
+
+    history_next_ = (history_next_ + 1) % history_.size();
+    history_size_ = std::min(history_size_ + 1, history_.size());
+    frame_++;
+
+    if(dump_interval_ > 0 && frame_ % dump_interval_ == 0){
+        dump();
+    }
+}
+
+void EngineStats::dump(){
+    if(dump_format_ == STATS_FORMAT_CSV){
+        for(int i = 0; i < COUNTER_COUNT; ++i){
+            EngineCounterSummary summary = getSummary((EngineCounter)i);
+
+            dump_file_ << frame_ << "," << counterName((EngineCounter)i) << "," << summary.last << "," << summary.min << "," << summary.mean << ","
+                       << summary.max << "," << summary.p99 << "\n";
+        }
+    }
+    else{
+        dump_file_ << "{\"frame\":" << frame_ << ",\"frames\":" << history_size_ << ",\"counters\":{";
+
+        for(int i = 0; i < COUNTER_COUNT; ++i){
+            EngineCounterSummary summary = getSummary((EngineCounter)i);
+
+            dump_file_ << (i > 0 ? "," : "") << "\"" << counterName((EngineCounter)i) << "\":{\"last\":" << summary.last << ",\"min\":" << summary.min
+                       << ",\"mean\":" << summary.mean << ",\"max\":" << summary.max << ",\"p99\":" << summary.p99 << "}";
+        }
+
+        dump_file_ << "}}\n";
+    }
+
+    //flushed so that the file is usable while the engine is still running, or if it crashes
+    dump_file_.flush();
+}
+
+void EngineStats::setWindow(unsigned int frames){
+    history_.assign(std::max(frames, 1u), EngineFrameStats());
+    history_next_ = 0;
+    history_size_ = 0;
+}
+
+EngineFrameStats EngineStats::getLastFrame(){
+    if(history_size_ == 0){
+        return EngineFrameStats();
+    }
+
+    return history_[(history_next_ + history_.size() - 1) % history_.size()];
+}
+
+EngineCounterSummary EngineStats::getSummary(EngineCounter counter){
+    EngineCounterSummary summary;
+    if(history_size_ == 0){
+        return summary;
+    }
+
+    std::vector<std::int64_t> values;
+    values.reserve(history_size_);
+
+    //the ring is only full once it has wrapped around, before that the frames start at index 0
+    size_t first = history_size_ == history_.size() ? history_next_ : 0;
+    for(size_t i = 0; i < history_size_; ++i){
+        values.push_back(history_[(first + i) % history_.size()].values[counter]);
+    }
+
+    summary.last = values.back();
+
+    double sum = 0.0;
+    for(auto value : values){
+        sum += (double)value;
+    }
+    summary.mean = sum / values.size();
+
+    std::sort(values.begin(), values.end());
+    summary.min = values.front();
+    summary.max = values.back();
+    summary.p99 = values[std::min((size_t)std::ceil(values.size() * 0.99) - 1, values.size() - 1)];
+
+    return summary;
+}
+
+bool EngineStats::setDumpFile(const std::string& filename, EngineStatsFormat format, unsigned int interval_frames){
+    if(dump_file_.is_open()){
+        dump_file_.close();
+    }
+
+    dump_interval_ = 0;
+
+    if(filename.empty()){
+        return true;
+    }
+
+    dump_file_.open(filename, std::ios::out | std::ios::trunc);
+    if(!dump_file_.is_open()){
+        std::cerr << "Error: unable to open stats file " << filename << std::endl;
+        return false;
+    }
+
+    dump_format_ = format;
+    dump_interval_ = std::max(interval_frames, 1u);
+
+    if(dump_format_ == STATS_FORMAT_CSV){
+        dump_file_ << "frame,counter,last,min,mean,max,p99\n";
+    }
+
+    return true;
+}
@@ -0,0 +1,178 @@
+#ifndef ENGINESTATS_H
+#define ENGINESTATS_H
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Counters collected by the engine. Per frame counters are reset after every frame, the others hold a current amount.
+ */
+enum EngineCounter{
+    //gauges
+    COUNTER_FRAME_TIME_US,
+    COUNTER_GPU_TIME_US,
+    //from polling the events of a frame until it has been presented
+    COUNTER_INPUT_LATENCY_US,
+    COUNTER_SCENE_NODES,
+    COUNTER_COMPONENTS,
+    COUNTER_MESHES,
+    COUNTER_SHADERS,
+    COUNTER_TEXTURES,
+    COUNTER_MESH_BYTES,
+    COUNTER_TEXTURE_BYTES,
+    //per frame
+    COUNTER_DRAW_CALLS,
+    COUNTER_TRIANGLES,
+    //program, vertex array and texture binds
+    COUNTER_STATE_CHANGES,
+    //GL buffers and textures created
+    COUNTER_GPU_ALLOCATIONS,
+    COUNTER_COUNT
+};
+
+enum EngineStatsFormat{STATS_FORMAT_CSV, STATS_FORMAT_JSON};
+
+/**
+ * @brief The EngineCounterSummary struct summarizes a counter over the frames kept by the EngineStats
+ */
+struct EngineCounterSummary{
+    std::int64_t last;
+    std::int64_t min;
+    std::int64_t max;
+    double mean;
+    //value which 99% of the frames are at or below
+    std::int64_t p99;
+
+    EngineCounterSummary() : last(0), min(0), max(0), mean(0.0), p99(0){
+    }
+};
+
+/**
+ * @brief The EngineFrameStats struct is the snapshot of every counter at the end of a frame
+ */
+struct EngineFrameStats{
+    std::uint64_t frame;
+    std::int64_t values[COUNTER_COUNT];
+
+    EngineFrameStats() : frame(0), values(){
+    }
+};
+
+/**
+ * @brief The EngineStats class gathers counters from the scene, renderer and resources into a snapshot per frame, and summarizes them over a
+ * rolling window of frames. Counters are atomics which can be updated from any thread, even before the engine has started, and subsystems
+ * update them in bulk where they can, so collecting them costs next to nothing. The summaries can be queried, or periodically appended to a
+ * CSV or JSON file to track regressions.
+ */
+class EngineStats
+{
+friend std::unique_ptr<EngineStats>::deleter_type;
+friend class Engine;
+private:
+    static std::atomic<std::int64_t> counters_[COUNTER_COUNT];
+
+    //ring of the snapshots of the last window_ frames
+    std::vector<EngineFrameStats> history_;
+    size_t history_next_;
+    size_t history_size_;
+    std::uint64_t frame_;
+
+    std::ofstream dump_file_;
+    EngineStatsFormat dump_format_;
+    unsigned int dump_interval_;
+
+    static std::unique_ptr<EngineStats> engine_stats_;
+
+private:
+    EngineStats();
+    EngineStats(const EngineStats& other) = delete;
+    ~EngineStats();
+
+    static bool initialize();
+    static bool shutdown();
+
+    //takes the snapshot of the frame, resets the per frame counters, and dumps the summaries when due
+    void frame();
+
+    //appends the summaries to the dump file
+    void dump();
+
+public:
+    static EngineStats* engineStats();
+
+    /**
+     * @brief Adds to a counter
+     * @param counter Counter
+     * @param amount Amount to add, negative to subtract
+     */
+    static void add(EngineCounter counter, std::int64_t amount = 1){
+        counters_[counter].fetch_add(amount, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Sets a counter
+     * @param counter Counter
+     * @param value Value
+     */
+    static void set(EngineCounter counter, std::int64_t value){
+        counters_[counter].store(value, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Gets the current value of a counter, which for per frame counters is the amount so far this frame
+     * @param counter Counter
+     * @return value of the counter
+     */
+    static std::int64_t get(EngineCounter counter){
+        return counters_[counter].load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Gets the name of a counter, as used in dumps
+     * @param counter Counter
+     * @return name of the counter
+     */
+    static const char* counterName(EngineCounter counter);
+
+    /**
+     * @brief Checks if a counter is reset after every frame
+     * @param counter Counter
+     * @return true if the counter is per frame, false if it holds a current amount
+     */
+    static bool isPerFrame(EngineCounter counter);
+
+    /**
+     * @brief Sets the number of frames summaries are made over, discarding the frames kept so far
+     * @param frames Number of frames. Default is 300.
+     */
+    void setWindow(unsigned int frames);
+
+    /**
+     * @brief Gets the snapshot of the last completed frame
+     * @return counters of the last frame
+     */
+    EngineFrameStats getLastFrame();
+
+    /**
+     * @brief Summarizes a counter over the frames in the window
+     * @param counter Counter
+     * @return summary of the counter
+     */
+    EngineCounterSummary getSummary(EngineCounter counter);
+
+    /**
+     * @brief Starts appending the summaries of every counter to a file every so many frames. CSV files get a row per counter, JSON files a line
+     * holding an object per dump.
+     * @param filename Name of the file, which is truncated. An empty name stops dumping.
+     * @param format Format of the file
+     * @param interval_frames Number of frames between dumps. Default is every 300 frames.
+     * @return true if succeeded, false if the file could not be opened
+     */
+    bool setDumpFile(const std::string& filename, EngineStatsFormat format, unsigned int interval_frames = 300);
+};
+
+#endif // ENGINESTATS_H
@@ -1,4 +1,5 @@
 #include "eventhandler.h"
+#include "profiler.h"
 #include <list>
 #include <iostream>
 
@@ -35,6 +36,8 @@ EventHandler::~EventHandler(){
 }
 
 void EventHandler::frame(){
+    PROFILE_ZONE("Events");
+
     resetKeys();
     resetMouseInfo();
     resetWindowEvents();
@@ -0,0 +1,168 @@
+#include "filewatcher.h"
+
+#include <cerrno>
+#include <iostream>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#include <fcntl.h>
+#endif
+
+#ifdef __linux__
+
+FileWatcher::FileWatcher() : inotify_fd_(-1), has_changes_(false){
+    wake_fds_[0] = -1;
+    wake_fds_[1] = -1;
+
+    inotify_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if(inotify_fd_ < 0 || pipe2(wake_fds_, O_CLOEXEC) != 0){
+        std::cerr << "Error: unable to initialize inotify, files will not be watched" << std::endl;
+        return;
+    }
+
+    thread_ = std::thread(&FileWatcher::watchLoop, this);
+}
+
+FileWatcher::~FileWatcher(){
+    if(thread_.joinable()){
+        char wake = 0;
+        while(write(wake_fds_[1], &wake, 1) < 0 && errno == EINTR){
+        }
+
+        thread_.join();
+    }
+
+    for(int fd : {inotify_fd_, wake_fds_[0], wake_fds_[1]}){
+        if(fd >= 0){
+            close(fd);
+        }
+    }
+}
+
+bool FileWatcher::isSupported(){
+    return thread_.joinable();
+}
+
+bool FileWatcher::watch(const std::string& filename){
+    if(!isSupported()){
+        return false;
+    }
+
+    size_t separator = filename.find_last_of('/');
+    std::string directory = separator == std::string::npos ? "." : filename.substr(0, separator + 1);
+    std::string name = separator == std::string::npos ? filename : filename.substr(separator + 1);
+
+    std::lock_guard<std::mutex> lock(watched_mutex_);
+
+    auto iter = directories_.find(directory);
+    if(iter == directories_.end()){
+        int wd = inotify_add_watch(inotify_fd_, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+        if(wd < 0){
+            std::cerr << "Error: unable to watch directory " << directory << std::endl;
+            return false;
+        }
+
+        iter = directories_.insert(std::make_pair(directory, wd)).first;
+    }
+
+    watched_[iter->second][name] = filename;
+
+    return true;
+}
+
+std::vector<std::string> FileWatcher::changedFiles(){
+    std::vector<std::string> files;
+
+    if(!has_changes_.load(std::memory_order_acquire)){
+        return files;
+    }
+
+    std::lock_guard<std::mutex> lock(changed_mutex_);
+
+    files.assign(changed_.begin(), changed_.end());
+    changed_.clear();
+    has_changes_.store(false, std::memory_order_release);
+
+    return files;
+}
+
+void FileWatcher::watchLoop(){
+    //large enough for a good number of events, which are variable in size due to their names
+    alignas(inotify_event) char buffer[16 * 1024];
+
+    while(true){
+        pollfd fds[2] = {{inotify_fd_, POLLIN, 0}, {wake_fds_[0], POLLIN, 0}};
+
+        if(poll(fds, 2, -1) < 0){
+            if(errno == EINTR){
+                continue;
+            }
+
+            break;
+        }
+
+        if(fds[1].revents != 0){
+            break;
+        }
+
+        ssize_t length;
+        while((length = read(inotify_fd_, buffer, sizeof(buffer))) > 0){
+            std::vector<std::string> files;
+
+            {
+                std::lock_guard<std::mutex> lock(watched_mutex_);
+
+                for(char* position = buffer; position < buffer + length;){
+                    inotify_event* event = (inotify_event*)position;
+                    position += sizeof(inotify_event) + event->len;
+
+                    auto directory = watched_.find(event->wd);
+                    if(directory == watched_.end() || event->len == 0){
+                        continue;
+                    }
+
+                    auto file = directory->second.find(event->name);
+                    if(file != directory->second.end()){
+                        files.push_back(file->second);
+                    }
+                }
+            }
+
+            if(!files.empty()){
+                std::lock_guard<std::mutex> lock(changed_mutex_);
+
+                changed_.insert(files.begin(), files.end());
+                has_changes_.store(true, std::memory_order_release);
+            }
+        }
+    }
+}
+
+#else
+
+FileWatcher::FileWatcher() : inotify_fd_(-1), has_changes_(false){
+    wake_fds_[0] = -1;
+    wake_fds_[1] = -1;
+}
+
+FileWatcher::~FileWatcher(){
+}
+
+bool FileWatcher::isSupported(){
+    return false;
+}
+
+bool FileWatcher::watch(const std::string& filename){
+    return false;
+}
+
+std::vector<std::string> FileWatcher::changedFiles(){
+    return std::vector<std::string>();
+}
+
+void FileWatcher::watchLoop(){
+}
+
+#endif
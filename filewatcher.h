@@ -0,0 +1,64 @@
+#ifndef FILEWATCHER_H
+#define FILEWATCHER_H
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * @brief The FileWatcher class watches files for changes on a background thread, using inotify. The directories of the files are watched rather than
+ * the files themselves, so that files which editors replace by renaming a new file over them are still picked up. Checking for changes is a single
+ * atomic load while nothing has changed. On platforms without inotify, no files can be watched.
+ */
+class FileWatcher
+{
+private:
+    int inotify_fd_;
+    //written to by the destructor to wake up the watcher thread
+    int wake_fds_[2];
+    std::thread thread_;
+
+    //watched files, by the watch descriptor of their directory and their name within it
+    std::unordered_map<int, std::unordered_map<std::string, std::string> > watched_;
+    std::unordered_map<std::string, int> directories_;
+    std::mutex watched_mutex_;
+
+    std::unordered_set<std::string> changed_;
+    std::atomic<bool> has_changes_;
+    std::mutex changed_mutex_;
+
+private:
+    //main loop of the watcher thread, collects the changed files until the watcher is destroyed
+    void watchLoop();
+
+public:
+    FileWatcher();
+    FileWatcher(const FileWatcher& other) = delete;
+    FileWatcher& operator = (const FileWatcher& other) = delete;
+    ~FileWatcher();
+
+    /**
+     * @brief Checks if files can be watched on this platform
+     * @return true if supported, otherwise false
+     */
+    bool isSupported();
+
+    /**
+     * @brief Starts watching \p filename. Watching a file twice has no effect.
+     * @param filename Name of the file, as it is reported by changedFiles()
+     * @return true if succeeded, false if the directory of the file could not be watched
+     */
+    bool watch(const std::string& filename);
+
+    /**
+     * @brief Gets the files which have been written to, or replaced, since the last call. Can be called from any thread.
+     * @return names of the changed files, as passed to watch()
+     */
+    std::vector<std::string> changedFiles();
+};
+
+#endif // FILEWATCHER_H
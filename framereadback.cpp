@@ -0,0 +1,127 @@
+#include "framereadback.h"
+#include "enginestats.h"
+
+#include <algorithm>
+#include <cstring>
+
+FrameReadback::FrameReadback(unsigned int buffers) : slots_(std::max(buffers, 1u)), next_slot_(0), oldest_slot_(0), pending_(0), dropped_frames_(0){
+    for(auto& slot : slots_){
+        slot.pbo = 0;
+        slot.fence = 0;
+        slot.size = 0;
+        slot.frame = 0;
+        slot.width = 0;
+        slot.height = 0;
+    }
+}
+
+FrameReadback::~FrameReadback(){
+    for(auto& slot : slots_){
+        if(slot.fence != 0){
+            glDeleteSync(slot.fence);
+        }
+
+        if(slot.pbo != 0){
+            glDeleteBuffers(1, &slot.pbo);
+        }
+    }
+}
+
+bool FrameReadback::capture(std::uint64_t frame, int width, int height){
+    if(pending_ == slots_.size()){
+        dropped_frames_++;
+        return false;
+    }
+
+    ReadbackSlot& slot = slots_[next_slot_];
+    size_t size = (size_t)width * (size_t)height * 4;
+
+    if(slot.pbo == 0){
+        glGenBuffers(1, &slot.pbo);
+    }
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+
+    //the buffer is only reallocated when the size of the frames changes
+    if(slot.size != size){
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, NULL, GL_STREAM_READ);
+        slot.size = size;
+        EngineStats::add(COUNTER_GPU_ALLOCATIONS);
+    }
+
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, (GLvoid*)0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.frame = frame;
+    slot.width = width;
+    slot.height = height;
+
+    next_slot_ = (next_slot_ + 1) % slots_.size();
+    pending_++;
+
+    return true;
+}
+
+void FrameReadback::readSlot(CapturedFrame& frame){
+    ReadbackSlot& slot = slots_[oldest_slot_];
+
+    glDeleteSync(slot.fence);
+    slot.fence = 0;
+
+    frame.frame = slot.frame;
+    frame.width = slot.width;
+    frame.height = slot.height;
+    frame.pixels.resize(slot.size);
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+    void* data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, slot.size, GL_MAP_READ_BIT);
+    if(data != nullptr){
+        std::memcpy(&frame.pixels[0], data, slot.size);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    oldest_slot_ = (oldest_slot_ + 1) % slots_.size();
+    pending_--;
+}
+
+bool FrameReadback::poll(CapturedFrame& frame){
+    if(pending_ == 0){
+        return false;
+    }
+
+    GLenum result = glClientWaitSync(slots_[oldest_slot_].fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+    if(result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED){
+        return false;
+    }
+
+    readSlot(frame);
+
+    return true;
+}
+
+bool FrameReadback::wait(CapturedFrame& frame){
+    if(pending_ == 0){
+        return false;
+    }
+
+    //waits in slices of a millisecond, flushing first so the fence is sure to be reached
+    GLenum result = glClientWaitSync(slots_[oldest_slot_].fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+    while(result == GL_TIMEOUT_EXPIRED){
+        result = glClientWaitSync(slots_[oldest_slot_].fence, 0, 1000000);
+    }
+
+    readSlot(frame);
+
+    return true;
+}
+
+unsigned int FrameReadback::pendingFrames(){
+    return pending_;
+}
+
+std::uint64_t FrameReadback::droppedFrames(){
+    return dropped_frames_;
+}
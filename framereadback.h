@@ -0,0 +1,99 @@
+#ifndef FRAMEREADBACK_H
+#define FRAMEREADBACK_H
+
+#include "common.h"
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief The CapturedFrame struct holds the pixels of a frame read back from the GPU
+ */
+struct CapturedFrame{
+    //engine frame the pixels were captured on
+    std::uint64_t frame;
+    int width;
+    int height;
+    //RGBA8 pixels, tightly packed, with the bottom row first as in OpenGL
+    std::vector<unsigned char> pixels;
+
+    CapturedFrame() : frame(0), width(0), height(0){
+    }
+};
+
+/**
+ * @brief The FrameReadback class copies frames from the read framebuffer into a ring of pixel pack buffers, and hands them out once the GPU
+ * has finished the copy, so capturing a frame does not stall the pipeline. If every buffer is still waiting to be read, further frames are
+ * dropped until one is. Used for image comparison tests and video capture.
+ */
+class FrameReadback
+{
+private:
+    struct ReadbackSlot{
+        GLuint pbo;
+        GLsync fence;
+        size_t size;
+        std::uint64_t frame;
+        int width;
+        int height;
+    };
+
+    std::vector<ReadbackSlot> slots_;
+    //slot the next frame is captured into, and the oldest captured slot
+    unsigned int next_slot_;
+    unsigned int oldest_slot_;
+    unsigned int pending_;
+
+    std::uint64_t dropped_frames_;
+
+private:
+    //copies the oldest slot out, whose fence has signalled
+    void readSlot(CapturedFrame& frame);
+
+public:
+    /**
+     * @brief Creates the readback, its buffers are created on first use
+     * @param buffers Number of frames which may be in flight at once, at least 1
+     */
+    FrameReadback(unsigned int buffers = 3);
+    FrameReadback(const FrameReadback& other) = delete;
+    FrameReadback& operator = (const FrameReadback& other) = delete;
+    ~FrameReadback();
+
+    /**
+     * @brief Starts copying the color attachment of the read framebuffer into the next buffer
+     * @param frame Frame number to tag the capture with
+     * @param width Width of the region to capture, from the bottom left corner
+     * @param height Height of the region to capture
+     * @return true if the copy was issued, false if the frame was dropped as all buffers are in flight
+     */
+    bool capture(std::uint64_t frame, int width, int height);
+
+    /**
+     * @brief Gets the oldest captured frame if the GPU has finished copying it, without waiting
+     * @param frame Frame to fill in
+     * @return true if a frame was read, otherwise false
+     */
+    bool poll(CapturedFrame& frame);
+
+    /**
+     * @brief Gets the oldest captured frame, waiting for the GPU to finish copying it
+     * @param frame Frame to fill in
+     * @return true if a frame was read, false if no frames are in flight
+     */
+    bool wait(CapturedFrame& frame);
+
+    /**
+     * @brief Gets the number of frames captured but not yet read
+     * @return number of pending frames
+     */
+    unsigned int pendingFrames();
+
+    /**
+     * @brief Gets the number of frames dropped as all buffers were in flight
+     * @return number of dropped frames
+     */
+    std::uint64_t droppedFrames();
+};
+
+#endif // FRAMEREADBACK_H
@@ -0,0 +1,75 @@
+#ifndef GLDISPATCH_H
+#define GLDISPATCH_H
+
+//included by common.h, after the GL headers
+
+/**
+ * @brief The GLCoreFunctions struct holds the OpenGL 1.1 functions used by the engine. GLEW calls every later function through a pointer it loads,
+ * but 1.1 functions are exported by the GL library and would be called directly, so the macros below route them through this table instead. This
+ * lets the render device replace all GL functions at once, see RenderDevice. Outside of the null device, the table holds the library functions.
+ */
+struct GLCoreFunctions{
+    void (GLAPIENTRY* BindTexture)(GLenum target, GLuint texture);
+    void (GLAPIENTRY* BlendFunc)(GLenum sfactor, GLenum dfactor);
+    void (GLAPIENTRY* Clear)(GLbitfield mask);
+    void (GLAPIENTRY* ClearColor)(GLclampf red, GLclampf green, GLclampf blue, GLclampf alpha);
+    void (GLAPIENTRY* CullFace)(GLenum mode);
+    void (GLAPIENTRY* DeleteTextures)(GLsizei n, const GLuint* textures);
+    void (GLAPIENTRY* DepthFunc)(GLenum func);
+    void (GLAPIENTRY* DepthMask)(GLboolean flag);
+    void (GLAPIENTRY* Disable)(GLenum cap);
+    void (GLAPIENTRY* DrawArrays)(GLenum mode, GLint first, GLsizei count);
+    void (GLAPIENTRY* DrawElements)(GLenum mode, GLsizei count, GLenum type, const GLvoid* indices);
+    void (GLAPIENTRY* Enable)(GLenum cap);
+    void (GLAPIENTRY* Finish)();
+    void (GLAPIENTRY* Flush)();
+    void (GLAPIENTRY* GenTextures)(GLsizei n, GLuint* textures);
+    GLenum (GLAPIENTRY* GetError)();
+    void (GLAPIENTRY* GetFloatv)(GLenum pname, GLfloat* params);
+    void (GLAPIENTRY* GetIntegerv)(GLenum pname, GLint* params);
+    const GLubyte* (GLAPIENTRY* GetString)(GLenum name);
+    void (GLAPIENTRY* PixelStorei)(GLenum pname, GLint param);
+    void (GLAPIENTRY* ReadPixels)(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, GLvoid* pixels);
+    void (GLAPIENTRY* TexImage1D)(GLenum target, GLint level, GLint internalformat, GLsizei width, GLint border, GLenum format, GLenum type,
+                                  const GLvoid* pixels);
+    void (GLAPIENTRY* TexImage2D)(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format,
+                                  GLenum type, const GLvoid* pixels);
+    void (GLAPIENTRY* TexParameterf)(GLenum target, GLenum pname, GLfloat param);
+    void (GLAPIENTRY* TexParameteri)(GLenum target, GLenum pname, GLint param);
+    void (GLAPIENTRY* TexSubImage2D)(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format,
+                                     GLenum type, const GLvoid* pixels);
+    void (GLAPIENTRY* Viewport)(GLint x, GLint y, GLsizei width, GLsizei height);
+};
+
+extern GLCoreFunctions gl_core_functions;
+
+//function like, so that the plain names still refer to the library functions, e.g. when filling in the table
+#define glBindTexture(...) gl_core_functions.BindTexture(__VA_ARGS__)
+#define glBlendFunc(...) gl_core_functions.BlendFunc(__VA_ARGS__)
+#define glClear(...) gl_core_functions.Clear(__VA_ARGS__)
+#define glClearColor(...) gl_core_functions.ClearColor(__VA_ARGS__)
+#define glCullFace(...) gl_core_functions.CullFace(__VA_ARGS__)
+#define glDeleteTextures(...) gl_core_functions.DeleteTextures(__VA_ARGS__)
+#define glDepthFunc(...) gl_core_functions.DepthFunc(__VA_ARGS__)
+#define glDepthMask(...) gl_core_functions.DepthMask(__VA_ARGS__)
+#define glDisable(...) gl_core_functions.Disable(__VA_ARGS__)
+#define glDrawArrays(...) gl_core_functions.DrawArrays(__VA_ARGS__)
+#define glDrawElements(...) gl_core_functions.DrawElements(__VA_ARGS__)
+#define glEnable(...) gl_core_functions.Enable(__VA_ARGS__)
+#define glFinish() gl_core_functions.Finish()
+#define glFlush() gl_core_functions.Flush()
+#define glGenTextures(...) gl_core_functions.GenTextures(__VA_ARGS__)
+#define glGetError() gl_core_functions.GetError()
+#define glGetFloatv(...) gl_core_functions.GetFloatv(__VA_ARGS__)
+#define glGetIntegerv(...) gl_core_functions.GetIntegerv(__VA_ARGS__)
+#define glGetString(...) gl_core_functions.GetString(__VA_ARGS__)
+#define glPixelStorei(...) gl_core_functions.PixelStorei(__VA_ARGS__)
+#define glReadPixels(...) gl_core_functions.ReadPixels(__VA_ARGS__)
+#define glTexImage1D(...) gl_core_functions.TexImage1D(__VA_ARGS__)
+#define glTexImage2D(...) gl_core_functions.TexImage2D(__VA_ARGS__)
+#define glTexParameterf(...) gl_core_functions.TexParameterf(__VA_ARGS__)
+#define glTexParameteri(...) gl_core_functions.TexParameteri(__VA_ARGS__)
+#define glTexSubImage2D(...) gl_core_functions.TexSubImage2D(__VA_ARGS__)
+#define glViewport(...) gl_core_functions.Viewport(__VA_ARGS__)
+
+#endif // GLDISPATCH_H
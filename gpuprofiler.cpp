@@ -0,0 +1,214 @@
+#include "gpuprofiler.h"
+#include "profiler.h"
+
+#include <algorithm>
+
+//frames between measurements of the difference between the GPU and steady clock
+const std::uint64_t GPU_CALIBRATION_INTERVAL = 300;
+
+GpuProfiler::GpuProfiler(unsigned int latency_frames) : initialized_(false), supported_(false), detailed_(false),
+                                                         sets_(std::max(latency_frames, 2u)), current_set_(0), recording_(false), frame_count_(0),
+                                                         skipped_frames_(0), gpu_to_steady_ns_(0), calibration_frame_(0), track_(nullptr){
+#ifdef ENGINE_PROFILING
+    enabled_ = true;
+#else
+    enabled_ = false;
+#endif
+
+    for(auto& set : sets_){
+        set.used = 0;
+        set.frame = 0;
+        set.in_flight = false;
+    }
+}
+
+GpuProfiler::~GpuProfiler(){
+    for(auto& set : sets_){
+        if(!set.queries.empty()){
+            glDeleteQueries((GLsizei)set.queries.size(), &set.queries[0]);
+        }
+    }
+}
+
+void GpuProfiler::initialize(){
+    initialized_ = true;
+
+    supported_ = GLEW_ARB_timer_query != 0;
+    if(supported_){
+        //a counter of 0 bits means timestamps are accepted but never advance
+        GLint bits = 0;
+        glGetQueryiv(GL_TIMESTAMP, GL_QUERY_COUNTER_BITS, &bits);
+        supported_ = bits > 0;
+    }
+
+    if(supported_){
+        track_ = Profiler::createTrack("GPU");
+        calibrate();
+    }
+}
+
+void GpuProfiler::calibrate(){
+    GLint64 gpu_now = 0;
+    glGetInteger64v(GL_TIMESTAMP, &gpu_now);
+
+    gpu_to_steady_ns_ = (std::int64_t)Profiler::steadyNow() - (std::int64_t)gpu_now;
+    calibration_frame_ = frame_count_;
+}
+
+void GpuProfiler::collect(){
+    std::vector<GLuint64> times;
+
+    //sets complete in the order they were issued, so the first one still in flight ends the search
+    for(unsigned int i = 1; i <= sets_.size(); ++i){
+        QuerySet& set = sets_[(current_set_ + i) % sets_.size()];
+        if(!set.in_flight){
+            continue;
+        }
+
+        GLuint available = GL_FALSE;
+        glGetQueryObjectuiv(set.queries[set.used - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if(available == GL_FALSE){
+            break;
+        }
+
+        times.resize(set.used);
+        for(unsigned int j = 0; j < set.used; ++j){
+            glGetQueryObjectui64v(set.queries[j], GL_QUERY_RESULT, &times[j]);
+        }
+
+        GLuint64 frame_start = times[set.zones.front().begin_query];
+
+        last_frame_.frame = set.frame;
+        last_frame_.frame_ms = (double)(times[set.zones.front().end_query] - frame_start) / 1e6;
+        last_frame_.zones.clear();
+
+        bool record = Profiler::isEnabled();
+
+        for(auto& zone : set.zones){
+            GLuint64 start = times[zone.begin_query];
+            GLuint64 end = std::max(times[zone.end_query], start);
+
+            last_frame_.zones.push_back(GpuZoneTime{zone.name, zone.depth, (double)(std::int64_t)(start - frame_start) / 1e6,
+                                                    (double)(end - start) / 1e6});
+
+            if(record){
+                Profiler::recordEvent(track_, ProfileEvent{zone.name, (std::uint64_t)((std::int64_t)start + gpu_to_steady_ns_),
+                                                           (std::uint64_t)((std::int64_t)end + gpu_to_steady_ns_), zone.depth});
+            }
+        }
+
+        set.in_flight = false;
+    }
+}
+
+unsigned int GpuProfiler::timestamp(){
+    QuerySet& set = sets_[current_set_];
+
+    if(set.used == set.queries.size()){
+        size_t old_size = set.queries.size();
+        set.queries.resize(std::max(old_size * 2, (size_t)16));
+        glGenQueries((GLsizei)(set.queries.size() - old_size), &set.queries[old_size]);
+    }
+
+    glQueryCounter(set.queries[set.used], GL_TIMESTAMP);
+
+    return set.used++;
+}
+
+void GpuProfiler::beginFrame(){
+    if(!initialized_){
+        initialize();
+    }
+
+    frame_count_++;
+
+    if(!supported_ || !enabled_){
+        return;
+    }
+
+    collect();
+
+    if(frame_count_ - calibration_frame_ >= GPU_CALIBRATION_INTERVAL){
+        calibrate();
+    }
+
+    unsigned int next_set = (current_set_ + 1) % sets_.size();
+    if(sets_[next_set].in_flight){
+        skipped_frames_++;
+        return;
+    }
+
+    current_set_ = next_set;
+
+    QuerySet& set = sets_[current_set_];
+    set.used = 0;
+    set.zones.clear();
+    set.frame = frame_count_;
+
+    recording_ = true;
+    pushZone("GPU frame");
+}
+
+void GpuProfiler::endFrame(){
+    if(!recording_){
+        return;
+    }
+
+    while(!open_zones_.empty()){
+        popZone();
+    }
+
+    sets_[current_set_].in_flight = true;
+    recording_ = false;
+}
+
+bool GpuProfiler::pushZone(const char* name){
+    if(!recording_){
+        return false;
+    }
+
+    QuerySet& set = sets_[current_set_];
+
+    open_zones_.push_back((unsigned int)set.zones.size());
+    set.zones.push_back(PendingZone{name, (std::uint32_t)open_zones_.size() - 1, timestamp(), 0});
+
+    return true;
+}
+
+void GpuProfiler::popZone(){
+    if(open_zones_.empty()){
+        return;
+    }
+
+    unsigned int end_query = timestamp();
+    sets_[current_set_].zones[open_zones_.back()].end_query = end_query;
+    open_zones_.pop_back();
+}
+
+void GpuProfiler::setEnabled(bool enabled){
+    enabled_ = enabled;
+}
+
+bool GpuProfiler::isEnabled(){
+    return enabled_;
+}
+
+void GpuProfiler::setDetailedZones(bool detailed){
+    detailed_ = detailed;
+}
+
+bool GpuProfiler::detailedZones(){
+    return detailed_;
+}
+
+bool GpuProfiler::isSupported(){
+    return supported_;
+}
+
+const GpuFrameTimes& GpuProfiler::getLastFrame(){
+    return last_frame_;
+}
+
+std::uint64_t GpuProfiler::skippedFrames(){
+    return skipped_frames_;
+}
@@ -0,0 +1,198 @@
+#ifndef GPUPROFILER_H
+#define GPUPROFILER_H
+
+#include "common.h"
+
+#include <cstdint>
+#include <vector>
+
+struct ProfileThreadBuffer;
+
+/**
+ * @brief The GpuZoneTime struct is the time a zone took on the GPU
+ */
+struct GpuZoneTime{
+    //string literal naming the zone
+    const char* name;
+    //nesting depth, the frame itself is at depth 0
+    std::uint32_t depth;
+    //start relative to the start of the frame on the GPU
+    double start_ms;
+    double duration_ms;
+};
+
+/**
+ * @brief The GpuFrameTimes struct holds the zones of the last frame whose queries have completed, which lags behind the current frame
+ */
+struct GpuFrameTimes{
+    //renderer frame the times are from
+    std::uint64_t frame;
+    //time from the start to the end of the frame on the GPU, 0 if no frame has completed
+    double frame_ms;
+    //zones in the order they were opened
+    std::vector<GpuZoneTime> zones;
+
+    GpuFrameTimes() : frame(0), frame_ms(0.0){
+    }
+};
+
+/**
+ * @brief The GpuProfiler class times zones of GL commands on the GPU with GL_TIMESTAMP queries. As GL_TIME_ELAPSED queries cannot be nested,
+ * a timestamp is written at the start and end of each zone instead. The queries of a frame are only read once they are available, frames later,
+ * from a ring of query sets, so the CPU never waits on the GPU. If every set of the ring is still in flight a frame is not timed. Completed zones
+ * are also recorded into a "GPU" track of the Profiler, mapped onto the steady clock, so they line up with the CPU zones in exported traces.
+ * Where timer queries are unsupported, such as on a mock GL backend, zones record nothing and no times are reported.
+ */
+class GpuProfiler
+{
+friend class Renderer;
+private:
+    struct PendingZone{
+        const char* name;
+        std::uint32_t depth;
+        unsigned int begin_query;
+        unsigned int end_query;
+    };
+
+    struct QuerySet{
+        std::vector<GLuint> queries;
+        unsigned int used;
+        std::vector<PendingZone> zones;
+        std::uint64_t frame;
+        bool in_flight;
+    };
+
+    bool initialized_;
+    bool supported_;
+    bool enabled_;
+    bool detailed_;
+
+    std::vector<QuerySet> sets_;
+    unsigned int current_set_;
+    bool recording_;
+    //zones of the current frame which are still open, as indices into its zones
+    std::vector<unsigned int> open_zones_;
+
+    std::uint64_t frame_count_;
+    std::uint64_t skipped_frames_;
+
+    //difference between the steady clock and the GPU clock, measured every so many frames as the clocks drift apart
+    std::int64_t gpu_to_steady_ns_;
+    std::uint64_t calibration_frame_;
+
+    ProfileThreadBuffer* track_;
+    GpuFrameTimes last_frame_;
+
+private:
+    //only constructable by the Renderer
+    GpuProfiler(unsigned int latency_frames);
+
+    //checks for timer query support, on first use as it needs the GL context
+    void initialize();
+
+    //measures the difference between the GPU and steady clock
+    void calibrate();
+
+    //reads the sets whose queries have completed, oldest first
+    void collect();
+
+    //issues a timestamp into the current set
+    unsigned int timestamp();
+
+    //starts timing a frame, reading the times of completed frames
+    void beginFrame();
+
+    //stops timing the frame
+    void endFrame();
+
+public:
+    GpuProfiler(const GpuProfiler& other) = delete;
+    GpuProfiler& operator = (const GpuProfiler& other) = delete;
+    ~GpuProfiler();
+
+    /**
+     * @brief Opens a zone, which must be closed by popZone() within the same frame. Prefer GpuProfileZone.
+     * @param name Name of the zone, a string literal
+     * @return true if the zone is timed, in which case it has to be closed
+     */
+    bool pushZone(const char* name);
+
+    /**
+     * @brief Closes the innermost open zone
+     */
+    void popZone();
+
+    /**
+     * @brief Enables or disables timing from the next frame. Enabled by default when built with ENGINE_PROFILING.
+     * @param enabled Whether zones are timed
+     */
+    void setEnabled(bool enabled);
+
+    /**
+     * @brief Checks if zones are timed
+     * @return true if enabled, otherwise false
+     */
+    bool isEnabled();
+
+    /**
+     * @brief Enables zones around each group of renderables sharing a vertex array and material, in addition to the cameras and passes
+     * @param detailed Whether groups are timed
+     */
+    void setDetailedZones(bool detailed);
+
+    /**
+     * @brief Checks if zones around groups of renderables are timed
+     * @return true if timed, otherwise false
+     */
+    bool detailedZones();
+
+    /**
+     * @brief Checks if the GL context supports timer queries. Always false before the first frame.
+     * @return true if supported, otherwise false
+     */
+    bool isSupported();
+
+    /**
+     * @brief Gets the zones of the last frame whose queries have completed
+     * @return times of the frame, with no zones if none has completed
+     */
+    const GpuFrameTimes& getLastFrame();
+
+    /**
+     * @brief Gets the number of frames which were not timed as all query sets were in flight
+     * @return number of skipped frames
+     */
+    std::uint64_t skippedFrames();
+};
+
+/**
+ * @brief The GpuProfileZone class times the GL commands issued from its construction to its destruction as a zone of a GpuProfiler
+ */
+class GpuProfileZone
+{
+private:
+    GpuProfiler* profiler_;
+
+public:
+    /**
+     * @param profiler Profiler to time the zone with, or nullptr
+     * @param name Name of the zone, a string literal
+     * @param active Whether to time the zone at all
+     */
+    GpuProfileZone(GpuProfiler* profiler, const char* name, bool active = true) : profiler_(nullptr){
+        if(profiler != nullptr && active && profiler->pushZone(name)){
+            profiler_ = profiler;
+        }
+    }
+
+    GpuProfileZone(const GpuProfileZone& other) = delete;
+    GpuProfileZone& operator = (const GpuProfileZone& other) = delete;
+
+    ~GpuProfileZone(){
+        if(profiler_ != nullptr){
+            profiler_->popZone();
+        }
+    }
+};
+
+#endif // GPUPROFILER_H
@@ -0,0 +1,11 @@
+#include "material.h"
+#include "resourcemanager.h"
+
+Shader* Material::getShader(){
+    ResourceManager* resource_manager = ResourceManager::resourceManager();
+    if(resource_manager == nullptr){
+        return nullptr;
+    }
+
+    return resource_manager->getShader(shader_);
+}
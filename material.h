@@ -2,7 +2,31 @@
 #define MATERIAL_H
 
 #include "shader.h"
+#include "shaderpermutations.h"
 #include <memory>
+#include <vector>
+#include <string>
+#include <cassert>
+
+class Texture;
+
+/**
+ * @brief The MaterialLocationNames struct holds the ids of the names of the attributes and uniforms the locations of a Material are resolved from.
+ * The default names are hashed at compile time.
+ */
+struct MaterialLocationNames{
+    StringId position;
+    StringId texcoord;
+    StringId colour;
+    StringId normal;
+    StringId model_mat;
+    StringId view_mat;
+    StringId proj_mat;
+
+    constexpr MaterialLocationNames() : position("position"_sid), texcoord("texcoord"_sid), colour("colour"_sid), normal("normal"_sid), model_mat("model"_sid),
+                                        view_mat("view"_sid), proj_mat("projection"_sid){
+    }
+};
 
 class Material
 {
@@ -15,17 +39,29 @@ protected:
     int view_mat_loc_;
     int proj_mat_loc_;
 
-    Shader* shader_;
+    //a handle rather than a pointer, so that a material whose shader was freed is skipped instead of drawing with a dangling shader
+    ShaderHandle shader_;
+
+    //permutations the shader is a variant of, if any, and the features the variant was selected with
+    ShaderPermutations* permutations_;
+    std::uint64_t features_;
+
+    //textures sampled by the material, which the renderer requests mip levels for
+    std::vector<Texture*> textures_;
+
+    //what the locations were last resolved with, so that they can be resolved again once the shader is reloaded
+    MaterialLocationNames location_names_;
+    std::uint32_t shader_revision_;
 
 public:
-    Material() : position_location_(-1), texcoord_location_(-1), colour_location_(-1), normal_location_(-1), shader_(nullptr),
-                 model_mat_loc_(-1), view_mat_loc_(-1), proj_mat_loc_(-1){
+    Material() : position_location_(-1), texcoord_location_(-1), colour_location_(-1), normal_location_(-1),
+                 model_mat_loc_(-1), view_mat_loc_(-1), proj_mat_loc_(-1), permutations_(nullptr), features_(0), shader_revision_(0){
 
     }
 
     Material(const Material& other) = default;
     Material& operator = (const Material& other) = default;
-    ~Material(){}
+    virtual ~Material(){}
 
     /**
      * @brief Gets vertex attribute location of positional vertex data
@@ -61,10 +97,99 @@ public:
 
     /**
      * @brief Gets an observer pointer to the shader associated with the material
-     * @return an observer pointer to the shader associated with the material
+     * @return an observer pointer to the shader associated with the material, or nullptr if the shader has been freed or was never set
+     */
+    Shader* getShader();
+
+    /**
+     * @brief Sets the shader of the material. Derived materials call this before resolving their locations.
+     * @param shader Shader to render with
+     */
+    void setShader(Shader* shader){
+        assert(shader != nullptr);
+        shader_ = shader->getHandle();
+    }
+
+    /**
+     * @brief Resolves the attribute and matrix locations of the material from the reflection of its shader. Locations whose names the shader does not
+     * have are set to -1. Derived materials call this once their shader is set, instead of querying OpenGL.
+     * @param names Names of the attributes and uniforms
+     */
+    void resolveLocations(const MaterialLocationNames& names = MaterialLocationNames()){
+        Shader* shader = getShader();
+        assert(shader != nullptr);
+
+        position_location_ = shader->getAttributeLocation(names.position);
+        texcoord_location_ = shader->getAttributeLocation(names.texcoord);
+        colour_location_ = shader->getAttributeLocation(names.colour);
+        normal_location_ = shader->getAttributeLocation(names.normal);
+        model_mat_loc_ = shader->getUniformLocation(names.model_mat);
+        view_mat_loc_ = shader->getUniformLocation(names.view_mat);
+        proj_mat_loc_ = shader->getUniformLocation(names.proj_mat);
+
+        location_names_ = names;
+        shader_revision_ = shader->getRevision();
+    }
+
+    /**
+     * @brief Gets the revision of the shader the locations of the material were resolved from, see Shader::getRevision()
+     * @return the revision of the shader when the locations were last resolved
+     */
+    std::uint32_t getShaderRevision(){
+        return shader_revision_;
+    }
+
+    /**
+     * @brief Resolves the locations of the material again after its shader was reloaded, called by the renderer before the material is next
+     * recorded. Derived materials with locations of their own override this to resolve those as well, calling the base version.
+     */
+    virtual void reloadLocations(){
+        resolveLocations(location_names_);
+    }
+
+    /**
+     * @brief Selects the variant of \p permutations with \p features enabled as the shader of the material. Derived materials call this before
+     * looking up their locations. As renderables share VAOs by shader, the variant must not change once a renderable has been created with the material.
+     * @param permutations Shader permutations to select from
+     * @param features Feature mask of the variant, see ShaderPermutations::getFeatureMask()
+     * @return true if the variant compiled, otherwise false, in which case the shader is left unchanged
+     */
+    bool selectVariant(ShaderPermutations* permutations, std::uint64_t features){
+        Shader* shader = permutations->getVariant(features);
+        if(shader == nullptr){
+            return false;
+        }
+
+        shader_ = shader->getHandle();
+        permutations_ = permutations;
+        features_ = features;
+
+        return true;
+    }
+
+    /**
+     * @brief Gets the permutations the shader of the material was selected from
+     * @return observer pointer to the permutations, or nullptr if the shader is not a variant
+     */
+    ShaderPermutations* getPermutations(){
+        return permutations_;
+    }
+
+    /**
+     * @brief Gets the feature mask the shader of the material was selected with
+     * @return the feature mask, 0 if the shader is not a variant
+     */
+    std::uint64_t getFeatures(){
+        return features_;
+    }
+
+    /**
+     * @brief Gets the textures sampled by the material. Derived materials add the textures they bind, so that the renderer can request the mip
+     * levels they need when streamed.
+     * @return the textures of the material
      */
-    Shader* getShader(){
-        return shader_;
+    const std::vector<Texture*>& getTextures(){
+        return textures_;
     }
 
     /**
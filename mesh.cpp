@@ -1,11 +1,35 @@
 #include "mesh.h"
+#include "enginestats.h"
 
-Mesh::Mesh(const std::string& lexical_name, std::uint32_t id, MeshCacheOption cache_option) :  id_(id), vbo_name_(0), ibo_name_(0), indices_(nullptr),
-                                                                                        vertices_(nullptr), cache_option_(cache_option),
-                                                                                        initialized_(false), lexical_name_(lexical_name){
+#include <cstring>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+Mesh::Mesh(const std::string& lexical_name, std::uint32_t id, MeshCacheOption cache_option, MeshUsageOption usage_option) :  id_(id), generation_(0), vbo_name_(0), ibo_name_(0),
+                                                                                        indices_(nullptr), vertices_(nullptr), cache_option_(cache_option),
+                                                                                        usage_option_(usage_option), initialized_(false), num_indices_(0),
+                                                                                        num_vertices_(0), lexical_name_(lexical_name), name_id_(StringId::intern(lexical_name)), bounds_(), uv_density_(0.f), mapped_vertices_(nullptr),
+                                                                                        current_buffer_(0),
+                                                                                        last_prepared_frame_(std::numeric_limits<std::uint64_t>::max()){
+    //dynamic meshes need the cpu copy to stream partial updates to every buffer of the ring
+    if(usage_option_ == DYNAMIC_MESH){
+        cache_option_ = CACHE;
+    }
+
+    for(unsigned int i = 0; i < DYNAMIC_MESH_BUFFER_COUNT; ++i){
+        buffer_fences_[i] = 0;
+        dirty_ranges_[i] = std::make_pair(0, 0);
+    }
 }
 
 Mesh::~Mesh(){
+    for(unsigned int i = 0; i < DYNAMIC_MESH_BUFFER_COUNT; ++i){
+        if(buffer_fences_[i] != 0){
+            glDeleteSync(buffer_fences_[i]);
+        }
+    }
+
     if(vbo_name_ != 0){
         glDeleteBuffers(1, &vbo_name_);
     }
@@ -13,6 +37,10 @@ Mesh::~Mesh(){
     if(ibo_name_ != 0){
         glDeleteBuffers(1, &ibo_name_);
     }
+
+    if(initialized_){
+        EngineStats::add(COUNTER_MESH_BYTES, -(std::int64_t)bufferSize());
+    }
 }
 
 GLuint Mesh::getVBO(){
@@ -43,42 +71,276 @@ GLuint Mesh::getIBO(){
     return ibo_name_;
 }
 
-std::uint32_t Mesh::getID(){
-    return id_;
+std::uint64_t Mesh::getID(){
+    return getHandle().packed();
+}
+
+MeshHandle Mesh::getHandle(){
+    return MeshHandle(id_, generation_);
 }
 
 std::vector<GLuint>* Mesh::getIndices(){
     return indices_.get();
 }
 
-std::string Mesh::getLexicalName(){
+const std::string& Mesh::getLexicalName(){
     return lexical_name_;
 }
 
+StringId Mesh::getNameId(){
+    return name_id_;
+}
+
 std::vector<VertexData>* Mesh::getVertices(){
     return vertices_.get();
 }
 
 bool Mesh::setMeshData(std::unique_ptr<std::vector<VertexData> >&& vertices, std::unique_ptr<std::vector<GLuint> >&& indices){
-    if(initialized_){
+    if(vertices == nullptr || indices == nullptr){
         return false;
     }
 
+    if(initialized_){
+        //the gpu buffers of a dynamic mesh are sized on creation, so the data can only be replaced if it fits exactly
+        if(usage_option_ != DYNAMIC_MESH || vertices->size() != num_vertices_ || indices->size() != num_indices_){
+            return false;
+        }
+
+        //copied into the existing vectors, as pointers from editVertices() are guaranteed to stay valid
+        if(vertices_ != nullptr && indices_ != nullptr){
+            std::copy(vertices->begin(), vertices->end(), vertices_->begin());
+            std::copy(indices->begin(), indices->end(), indices_->begin());
+        }
+        else{
+            vertices_ = std::move(vertices);
+            indices_ = std::move(indices);
+        }
+
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo_name_);
+        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, sizeof(GLuint) * num_indices_, &(*indices_)[0]);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+        markDirty(0, num_vertices_);
+        calculateBounds();
+        calculateUVDensity(&(*vertices_)[0], num_vertices_, &(*indices_)[0], num_indices_);
+
+        return true;
+    }
+
     vertices_ = std::move(vertices);
     indices_ = std::move(indices);
 
     num_indices_ = indices_->size();
-    num_vertices_ = vertices->size();
+    num_vertices_ = vertices_->size();
+
+    lods_.clear();
+    lods_.push_back(MeshLOD{0, num_indices_});
+
+    calculateBounds();
+    calculateUVDensity(vertices_->empty() ? nullptr : &(*vertices_)[0], num_vertices_, indices_->empty() ? nullptr : &(*indices_)[0], num_indices_);
 
     return true;
 }
 
+void Mesh::calculateBounds(){
+    for(int axis = 0; axis < 3; ++axis){
+        bounds_.min[axis] = vertices_->empty() ? 0.f : std::numeric_limits<GLfloat>::max();
+        bounds_.max[axis] = vertices_->empty() ? 0.f : std::numeric_limits<GLfloat>::lowest();
+    }
+
+    for(auto& vertex : *vertices_){
+        for(int axis = 0; axis < 3; ++axis){
+            bounds_.min[axis] = std::min(bounds_.min[axis], vertex.position[axis]);
+            bounds_.max[axis] = std::max(bounds_.max[axis], vertex.position[axis]);
+        }
+    }
+}
+
+void Mesh::calculateUVDensity(const VertexData* vertices, size_t num_vertices, const GLuint* indices, size_t num_indices){
+    double uv_area = 0.0;
+    double model_area = 0.0;
+
+    for(size_t i = 0; i + 2 < num_indices; i += 3){
+        //indices come from user data and files, triangles referring past the vertices are left out rather than read out of bounds
+        if(indices[i] >= num_vertices || indices[i + 1] >= num_vertices || indices[i + 2] >= num_vertices){
+            continue;
+        }
+
+        const VertexData& a = vertices[indices[i]];
+        const VertexData& b = vertices[indices[i + 1]];
+        const VertexData& c = vertices[indices[i + 2]];
+
+        double ab[3], ac[3];
+        for(int axis = 0; axis < 3; ++axis){
+            ab[axis] = b.position[axis] - a.position[axis];
+            ac[axis] = c.position[axis] - a.position[axis];
+        }
+
+        double cross_x = ab[1] * ac[2] - ab[2] * ac[1];
+        double cross_y = ab[2] * ac[0] - ab[0] * ac[2];
+        double cross_z = ab[0] * ac[1] - ab[1] * ac[0];
+        model_area += std::sqrt(cross_x * cross_x + cross_y * cross_y + cross_z * cross_z) / 2.0;
+
+        double uv_ab[2] = {b.texturecoord[0] - a.texturecoord[0], b.texturecoord[1] - a.texturecoord[1]};
+        double uv_ac[2] = {c.texturecoord[0] - a.texturecoord[0], c.texturecoord[1] - a.texturecoord[1]};
+        uv_area += std::abs(uv_ab[0] * uv_ac[1] - uv_ab[1] * uv_ac[0]) / 2.0;
+    }
+
+    uv_density_ = model_area > 0.0 ? (GLfloat)std::sqrt(uv_area / model_area) : 0.f;
+}
+
+GLfloat Mesh::getUVDensity(){
+    return uv_density_;
+}
+
+MeshBounds Mesh::getBounds(){
+    return bounds_;
+}
+
+size_t Mesh::getNumLODs(){
+    return lods_.size();
+}
+
+MeshLOD Mesh::getLOD(size_t level){
+    if(level >= lods_.size()){
+        return MeshLOD{0, 0};
+    }
+
+    return lods_[level];
+}
+
+VertexData* Mesh::editVertices(size_t first, size_t count){
+    if(usage_option_ != DYNAMIC_MESH || vertices_ == nullptr || count == 0 || first + count > num_vertices_){
+        return nullptr;
+    }
+
+    markDirty(first, count);
+
+    return &(*vertices_)[first];
+}
+
+bool Mesh::updateVertices(size_t first, const VertexData* vertices, size_t count){
+    VertexData* dest = editVertices(first, count);
+    if(dest == nullptr){
+        return false;
+    }
+
+    std::memcpy(dest, vertices, sizeof(VertexData) * count);
+
+    return true;
+}
+
+MeshUsageOption Mesh::getUsageOption(){
+    return usage_option_;
+}
+
+GLint Mesh::getBaseVertex(){
+    return usage_option_ == DYNAMIC_MESH ? (GLint)(current_buffer_ * num_vertices_) : 0;
+}
+
+void Mesh::markDirty(size_t first, size_t count){
+    for(unsigned int i = 0; i < DYNAMIC_MESH_BUFFER_COUNT; ++i){
+        auto& range = dirty_ranges_[i];
+
+        if(range.first >= range.second){
+            range = std::make_pair(first, first + count);
+        }
+        else{
+            range.first = std::min(range.first, first);
+            range.second = std::max(range.second, first + count);
+        }
+    }
+}
+
+bool Mesh::prepareFrame(std::uint64_t frame){
+    if(!initialized_ || usage_option_ != DYNAMIC_MESH || last_prepared_frame_ == frame){
+        return false;
+    }
+
+    last_prepared_frame_ = frame;
+
+    //the current buffer only becomes dirty if the vertices were edited after it was written, otherwise it still holds the latest data
+    auto current_range = dirty_ranges_[current_buffer_];
+    if(current_range.first >= current_range.second){
+        return true;
+    }
+
+    current_buffer_ = (current_buffer_ + 1) % DYNAMIC_MESH_BUFFER_COUNT;
+
+    GLsync& fence = buffer_fences_[current_buffer_];
+    if(fence != 0){
+        GLenum wait_result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+        while(wait_result == GL_TIMEOUT_EXPIRED){
+            wait_result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+        }
+
+        glDeleteSync(fence);
+        fence = 0;
+    }
+
+    auto& range = dirty_ranges_[current_buffer_];
+    size_t offset = current_buffer_ * num_vertices_ + range.first;
+    size_t count = range.second - range.first;
+
+    if(mapped_vertices_ != nullptr){
+        std::memcpy(mapped_vertices_ + offset, &(*vertices_)[range.first], sizeof(VertexData) * count);
+    }
+    else{
+        glBindBuffer(GL_ARRAY_BUFFER, vbo_name_);
+        glBufferSubData(GL_ARRAY_BUFFER, sizeof(VertexData) * offset, sizeof(VertexData) * count, &(*vertices_)[range.first]);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    range = std::make_pair(0, 0);
+
+    return true;
+}
+
+void Mesh::fenceFrame(){
+    GLsync& fence = buffer_fences_[current_buffer_];
+    if(fence != 0){
+        glDeleteSync(fence);
+    }
+
+    fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
 void Mesh::initializeBuffers(){
     assert(vertices_ != nullptr && indices_ != nullptr);
 
     glGenBuffers(1, &vbo_name_);
     glBindBuffer(GL_ARRAY_BUFFER, vbo_name_);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(VertexData) * vertices_->size(), &(*vertices_)[0], GL_STATIC_DRAW);
+
+    if(usage_option_ == DYNAMIC_MESH){
+        GLsizeiptr copy_size = sizeof(VertexData) * num_vertices_;
+        GLsizeiptr buffer_size = copy_size * DYNAMIC_MESH_BUFFER_COUNT;
+
+        //persistently map the ring where supported so that updates are plain memcpys, otherwise fall back to sub data uploads
+        if(GLEW_ARB_buffer_storage){
+            GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            glBufferStorage(GL_ARRAY_BUFFER, buffer_size, NULL, flags);
+            mapped_vertices_ = (VertexData*)glMapBufferRange(GL_ARRAY_BUFFER, 0, buffer_size, flags);
+        }
+        else{
+            glBufferData(GL_ARRAY_BUFFER, buffer_size, NULL, GL_STREAM_DRAW);
+        }
+
+        for(unsigned int i = 0; i < DYNAMIC_MESH_BUFFER_COUNT; ++i){
+            if(mapped_vertices_ != nullptr){
+                std::memcpy(mapped_vertices_ + i * num_vertices_, &(*vertices_)[0], copy_size);
+            }
+            else{
+                glBufferSubData(GL_ARRAY_BUFFER, copy_size * i, copy_size, &(*vertices_)[0]);
+            }
+
+            dirty_ranges_[i] = std::make_pair(0, 0);
+        }
+
+        current_buffer_ = 0;
+    }
+    else{
+        glBufferData(GL_ARRAY_BUFFER, sizeof(VertexData) * vertices_->size(), &(*vertices_)[0], GL_STATIC_DRAW);
+    }
 
     glGenBuffers(1, &ibo_name_);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo_name_);
@@ -93,6 +355,41 @@ void Mesh::initializeBuffers(){
     }
 
     initialized_ = true;
+
+    EngineStats::add(COUNTER_GPU_ALLOCATIONS, 2);
+    EngineStats::add(COUNTER_MESH_BYTES, (std::int64_t)bufferSize());
+}
+
+size_t Mesh::bufferSize(){
+    size_t copies = usage_option_ == DYNAMIC_MESH ? DYNAMIC_MESH_BUFFER_COUNT : 1;
+    return sizeof(VertexData) * num_vertices_ * copies + sizeof(GLuint) * num_indices_;
+}
+
+void Mesh::initializeBuffers(const VertexData* vertices, size_t num_vertices, const GLuint* indices, size_t num_indices){
+    assert(usage_option_ == STATIC_MESH && vertices != nullptr && indices != nullptr);
+
+    vertices_ = nullptr;
+    indices_ = nullptr;
+    num_vertices_ = num_vertices;
+    num_indices_ = num_indices;
+
+    calculateUVDensity(vertices, num_vertices, indices, num_indices);
+
+    glGenBuffers(1, &vbo_name_);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo_name_);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(VertexData) * num_vertices, vertices, GL_STATIC_DRAW);
+
+    glGenBuffers(1, &ibo_name_);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo_name_);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint) * num_indices, indices, GL_STATIC_DRAW);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    initialized_ = true;
+
+    EngineStats::add(COUNTER_GPU_ALLOCATIONS, 2);
+    EngineStats::add(COUNTER_MESH_BYTES, (std::int64_t)bufferSize());
 }
 
 size_t Mesh::getNumIndices(){
@@ -2,6 +2,8 @@
 #define MESH_H
 
 #include "common.h"
+#include "resourcepool.h"
+#include "stringid.h"
 
 #include <vector>
 #include <memory>
@@ -14,17 +16,49 @@ struct VertexData{
     GLfloat texturecoord[2];
 };
 
+/**
+ * @brief The MeshBounds struct holds the axis aligned bounding box of a mesh in model space
+ */
+struct MeshBounds{
+    GLfloat min[3];
+    GLfloat max[3];
+};
+
+/**
+ * @brief The MeshLOD struct describes a level of detail of a mesh as a range of its indices. Level 0 is the most detailed.
+ */
+struct MeshLOD{
+    size_t first_index;
+    size_t num_indices;
+};
+
 /**
  * @brief The MeshCacheOption enum specifies vertex and index caching options. DELETE_ON_BUFFER_CREATION sets to delete the data once it has
  * been transfered to the GPU, whereas CACHE keeps the data on the cpu.
  */
 enum MeshCacheOption{DELETE_ON_BUFFER_CREATION, CACHE};
 
+/**
+ * @brief The MeshUsageOption enum specifies how the vertex data of the mesh is expected to change. STATIC_MESH data is uploaded once and can not be
+ * modified afterwards, whereas DYNAMIC_MESH data is streamed to the GPU through a ring of buffers and can be rewritten every frame. Dynamic meshes
+ * always keep a CPU copy of their data, regardless of the cache option.
+ */
+enum MeshUsageOption{STATIC_MESH, DYNAMIC_MESH};
+
+//number of copies of the vertex data kept on the GPU for dynamic meshes, so that the CPU can write a copy while the GPU still reads the others
+const unsigned int DYNAMIC_MESH_BUFFER_COUNT = 3;
+
+class Mesh;
+typedef ResourceHandle<Mesh> MeshHandle;
+
 class Mesh
 {
 friend class ResourceManager;
+friend class Renderer;
 private:
     std::uint32_t id_;
+    //generation of the slot of the mesh in the ResourceManager, which together with the id makes up its handle
+    std::uint32_t generation_;
     GLuint vbo_name_;
     GLuint ibo_name_;
 
@@ -32,6 +66,7 @@ private:
     std::unique_ptr<std::vector<VertexData> > vertices_;
 
     MeshCacheOption cache_option_;
+    MeshUsageOption usage_option_;
 
     bool initialized_;
 
@@ -39,12 +74,48 @@ private:
     size_t num_vertices_;
 
     std::string lexical_name_;
+    StringId name_id_;
+
+    MeshBounds bounds_;
+    std::vector<MeshLOD> lods_;
+    GLfloat uv_density_;
+
+    //dynamic mesh state. The vbo holds DYNAMIC_MESH_BUFFER_COUNT consecutive copies of the vertex data, and each copy keeps track of the
+    //vertex range [first, second) that has changed since it was last written to, as well as the fence of the last frame that read from it
+    VertexData* mapped_vertices_;
+    GLsync buffer_fences_[DYNAMIC_MESH_BUFFER_COUNT];
+    std::pair<size_t, size_t> dirty_ranges_[DYNAMIC_MESH_BUFFER_COUNT];
+    unsigned int current_buffer_;
+    std::uint64_t last_prepared_frame_;
 
 private:
-    Mesh(const std::string& lexical_name, std::uint32_t id, MeshCacheOption cache_option = DELETE_ON_BUFFER_CREATION);
+    Mesh(const std::string& lexical_name, std::uint32_t id, MeshCacheOption cache_option = DELETE_ON_BUFFER_CREATION,
+         MeshUsageOption usage_option = STATIC_MESH);
 
     void initializeBuffers();
 
+    //size of the gpu buffers of the mesh, once created
+    size_t bufferSize();
+
+    //uploads static vertex and index data straight from memory not owned by the mesh, such as a mapped mesh file. No cpu copy is kept
+    void initializeBuffers(const VertexData* vertices, size_t num_vertices, const GLuint* indices, size_t num_indices);
+
+    //recalculates bounds_ from the cpu copy of the vertices
+    void calculateBounds();
+
+    //recalculates uv_density_ from the triangles of the given data, skipping those with indices past num_vertices
+    void calculateUVDensity(const VertexData* vertices, size_t num_vertices, const GLuint* indices, size_t num_indices);
+
+    //marks the vertex range for re-upload in all the buffers of a dynamic mesh
+    void markDirty(size_t first, size_t count);
+
+    //streams the pending vertex changes of a dynamic mesh into the next buffer of the ring, waiting on that buffer's fence beforehand.
+    //Returns true the first time it is called for a given frame, so that the renderer knows to fence the mesh once it has been drawn
+    bool prepareFrame(std::uint64_t frame);
+
+    //fences the buffer drawn from in the current frame so that it is not overwritten while the gpu is still reading from it
+    void fenceFrame();
+
 public:
     //dissallow constructing or copying of the mesh, as it should only be constructed within MeshManager
     Mesh() = delete;
@@ -79,8 +150,9 @@ public:
     std::vector<VertexData>* getVertices();
 
     /**
-     * @brief Assigns mesh vertex and index data. This can be done as many times as one wishes as long as the the data has not been sent to the GPU (occurs when
-     * getVBO() or get IBO() are first called). This is because the system currently does not support dynamic meshes.
+     * @brief Assigns mesh vertex and index data. For static meshes this can be done as many times as one wishes as long as the the data has not been sent to the GPU
+     * (occurs when getVBO() or get IBO() are first called). Dynamic meshes may also be reassigned afterwards, as long as the number of vertices and indices stay the same, in which case the data is copied
+     * into the existing CPU copy, so that pointers returned by editVertices() stay valid.
      * @param vertices Vertex data of mesh
      * @param indices Index data of mesh
      * @return true of succeeded, otherwise false
@@ -88,10 +160,48 @@ public:
     bool setMeshData(std::unique_ptr<std::vector<VertexData> >&& vertices, std::unique_ptr<std::vector<GLuint> >&& indices);
 
     /**
-     * @brief Gets ID of the mesh. Use this to query the MeshManager if you wish to get a pointer to the mesh.
-     * @return id of the mesh.
+     * @brief Gets a writable pointer to \p count vertices of a dynamic mesh, starting at vertex \p first. The pointer points into the CPU copy of the mesh, which is
+     * never reallocated, and the range is streamed to the GPU the next time the mesh is rendered. Only the given range may be written to.
+     * @param first Index of the first vertex to edit
+     * @param count Number of vertices to edit
+     * @return pointer to the first vertex of the range, or nullptr if the mesh is static, has no data assigned, or if the range is out of bounds
+     */
+    VertexData* editVertices(size_t first, size_t count);
+
+    /**
+     * @brief Copies \p count vertices into a dynamic mesh, starting at vertex \p first. This is a convenience wrapper around editVertices().
+     * @param first Index of the first vertex to overwrite
+     * @param vertices Vertices to copy into the mesh
+     * @param count Number of vertices to copy
+     * @return true if succeeded, otherwise false
+     */
+    bool updateVertices(size_t first, const VertexData* vertices, size_t count);
+
+    /**
+     * @brief Gets the usage option of the mesh, either STATIC_MESH or DYNAMIC_MESH
+     * @return usage option of the mesh
      */
-    std::uint32_t getID();
+    MeshUsageOption getUsageOption();
+
+    /**
+     * @brief Gets the offset which should be added to the indices of the mesh when drawing. This is always 0 for static meshes, whereas for dynamic meshes it
+     * points to the copy of the vertex data within the vbo which holds the latest data.
+     * @return base vertex to pass to glDrawElementsBaseVertex
+     */
+    GLint getBaseVertex();
+
+    /**
+     * @brief Gets ID of the mesh, which can be used to query the ResourceManager for it later. IDs are never reused, so an ID kept after the mesh was freed
+     * does not refer to another one.
+     * @return id of the mesh, its packed handle
+     */
+    std::uint64_t getID();
+
+    /**
+     * @brief Gets the handle of the mesh. Unlike the id, which is reused after the mesh is freed, the handle of a freed mesh never refers to another.
+     * @return handle of the mesh
+     */
+    MeshHandle getHandle();
 
     /**
      * @brief Gets number of elements to be drawn for this mesh
@@ -105,11 +215,44 @@ public:
      */
     size_t getNumVertices();
 
+    /**
+     * @brief Gets the axis aligned bounding box of the mesh in model space
+     * @return bounds of the mesh
+     */
+    MeshBounds getBounds();
+
+    /**
+     * @brief Gets the average density of texture coordinates over the surface of the mesh, as the square root of the ratio between the texture
+     * coordinate area and the model space area of its triangles. Multiplying this by the size of a texture gives the number of texels per
+     * model space unit, which is what the renderer uses to pick the mip levels textures need.
+     * @return texture coordinates per model space unit, or 0 if the mesh has no texture coordinates or no area
+     */
+    GLfloat getUVDensity();
+
+    /**
+     * @brief Gets the number of levels of detail of the mesh. Meshes created from vertex and index data have a single level covering all indices.
+     * @return number of levels of detail
+     */
+    size_t getNumLODs();
+
+    /**
+     * @brief Gets the index range of the level of detail \p level
+     * @param level Level of detail, with 0 being the most detailed
+     * @return index range of the level of detail, or an empty range if \p level does not exist
+     */
+    MeshLOD getLOD(size_t level);
+
     /**
      * @brief Gets the lexical name of the mesh
      * @return a string containing the lexical name of the mesh
      */
-    std::string getLexicalName();
+    const std::string& getLexicalName();
+
+    /**
+     * @brief Gets the interned id of the lexical name of the mesh, which it can be looked up by without hashing the name
+     * @return id of the lexical name
+     */
+    StringId getNameId();
 };
 
 #endif // MESH_H
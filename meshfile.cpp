@@ -0,0 +1,257 @@
+#include "meshfile.h"
+
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+//rounds offset up to the next multiple of MESH_FILE_ALIGNMENT
+std::uint64_t alignMeshFileOffset(std::uint64_t offset){
+    return (offset + MESH_FILE_ALIGNMENT - 1) / MESH_FILE_ALIGNMENT * MESH_FILE_ALIGNMENT;
+}
+
+//checks that a section of count elements of element_size bytes at offset lies within a file of size bytes. The header fields are untrusted, so
+//this is done without any sums or products of them which could wrap around
+bool meshFileSectionFits(std::uint64_t offset, std::uint64_t count, std::uint64_t element_size, std::uint64_t size){
+    return offset % MESH_FILE_ALIGNMENT == 0 && offset <= size && count <= (size - offset) / element_size;
+}
+
+//writes zeroes to the stream until its position reaches offset
+void padMeshFile(std::ofstream& file, std::uint64_t offset){
+    static const char zeroes[MESH_FILE_ALIGNMENT] = {0};
+
+    std::uint64_t position = (std::uint64_t)file.tellp();
+    if(position < offset){
+        file.write(zeroes, offset - position);
+    }
+}
+
+bool writeMeshFile(const std::string& filename, const float* vertices, std::uint64_t vertex_count, const std::uint32_t* indices, std::uint64_t index_count,
+                   const std::vector<MeshFileLOD>& lods, std::uint32_t vertex_attributes){
+    std::vector<MeshFileLOD> lod_table = lods;
+    if(lod_table.empty()){
+        MeshFileLOD lod;
+        lod.first_index = 0;
+        lod.index_count = index_count;
+        lod_table.push_back(lod);
+    }
+
+    for(auto& lod : lod_table){
+        if(lod.first_index + lod.index_count > index_count){
+            std::cerr << "Error: mesh file level of detail is out of the bounds of the index data" << std::endl;
+            return false;
+        }
+    }
+
+    MeshFileHeader header;
+    std::memset(&header, 0, sizeof(MeshFileHeader));
+
+    header.magic = MESH_FILE_MAGIC;
+    header.version = MESH_FILE_VERSION;
+    header.vertex_stride = MESH_FILE_VERTEX_FLOATS * sizeof(float);
+    header.vertex_attributes = vertex_attributes;
+    header.vertex_count = vertex_count;
+    header.index_count = index_count;
+    header.lod_count = (std::uint32_t)lod_table.size();
+
+    for(int axis = 0; axis < 3; ++axis){
+        header.bounds_min[axis] = vertex_count > 0 ? std::numeric_limits<float>::max() : 0.f;
+        header.bounds_max[axis] = vertex_count > 0 ? std::numeric_limits<float>::lowest() : 0.f;
+    }
+
+    for(std::uint64_t i = 0; i < vertex_count; ++i){
+        const float* position = vertices + i * MESH_FILE_VERTEX_FLOATS;
+        for(int axis = 0; axis < 3; ++axis){
+            header.bounds_min[axis] = std::min(header.bounds_min[axis], position[axis]);
+            header.bounds_max[axis] = std::max(header.bounds_max[axis], position[axis]);
+        }
+    }
+
+    header.lod_offset = alignMeshFileOffset(sizeof(MeshFileHeader));
+    header.vertex_offset = alignMeshFileOffset(header.lod_offset + sizeof(MeshFileLOD) * lod_table.size());
+    header.index_offset = alignMeshFileOffset(header.vertex_offset + (std::uint64_t)header.vertex_stride * vertex_count);
+    header.file_size = alignMeshFileOffset(header.index_offset + sizeof(std::uint32_t) * index_count);
+
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    if(!file.is_open()){
+        std::cerr << "Error: unable to open mesh file " << filename << " for writing" << std::endl;
+        return false;
+    }
+
+    file.write((const char*)&header, sizeof(MeshFileHeader));
+    padMeshFile(file, header.lod_offset);
+    file.write((const char*)&lod_table[0], sizeof(MeshFileLOD) * lod_table.size());
+    padMeshFile(file, header.vertex_offset);
+    file.write((const char*)vertices, (std::streamsize)header.vertex_stride * vertex_count);
+    padMeshFile(file, header.index_offset);
+    file.write((const char*)indices, sizeof(std::uint32_t) * index_count);
+    padMeshFile(file, header.file_size);
+
+    return file.good();
+}
+
+#ifdef _WIN32
+MappedMeshFile::MappedMeshFile() : data_(nullptr), size_(0), file_handle_(INVALID_HANDLE_VALUE), mapping_handle_(nullptr){
+}
+#else
+MappedMeshFile::MappedMeshFile() : data_(nullptr), size_(0), file_descriptor_(-1){
+}
+#endif
+
+MappedMeshFile::~MappedMeshFile(){
+    close();
+}
+
+bool MappedMeshFile::open(const std::string& filename){
+    close();
+
+#ifdef _WIN32
+    file_handle_ = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if(file_handle_ == INVALID_HANDLE_VALUE){
+        return false;
+    }
+
+    LARGE_INTEGER file_size;
+    if(!GetFileSizeEx(file_handle_, &file_size)){
+        close();
+        return false;
+    }
+    size_ = (size_t)file_size.QuadPart;
+
+    mapping_handle_ = CreateFileMappingA(file_handle_, NULL, PAGE_READONLY, 0, 0, NULL);
+    if(mapping_handle_ == nullptr){
+        close();
+        return false;
+    }
+
+    data_ = MapViewOfFile(mapping_handle_, FILE_MAP_READ, 0, 0, 0);
+#else
+    file_descriptor_ = ::open(filename.c_str(), O_RDONLY);
+    if(file_descriptor_ < 0){
+        return false;
+    }
+
+    struct stat file_stat;
+    if(fstat(file_descriptor_, &file_stat) != 0){
+        close();
+        return false;
+    }
+    size_ = (size_t)file_stat.st_size;
+
+    void* mapped = size_ > 0 ? mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, file_descriptor_, 0) : MAP_FAILED;
+    data_ = mapped == MAP_FAILED ? nullptr : mapped;
+
+    if(data_ != nullptr){
+        //the whole file is about to be uploaded, so let the kernel read ahead
+        madvise(data_, size_, MADV_WILLNEED);
+    }
+#endif
+
+    if(data_ == nullptr){
+        close();
+        return false;
+    }
+
+    const MeshFileHeader* head = header();
+    bool valid = size_ >= sizeof(MeshFileHeader) && head->magic == MESH_FILE_MAGIC && head->version == MESH_FILE_VERSION &&
+                 head->vertex_stride == MESH_FILE_VERTEX_FLOATS * sizeof(float) && head->file_size <= size_ &&
+                 meshFileSectionFits(head->lod_offset, head->lod_count, sizeof(MeshFileLOD), size_) &&
+                 meshFileSectionFits(head->vertex_offset, head->vertex_count, head->vertex_stride, size_) &&
+                 meshFileSectionFits(head->index_offset, head->index_count, sizeof(std::uint32_t), size_);
+
+    if(valid){
+        const MeshFileLOD* lod_table = lods();
+        for(std::uint32_t i = 0; i < head->lod_count; ++i){
+            if(lod_table[i].first_index > head->index_count || lod_table[i].index_count > head->index_count - lod_table[i].first_index){
+                valid = false;
+            }
+        }
+    }
+
+    if(valid){
+        //the indices go to the GPU as they are, where one past the vertices reads out of bounds
+        const std::uint32_t* index_data = indices();
+        for(std::uint64_t i = 0; i < head->index_count; ++i){
+            if(index_data[i] >= head->vertex_count){
+                valid = false;
+                break;
+            }
+        }
+    }
+
+    if(!valid){
+        std::cerr << "Error: " << filename << " is not a valid mesh file" << std::endl;
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void MappedMeshFile::close(){
+#ifdef _WIN32
+    if(data_ != nullptr){
+        UnmapViewOfFile(data_);
+    }
+
+    if(mapping_handle_ != nullptr){
+        CloseHandle(mapping_handle_);
+        mapping_handle_ = nullptr;
+    }
+
+    if(file_handle_ != INVALID_HANDLE_VALUE){
+        CloseHandle(file_handle_);
+        file_handle_ = INVALID_HANDLE_VALUE;
+    }
+#else
+    if(data_ != nullptr){
+        munmap(data_, size_);
+    }
+
+    if(file_descriptor_ >= 0){
+        ::close(file_descriptor_);
+        file_descriptor_ = -1;
+    }
+#endif
+
+    data_ = nullptr;
+    size_ = 0;
+}
+
+const MeshFileHeader* MappedMeshFile::header(){
+    return (const MeshFileHeader*)data_;
+}
+
+const float* MappedMeshFile::vertices(){
+    if(data_ == nullptr){
+        return nullptr;
+    }
+
+    return (const float*)((const char*)data_ + header()->vertex_offset);
+}
+
+const std::uint32_t* MappedMeshFile::indices(){
+    if(data_ == nullptr){
+        return nullptr;
+    }
+
+    return (const std::uint32_t*)((const char*)data_ + header()->index_offset);
+}
+
+const MeshFileLOD* MappedMeshFile::lods(){
+    if(data_ == nullptr){
+        return nullptr;
+    }
+
+    return (const MeshFileLOD*)((const char*)data_ + header()->lod_offset);
+}
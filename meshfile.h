@@ -0,0 +1,126 @@
+#ifndef MESHFILE_H
+#define MESHFILE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+//"EMSH" when read as bytes
+const std::uint32_t MESH_FILE_MAGIC = 0x48534d45;
+const std::uint32_t MESH_FILE_VERSION = 1;
+//every section of the file starts at a multiple of this, so that the mapped sections can be handed straight to the GPU
+const std::uint64_t MESH_FILE_ALIGNMENT = 64;
+//number of floats in a vertex record: position(3), normal(3), colour(4), texture coordinate(2). This matches the layout of VertexData
+const std::uint32_t MESH_FILE_VERTEX_FLOATS = 12;
+
+/**
+ * @brief The MeshFileAttribute enum flags which vertex attributes were present in the source of the mesh file. Every vertex record stores all
+ * attributes regardless, with missing ones being zeroed (white for colours).
+ */
+enum MeshFileAttribute{MESH_ATTRIBUTE_POSITION = 1, MESH_ATTRIBUTE_NORMAL = 2, MESH_ATTRIBUTE_COLOUR = 4, MESH_ATTRIBUTE_TEXCOORD = 8};
+
+/**
+ * @brief The MeshFileLOD struct describes a level of detail of the mesh as a range of the index section. Level 0 is the most detailed.
+ */
+struct MeshFileLOD{
+    std::uint64_t first_index;
+    std::uint64_t index_count;
+};
+
+/**
+ * @brief The MeshFileHeader struct is found at the start of every mesh file. All offsets are in bytes from the start of the file.
+ */
+struct MeshFileHeader{
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint32_t vertex_stride;
+    std::uint32_t vertex_attributes;
+    std::uint64_t vertex_count;
+    std::uint64_t index_count;
+    float bounds_min[3];
+    float bounds_max[3];
+    std::uint32_t lod_count;
+    std::uint32_t reserved;
+    std::uint64_t lod_offset;
+    std::uint64_t vertex_offset;
+    std::uint64_t index_offset;
+    std::uint64_t file_size;
+};
+
+/**
+ * @brief Writes a mesh file. The bounds of the mesh are calculated from the vertices.
+ * @param filename Name of the file to write
+ * @param vertices Vertex records, MESH_FILE_VERTEX_FLOATS floats per vertex
+ * @param vertex_count Number of vertices
+ * @param indices Triangle indices of all levels of detail
+ * @param index_count Number of indices
+ * @param lods Levels of detail, as ranges of \p indices. If empty, a single level covering all indices is written
+ * @param vertex_attributes MeshFileAttribute flags of the attributes present in the vertices
+ * @return true if succeeded, otherwise false
+ */
+bool writeMeshFile(const std::string& filename, const float* vertices, std::uint64_t vertex_count, const std::uint32_t* indices, std::uint64_t index_count,
+                   const std::vector<MeshFileLOD>& lods, std::uint32_t vertex_attributes);
+
+/**
+ * @brief The MappedMeshFile class maps a mesh file into memory and validates it, giving direct access to its sections without copying them.
+ * The pointers returned are only valid while the file is mapped.
+ */
+class MappedMeshFile
+{
+private:
+    void* data_;
+    size_t size_;
+
+#ifdef _WIN32
+    void* file_handle_;
+    void* mapping_handle_;
+#else
+    int file_descriptor_;
+#endif
+
+public:
+    MappedMeshFile();
+    MappedMeshFile(const MappedMeshFile& other) = delete;
+    MappedMeshFile& operator = (const MappedMeshFile& other) = delete;
+    ~MappedMeshFile();
+
+    /**
+     * @brief Maps the file with the given \p filename, closing any previously mapped file. The file is rejected if any of its sections or levels of
+     * detail are out of bounds, or any index refers to a vertex past the end of the vertex section.
+     * @param filename Name of the mesh file
+     * @return true if the file was mapped and is a valid mesh file, otherwise false
+     */
+    bool open(const std::string& filename);
+
+    /**
+     * @brief Unmaps the file, invalidating all pointers acquired from it
+     */
+    void close();
+
+    /**
+     * @brief Gets the header of the file
+     * @return pointer to the header, or nullptr if no file is mapped
+     */
+    const MeshFileHeader* header();
+
+    /**
+     * @brief Gets the vertex section of the file
+     * @return pointer to the first vertex record, or nullptr if no file is mapped
+     */
+    const float* vertices();
+
+    /**
+     * @brief Gets the index section of the file
+     * @return pointer to the first index, or nullptr if no file is mapped
+     */
+    const std::uint32_t* indices();
+
+    /**
+     * @brief Gets the level of detail table of the file
+     * @return pointer to the first level of detail, or nullptr if no file is mapped
+     */
+    const MeshFileLOD* lods();
+};
+
+#endif // MESHFILE_H
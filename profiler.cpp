@@ -0,0 +1,185 @@
+#include "profiler.h"
+
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <limits>
+#include <algorithm>
+
+std::atomic<bool> Profiler::enabled_(true);
+
+//buffers of every thread which recorded a zone, kept until the program exits
+struct ProfileRegistry{
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ProfileThreadBuffer> > buffers;
+
+    //ticks and steady clock time when the first buffer was created, which ticks are calibrated against
+    std::uint64_t calibration_ticks;
+    std::uint64_t calibration_ns;
+
+    ProfileRegistry() : calibration_ticks(0), calibration_ns(0){
+    }
+};
+
+ProfileRegistry& profileRegistry(){
+    static ProfileRegistry registry;
+    return registry;
+}
+
+ProfileThreadBuffer* Profiler::threadBuffer(){
+    static thread_local ProfileThreadBuffer* buffer = nullptr;
+
+    //only the first zone of a thread takes the lock
+    if(buffer == nullptr){
+        buffer = registerBuffer(false);
+    }
+
+    return buffer;
+}
+
+ProfileThreadBuffer* Profiler::registerBuffer(bool steady_time){
+    ProfileRegistry& registry = profileRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    if(registry.buffers.empty()){
+        registry.calibration_ticks = now();
+        registry.calibration_ns = steadyNow();
+    }
+
+    registry.buffers.push_back(std::unique_ptr<ProfileThreadBuffer>(new ProfileThreadBuffer()));
+    ProfileThreadBuffer* buffer = registry.buffers.back().get();
+    buffer->thread_index = (std::uint32_t)registry.buffers.size();
+    buffer->thread_name = "Thread " + std::to_string(buffer->thread_index);
+    buffer->steady_time = steady_time;
+
+    return buffer;
+}
+
+void Profiler::setEnabled(bool enabled){
+    enabled_.store(enabled, std::memory_order_relaxed);
+}
+
+bool Profiler::isEnabled(){
+    return enabled_.load(std::memory_order_relaxed);
+}
+
+void Profiler::setThreadName(const std::string& name){
+    ProfileThreadBuffer* buffer = threadBuffer();
+
+    std::lock_guard<std::mutex> lock(profileRegistry().mutex);
+    buffer->thread_name = name;
+}
+
+ProfileThreadBuffer* Profiler::createTrack(const std::string& name){
+    ProfileThreadBuffer* track = registerBuffer(true);
+
+    std::lock_guard<std::mutex> lock(profileRegistry().mutex);
+    track->thread_name = name;
+
+    return track;
+}
+
+void Profiler::recordEvent(ProfileThreadBuffer* track, const ProfileEvent& event){
+    std::uint64_t head = track->head.load(std::memory_order_relaxed);
+
+    track->events[head % PROFILE_BUFFER_EVENTS] = event;
+    track->head.store(head + 1, std::memory_order_release);
+}
+
+//writes \p str as a JSON string
+void writeJSONString(std::ostream& stream, const char* str){
+    stream << '"';
+    for(; *str != '\0'; ++str){
+        if(*str == '"' || *str == '\\'){
+            stream << '\\';
+        }
+
+        stream << *str;
+    }
+    stream << '"';
+}
+
+bool Profiler::writeChromeTrace(const std::string& filename){
+    std::ofstream file(filename);
+    if(!file.is_open()){
+        std::cerr << "Error: unable to write profile trace " << filename << std::endl;
+        return false;
+    }
+
+    ProfileRegistry& registry = profileRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    double ns_per_tick = 1.0;
+#ifdef PROFILE_USE_TSC
+    if(!registry.buffers.empty()){
+        std::uint64_t ticks = now() - registry.calibration_ticks;
+        std::uint64_t ns = steadyNow() - registry.calibration_ns;
+
+        ns_per_tick = ticks > 0 ? (double)ns / (double)ticks : 1.0;
+    }
+#endif
+
+    //the oldest events of a full ring may be overwritten while writing, so a margin of them is skipped
+    std::vector<std::pair<std::uint64_t, std::uint64_t> > ranges;
+    for(auto& buffer : registry.buffers){
+        std::uint64_t head = buffer->head.load(std::memory_order_acquire);
+        std::uint64_t first = head > PROFILE_BUFFER_EVENTS ? head - PROFILE_BUFFER_EVENTS + PROFILE_BUFFER_EVENTS / 16 : 0;
+
+        ranges.push_back(std::make_pair(first, head));
+    }
+
+    //ticks are converted to nanoseconds of the steady clock since calibration, so that they line up with tracks
+    auto toNs = [&](const ProfileThreadBuffer* buffer, std::uint64_t time){
+        if(buffer->steady_time){
+            return (double)(std::int64_t)(time - registry.calibration_ns);
+        }
+
+        return (double)(std::int64_t)(time - registry.calibration_ticks) * ns_per_tick;
+    };
+
+    //timestamps are made relative to the earliest zone, as the trace format is in microseconds
+    double origin = std::numeric_limits<double>::max();
+    for(size_t i = 0; i < registry.buffers.size(); ++i){
+        for(std::uint64_t j = ranges[i].first; j < ranges[i].second; ++j){
+            origin = std::min(origin, toNs(registry.buffers[i].get(), registry.buffers[i]->events[j % PROFILE_BUFFER_EVENTS].start));
+        }
+    }
+
+    file << std::fixed << std::setprecision(3) << "{\"traceEvents\":[";
+
+    for(size_t i = 0; i < registry.buffers.size(); ++i){
+        ProfileThreadBuffer* buffer = registry.buffers[i].get();
+
+        file << (i > 0 ? ",\n" : "\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->thread_index << ",\"args\":{\"name\":";
+        writeJSONString(file, buffer->thread_name.c_str());
+        file << "}}";
+
+        for(std::uint64_t j = ranges[i].first; j < ranges[i].second; ++j){
+            const ProfileEvent& event = buffer->events[j % PROFILE_BUFFER_EVENTS];
+
+            file << ",\n{\"name\":";
+            writeJSONString(file, event.name);
+            double start_ns = toNs(buffer, event.start);
+            double end_ns = toNs(buffer, event.end);
+
+            file << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->thread_index << ",\"ts\":" << (start_ns - origin) / 1000.0
+                 << ",\"dur\":" << (end_ns - start_ns) / 1000.0 << "}";
+        }
+    }
+
+    file << "\n]}\n";
+
+    return file.good();
+}
+
+void Profiler::clear(){
+    ProfileRegistry& registry = profileRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    for(auto& buffer : registry.buffers){
+        buffer->head.store(0, std::memory_order_release);
+    }
+}
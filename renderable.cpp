@@ -1,5 +1,15 @@
 #include "renderable.h"
 #include "renderer.h"
+#include "resourcemanager.h"
+
+VertexArray::VertexArray(GLuint vao_name, std::uint64_t vao_key) : name(vao_name), key(vao_key), references(1){
+}
+
+VertexArray::~VertexArray(){
+    if(name != 0){
+        glDeleteVertexArrays(1, &name);
+    }
+}
 
 void Renderable::frameStart(){
     Renderer::renderer()->addRenderable(this);
@@ -14,11 +24,13 @@ void Renderable::startup(){
 void Renderable::shutdown(){
 }
 
-Renderable::Renderable(std::unique_ptr<Material>&& mat, Mesh* mesh) : material_(std::move(mat)), mesh_(mesh){
-    if(material_ == nullptr || mesh_ == nullptr){
+Renderable::Renderable(std::unique_ptr<Material>&& mat, Mesh* mesh) : material_(std::move(mat)){
+    if(material_ == nullptr || mesh == nullptr){
         throw RenderableError("Material and Mesh passed must not be null");
     }
 
+    mesh_ = mesh->getHandle();
+
     GLuint mesh_vbo = mesh->getVBO();
     GLuint mesh_ibo = mesh->getIBO();
 
@@ -30,25 +42,25 @@ Renderable::Renderable(std::unique_ptr<Material>&& mat, Mesh* mesh) : material_(
     glBindVertexArray(vao_name_);
 
     if(material_->getPositionLocation() >= 0){
-        GLuint loc = (GLuint)mat->getPositionLocation();
+        GLuint loc = (GLuint)material_->getPositionLocation();
         glEnableVertexAttribArray(loc);
         glVertexAttribPointer(loc, 3, GL_FLOAT, GL_FALSE, sizeof(VertexData), (GLvoid*)offsetof(VertexData, position));
     }
 
     if(material_->getTexcoordLocation() >= 0){
-        GLuint loc = (GLuint)mat->getTexcoordLocation();
+        GLuint loc = (GLuint)material_->getTexcoordLocation();
         glEnableVertexAttribArray(loc);
         glVertexAttribPointer(loc, 2, GL_FLOAT, GL_FALSE, sizeof(VertexData), (GLvoid*)offsetof(VertexData, texturecoord));
     }
 
     if(material_->getColourLocation() >= 0){
-        GLuint loc = (GLuint)mat->getColourLocation();
+        GLuint loc = (GLuint)material_->getColourLocation();
         glEnableVertexAttribArray(loc);
         glVertexAttribPointer(loc, 4, GL_FLOAT, GL_FALSE, sizeof(VertexData), (GLvoid*)offsetof(VertexData, colour));
     }
 
     if(material_->getNormalLocation() >= 0){
-        GLuint loc = (GLuint)mat->getNormalLocation();
+        GLuint loc = (GLuint)material_->getNormalLocation();
         glEnableVertexAttribArray(loc);
         glVertexAttribPointer(loc, 3, GL_FLOAT, GL_FALSE, sizeof(VertexData), (GLvoid*)offsetof(VertexData, normal));
     }
@@ -59,22 +71,51 @@ Renderable::Renderable(std::unique_ptr<Material>&& mat, Mesh* mesh) : material_(
 
 }
 
-Renderable::Renderable(std::unique_ptr<Material>&& mat, Mesh* mesh, GLuint vao_name) : material_(std::move(mat)), mesh_(mesh), vao_name_(vao_name){
+Renderable::Renderable(std::unique_ptr<Material>&& mat, Mesh* mesh, GLuint vao_name, VertexArrayHandle vao_handle) : vao_name_(vao_name),
+                                                                                                                         vao_handle_(vao_handle),
+                                                                                                                         material_(std::move(mat)), mesh_(mesh->getHandle()){
 }
 
-Renderable::Renderable(const Renderable& other) : Component(other), material_(std::move(other.material_->clone())), mesh_(other.mesh_), vao_name_(other.vao_name_){
+Renderable::Renderable(const Renderable& other) : Component(other), vao_name_(other.vao_name_), vao_handle_(other.vao_handle_),
+                                                  material_(std::move(other.material_->clone())), mesh_(other.mesh_){
+    ResourceManager* resource_manager = ResourceManager::resourceManager();
+    if(resource_manager != nullptr){
+        resource_manager->acquireVertexArray(vao_handle_);
+    }
 }
 
 Renderable& Renderable::operator = (const Renderable& other){
     Component::operator=(other);
+
+    //the material may still be bound by frames in flight on the render thread
+    ResourceManager* resource_manager = ResourceManager::resourceManager();
+    if(resource_manager != nullptr){
+        resource_manager->deferFree(std::shared_ptr<Material>(std::move(material_)));
+    }
+
     material_ = std::move(other.material_->clone());
     mesh_ = other.mesh_;
+
+    //acquired before releasing, in case both renderables share the vao
+    if(resource_manager != nullptr){
+        resource_manager->acquireVertexArray(other.vao_handle_);
+        resource_manager->releaseVertexArray(vao_handle_);
+    }
+
     vao_name_ = other.vao_name_;
+    vao_handle_ = other.vao_handle_;
 
     return *this;
 }
 
 Renderable::~Renderable(){
+    //the vao is deleted along with the resource manager if it is already being shut down, and the material is freed along with it, as frames
+    //in flight on the render thread may still bind it
+    ResourceManager* resource_manager = ResourceManager::resourceManager();
+    if(resource_manager != nullptr){
+        resource_manager->releaseVertexArray(vao_handle_);
+        resource_manager->deferFree(std::shared_ptr<Material>(std::move(material_)));
+    }
 }
 
 Material* Renderable::getMaterial(){
@@ -82,7 +123,12 @@ Material* Renderable::getMaterial(){
 }
 
 Mesh* Renderable::getMesh(){
-    return mesh_;
+    ResourceManager* resource_manager = ResourceManager::resourceManager();
+    if(resource_manager == nullptr){
+        return nullptr;
+    }
+
+    return resource_manager->getMesh(mesh_);
 }
 
 GLuint Renderable::getVAOName(){
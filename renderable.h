@@ -5,6 +5,7 @@
 #include "component.h"
 #include "material.h"
 #include "mesh.h"
+#include "resourcepool.h"
 
 #include <memory>
 #include <exception>
@@ -23,6 +24,21 @@ public:
     }
 };
 
+/**
+ * @brief The VertexArray struct holds a VAO shared by the renderables with the same shader and mesh, and the number of renderables using it
+ */
+struct VertexArray{
+    GLuint name;
+    //slot indices of the shader and mesh the VAO was created for, in the upper and lower 32 bits
+    std::uint64_t key;
+    unsigned int references;
+
+    VertexArray(GLuint vao_name, std::uint64_t vao_key);
+    ~VertexArray();
+};
+
+typedef ResourceHandle<VertexArray> VertexArrayHandle;
+
 class Renderable : public Component
 {
 friend class ResourceManager;
@@ -30,13 +46,15 @@ friend class Renderer;
 
 private:
     GLuint vao_name_;
+    VertexArrayHandle vao_handle_;
     std::unique_ptr<Material> material_;
-    Mesh* mesh_;
+    //a handle rather than a pointer, so that a renderable whose mesh was freed is skipped instead of drawing a dangling mesh
+    MeshHandle mesh_;
 
 private:
     Renderable() = delete;
     Renderable(std::unique_ptr<Material>&& mat, Mesh* mesh);
-    Renderable(std::unique_ptr<Material>&& mat, Mesh* mesh, GLuint vao_name);
+    Renderable(std::unique_ptr<Material>&& mat, Mesh* mesh, GLuint vao_name, VertexArrayHandle vao_handle);
 
 protected:
     virtual void frameStart();
@@ -57,7 +75,7 @@ public:
 
     /**
      * @brief Gets an observer pointer to the Renderable's mesh
-     * @return a pointer to the Renderable's mesh
+     * @return a pointer to the Renderable's mesh, or nullptr if the mesh has been freed
      */
     Mesh* getMesh();
 
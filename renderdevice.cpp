@@ -0,0 +1,1235 @@
+#include "renderdevice.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <unordered_map>
+
+std::unique_ptr<RenderDevice> RenderDevice::render_device_ = nullptr;
+
+//the macros of gldispatch.h are function like, so the plain names here are the library functions
+GLCoreFunctions libraryCoreFunctions(){
+    GLCoreFunctions functions;
+
+    functions.BindTexture = glBindTexture;
+    functions.BlendFunc = glBlendFunc;
+    functions.Clear = glClear;
+    functions.ClearColor = glClearColor;
+    functions.CullFace = glCullFace;
+    functions.DeleteTextures = glDeleteTextures;
+    functions.DepthFunc = glDepthFunc;
+    functions.DepthMask = glDepthMask;
+    functions.Disable = glDisable;
+    functions.DrawArrays = glDrawArrays;
+    functions.DrawElements = glDrawElements;
+    functions.Enable = glEnable;
+    functions.Finish = glFinish;
+    functions.Flush = glFlush;
+    functions.GenTextures = glGenTextures;
+    functions.GetError = glGetError;
+    functions.GetFloatv = glGetFloatv;
+    functions.GetIntegerv = glGetIntegerv;
+    functions.GetString = glGetString;
+    functions.PixelStorei = glPixelStorei;
+    functions.ReadPixels = glReadPixels;
+    functions.TexImage1D = glTexImage1D;
+    functions.TexImage2D = glTexImage2D;
+    functions.TexParameterf = glTexParameterf;
+    functions.TexParameteri = glTexParameteri;
+    functions.TexSubImage2D = glTexSubImage2D;
+    functions.Viewport = glViewport;
+
+    return functions;
+}
+
+GLCoreFunctions gl_core_functions = libraryCoreFunctions();
+
+/**
+ * @brief The NullVariable struct is an active attribute or uniform of a program of the null device
+ */
+struct NullVariable{
+    //arrays are named as GL reports them, e.g. lights[0]
+    std::string name;
+    std::string base_name;
+    GLint size;
+    GLenum type;
+    GLint location;
+};
+
+struct NullShader{
+    GLenum type;
+    std::string source;
+};
+
+struct NullProgram{
+    std::vector<GLuint> shaders;
+    std::vector<NullVariable> attributes;
+    std::vector<NullVariable> uniforms;
+    //locations given with glBindAttribLocation, which take effect when the program is next linked
+    std::unordered_map<std::string, GLint> bound_attributes;
+};
+
+struct NullDeviceState{
+    //names are shared by all object types, which GL allows
+    GLuint next_name;
+
+    std::unordered_map<const char*, std::uint64_t> call_counts;
+    std::uint64_t total_calls;
+
+    bool logging;
+    size_t max_log_calls;
+    std::vector<GLCall> log;
+
+    //contents of buffers, so that they can be mapped
+    std::unordered_map<GLuint, std::vector<unsigned char> > buffers;
+    std::unordered_map<GLenum, GLuint> bound_buffers;
+
+    std::unordered_map<GLuint, NullShader> shaders;
+    std::unordered_map<GLuint, NullProgram> programs;
+
+    NullDeviceState() : next_name(1), total_calls(0), logging(false), max_log_calls(0){
+    }
+
+    void record(const char* function, std::initializer_list<std::int64_t> args){
+        call_counts[function]++;
+        total_calls++;
+
+        if(logging && log.size() < max_log_calls){
+            GLCall call;
+            call.function = function;
+            call.arg_count = 0;
+
+            for(auto arg : args){
+                if(call.arg_count < GL_CALL_MAX_ARGS){
+                    call.args[call.arg_count++] = arg;
+                }
+            }
+
+            log.push_back(call);
+        }
+    }
+
+    void createNames(GLsizei n, GLuint* names){
+        for(GLsizei i = 0; i < n; ++i){
+            names[i] = next_name++;
+        }
+    }
+
+    std::vector<unsigned char>* boundBuffer(GLenum target){
+        auto bound = bound_buffers.find(target);
+        if(bound == bound_buffers.end() || bound->second == 0){
+            return nullptr;
+        }
+
+        return &buffers[bound->second];
+    }
+};
+
+//state of the null device while it is installed
+NullDeviceState* null_device_state = nullptr;
+
+void recordCall(const char* function, std::initializer_list<std::int64_t> args = {}){
+    null_device_state->record(function, args);
+}
+
+void copyString(const std::string& string, GLsizei buffer_size, GLsizei* length, GLchar* buffer){
+    GLsizei copied = 0;
+
+    if(buffer_size > 0 && buffer != nullptr){
+        copied = std::min((GLsizei)string.size(), buffer_size - 1);
+        std::memcpy(buffer, string.data(), copied);
+        buffer[copied] = '\0';
+    }
+
+    if(length != nullptr){
+        *length = copied;
+    }
+}
+
+//reflection of the null device, which parses the declarations of the GLSL sources of a program
+
+GLenum glslType(const std::string& type){
+    static const std::map<std::string, GLenum> types = {
+        {"float", GL_FLOAT}, {"vec2", GL_FLOAT_VEC2}, {"vec3", GL_FLOAT_VEC3}, {"vec4", GL_FLOAT_VEC4},
+        {"int", GL_INT}, {"ivec2", GL_INT_VEC2}, {"ivec3", GL_INT_VEC3}, {"ivec4", GL_INT_VEC4},
+        {"uint", GL_UNSIGNED_INT}, {"bool", GL_BOOL},
+        {"mat2", GL_FLOAT_MAT2}, {"mat3", GL_FLOAT_MAT3}, {"mat4", GL_FLOAT_MAT4},
+        {"sampler1D", GL_SAMPLER_1D}, {"sampler2D", GL_SAMPLER_2D}, {"sampler3D", GL_SAMPLER_3D}, {"samplerCube", GL_SAMPLER_CUBE},
+        {"sampler2DShadow", GL_SAMPLER_2D_SHADOW}, {"sampler2DArray", GL_SAMPLER_2D_ARRAY}
+    };
+
+    auto found = types.find(type);
+    if(found != types.end()){
+        return found->second;
+    }
+
+    //other samplers only need to be recognised as samplers
+    return type.find("sampler") != std::string::npos ? GL_SAMPLER_2D : GL_FLOAT_VEC4;
+}
+
+//strips comments and preprocessor lines, leaving the declarations
+std::string stripGLSL(const std::string& source){
+    std::string code;
+    bool line_start = true;
+
+    for(size_t i = 0; i < source.size();){
+        if(source.compare(i, 2, "//") == 0 || (line_start && source[i] == '#')){
+            i = source.find('\n', i);
+            if(i == std::string::npos){
+                break;
+            }
+        }
+        else if(source.compare(i, 2, "/*") == 0){
+            i = source.find("*/", i);
+            if(i == std::string::npos){
+                break;
+            }
+            i += 2;
+            code += ' ';
+        }
+        else{
+            if(source[i] == '\n'){
+                line_start = true;
+            }
+            else if(source[i] != ' ' && source[i] != '\t'){
+                line_start = false;
+            }
+
+            code += source[i++];
+        }
+    }
+
+    return code;
+}
+
+void addVariable(std::vector<NullVariable>& variables, const std::string& type, std::string declarator, GLint& next_location){
+    NullVariable variable;
+    variable.type = glslType(type);
+    variable.size = 1;
+
+    size_t bracket = declarator.find('[');
+    if(bracket != std::string::npos){
+        variable.size = std::max(std::atoi(declarator.c_str() + bracket + 1), 1);
+        declarator = declarator.substr(0, bracket);
+    }
+
+    variable.base_name = declarator;
+    variable.name = bracket != std::string::npos ? declarator + "[0]" : declarator;
+
+    //the same uniform may be declared by both stages
+    for(auto& existing : variables){
+        if(existing.base_name == variable.base_name){
+            return;
+        }
+    }
+
+    variable.location = next_location;
+    next_location += variable.size;
+
+    variables.push_back(variable);
+}
+
+void reflectProgram(NullDeviceState* state, NullProgram& program){
+    const char* qualifiers[] = {"flat", "smooth", "noperspective", "centroid", "invariant", "precise", "highp", "mediump", "lowp", "const"};
+
+    program.attributes.clear();
+    program.uniforms.clear();
+
+    GLint next_attribute = 0;
+    GLint next_uniform = 0;
+
+    for(auto name : program.shaders){
+        auto shader = state->shaders.find(name);
+        if(shader == state->shaders.end()){
+            continue;
+        }
+
+        std::string code = stripGLSL(shader->second.source);
+
+        //statements end at semicolons, and block braces are treated the same, so that block names and members are skipped below
+        size_t start = 0;
+        while(start < code.size()){
+            size_t end = code.find_first_of(";{}", start);
+            if(end == std::string::npos){
+                end = code.size();
+            }
+
+            std::string statement = code.substr(start, end - start);
+            start = end + 1;
+
+            size_t layout = statement.find("layout");
+            if(layout != std::string::npos){
+                size_t close = statement.find(')', layout);
+                statement.erase(layout, close == std::string::npos ? std::string::npos : close - layout + 1);
+            }
+
+            //initializers are dropped, which drops any declarators after one as well
+            size_t initializer = statement.find('=');
+            if(initializer != std::string::npos){
+                statement.erase(initializer);
+            }
+
+            //commas are split off, so that declarators can be read token by token
+            std::string spaced;
+            for(char c : statement){
+                if(c == ','){
+                    spaced += " , ";
+                }
+                else{
+                    spaced += c;
+                }
+            }
+
+            std::istringstream stream(spaced);
+            std::vector<std::string> tokens;
+            std::string token;
+            while(stream >> token){
+                if(std::find(std::begin(qualifiers), std::end(qualifiers), token) == std::end(qualifiers)){
+                    tokens.push_back(token);
+                }
+            }
+
+            if(tokens.size() < 3){
+                continue;
+            }
+
+            bool uniform = tokens[0] == "uniform";
+            bool attribute = shader->second.type == GL_VERTEX_SHADER && (tokens[0] == "in" || tokens[0] == "attribute");
+            if(!uniform && !attribute){
+                continue;
+            }
+
+            //declarators, with array sizes written apart from their names joined back on
+            std::string declarator;
+            for(size_t i = 2; i <= tokens.size(); ++i){
+                if(i == tokens.size() || tokens[i] == ","){
+                    if(!declarator.empty()){
+                        if(uniform){
+                            addVariable(program.uniforms, tokens[1], declarator, next_uniform);
+                        }
+                        else{
+                            addVariable(program.attributes, tokens[1], declarator, next_attribute);
+                        }
+                    }
+
+                    declarator.clear();
+                }
+                else{
+                    declarator += tokens[i];
+                }
+            }
+        }
+    }
+}
+
+NullProgram* findProgram(GLuint program){
+    auto found = null_device_state->programs.find(program);
+    return found != null_device_state->programs.end() ? &found->second : nullptr;
+}
+
+GLint findLocation(const std::vector<NullVariable>& variables, const GLchar* name){
+    std::string query = name;
+    GLint index = 0;
+
+    size_t bracket = query.find('[');
+    if(bracket != std::string::npos){
+        index = std::atoi(query.c_str() + bracket + 1);
+        query = query.substr(0, bracket);
+    }
+
+    for(auto& variable : variables){
+        if(variable.base_name == query && index < variable.size){
+            return variable.location + index;
+        }
+    }
+
+    return -1;
+}
+
+GLsizei maxNameLength(const std::vector<NullVariable>& variables){
+    GLsizei length = 0;
+
+    for(auto& variable : variables){
+        length = std::max(length, (GLsizei)variable.name.size() + 1);
+    }
+
+    return length;
+}
+
+void getActiveVariable(const std::vector<NullVariable>& variables, GLuint index, GLsizei buffer_size, GLsizei* length, GLint* size, GLenum* type,
+                       GLchar* name){
+    if(index >= variables.size()){
+        copyString("", buffer_size, length, name);
+        return;
+    }
+
+    const NullVariable& variable = variables[index];
+    copyString(variable.name, buffer_size, length, name);
+
+    if(size != nullptr){
+        *size = variable.size;
+    }
+
+    if(type != nullptr){
+        *type = variable.type;
+    }
+}
+
+//functions of the null device, OpenGL 1.1
+
+void GLAPIENTRY nullBindTexture(GLenum target, GLuint texture){
+    recordCall("glBindTexture", {target, texture});
+}
+
+void GLAPIENTRY nullBlendFunc(GLenum sfactor, GLenum dfactor){
+    recordCall("glBlendFunc", {sfactor, dfactor});
+}
+
+void GLAPIENTRY nullClear(GLbitfield mask){
+    recordCall("glClear", {mask});
+}
+
+void GLAPIENTRY nullClearColor(GLclampf, GLclampf, GLclampf, GLclampf){
+    recordCall("glClearColor");
+}
+
+void GLAPIENTRY nullCullFace(GLenum mode){
+    recordCall("glCullFace", {mode});
+}
+
+void GLAPIENTRY nullDeleteTextures(GLsizei n, const GLuint*){
+    recordCall("glDeleteTextures", {n});
+}
+
+void GLAPIENTRY nullDepthFunc(GLenum func){
+    recordCall("glDepthFunc", {func});
+}
+
+void GLAPIENTRY nullDepthMask(GLboolean flag){
+    recordCall("glDepthMask", {flag});
+}
+
+void GLAPIENTRY nullDisable(GLenum cap){
+    recordCall("glDisable", {cap});
+}
+
+void GLAPIENTRY nullDrawArrays(GLenum mode, GLint first, GLsizei count){
+    recordCall("glDrawArrays", {mode, first, count});
+}
+
+void GLAPIENTRY nullDrawElements(GLenum mode, GLsizei count, GLenum type, const GLvoid*){
+    recordCall("glDrawElements", {mode, count, type});
+}
+
+void GLAPIENTRY nullEnable(GLenum cap){
+    recordCall("glEnable", {cap});
+}
+
+void GLAPIENTRY nullFinish(){
+    recordCall("glFinish");
+}
+
+void GLAPIENTRY nullFlush(){
+    recordCall("glFlush");
+}
+
+void GLAPIENTRY nullGenTextures(GLsizei n, GLuint* textures){
+    recordCall("glGenTextures", {n});
+    null_device_state->createNames(n, textures);
+}
+
+GLenum GLAPIENTRY nullGetError(){
+    recordCall("glGetError");
+    return GL_NO_ERROR;
+}
+
+void GLAPIENTRY nullGetFloatv(GLenum pname, GLfloat* params){
+    recordCall("glGetFloatv", {pname});
+    *params = pname == GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT ? 16.f : 0.f;
+}
+
+void GLAPIENTRY nullGetIntegerv(GLenum pname, GLint* params){
+    recordCall("glGetIntegerv", {pname});
+
+    switch(pname){
+        case GL_MAX_TEXTURE_SIZE:
+            *params = 16384;
+            break;
+        case GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS:
+            *params = 32;
+            break;
+        default:
+            *params = 0;
+    }
+}
+
+const GLubyte* GLAPIENTRY nullGetString(GLenum name){
+    recordCall("glGetString", {name});
+
+    switch(name){
+        case GL_VENDOR:
+            return (const GLubyte*)"Engine";
+        case GL_RENDERER:
+            return (const GLubyte*)"Null device";
+        case GL_VERSION:
+            return (const GLubyte*)"3.3 Null device";
+        case GL_SHADING_LANGUAGE_VERSION:
+            return (const GLubyte*)"3.30";
+        default:
+            return (const GLubyte*)"";
+    }
+}
+
+void GLAPIENTRY nullPixelStorei(GLenum pname, GLint param){
+    recordCall("glPixelStorei", {pname, param});
+}
+
+void GLAPIENTRY nullReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum, GLenum, GLvoid*){
+    recordCall("glReadPixels", {x, y, width, height});
+}
+
+void GLAPIENTRY nullTexImage1D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLint, GLenum, GLenum, const GLvoid*){
+    recordCall("glTexImage1D", {target, level, internalformat, width});
+}
+
+void GLAPIENTRY nullTexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei, GLint, GLenum, GLenum, const GLvoid*){
+    recordCall("glTexImage2D", {target, level, internalformat, width});
+}
+
+void GLAPIENTRY nullTexParameterf(GLenum target, GLenum pname, GLfloat){
+    recordCall("glTexParameterf", {target, pname});
+}
+
+void GLAPIENTRY nullTexParameteri(GLenum target, GLenum pname, GLint param){
+    recordCall("glTexParameteri", {target, pname, param});
+}
+
+void GLAPIENTRY nullTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei, GLsizei, GLenum, GLenum, const GLvoid*){
+    recordCall("glTexSubImage2D", {target, level, xoffset, yoffset});
+}
+
+void GLAPIENTRY nullViewport(GLint x, GLint y, GLsizei width, GLsizei height){
+    recordCall("glViewport", {x, y, width, height});
+}
+
+GLCoreFunctions nullCoreFunctions(){
+    GLCoreFunctions functions;
+
+    functions.BindTexture = nullBindTexture;
+    functions.BlendFunc = nullBlendFunc;
+    functions.Clear = nullClear;
+    functions.ClearColor = nullClearColor;
+    functions.CullFace = nullCullFace;
+    functions.DeleteTextures = nullDeleteTextures;
+    functions.DepthFunc = nullDepthFunc;
+    functions.DepthMask = nullDepthMask;
+    functions.Disable = nullDisable;
+    functions.DrawArrays = nullDrawArrays;
+    functions.DrawElements = nullDrawElements;
+    functions.Enable = nullEnable;
+    functions.Finish = nullFinish;
+    functions.Flush = nullFlush;
+    functions.GenTextures = nullGenTextures;
+    functions.GetError = nullGetError;
+    functions.GetFloatv = nullGetFloatv;
+    functions.GetIntegerv = nullGetIntegerv;
+    functions.GetString = nullGetString;
+    functions.PixelStorei = nullPixelStorei;
+    functions.ReadPixels = nullReadPixels;
+    functions.TexImage1D = nullTexImage1D;
+    functions.TexImage2D = nullTexImage2D;
+    functions.TexParameterf = nullTexParameterf;
+    functions.TexParameteri = nullTexParameteri;
+    functions.TexSubImage2D = nullTexSubImage2D;
+    functions.Viewport = nullViewport;
+
+    return functions;
+}
+
+//functions of the null device, loaded by GLEW
+
+void GLAPIENTRY nullGenBuffers(GLsizei n, GLuint* buffers){
+    recordCall("glGenBuffers", {n});
+    null_device_state->createNames(n, buffers);
+}
+
+void GLAPIENTRY nullDeleteBuffers(GLsizei n, const GLuint* buffers){
+    recordCall("glDeleteBuffers", {n});
+
+    for(GLsizei i = 0; i < n; ++i){
+        null_device_state->buffers.erase(buffers[i]);
+    }
+}
+
+void GLAPIENTRY nullBindBuffer(GLenum target, GLuint buffer){
+    recordCall("glBindBuffer", {target, buffer});
+    null_device_state->bound_buffers[target] = buffer;
+}
+
+void GLAPIENTRY nullBufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage){
+    recordCall("glBufferData", {target, size, usage});
+
+    auto buffer = null_device_state->boundBuffer(target);
+    if(buffer != nullptr){
+        buffer->assign((size_t)size, 0);
+        if(data != nullptr){
+            std::memcpy(buffer->data(), data, (size_t)size);
+        }
+    }
+}
+
+void GLAPIENTRY nullBufferStorage(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags){
+    recordCall("glBufferStorage", {target, size, flags});
+
+    auto buffer = null_device_state->boundBuffer(target);
+    if(buffer != nullptr){
+        buffer->assign((size_t)size, 0);
+        if(data != nullptr){
+            std::memcpy(buffer->data(), data, (size_t)size);
+        }
+    }
+}
+
+void GLAPIENTRY nullBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data){
+    recordCall("glBufferSubData", {target, offset, size});
+
+    auto buffer = null_device_state->boundBuffer(target);
+    if(buffer != nullptr && data != nullptr && (size_t)(offset + size) <= buffer->size()){
+        std::memcpy(buffer->data() + offset, data, (size_t)size);
+    }
+}
+
+void* GLAPIENTRY nullMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access){
+    recordCall("glMapBufferRange", {target, offset, length, access});
+
+    auto buffer = null_device_state->boundBuffer(target);
+    if(buffer == nullptr || (size_t)(offset + length) > buffer->size()){
+        return nullptr;
+    }
+
+    return buffer->data() + offset;
+}
+
+GLboolean GLAPIENTRY nullUnmapBuffer(GLenum target){
+    recordCall("glUnmapBuffer", {target});
+    return GL_TRUE;
+}
+
+void GLAPIENTRY nullGenVertexArrays(GLsizei n, GLuint* arrays){
+    recordCall("glGenVertexArrays", {n});
+    null_device_state->createNames(n, arrays);
+}
+
+void GLAPIENTRY nullDeleteVertexArrays(GLsizei n, const GLuint*){
+    recordCall("glDeleteVertexArrays", {n});
+}
+
+void GLAPIENTRY nullBindVertexArray(GLuint array){
+    recordCall("glBindVertexArray", {array});
+}
+
+void GLAPIENTRY nullEnableVertexAttribArray(GLuint index){
+    recordCall("glEnableVertexAttribArray", {index});
+}
+
+void GLAPIENTRY nullDisableVertexAttribArray(GLuint index){
+    recordCall("glDisableVertexAttribArray", {index});
+}
+
+void GLAPIENTRY nullVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean, GLsizei stride, const void*){
+    recordCall("glVertexAttribPointer", {index, size, type, stride});
+}
+
+GLuint GLAPIENTRY nullCreateShader(GLenum type){
+    recordCall("glCreateShader", {type});
+
+    GLuint name = null_device_state->next_name++;
+    null_device_state->shaders[name].type = type;
+
+    return name;
+}
+
+void GLAPIENTRY nullDeleteShader(GLuint shader){
+    recordCall("glDeleteShader", {shader});
+    null_device_state->shaders.erase(shader);
+}
+
+void GLAPIENTRY nullShaderSource(GLuint shader, GLsizei count, const GLchar* const* string, const GLint* length){
+    recordCall("glShaderSource", {shader, count});
+
+    auto found = null_device_state->shaders.find(shader);
+    if(found == null_device_state->shaders.end()){
+        return;
+    }
+
+    found->second.source.clear();
+    for(GLsizei i = 0; i < count; ++i){
+        if(length != nullptr && length[i] >= 0){
+            found->second.source.append(string[i], (size_t)length[i]);
+        }
+        else{
+            found->second.source.append(string[i]);
+        }
+    }
+}
+
+void GLAPIENTRY nullCompileShader(GLuint shader){
+    recordCall("glCompileShader", {shader});
+}
+
+void GLAPIENTRY nullGetShaderiv(GLuint shader, GLenum pname, GLint* params){
+    recordCall("glGetShaderiv", {shader, pname});
+
+    switch(pname){
+        case GL_COMPILE_STATUS:
+            *params = GL_TRUE;
+            break;
+        default:
+            *params = 0;
+    }
+}
+
+void GLAPIENTRY nullGetShaderInfoLog(GLuint shader, GLsizei buffer_size, GLsizei* length, GLchar* log){
+    recordCall("glGetShaderInfoLog", {shader});
+    copyString("", buffer_size, length, log);
+}
+
+GLuint GLAPIENTRY nullCreateProgram(){
+    recordCall("glCreateProgram");
+
+    GLuint name = null_device_state->next_name++;
+    null_device_state->programs[name] = NullProgram();
+
+    return name;
+}
+
+void GLAPIENTRY nullDeleteProgram(GLuint program){
+    recordCall("glDeleteProgram", {program});
+    null_device_state->programs.erase(program);
+}
+
+void GLAPIENTRY nullAttachShader(GLuint program, GLuint shader){
+    recordCall("glAttachShader", {program, shader});
+
+    NullProgram* found = findProgram(program);
+    if(found != nullptr){
+        found->shaders.push_back(shader);
+    }
+}
+
+void GLAPIENTRY nullDetachShader(GLuint program, GLuint shader){
+    recordCall("glDetachShader", {program, shader});
+
+    NullProgram* found = findProgram(program);
+    if(found != nullptr){
+        found->shaders.erase(std::remove(found->shaders.begin(), found->shaders.end(), shader), found->shaders.end());
+    }
+}
+
+void GLAPIENTRY nullLinkProgram(GLuint program){
+    recordCall("glLinkProgram", {program});
+
+    NullProgram* found = findProgram(program);
+    if(found != nullptr){
+        reflectProgram(null_device_state, *found);
+
+        for(auto& attribute : found->attributes){
+            auto bound = found->bound_attributes.find(attribute.base_name);
+            if(bound != found->bound_attributes.end()){
+                attribute.location = bound->second;
+            }
+        }
+    }
+}
+
+void GLAPIENTRY nullBindAttribLocation(GLuint program, GLuint index, const GLchar* name){
+    recordCall("glBindAttribLocation", {program, index});
+
+    NullProgram* found = findProgram(program);
+    if(found != nullptr){
+        found->bound_attributes[name] = (GLint)index;
+    }
+}
+
+void GLAPIENTRY nullGetProgramiv(GLuint program, GLenum pname, GLint* params){
+    recordCall("glGetProgramiv", {program, pname});
+
+    NullProgram* found = findProgram(program);
+
+    switch(pname){
+        case GL_LINK_STATUS:
+        case GL_COMPLETION_STATUS_KHR:
+            *params = found != nullptr ? GL_TRUE : GL_FALSE;
+            break;
+        case GL_ACTIVE_ATTRIBUTES:
+            *params = found != nullptr ? (GLint)found->attributes.size() : 0;
+            break;
+        case GL_ACTIVE_ATTRIBUTE_MAX_LENGTH:
+            *params = found != nullptr ? maxNameLength(found->attributes) : 0;
+            break;
+        case GL_ACTIVE_UNIFORMS:
+            *params = found != nullptr ? (GLint)found->uniforms.size() : 0;
+            break;
+        case GL_ACTIVE_UNIFORM_MAX_LENGTH:
+            *params = found != nullptr ? maxNameLength(found->uniforms) : 0;
+            break;
+        default:
+            *params = 0;
+    }
+}
+
+void GLAPIENTRY nullGetProgramInfoLog(GLuint program, GLsizei buffer_size, GLsizei* length, GLchar* log){
+    recordCall("glGetProgramInfoLog", {program});
+    copyString("", buffer_size, length, log);
+}
+
+void GLAPIENTRY nullUseProgram(GLuint program){
+    recordCall("glUseProgram", {program});
+}
+
+void GLAPIENTRY nullProgramParameteri(GLuint program, GLenum pname, GLint value){
+    recordCall("glProgramParameteri", {program, pname, value});
+}
+
+void GLAPIENTRY nullProgramBinary(GLuint program, GLenum binary_format, const void*, GLsizei length){
+    recordCall("glProgramBinary", {program, binary_format, length});
+}
+
+void GLAPIENTRY nullGetProgramBinary(GLuint program, GLsizei buffer_size, GLsizei* length, GLenum* binary_format, void*){
+    recordCall("glGetProgramBinary", {program, buffer_size});
+
+    if(length != nullptr){
+        *length = 0;
+    }
+
+    *binary_format = 0;
+}
+
+void GLAPIENTRY nullGetActiveAttrib(GLuint program, GLuint index, GLsizei buffer_size, GLsizei* length, GLint* size, GLenum* type, GLchar* name){
+    recordCall("glGetActiveAttrib", {program, index});
+
+    NullProgram* found = findProgram(program);
+    getActiveVariable(found != nullptr ? found->attributes : std::vector<NullVariable>(), index, buffer_size, length, size, type, name);
+}
+
+void GLAPIENTRY nullGetActiveUniform(GLuint program, GLuint index, GLsizei buffer_size, GLsizei* length, GLint* size, GLenum* type, GLchar* name){
+    recordCall("glGetActiveUniform", {program, index});
+
+    NullProgram* found = findProgram(program);
+    getActiveVariable(found != nullptr ? found->uniforms : std::vector<NullVariable>(), index, buffer_size, length, size, type, name);
+}
+
+//uniform blocks are not reflected, so these are only called for programs which report none
+void GLAPIENTRY nullGetActiveUniformBlockName(GLuint program, GLuint index, GLsizei buffer_size, GLsizei* length, GLchar* name){
+    recordCall("glGetActiveUniformBlockName", {program, index});
+    copyString("", buffer_size, length, name);
+}
+
+void GLAPIENTRY nullGetActiveUniformBlockiv(GLuint program, GLuint index, GLenum pname, GLint* params){
+    recordCall("glGetActiveUniformBlockiv", {program, index, pname});
+    *params = 0;
+}
+
+GLint GLAPIENTRY nullGetAttribLocation(GLuint program, const GLchar* name){
+    recordCall("glGetAttribLocation", {program});
+
+    NullProgram* found = findProgram(program);
+    return found != nullptr ? findLocation(found->attributes, name) : -1;
+}
+
+GLint GLAPIENTRY nullGetUniformLocation(GLuint program, const GLchar* name){
+    recordCall("glGetUniformLocation", {program});
+
+    NullProgram* found = findProgram(program);
+    return found != nullptr ? findLocation(found->uniforms, name) : -1;
+}
+
+void GLAPIENTRY nullMaxShaderCompilerThreadsKHR(GLuint count){
+    recordCall("glMaxShaderCompilerThreadsKHR", {count});
+}
+
+void GLAPIENTRY nullUniform1i(GLint location, GLint v0){
+    recordCall("glUniform1i", {location, v0});
+}
+
+void GLAPIENTRY nullUniform1f(GLint location, GLfloat){
+    recordCall("glUniform1f", {location});
+}
+
+void GLAPIENTRY nullUniform2fv(GLint location, GLsizei count, const GLfloat*){
+    recordCall("glUniform2fv", {location, count});
+}
+
+void GLAPIENTRY nullUniform3fv(GLint location, GLsizei count, const GLfloat*){
+    recordCall("glUniform3fv", {location, count});
+}
+
+void GLAPIENTRY nullUniform4fv(GLint location, GLsizei count, const GLfloat*){
+    recordCall("glUniform4fv", {location, count});
+}
+
+void GLAPIENTRY nullUniformMatrix3fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat*){
+    recordCall("glUniformMatrix3fv", {location, count, transpose});
+}
+
+void GLAPIENTRY nullUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat*){
+    recordCall("glUniformMatrix4fv", {location, count, transpose});
+}
+
+void GLAPIENTRY nullActiveTexture(GLenum texture){
+    recordCall("glActiveTexture", {texture});
+}
+
+void GLAPIENTRY nullTexImage3D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei, GLsizei, GLint, GLenum, GLenum,
+                               const void*){
+    recordCall("glTexImage3D", {target, level, internalformat, width});
+}
+
+void GLAPIENTRY nullTexStorage2D(GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei){
+    recordCall("glTexStorage2D", {target, levels, internalformat, width});
+}
+
+void GLAPIENTRY nullCompressedTexImage2D(GLenum target, GLint level, GLenum internalformat, GLsizei, GLsizei, GLint, GLsizei image_size,
+                                         const void*){
+    recordCall("glCompressedTexImage2D", {target, level, internalformat, image_size});
+}
+
+void GLAPIENTRY nullCompressedTexSubImage2D(GLenum target, GLint level, GLint, GLint, GLsizei, GLsizei, GLenum format, GLsizei image_size,
+                                            const void*){
+    recordCall("glCompressedTexSubImage2D", {target, level, format, image_size});
+}
+
+void GLAPIENTRY nullGenerateMipmap(GLenum target){
+    recordCall("glGenerateMipmap", {target});
+}
+
+void GLAPIENTRY nullGenFramebuffers(GLsizei n, GLuint* framebuffers){
+    recordCall("glGenFramebuffers", {n});
+    null_device_state->createNames(n, framebuffers);
+}
+
+void GLAPIENTRY nullDeleteFramebuffers(GLsizei n, const GLuint*){
+    recordCall("glDeleteFramebuffers", {n});
+}
+
+void GLAPIENTRY nullBindFramebuffer(GLenum target, GLuint framebuffer){
+    recordCall("glBindFramebuffer", {target, framebuffer});
+}
+
+void GLAPIENTRY nullGenRenderbuffers(GLsizei n, GLuint* renderbuffers){
+    recordCall("glGenRenderbuffers", {n});
+    null_device_state->createNames(n, renderbuffers);
+}
+
+void GLAPIENTRY nullDeleteRenderbuffers(GLsizei n, const GLuint*){
+    recordCall("glDeleteRenderbuffers", {n});
+}
+
+void GLAPIENTRY nullBindRenderbuffer(GLenum target, GLuint renderbuffer){
+    recordCall("glBindRenderbuffer", {target, renderbuffer});
+}
+
+void GLAPIENTRY nullRenderbufferStorage(GLenum target, GLenum internalformat, GLsizei width, GLsizei height){
+    recordCall("glRenderbufferStorage", {target, internalformat, width, height});
+}
+
+void GLAPIENTRY nullFramebufferRenderbuffer(GLenum target, GLenum attachment, GLenum renderbuffer_target, GLuint renderbuffer){
+    recordCall("glFramebufferRenderbuffer", {target, attachment, renderbuffer_target, renderbuffer});
+}
+
+GLenum GLAPIENTRY nullCheckFramebufferStatus(GLenum target){
+    recordCall("glCheckFramebufferStatus", {target});
+    return GL_FRAMEBUFFER_COMPLETE;
+}
+
+GLsync GLAPIENTRY nullFenceSync(GLenum condition, GLbitfield flags){
+    recordCall("glFenceSync", {condition, flags});
+
+    //only needs to be a distinct non null handle, it is never dereferenced
+    return (GLsync)(std::uintptr_t)null_device_state->next_name++;
+}
+
+//the null device has no work in flight, so every fence has signalled
+GLenum GLAPIENTRY nullClientWaitSync(GLsync sync, GLbitfield flags, GLuint64){
+    recordCall("glClientWaitSync", {(std::int64_t)(std::uintptr_t)sync, flags});
+    return GL_ALREADY_SIGNALED;
+}
+
+void GLAPIENTRY nullDeleteSync(GLsync sync){
+    recordCall("glDeleteSync", {(std::int64_t)(std::uintptr_t)sync});
+}
+
+void GLAPIENTRY nullGenQueries(GLsizei n, GLuint* ids){
+    recordCall("glGenQueries", {n});
+    null_device_state->createNames(n, ids);
+}
+
+void GLAPIENTRY nullDeleteQueries(GLsizei n, const GLuint*){
+    recordCall("glDeleteQueries", {n});
+}
+
+void GLAPIENTRY nullQueryCounter(GLuint id, GLenum target){
+    recordCall("glQueryCounter", {id, target});
+}
+
+void GLAPIENTRY nullGetQueryiv(GLenum target, GLenum pname, GLint* params){
+    recordCall("glGetQueryiv", {target, pname});
+    *params = 0;
+}
+
+void GLAPIENTRY nullGetQueryObjectuiv(GLuint id, GLenum pname, GLuint* params){
+    recordCall("glGetQueryObjectuiv", {id, pname});
+    *params = pname == GL_QUERY_RESULT_AVAILABLE ? GL_TRUE : 0;
+}
+
+void GLAPIENTRY nullGetQueryObjectui64v(GLuint id, GLenum pname, GLuint64* params){
+    recordCall("glGetQueryObjectui64v", {id, pname});
+    *params = 0;
+}
+
+void GLAPIENTRY nullGetInteger64v(GLenum pname, GLint64* data){
+    recordCall("glGetInteger64v", {pname});
+
+    if(pname == GL_TIMESTAMP){
+        *data = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+    else{
+        *data = 0;
+    }
+}
+
+void GLAPIENTRY nullDrawElementsBaseVertex(GLenum mode, GLsizei count, GLenum, const void* indices, GLint base_vertex){
+    recordCall("glDrawElementsBaseVertex", {mode, count, (std::int64_t)(std::uintptr_t)indices, base_vertex});
+}
+
+//sets a pointer loaded by GLEW, whose exact type differs between GLEW versions for some functions
+template<class Pointer, class Function>
+void setFunction(Pointer& pointer, Function function, bool install){
+    pointer = install ? reinterpret_cast<Pointer>(function) : nullptr;
+}
+
+//installs the functions of the null device, or clears them again
+void setNullFunctions(bool install){
+    gl_core_functions = install ? nullCoreFunctions() : libraryCoreFunctions();
+
+    setFunction(__glewGenBuffers, nullGenBuffers, install);
+    setFunction(__glewDeleteBuffers, nullDeleteBuffers, install);
+    setFunction(__glewBindBuffer, nullBindBuffer, install);
+    setFunction(__glewBufferData, nullBufferData, install);
+    setFunction(__glewBufferStorage, nullBufferStorage, install);
+    setFunction(__glewBufferSubData, nullBufferSubData, install);
+    setFunction(__glewMapBufferRange, nullMapBufferRange, install);
+    setFunction(__glewUnmapBuffer, nullUnmapBuffer, install);
+
+    setFunction(__glewGenVertexArrays, nullGenVertexArrays, install);
+    setFunction(__glewDeleteVertexArrays, nullDeleteVertexArrays, install);
+    setFunction(__glewBindVertexArray, nullBindVertexArray, install);
+    setFunction(__glewEnableVertexAttribArray, nullEnableVertexAttribArray, install);
+    setFunction(__glewDisableVertexAttribArray, nullDisableVertexAttribArray, install);
+    setFunction(__glewVertexAttribPointer, nullVertexAttribPointer, install);
+
+    setFunction(__glewCreateShader, nullCreateShader, install);
+    setFunction(__glewDeleteShader, nullDeleteShader, install);
+    setFunction(__glewShaderSource, nullShaderSource, install);
+    setFunction(__glewCompileShader, nullCompileShader, install);
+    setFunction(__glewGetShaderiv, nullGetShaderiv, install);
+    setFunction(__glewGetShaderInfoLog, nullGetShaderInfoLog, install);
+    setFunction(__glewCreateProgram, nullCreateProgram, install);
+    setFunction(__glewDeleteProgram, nullDeleteProgram, install);
+    setFunction(__glewAttachShader, nullAttachShader, install);
+    setFunction(__glewDetachShader, nullDetachShader, install);
+    setFunction(__glewLinkProgram, nullLinkProgram, install);
+    setFunction(__glewBindAttribLocation, nullBindAttribLocation, install);
+    setFunction(__glewGetProgramiv, nullGetProgramiv, install);
+    setFunction(__glewGetProgramInfoLog, nullGetProgramInfoLog, install);
+    setFunction(__glewUseProgram, nullUseProgram, install);
+    setFunction(__glewProgramParameteri, nullProgramParameteri, install);
+    setFunction(__glewProgramBinary, nullProgramBinary, install);
+    setFunction(__glewGetProgramBinary, nullGetProgramBinary, install);
+    setFunction(__glewGetActiveAttrib, nullGetActiveAttrib, install);
+    setFunction(__glewGetActiveUniform, nullGetActiveUniform, install);
+    setFunction(__glewGetActiveUniformBlockName, nullGetActiveUniformBlockName, install);
+    setFunction(__glewGetActiveUniformBlockiv, nullGetActiveUniformBlockiv, install);
+    setFunction(__glewGetAttribLocation, nullGetAttribLocation, install);
+    setFunction(__glewGetUniformLocation, nullGetUniformLocation, install);
+    setFunction(__glewMaxShaderCompilerThreadsKHR, nullMaxShaderCompilerThreadsKHR, install);
+
+    setFunction(__glewUniform1i, nullUniform1i, install);
+    setFunction(__glewUniform1f, nullUniform1f, install);
+    setFunction(__glewUniform2fv, nullUniform2fv, install);
+    setFunction(__glewUniform3fv, nullUniform3fv, install);
+    setFunction(__glewUniform4fv, nullUniform4fv, install);
+    setFunction(__glewUniformMatrix3fv, nullUniformMatrix3fv, install);
+    setFunction(__glewUniformMatrix4fv, nullUniformMatrix4fv, install);
+
+    setFunction(__glewActiveTexture, nullActiveTexture, install);
+    setFunction(__glewTexImage3D, nullTexImage3D, install);
+    setFunction(__glewTexStorage2D, nullTexStorage2D, install);
+    setFunction(__glewCompressedTexImage2D, nullCompressedTexImage2D, install);
+    setFunction(__glewCompressedTexSubImage2D, nullCompressedTexSubImage2D, install);
+    setFunction(__glewGenerateMipmap, nullGenerateMipmap, install);
+
+    setFunction(__glewGenFramebuffers, nullGenFramebuffers, install);
+    setFunction(__glewDeleteFramebuffers, nullDeleteFramebuffers, install);
+    setFunction(__glewBindFramebuffer, nullBindFramebuffer, install);
+    setFunction(__glewGenRenderbuffers, nullGenRenderbuffers, install);
+    setFunction(__glewDeleteRenderbuffers, nullDeleteRenderbuffers, install);
+    setFunction(__glewBindRenderbuffer, nullBindRenderbuffer, install);
+    setFunction(__glewRenderbufferStorage, nullRenderbufferStorage, install);
+    setFunction(__glewFramebufferRenderbuffer, nullFramebufferRenderbuffer, install);
+    setFunction(__glewCheckFramebufferStatus, nullCheckFramebufferStatus, install);
+
+    setFunction(__glewFenceSync, nullFenceSync, install);
+    setFunction(__glewClientWaitSync, nullClientWaitSync, install);
+    setFunction(__glewDeleteSync, nullDeleteSync, install);
+
+    setFunction(__glewGenQueries, nullGenQueries, install);
+    setFunction(__glewDeleteQueries, nullDeleteQueries, install);
+    setFunction(__glewQueryCounter, nullQueryCounter, install);
+    setFunction(__glewGetQueryiv, nullGetQueryiv, install);
+    setFunction(__glewGetQueryObjectuiv, nullGetQueryObjectuiv, install);
+    setFunction(__glewGetQueryObjectui64v, nullGetQueryObjectui64v, install);
+    setFunction(__glewGetInteger64v, nullGetInteger64v, install);
+
+    setFunction(__glewDrawElementsBaseVertex, nullDrawElementsBaseVertex, install);
+
+    //no extensions, so that the engine takes the paths every GL 3.3 implementation supports
+    __GLEW_ARB_buffer_storage = GL_FALSE;
+    __GLEW_ARB_get_program_binary = GL_FALSE;
+    __GLEW_ARB_texture_storage = GL_FALSE;
+    __GLEW_ARB_timer_query = GL_FALSE;
+    __GLEW_KHR_parallel_shader_compile = GL_FALSE;
+}
+
+RenderDevice::RenderDevice(RenderDeviceType type) : type_(type), null_state_(new NullDeviceState()){
+}
+
+RenderDevice::~RenderDevice(){
+}
+
+bool RenderDevice::initialize(RenderDeviceType type, bool headless){
+    if(RenderDevice::render_device_ != nullptr){
+        return false;
+    }
+
+    if(type == RENDER_DEVICE_NULL){
+        RenderDevice::render_device_ = std::unique_ptr<RenderDevice>(new RenderDevice(type));
+
+        null_device_state = RenderDevice::render_device_->null_state_.get();
+        setNullFunctions(true);
+
+        return true;
+    }
+
+    gl_core_functions = libraryCoreFunctions();
+
+    glewExperimental = GL_TRUE;
+    GLenum glew_err = glewInit();
+
+#ifdef GLEW_ERROR_NO_GLX_DISPLAY
+    //GLEW built for GLX also looks up the GLX functions, which fails without an X display even though the EGL context is fine
+    if(headless && glew_err == GLEW_ERROR_NO_GLX_DISPLAY){
+        glew_err = GLEW_OK;
+    }
+#else
+    (void)headless;
+#endif
+
+    if(glew_err != GLEW_OK){
+        std::cerr << "Error initializing GLEW: " << glewGetErrorString(glew_err) << std::endl;
+        return false;
+    }
+
+    RenderDevice::render_device_ = std::unique_ptr<RenderDevice>(new RenderDevice(type));
+
+    return true;
+}
+
+bool RenderDevice::shutdown(){
+    if(RenderDevice::render_device_ == nullptr){
+        return false;
+    }
+
+    if(RenderDevice::render_device_->type_ == RENDER_DEVICE_NULL){
+        setNullFunctions(false);
+        null_device_state = nullptr;
+    }
+
+    RenderDevice::render_device_ = nullptr;
+
+    return true;
+}
+
+RenderDevice* RenderDevice::renderDevice(){
+    return render_device_.get();
+}
+
+RenderDeviceType RenderDevice::getType(){
+    return type_;
+}
+
+std::uint64_t RenderDevice::getCallCount(const std::string& function){
+    std::uint64_t count = 0;
+
+    //counts are keyed by the literal names of the null functions
+    for(auto& call_count : null_state_->call_counts){
+        if(function == call_count.first){
+            count += call_count.second;
+        }
+    }
+
+    return count;
+}
+
+std::vector<GLCallCount> RenderDevice::getCallCounts(){
+    std::map<std::string, std::uint64_t> sorted;
+    for(auto& call_count : null_state_->call_counts){
+        sorted[call_count.first] += call_count.second;
+    }
+
+    std::vector<GLCallCount> counts;
+    for(auto& call_count : sorted){
+        counts.push_back(GLCallCount{call_count.first, call_count.second});
+    }
+
+    return counts;
+}
+
+std::uint64_t RenderDevice::getTotalCalls(){
+    return null_state_->total_calls;
+}
+
+void RenderDevice::resetCallCounts(){
+    null_state_->call_counts.clear();
+    null_state_->total_calls = 0;
+}
+
+void RenderDevice::setLogging(bool enabled, size_t max_calls){
+    null_state_->logging = enabled;
+    null_state_->max_log_calls = max_calls;
+}
+
+const std::vector<GLCall>& RenderDevice::getLog(){
+    return null_state_->log;
+}
+
+void RenderDevice::clearLog(){
+    null_state_->log.clear();
+}
+
+void RenderDevice::writeLog(std::ostream& stream){
+    for(auto& call : null_state_->log){
+        stream << call.function << "(";
+
+        for(unsigned int i = 0; i < call.arg_count; ++i){
+            stream << (i > 0 ? ", " : "") << call.args[i];
+        }
+
+        stream << ")\n";
+    }
+}
@@ -0,0 +1,129 @@
+#ifndef RENDERDEVICE_H
+#define RENDERDEVICE_H
+
+#include "common.h"
+
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief The RenderDeviceType enum selects what the GL functions of the engine do. RENDER_DEVICE_GL calls the driver, and RENDER_DEVICE_NULL
+ * calls nothing, but records and counts the calls and simulates the objects they create, so the engine runs without a GL context or GPU.
+ */
+enum RenderDeviceType{RENDER_DEVICE_GL, RENDER_DEVICE_NULL};
+
+const unsigned int GL_CALL_MAX_ARGS = 4;
+
+/**
+ * @brief The GLCall struct is a call recorded by the null device. Only the integer arguments of a call, such as targets, names and sizes, are
+ * recorded, pointers and floats are left out.
+ */
+struct GLCall{
+    const char* function;
+    unsigned int arg_count;
+    std::int64_t args[GL_CALL_MAX_ARGS];
+};
+
+/**
+ * @brief The GLCallCount struct is the number of times a GL function was called
+ */
+struct GLCallCount{
+    std::string function;
+    std::uint64_t count;
+};
+
+//objects simulated by the null device, and the calls it recorded, defined in renderdevice.cpp
+struct NullDeviceState;
+
+/**
+ * @brief The RenderDevice class selects the GL functions the engine calls. The engine calls GL directly, and the device is the table of function
+ * pointers behind those calls: the ones GLEW loads, and the 1.1 functions of GLCoreFunctions. The GL device loads the driver functions with GLEW,
+ * while the null device replaces them with functions which record the call stream, count calls per function, and simulate what the engine reads
+ * back, such as object names, mapped buffers, compile and link status, and shader reflection parsed from the GLSL source. This allows the CPU side
+ * of the renderer to be benchmarked in isolation, and state changes to be counted, on machines without a GPU.
+ *
+ * The null device implements the functions the engine calls, along with common draw, state and uniform functions. Others are left null, and
+ * crash if called. It reports no extensions, so the engine takes its fallback paths.
+ */
+class RenderDevice
+{
+friend std::unique_ptr<RenderDevice>::deleter_type;
+friend class Engine;
+private:
+    RenderDeviceType type_;
+    std::unique_ptr<NullDeviceState> null_state_;
+
+    static std::unique_ptr<RenderDevice> render_device_;
+
+private:
+    RenderDevice(RenderDeviceType type);
+    RenderDevice(const RenderDevice& other) = delete;
+    ~RenderDevice();
+
+    //loads the GL functions or installs the null ones, once the context, if any, is current. headless GL devices tolerate GLEW failing to
+    //find a GLX display, as an EGL context needs none
+    static bool initialize(RenderDeviceType type, bool headless);
+    static bool shutdown();
+
+public:
+    static RenderDevice* renderDevice();
+
+    /**
+     * @brief Gets the type of the device
+     * @return type of the device
+     */
+    RenderDeviceType getType();
+
+    /**
+     * @brief Gets the number of times a GL function was called since the counts were last reset. Calls are only counted by the null device.
+     * @param function Name of the function, e.g. "glBindBuffer"
+     * @return number of calls
+     */
+    std::uint64_t getCallCount(const std::string& function);
+
+    /**
+     * @brief Gets the number of calls to every function called since the counts were last reset, sorted by name
+     * @return calls per function
+     */
+    std::vector<GLCallCount> getCallCounts();
+
+    /**
+     * @brief Gets the number of calls to all functions since the counts were last reset
+     * @return number of calls
+     */
+    std::uint64_t getTotalCalls();
+
+    /**
+     * @brief Resets the call counts
+     */
+    void resetCallCounts();
+
+    /**
+     * @brief Enables recording the calls of the null device into the log, which is off by default
+     * @param enabled Whether calls are recorded
+     * @param max_calls Number of calls the log keeps, further calls are counted but not recorded
+     */
+    void setLogging(bool enabled, size_t max_calls = 1 << 20);
+
+    /**
+     * @brief Gets the calls recorded since the log was last cleared
+     * @return recorded calls, in order
+     */
+    const std::vector<GLCall>& getLog();
+
+    /**
+     * @brief Clears the log
+     */
+    void clearLog();
+
+    /**
+     * @brief Writes the log, one call per line, e.g. glBindBuffer(34962, 3)
+     * @param stream Stream to write to
+     */
+    void writeLog(std::ostream& stream);
+};
+
+#endif // RENDERDEVICE_H
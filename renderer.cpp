@@ -7,10 +7,24 @@
 #include "material.h"
 #include "mesh.h"
 #include "scenenode.h"
+#include "texture.h"
+#include "resourcemanager.h"
+#include "profiler.h"
+#include "enginestats.h"
+
+#include <cmath>
+#include <chrono>
+#include <algorithm>
+#include <functional>
+#include <limits>
 
 std::unique_ptr<Renderer> Renderer::renderer_ = nullptr;
 
-Renderer::Renderer(){
+//number of frames of GPU timer queries which may be in flight before a frame is not timed
+const unsigned int GPU_PROFILER_LATENCY_FRAMES = 4;
+
+Renderer::Renderer() : recording_packet_(nullptr), record_threads_(0), next_record_job_(0), running_record_tasks_(0), frame_count_(0),
+                       active_texture_unit_(0), gpu_profiler_(new GpuProfiler(GPU_PROFILER_LATENCY_FRAMES)){
 }
 
 Renderer::~Renderer(){
@@ -20,6 +34,12 @@ bool Renderer::initialize(){
     if(Renderer::renderer_ == nullptr){
         Renderer::renderer_ = std::unique_ptr<Renderer>(new Renderer);
 
+        //let the driver decide how many threads to compile shaders on, which some drivers only do once asked to. This is a setting of the
+        //context, so it is made once rather than for every shader
+        if(GLEW_KHR_parallel_shader_compile){
+            glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+        }
+
         return true;
     }
 
@@ -40,6 +60,16 @@ Renderer* Renderer::renderer(){
 }
 
 void Renderer::frame(){
+    PROFILE_ZONE("Render");
+
+    buildFrame(frame_packet_);
+    prepareFrame(frame_packet_);
+    executeFrame(frame_packet_);
+}
+
+void Renderer::buildFrame(FramePacket& packet){
+    PROFILE_ZONE("Build frame");
+
     if(cameras_.size() > 1){
         std::sort(cameras_.begin(), cameras_.end(), [](Camera* first, Camera* second){
             auto first_vp = first->getViewport();
@@ -52,13 +82,68 @@ void Renderer::frame(){
         });
     }
 
+    packet.frame = frame_count_;
+    packet.meshes.clear();
+    packet.textures.clear();
+    draw_items_.clear();
+
+    {
+        PROFILE_ZONE("Sort renderables");
+        for(auto& vao_renderables : renderables_){
+            //renderables sharing a texture, or an atlas, are drawn one after another so that their binding is shared
+            vao_renderables.second.sort([](Renderable* first, Renderable* second){
+                auto& first_textures = first->getMaterial()->getTextures();
+                auto& second_textures = second->getMaterial()->getTextures();
+
+                Texture* first_atlas = first_textures.empty() ? nullptr : first_textures.front()->getAtlas();
+                Texture* second_atlas = second_textures.empty() ? nullptr : second_textures.front()->getAtlas();
+
+                return std::less<Texture*>()(first_atlas, second_atlas);
+            });
+
+            for(auto renderable : vao_renderables.second){
+                Mesh* mesh = renderable->getMesh();
+
+                Material* mat = renderable->getMaterial();
+                Shader* shader = mat->getShader();
+
+                //the mesh or shader was freed while the renderable still uses it
+                if(mesh == nullptr || shader == nullptr){
+                    continue;
+                }
+
+                //the shader was reloaded since the locations were resolved. Frames already in flight bind the new locations for the program they
+                //were recorded with, which at worst leaves their uniforms unset until the render thread catches up
+                if(mat->getShaderRevision() != shader->getRevision()){
+                    mat->reloadLocations();
+                }
+
+                if(mesh->getUsageOption() == DYNAMIC_MESH){
+                    packet.meshes.push_back(mesh);
+                }
+
+                //renderables sharing textures are adjacent, which takes care of most duplicates
+                for(auto texture : renderable->getMaterial()->getTextures()){
+                    if(packet.textures.empty() || packet.textures.back() != texture){
+                        packet.textures.push_back(texture);
+                    }
+                }
+
+                draw_items_.push_back(DrawItem{renderable, vao_renderables.first, mesh, shader});
+            }
+        }
+    }
+
     Window* window = Engine::engine()->window();
     auto res = window->getResolution();
     std::pair<std::uint32_t, std::uint32_t> res_unsigned((std::uint32_t)res.first, (std::uint32_t)res.second);
 
+    packet.camera_passes.clear();
+
     for(auto camera : cameras_){
-        Eigen::Matrix4f view_mat = camera->viewMatrix();
-        Eigen::Matrix4f projection_mat = camera->projectionMatrix(res_unsigned);
+        CameraPass pass;
+        pass.view = camera->viewMatrix();
+        pass.projection = camera->projectionMatrix(res_unsigned);
 
         Viewport vp = camera->getViewport();
         GLint start_x = vp.start.first * res_unsigned.first;
@@ -68,68 +153,347 @@ void Renderer::frame(){
 
         assert(start_x < end_x && start_y < end_y);
 
-        GLuint width = end_x - start_x;
-        GLuint height = end_y - start_y;
+        pass.x = start_x;
+        pass.y = start_y;
+        pass.width = end_x - start_x;
+        pass.height = end_y - start_y;
 
-        glViewport(start_x, start_y, width, height);
+        pass.position = Eigen::Affine3f(pass.view).inverse().translation();
+        pass.perspective = pass.projection(3, 3) == 0.f;
+        pass.pixel_scale = (float)pass.height * pass.projection(1, 1) / 2.f;
 
-        GLuint current_program = 0;
-        bool program_changed = true;
+        packet.camera_passes.push_back(pass);
+    }
 
-        for(auto& vao_renderables : renderables_){
-            GLuint vao_name = vao_renderables.first;
+    //one chunk more than there are recording threads, as the thread building the frame records too
+    size_t chunks = std::min<size_t>(record_threads_ + 1, std::max<size_t>(draw_items_.size() / MIN_RECORD_CHUNK_RENDERABLES, 1));
 
-            GLuint program = vao_renderables.second.front()->getMaterial()->getShader()->getProgram();
+    chunk_starts_.clear();
+    for(size_t i = 0; i <= chunks; ++i){
+        chunk_starts_.push_back(draw_items_.size() * i / chunks);
+    }
 
-            if(current_program != program){
-                current_program = program;
-                glUseProgram(program);
+    packet.chunks = chunks;
+
+    size_t jobs = packet.camera_passes.size() * chunks;
+    while(packet.command_buffers.size() < jobs){
+        packet.command_buffers.push_back(std::unique_ptr<CommandBuffer>(new CommandBuffer()));
+    }
+
+    auto record_start = std::chrono::steady_clock::now();
+
+    {
+        PROFILE_ZONE("Record commands");
+
+        recording_packet_ = &packet;
+        next_record_job_ = 0;
+
+        //the building thread takes jobs as well, so no more tasks are started than there are jobs it would otherwise be left waiting on
+        unsigned int tasks = (unsigned int)std::min<size_t>(record_threads_, jobs > 0 ? jobs - 1 : 0);
+
+        if(tasks > 0){
+            {
+                std::lock_guard<std::mutex> lock(record_mutex_);
+                running_record_tasks_ = tasks;
             }
-            else program_changed = false;
 
-            glBindVertexArray(vao_name);
+            for(unsigned int i = 0; i < tasks; ++i){
+                record_workers_->submit([this](){
+                    recordJobs();
 
-            for(auto renderable : vao_renderables.second){
-                Material* mat = renderable->getMaterial();
-                Mesh* mesh = renderable->getMesh();
+                    std::lock_guard<std::mutex> lock(record_mutex_);
+                    running_record_tasks_--;
+                    record_condition_.notify_one();
+                });
+            }
+        }
 
-                assert(renderable->owner_ != nullptr);
-                Eigen::Affine3f world = renderable->owner_->worldTransform();
+        recordJobs();
 
-                int world_mat_pos = mat->getModelMatLocation();
-                int proj_mat_pos = mat->getProjMatLocation();
-                int view_mat_pos = mat->getViewMatLocation();
+        std::unique_lock<std::mutex> lock(record_mutex_);
+        record_condition_.wait(lock, [this](){return running_record_tasks_ == 0;});
 
-                mat->bind();
+        recording_packet_ = nullptr;
+    }
 
-                if(program_changed){
-                    if(view_mat_pos >= 0){
-                        glUniformMatrix4fv((GLuint)view_mat_pos, 1, GL_FALSE, view_mat.data());
-                    }
+    packet.record_ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - record_start).count();
 
-                    if(proj_mat_pos >= 0){
-                        glUniformMatrix4fv((GLuint)proj_mat_pos, 1, GL_FALSE, projection_mat.data());
-                    }
-                }
+    cameras_.clear();
+    renderables_.clear();
+
+    frame_count_++;
+}
+
+void Renderer::prepareFrame(FramePacket& packet){
+    {
+        PROFILE_ZONE("Upload meshes");
+
+        for(auto mesh : packet.meshes){
+            //meshes drawn more than once are only prepared the first time
+            if(mesh->prepareFrame(packet.frame)){
+                dynamic_meshes_.push_back(mesh);
+            }
+        }
+    }
+
+    PROFILE_ZONE("Upload textures");
+
+    TextureManager* texture_manager = ResourceManager::resourceManager()->textureManager();
+
+    for(auto texture : packet.textures){
+        //textures freed since the frame was built stay alive until no frame in flight uses them, but are not made resident again
+        if(texture_manager->getTexture(texture->getHandle()) != texture){
+            texture->prepared_name_ = 0;
+            continue;
+        }
+
+        texture->prepared_name_ = texture->getTextureName();
+    }
+
+    //making a texture resident may have evicted one prepared before it
+    for(auto texture : packet.textures){
+        if(texture->prepared_name_ != 0 && texture->getAtlas()->texture_name_ != texture->prepared_name_){
+            texture->prepared_name_ = 0;
+        }
+    }
+}
+
+void Renderer::executeFrame(FramePacket& packet){
+    PROFILE_ZONE("Execute frame");
+
+    gpu_profiler_->beginFrame();
+
+    //textures may have been bound outside of the renderer since the last frame
+    bound_textures_.clear();
+    active_texture_unit_ = std::numeric_limits<GLuint>::max();
+
+    auto execute_start = std::chrono::steady_clock::now();
+
+    for(size_t camera = 0; camera < packet.camera_passes.size(); ++camera){
+        PROFILE_ZONE("Draw camera");
+        GpuProfileZone camera_zone(gpu_profiler_.get(), "Camera");
+
+        const CameraPass& pass = packet.camera_passes[camera];
+        glViewport(pass.x, pass.y, pass.width, pass.height);
+
+        GpuProfileZone pass_zone(gpu_profiler_.get(), "Geometry pass");
+
+        for(size_t chunk = 0; chunk < packet.chunks; ++chunk){
+            CommandBuffer* buffer = packet.command_buffers[camera * packet.chunks + chunk].get();
+
+            buffer->execute(gpu_profiler_.get(), frame_stats_);
+            frame_stats_.commands += (unsigned int)buffer->size();
+        }
+    }
+
+    frame_stats_.record_ms = packet.record_ms;
+    frame_stats_.execute_ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - execute_start).count();
+
+    gpu_profiler_->endFrame();
+
+    for(auto mesh : dynamic_meshes_){
+        mesh->fenceFrame();
+    }
+
+    dynamic_meshes_.clear();
+
+    //counters are handed to the EngineStats once per frame rather than per draw
+    EngineStats::add(COUNTER_DRAW_CALLS, frame_stats_.draw_calls);
+    EngineStats::add(COUNTER_TRIANGLES, frame_stats_.triangles);
+    EngineStats::add(COUNTER_STATE_CHANGES, frame_stats_.program_binds + frame_stats_.vertex_array_binds + frame_stats_.texture_binds);
+    EngineStats::set(COUNTER_GPU_TIME_US, (std::int64_t)(gpu_profiler_->getLastFrame().frame_ms * 1000.0));
+
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        last_frame_stats_ = frame_stats_;
+    }
+
+    frame_stats_ = RendererStats();
+}
 
-                if(world_mat_pos >= 0){
-                    glUniformMatrix4fv((GLuint)world_mat_pos, 1, GL_FALSE, world.matrix().data());
+void Renderer::recordJobs(){
+    FramePacket& packet = *recording_packet_;
+    size_t jobs = packet.camera_passes.size() * packet.chunks;
+
+    for(size_t job = next_record_job_++; job < jobs; job = next_record_job_++){
+        CommandBuffer& buffer = *packet.command_buffers[job];
+        size_t chunk = job % packet.chunks;
+
+        buffer.clear();
+        recordCommands(buffer, packet.camera_passes[job / packet.chunks], chunk_starts_[chunk], chunk_starts_[chunk + 1]);
+    }
+}
+
+void Renderer::recordCommands(CommandBuffer& buffer, const CameraPass& pass, size_t first, size_t last){
+    bool detailed_zones = gpu_profiler_->detailedZones();
+
+    GLuint current_program = 0;
+    GLuint current_vao = 0;
+
+    for(size_t i = first; i < last; ++i){
+        Renderable* renderable = draw_items_[i].renderable;
+        Material* mat = renderable->getMaterial();
+        Mesh* mesh = draw_items_[i].mesh;
+
+        //renderables sharing a vertex array share their shader too, so the program and camera matrices only change between groups
+        if(i == first || draw_items_[i].vao != current_vao){
+            if(i != first){
+                buffer.bindVertexArray(0);
+
+                if(detailed_zones){
+                    buffer.popGpuZone();
                 }
+            }
 
-                glBindBuffer(GL_ARRAY_BUFFER, mesh->getVBO());
+            if(detailed_zones){
+                buffer.pushGpuZone("Draw group");
+            }
+
+            GLuint program = draw_items_[i].shader->getProgram();
+
+            if(current_program != program){
+                current_program = program;
+                buffer.useProgram(program);
 
-                glDrawElements(GL_TRIANGLES, mesh->getNumIndices(), GL_UNSIGNED_INT, NULL);
+                //uniforms keep their values per program, so the camera matrices are set once for each program bound
+                if(mat->getViewMatLocation() >= 0){
+                    buffer.uniformMatrix4(mat->getViewMatLocation(), pass.view.data());
+                }
 
-                glBindBuffer(GL_ARRAY_BUFFER, 0);
+                if(mat->getProjMatLocation() >= 0){
+                    buffer.uniformMatrix4(mat->getProjMatLocation(), pass.projection.data());
+                }
             }
 
-            glBindVertexArray(0);
+            current_vao = draw_items_[i].vao;
+            buffer.bindVertexArray(current_vao);
+        }
+
+        assert(renderable->owner_ != nullptr);
+        Eigen::Affine3f world = renderable->owner_->worldTransform();
+
+        buffer.bindMaterial(mat);
+
+        if(mat->getModelMatLocation() >= 0){
+            buffer.uniformMatrix4(mat->getModelMatLocation(), world.matrix().data());
+        }
+
+        requestTextureLevels(buffer, renderable, mesh, world, pass.position, pass.pixel_scale, pass.perspective);
+
+        buffer.bindBuffer(GL_ARRAY_BUFFER, mesh->getVBO());
+
+        //the ring buffer a dynamic mesh is drawn from is only chosen once its data is uploaded, which is after recording
+        MeshLOD lod = mesh->getLOD(0);
+        if(mesh->getUsageOption() == DYNAMIC_MESH){
+            buffer.drawMesh(mesh, (GLsizei)lod.num_indices, (GLuint)lod.first_index);
+        }
+        else{
+            buffer.drawElements((GLsizei)lod.num_indices, (GLuint)lod.first_index, mesh->getBaseVertex());
         }
 
+        buffer.bindBuffer(GL_ARRAY_BUFFER, 0);
     }
 
-    cameras_.clear();
-    renderables_.clear();
+    if(last > first){
+        buffer.bindVertexArray(0);
+
+        if(detailed_zones){
+            buffer.popGpuZone();
+        }
+    }
+}
+
+void Renderer::requestTextureLevels(CommandBuffer& buffer, Renderable* renderable, Mesh* mesh, const Eigen::Affine3f& world,
+                                    const Eigen::Vector3f& camera_position, float pixel_scale, bool perspective){
+    auto& textures = renderable->getMaterial()->getTextures();
+    if(textures.empty()){
+        return;
+    }
+
+    MeshBounds bounds = mesh->getBounds();
+
+    Eigen::Vector3f bounds_min(bounds.min[0], bounds.min[1], bounds.min[2]);
+    Eigen::Vector3f bounds_max(bounds.max[0], bounds.max[1], bounds.max[2]);
+
+    //the largest axis scale is used, which errs on the side of finer levels for non uniformly scaled objects
+    float scale = std::max(world.linear().col(0).norm(), std::max(world.linear().col(1).norm(), world.linear().col(2).norm()));
+
+    float pixels_per_unit = pixel_scale;
+    if(perspective){
+        //the closest point of the bounding sphere determines the finest level needed
+        Eigen::Vector3f center = world * ((bounds_min + bounds_max) / 2.f);
+        float radius = (bounds_max - bounds_min).norm() / 2.f * scale;
+        float distance = std::max((center - camera_position).norm() - radius, 1e-3f);
+
+        pixels_per_unit = pixel_scale / distance;
+    }
+
+    float uv_density = mesh->getUVDensity();
+
+    for(auto texture : textures){
+        unsigned int level = 0;
+
+        //meshes without texture coordinate density information always get the full texture
+        if(uv_density > 0.f && scale > 0.f){
+            auto dimensions = texture->getDimensions();
+            float size = (float)*std::max_element(dimensions.begin(), dimensions.end());
+            float texels_per_pixel = size * uv_density / scale / pixels_per_unit;
+
+            level = texels_per_pixel > 1.f ? (unsigned int)std::log2(texels_per_pixel) : 0;
+        }
+
+        buffer.requestTextureLevel(texture, level);
+    }
+}
+
+bool Renderer::bindTexture(unsigned int unit, Texture* texture){
+    //the texture manager is not touched here, as this runs on the render thread without the engine lock when there is one
+    GLuint name = texture->prepared_name_;
+    if(name == 0){
+        return false;
+    }
+
+    if(unit < bound_textures_.size() && bound_textures_[unit] == name){
+        frame_stats_.redundant_texture_binds++;
+        return true;
+    }
+
+    if(unit >= bound_textures_.size()){
+        bound_textures_.resize(unit + 1, 0);
+    }
+
+    if(active_texture_unit_ != unit){
+        glActiveTexture(GL_TEXTURE0 + unit);
+        active_texture_unit_ = unit;
+    }
+
+    glBindTexture(texture->getTarget(), name);
+    bound_textures_[unit] = name;
+    frame_stats_.texture_binds++;
+
+    return true;
+}
+
+void Renderer::setRecordThreads(unsigned int threads){
+    if(threads == record_threads_){
+        return;
+    }
+
+    record_workers_ = threads > 0 ? std::unique_ptr<AsyncLoader>(new AsyncLoader(threads)) : nullptr;
+    record_threads_ = threads;
+}
+
+unsigned int Renderer::recordThreads(){
+    return record_threads_;
+}
+
+RendererStats Renderer::getStats(){
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    return last_frame_stats_;
+}
+
+GpuProfiler* Renderer::gpuProfiler(){
+    return gpu_profiler_.get();
 }
 
 void Renderer::addRenderable(Renderable* renderable){
@@ -2,7 +2,17 @@
 #define RENDERER_H
 
 #include "common.h"
+#include "gpuprofiler.h"
+#include "commandbuffer.h"
+#include "asyncloader.h"
 
+#include <Eigen/Geometry>
+#include <Eigen/StdVector>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
 #include <unordered_map>
 #include <list>
 #include <memory>
@@ -10,14 +20,127 @@
 
 class Renderable;
 class Camera;
+class Mesh;
+class Shader;
+class Texture;
+
+/**
+ * @brief The RendererStats struct holds the counters of a frame of the renderer
+ */
+struct RendererStats{
+    unsigned int draw_calls;
+    unsigned int triangles;
+    unsigned int program_binds;
+    unsigned int vertex_array_binds;
+    unsigned int texture_binds;
+    //binds skipped as the texture, or the atlas it is part of, was already bound to the unit
+    unsigned int redundant_texture_binds;
+    //commands recorded into the command buffers of the frame
+    unsigned int commands;
+    //time spent recording the commands, including waiting on the recording threads, and executing them on the GL thread
+    float record_ms;
+    float execute_ms;
+
+    RendererStats() : draw_calls(0), triangles(0), program_binds(0), vertex_array_binds(0), texture_binds(0), redundant_texture_binds(0),
+                      commands(0), record_ms(0.f), execute_ms(0.f){
+    }
+};
+
+//fewest renderables recorded into a command buffer of their own when recording on several threads, so that small frames are not split up
+const unsigned int MIN_RECORD_CHUNK_RENDERABLES = 256;
+
+/**
+ * @brief The CameraPass struct is what the commands of a camera are recorded with, worked out before recording
+ */
+struct CameraPass{
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    Eigen::Matrix4f view;
+    Eigen::Matrix4f projection;
+    Eigen::Vector3f position;
+    float pixel_scale;
+    bool perspective;
+    GLint x;
+    GLint y;
+    GLsizei width;
+    GLsizei height;
+};
+
+/**
+ * @brief The FramePacket struct is a frame recorded by the renderer, ready to be executed on the GL thread. The transforms, cameras and draws of
+ * the frame are all recorded into it, so that the scene can move on to the next frame while it is executed, see Engine::enableRenderThread().
+ * Packets are reused, and keep the storage of their command buffers.
+ */
+struct FramePacket{
+    std::uint64_t frame;
+    std::vector<CameraPass, Eigen::aligned_allocator<CameraPass> > camera_passes;
+    //the buffer of chunk i of camera c is at c * chunks + i
+    size_t chunks;
+    std::vector<std::unique_ptr<CommandBuffer> > command_buffers;
+    //dynamic meshes drawn, whose data is uploaded before the packet is executed
+    std::vector<Mesh*> meshes;
+    //textures of the materials drawn, which are made resident before the packet is executed
+    std::vector<Texture*> textures;
+    float record_ms;
+    //when the input the frame was simulated from was read, see COUNTER_INPUT_LATENCY_US
+    std::chrono::steady_clock::time_point input_time;
+
+    FramePacket() : frame(0), chunks(0), record_ms(0.f){
+    }
+};
 
 class Renderer
 {
 friend std::unique_ptr<Renderer>::deleter_type;
+friend class Engine;
+friend class Window;
+friend class RenderThread;
+//removes the renderables of a frame without building it, in tools/microbench.cpp
+friend class RendererDriver;
 private:
+    //a renderable to draw, along with the vertex array it is grouped by
+    struct DrawItem{
+        Renderable* renderable;
+        GLuint vao;
+        //resolved from the handles of the renderable and its material once, when the frame is built
+        Mesh* mesh;
+        Shader* shader;
+    };
+
     std::unordered_map<GLuint, std::list<Renderable*> > renderables_;
     std::vector<Camera*> cameras_;
 
+    //renderables of the frame in draw order, split into chunks which are recorded into a command buffer each, per camera. chunk i covers
+    //draw_items_[chunk_starts_[i], chunk_starts_[i + 1])
+    std::vector<DrawItem> draw_items_;
+    std::vector<size_t> chunk_starts_;
+    //packet being recorded, and the one frame() renders through when not on a render thread
+    FramePacket* recording_packet_;
+    FramePacket frame_packet_;
+
+    //threads recording along with the GL thread, none if everything is recorded on the GL thread
+    std::unique_ptr<AsyncLoader> record_workers_;
+    unsigned int record_threads_;
+    std::atomic<size_t> next_record_job_;
+    std::mutex record_mutex_;
+    std::condition_variable record_condition_;
+    unsigned int running_record_tasks_;
+
+    //dynamic meshes drawn during the frame being executed, which need to be fenced once all their draw calls have been issued
+    std::vector<Mesh*> dynamic_meshes_;
+    std::uint64_t frame_count_;
+
+    //texture bound to each unit through bindTexture() during the current frame, indexed by unit
+    std::vector<GLuint> bound_textures_;
+    GLuint active_texture_unit_;
+
+    RendererStats frame_stats_;
+    //written on the GL thread, and read from any
+    RendererStats last_frame_stats_;
+    std::mutex stats_mutex_;
+
+    std::unique_ptr<GpuProfiler> gpu_profiler_;
+
     static std::unique_ptr<Renderer> renderer_;
 
 private:
@@ -27,6 +150,30 @@ private:
     static bool initialize();
     static bool shutdown();
 
+    //records the renderables and cameras added for the frame into packet, and starts the next frame. Makes no GL calls
+    void buildFrame(FramePacket& packet);
+
+    //uploads the dynamic meshes drawn by packet and makes its textures resident, on the GL thread with the engine lock held, so that executing
+    //the packet touches neither the meshes nor the texture manager
+    void prepareFrame(FramePacket& packet);
+
+    //executes the command buffers of packet, on the GL thread
+    void executeFrame(FramePacket& packet);
+
+    //records the draws of draw_items_[first, last) as seen by the camera of pass into buffer. Reads only the renderables, their materials and
+    //meshes, so that it can run on any thread
+    void recordCommands(CommandBuffer& buffer, const CameraPass& pass, size_t first, size_t last);
+
+    //records the command buffers of the packet being recorded, one job per camera and chunk, taking jobs until none are left. Called on the
+    //thread building the frame and the recording threads alike
+    void recordJobs();
+
+    //records requests for the mip levels the textures of the renderable need, by comparing the texel density of its mesh to the number of pixels
+    //a unit covers at the distance of its bounds. pixel_scale is the number of pixels a unit covers at a distance of 1, or at any distance when
+    //not perspective
+    void requestTextureLevels(CommandBuffer& buffer, Renderable* renderable, Mesh* mesh, const Eigen::Affine3f& world,
+                              const Eigen::Vector3f& camera_position, float pixel_scale, bool perspective);
+
 public:
     Renderer(const Renderer& other) = delete;
     Renderer& operator = (const Renderer& other) = delete;
@@ -34,7 +181,7 @@ public:
     static Renderer* renderer();
 
     /**
-     * @brief Advances renderer by a frame
+     * @brief Advances renderer by a frame, recording and executing it on the calling thread
      */
     void frame();
 
@@ -49,6 +196,45 @@ public:
      * @param camera Camera to be used for the current frame
      */
     void addCamera(Camera* camera);
+
+    /**
+     * @brief Binds a texture to a texture unit, skipping the bind if the same GL texture is already bound there. As atlas regions bind the
+     * texture of their atlas, materials using different regions of the same atlas share the binding. Materials should bind their textures
+     * through this rather than binding them directly. Only textures returned by Material::getTextures() can be bound, as they are made resident
+     * when the frame is prepared, with the engine lock held, and binding merely uses the name resolved then.
+     * @param unit Index of the texture unit, starting at 0 for GL_TEXTURE0
+     * @param texture Texture to bind
+     * @return true if the texture is bound, false if its data is not available
+     */
+    bool bindTexture(unsigned int unit, Texture* texture);
+
+    /**
+     * @brief Sets the number of threads recording the command buffers of a frame along with the GL thread. The renderables of a frame are split
+     * into chunks of at least MIN_RECORD_CHUNK_RENDERABLES, and the commands of every camera and chunk are recorded into a buffer of their own,
+     * which are then executed in order on the GL thread. With 0 threads, which is the default, everything is recorded on the thread building
+     * the frame.
+     * @param threads Number of recording threads
+     */
+    void setRecordThreads(unsigned int threads);
+
+    /**
+     * @brief Gets the number of threads recording command buffers along with the GL thread
+     * @return number of recording threads
+     */
+    unsigned int recordThreads();
+
+    /**
+     * @brief Gets the counters of the last frame executed
+     * @return counters of the last frame
+     */
+    RendererStats getStats();
+
+    /**
+     * @brief Gets the profiler timing the frames of the renderer on the GPU, per camera and pass. Only to be used on the GL thread, through
+     * Engine::runOnGLThread() while the engine has a render thread.
+     * @return GPU profiler
+     */
+    GpuProfiler* gpuProfiler();
 };
 
 #endif // RENDERER_H
@@ -0,0 +1,68 @@
+#include "rendertarget.h"
+
+#include <cassert>
+
+RenderTarget::RenderTarget(int width, int height) : framebuffer_(0), color_buffer_(0), depth_buffer_(0), width_(width), height_(height){
+    assert(width > 0 && height > 0);
+
+    glGenFramebuffers(1, &framebuffer_);
+    glGenRenderbuffers(1, &color_buffer_);
+    glGenRenderbuffers(1, &depth_buffer_);
+
+    try{
+        allocate();
+    }
+    catch(...){
+        glDeleteRenderbuffers(1, &depth_buffer_);
+        glDeleteRenderbuffers(1, &color_buffer_);
+        glDeleteFramebuffers(1, &framebuffer_);
+        throw;
+    }
+}
+
+RenderTarget::~RenderTarget(){
+    glDeleteRenderbuffers(1, &depth_buffer_);
+    glDeleteRenderbuffers(1, &color_buffer_);
+    glDeleteFramebuffers(1, &framebuffer_);
+}
+
+void RenderTarget::allocate(){
+    glBindRenderbuffer(GL_RENDERBUFFER, color_buffer_);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width_, height_);
+
+    glBindRenderbuffer(GL_RENDERBUFFER, depth_buffer_);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width_, height_);
+
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color_buffer_);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depth_buffer_);
+
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    if(status != GL_FRAMEBUFFER_COMPLETE){
+        throw RenderTargetError("framebuffer of " + std::to_string(width_) + "x" + std::to_string(height_) + " is incomplete, status " +
+                                std::to_string(status));
+    }
+}
+
+void RenderTarget::bind(){
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+}
+
+void RenderTarget::resize(int width, int height){
+    assert(width > 0 && height > 0);
+
+    width_ = width;
+    height_ = height;
+
+    allocate();
+}
+
+GLuint RenderTarget::getFramebuffer(){
+    return framebuffer_;
+}
+
+std::pair<int, int> RenderTarget::getResolution(){
+    return std::make_pair(width_, height_);
+}
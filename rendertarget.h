@@ -0,0 +1,78 @@
+#ifndef RENDERTARGET_H
+#define RENDERTARGET_H
+
+#include "common.h"
+
+#include <exception>
+#include <string>
+#include <utility>
+
+class RenderTargetError : public std::exception{
+private:
+    std::string error_log_;
+
+public:
+    RenderTargetError(std::string log){
+        error_log_ = log;
+    }
+
+    virtual const char* what() const throw(){
+        return error_log_.c_str();
+    }
+};
+
+/**
+ * @brief The RenderTarget class is an offscreen framebuffer with an RGBA8 color and a 24 bit depth, 8 bit stencil renderbuffer, which frames
+ * can be rendered into instead of a window, such as when running headless.
+ */
+class RenderTarget
+{
+private:
+    GLuint framebuffer_;
+    GLuint color_buffer_;
+    GLuint depth_buffer_;
+
+    int width_;
+    int height_;
+
+private:
+    //(re)allocates the renderbuffers at the current size, and checks that the framebuffer is complete
+    void allocate();
+
+public:
+    /**
+     * @brief Creates the framebuffer, which needs a current GL context. Throws RenderTargetError if the framebuffer is not complete.
+     * @param width Width in pixels
+     * @param height Height in pixels
+     */
+    RenderTarget(int width, int height);
+    RenderTarget(const RenderTarget& other) = delete;
+    RenderTarget& operator = (const RenderTarget& other) = delete;
+    ~RenderTarget();
+
+    /**
+     * @brief Binds the framebuffer for both drawing and reading
+     */
+    void bind();
+
+    /**
+     * @brief Resizes the renderbuffers, discarding their contents. Throws RenderTargetError if the framebuffer is not complete.
+     * @param width Width in pixels
+     * @param height Height in pixels
+     */
+    void resize(int width, int height);
+
+    /**
+     * @brief Gets the GL name of the framebuffer
+     * @return name of the framebuffer
+     */
+    GLuint getFramebuffer();
+
+    /**
+     * @brief Gets the size of the target
+     * @return a pair containing the width and height in pixels
+     */
+    std::pair<int, int> getResolution();
+};
+
+#endif // RENDERTARGET_H
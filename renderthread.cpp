@@ -0,0 +1,149 @@
+#include "renderthread.h"
+#include "renderer.h"
+#include "window.h"
+#include "resourcemanager.h"
+#include "enginestats.h"
+#include "profiler.h"
+
+#include <cassert>
+#include <chrono>
+
+RenderThread::RenderThread(Window* window, unsigned int max_frames_in_flight) : window_(window), max_frames_in_flight_(max_frames_in_flight),
+                                                                                frames_in_flight_(0), gl_tasks_submitted_(0), gl_tasks_run_(0),
+                                                                                main_lock_(engine_mutex_), render_waiting_(true), render_idle_(false),
+                                                                                stopping_(false){
+    assert(max_frames_in_flight_ > 0);
+
+    for(unsigned int i = 0; i <= max_frames_in_flight_; ++i){
+        packets_.push_back(std::unique_ptr<FramePacket>(new FramePacket()));
+        free_packets_.push_back(packets_.back().get());
+    }
+
+    //a context can only be current on one thread at a time
+    window_->releaseCurrent();
+
+    thread_ = std::thread(&RenderThread::renderLoop, this);
+}
+
+RenderThread::~RenderThread(){
+    stopping_ = true;
+    condition_.notify_all();
+    main_lock_.unlock();
+
+    thread_.join();
+
+    window_->makeCurrent();
+}
+
+void RenderThread::renderLoop(){
+    PROFILE_THREAD("Render");
+
+    window_->makeCurrent();
+
+    std::unique_lock<std::mutex> lock(engine_mutex_);
+    render_waiting_ = false;
+
+    while(true){
+        render_idle_ = true;
+        condition_.wait(lock, [this](){return stopping_ || !gl_tasks_.empty() || !queued_packets_.empty();});
+        render_idle_ = false;
+
+        runGLTasks();
+
+        if(queued_packets_.empty()){
+            if(stopping_){
+                break;
+            }
+
+            continue;
+        }
+
+        FramePacket* packet = queued_packets_.front();
+        queued_packets_.pop_front();
+
+        //steps once per frame rendered rather than built, so that resources freed by the main thread outlive the frames in flight using them
+        ResourceManager::resourceManager()->frame();
+
+        if(packet != nullptr){
+            Renderer::renderer()->prepareFrame(*packet);
+        }
+
+        lock.unlock();
+        condition_.notify_all();
+
+        if(packet != nullptr){
+            window_->renderFrame(*packet);
+
+            auto latency = std::chrono::steady_clock::now() - packet->input_time;
+            EngineStats::set(COUNTER_INPUT_LATENCY_US, std::chrono::duration_cast<std::chrono::microseconds>(latency).count());
+        }
+
+        render_waiting_ = true;
+        lock.lock();
+        render_waiting_ = false;
+
+        frames_in_flight_--;
+        if(packet != nullptr){
+            free_packets_.push_back(packet);
+        }
+
+        condition_.notify_all();
+    }
+
+    window_->releaseCurrent();
+}
+
+void RenderThread::runGLTasks(){
+    if(gl_tasks_.empty()){
+        return;
+    }
+
+    while(!gl_tasks_.empty()){
+        std::function<void()> task = std::move(gl_tasks_.front());
+        gl_tasks_.pop_front();
+
+        task();
+        gl_tasks_run_++;
+    }
+
+    condition_.notify_all();
+}
+
+FramePacket* RenderThread::acquirePacket(){
+    assert(!free_packets_.empty());
+
+    FramePacket* packet = free_packets_.back();
+    free_packets_.pop_back();
+
+    return packet;
+}
+
+void RenderThread::submit(FramePacket* packet){
+    PROFILE_ZONE("Wait for render thread");
+
+    queued_packets_.push_back(packet);
+    frames_in_flight_++;
+    condition_.notify_all();
+
+    //the render thread can only take frames while the main thread waits, so the lock is given up whenever it wants it, even if there is room
+    //for more frames
+    condition_.wait(main_lock_, [this](){
+        return frames_in_flight_ <= max_frames_in_flight_ && !render_waiting_ && (!render_idle_ || queued_packets_.empty());
+    });
+}
+
+void RenderThread::releasePacket(FramePacket* packet){
+    free_packets_.push_back(packet);
+}
+
+void RenderThread::runOnGLThread(std::function<void()> task){
+    gl_tasks_.push_back(std::move(task));
+    std::uint64_t id = ++gl_tasks_submitted_;
+    condition_.notify_all();
+
+    condition_.wait(main_lock_, [this, id](){return gl_tasks_run_ >= id;});
+}
+
+unsigned int RenderThread::maxFramesInFlight(){
+    return max_frames_in_flight_;
+}
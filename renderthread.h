@@ -0,0 +1,109 @@
+#ifndef RENDERTHREAD_H
+#define RENDERTHREAD_H
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+class Window;
+struct FramePacket;
+
+/**
+ * @brief The RenderThread class executes the frames built on the main thread on a thread of its own, which owns the GL context, so that the main
+ * thread can build the next frame while the last one is being rendered. Frames are handed over as FramePackets, of which a bounded number may be
+ * in flight, submitted but not yet presented, which bounds the latency the pipelining adds.
+ *
+ * The main thread holds the engine lock whenever it runs, and only gives it up while waiting in submit() or runOnGLThread(). The render thread
+ * steps the resource manager, uploads the meshes and textures of a frame and runs GL tasks with the lock held, so that none of it races the main
+ * thread, and executes the commands of the frame without it, which is the part overlapping the main thread. Executing touches no state the main
+ * thread may change, materials bind the texture names resolved while the frame was prepared.
+ */
+class RenderThread
+{
+private:
+    Window* window_;
+    unsigned int max_frames_in_flight_;
+
+    //one packet more than may be in flight, for the frame being built
+    std::vector<std::unique_ptr<FramePacket> > packets_;
+    std::vector<FramePacket*> free_packets_;
+    //nullptr for frames with nothing to render, which still step the resource manager
+    std::deque<FramePacket*> queued_packets_;
+    unsigned int frames_in_flight_;
+
+    std::deque<std::function<void()> > gl_tasks_;
+    std::uint64_t gl_tasks_submitted_;
+    std::uint64_t gl_tasks_run_;
+
+    std::mutex engine_mutex_;
+    //held by the main thread from construction until destruction, other than while it waits
+    std::unique_lock<std::mutex> main_lock_;
+    std::condition_variable condition_;
+    //set while the render thread waits on the engine lock, so that the main thread gives it up at its next submit
+    std::atomic<bool> render_waiting_;
+    //set while the render thread waits for frames or tasks
+    bool render_idle_;
+    bool stopping_;
+
+    std::thread thread_;
+
+private:
+    //main loop of the render thread, renders frames until the thread is stopped and the queue is empty
+    void renderLoop();
+
+    //runs the queued GL tasks, with the engine lock held
+    void runGLTasks();
+
+public:
+    /**
+     * @brief Starts the render thread, handing the GL context of \p window over to it. Must be called on the thread the context is current on.
+     * @param window Window the frames are rendered to
+     * @param max_frames_in_flight Number of frames which may be submitted but not yet presented, at least 1
+     */
+    RenderThread(Window* window, unsigned int max_frames_in_flight);
+    RenderThread(const RenderThread& other) = delete;
+    RenderThread& operator = (const RenderThread& other) = delete;
+
+    /**
+     * @brief Renders the frames still queued, stops the render thread and makes the GL context current on the calling thread again
+     */
+    ~RenderThread();
+
+    /**
+     * @brief Takes a packet for the main thread to build the next frame into. One is always free after submit() returns.
+     * @return the packet
+     */
+    FramePacket* acquirePacket();
+
+    /**
+     * @brief Hands a frame over to the render thread, and waits until no more than the maximum number of frames are in flight
+     * @param packet Packet taken with acquirePacket(), or nullptr for a frame with nothing to render
+     */
+    void submit(FramePacket* packet);
+
+    /**
+     * @brief Returns a packet taken with acquirePacket() which was not submitted
+     * @param packet The packet
+     */
+    void releasePacket(FramePacket* packet);
+
+    /**
+     * @brief Runs \p task on the render thread, and waits for it to finish. Tasks run between frames, in submission order.
+     * @param task Task to run, which may make GL calls
+     */
+    void runOnGLThread(std::function<void()> task);
+
+    /**
+     * @brief Gets the number of frames which may be submitted but not yet presented
+     * @return maximum frames in flight
+     */
+    unsigned int maxFramesInFlight();
+};
+
+#endif // RENDERTHREAD_H
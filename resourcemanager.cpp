@@ -1,7 +1,25 @@
 #include "resourcemanager.h"
+#include "profiler.h"
+#include "enginestats.h"
+
+#include <limits>
 
 std::unique_ptr<ResourceManager> ResourceManager::resource_manager_ = nullptr;
 
+//reads the entire file into contents, returns false if the file could not be opened
+bool readFile(const std::string& filename, std::string& contents){
+    std::ifstream file(filename);
+    if(!file.is_open()){
+        return false;
+    }
+
+    std::stringstream stream;
+    stream << file.rdbuf();
+    contents = stream.str();
+
+    return true;
+}
+
 ResourceManager* ResourceManager::resourceManager(){
     return ResourceManager::resource_manager_.get();
 }
@@ -26,168 +44,675 @@ bool ResourceManager::shutdown(){
     return true;
 }
 
-ResourceManager::ResourceManager() : mesh_id_counter_(0), shader_id_counter_(0){
-
+ResourceManager::ResourceManager() : shader_cache_(new ShaderCache()), frame_(0), upload_budget_ms_(2.f), async_loader_(new AsyncLoader()){
+    //the texture manager is declared first, so it is destroyed after the workers filling its pixel buffers are joined
+    texture_manager_ = std::unique_ptr<TextureManager>(new TextureManager(async_loader_.get()));
 }
 
 ResourceManager::~ResourceManager(){
 
 }
 
+void ResourceManager::frame(){
+    PROFILE_ZONE("Resources");
+
+    reloadChangedFiles();
+    finishPendingShaders();
+    async_loader_->processGLTasks(upload_budget_ms_);
+    texture_manager_->frame();
+
+    while(!freed_resources_.empty() && freed_resources_.front().first + RESOURCE_FREE_DELAY_FRAMES <= frame_){
+        freed_resources_.pop_front();
+    }
+
+    EngineStats::set(COUNTER_MESHES, (std::int64_t)meshes_.size());
+    EngineStats::set(COUNTER_SHADERS, (std::int64_t)shaders_.size());
+
+    frame_++;
+}
+
+void ResourceManager::deferFree(std::shared_ptr<void> resource){
+    freed_resources_.push_back(std::make_pair(frame_, std::move(resource)));
+}
+
+TextureManager* ResourceManager::textureManager(){
+    return texture_manager_.get();
+}
+
+ShaderCache* ResourceManager::shaderCache(){
+    return shader_cache_.get();
+}
+
+std::shared_future<Texture*> ResourceManager::createTextureAsync(const std::string& lexical_name, TextureLoadFunction loader, TextureOptions options){
+    auto promise = std::make_shared<std::promise<Texture*> >();
+    std::shared_future<Texture*> future = promise->get_future().share();
+
+    async_loader_->submit([this, promise, loader, lexical_name, options](){
+        auto data = std::make_shared<ProcessedTexture>();
+
+        if(!loader(*data) || data->levels.empty()){
+            std::cerr << "Error: unable to load texture data for texture " << lexical_name << std::endl;
+            promise->set_value(nullptr);
+            return;
+        }
+
+        async_loader_->submitGL([this, promise, data, lexical_name, options](){
+            Texture* texture = nullptr;
+
+            //streamed textures upload their levels on demand, everything else goes through the pixel buffers of the uploader
+            if(options.stream_mips){
+                texture = texture_manager_->createTexture(lexical_name, std::move(*data), options);
+            }
+            else{
+                texture = texture_manager_->createTextureAsync(lexical_name, processedTextureLayout(*data), processedTextureFill(data), options);
+            }
+
+            if(texture != nullptr){
+                texture->getTextureName();
+            }
+
+            promise->set_value(texture);
+        });
+    });
+
+    return future;
+}
+
+void ResourceManager::setUploadBudget(float milliseconds){
+    upload_budget_ms_ = milliseconds;
+}
+
+AsyncLoader* ResourceManager::asyncLoader(){
+    return async_loader_.get();
+}
+
 Mesh* ResourceManager::createMesh(const std::string& lexical_name, std::unique_ptr<std::vector<VertexData> >&& vertices, std::unique_ptr<std::vector<GLuint> >&& indices,
-                              MeshCacheOption cache_options){
-    if(mesh_lexical_names_.find(lexical_name) != mesh_lexical_names_.end()){
+                              MeshCacheOption cache_options, MeshUsageOption usage_option){
+    if(mesh_lexical_names_.find(StringId(lexical_name)) != mesh_lexical_names_.end()){
         std::cerr << "Error: Mesh lexical names must not be duplicate" << std::endl;
 
         return nullptr;
     }
 
-    std::uint32_t mesh_id = mesh_id_counter_++;
+    MeshHandle handle = meshes_.nextHandle();
 
-    meshes_[mesh_id] = std::unique_ptr<Mesh>(new Mesh(lexical_name, mesh_id, cache_options));
+    std::unique_ptr<Mesh> mesh(new Mesh(lexical_name, handle.index, cache_options, usage_option));
+    mesh->generation_ = handle.generation;
 
     if(vertices != nullptr && indices != nullptr){
-        meshes_[mesh_id]->setMeshData(std::move(vertices), std::move(indices));
+        mesh->setMeshData(std::move(vertices), std::move(indices));
     }
 
-    mesh_lexical_names_[lexical_name] = mesh_id;
+    meshes_.insert(std::move(mesh));
+    mesh_lexical_names_[StringId(lexical_name)] = handle;
 
-    return meshes_[mesh_id].get();
+    return meshes_.get(handle);
 }
 
-Mesh* ResourceManager::getMesh(const std::uint32_t& id){
-    if(meshes_.find(id) != meshes_.end()){
-        return meshes_[id].get();
+Mesh* ResourceManager::createMeshFromFile(const std::string& lexical_name, const std::string& filename){
+    static_assert(sizeof(VertexData) == MESH_FILE_VERTEX_FLOATS * sizeof(float), "VertexData does not match the vertex layout of mesh files");
+    static_assert(sizeof(GLuint) == sizeof(std::uint32_t), "GLuint does not match the index type of mesh files");
+
+    MappedMeshFile file;
+    if(!file.open(filename)){
+        std::cerr << "Error: unable to load mesh file " << filename << std::endl;
+        return nullptr;
     }
-    else{
+
+    Mesh* mesh = createMesh(lexical_name);
+    if(mesh == nullptr){
         return nullptr;
     }
+
+    const MeshFileHeader* header = file.header();
+
+    mesh->initializeBuffers((const VertexData*)file.vertices(), (size_t)header->vertex_count, (const GLuint*)file.indices(), (size_t)header->index_count);
+
+    for(int axis = 0; axis < 3; ++axis){
+        mesh->bounds_.min[axis] = header->bounds_min[axis];
+        mesh->bounds_.max[axis] = header->bounds_max[axis];
+    }
+
+    const MeshFileLOD* lods = file.lods();
+    for(std::uint32_t i = 0; i < header->lod_count; ++i){
+        mesh->lods_.push_back(MeshLOD{(size_t)lods[i].first_index, (size_t)lods[i].index_count});
+    }
+
+    if(mesh->lods_.empty()){
+        mesh->lods_.push_back(MeshLOD{0, mesh->num_indices_});
+    }
+
+    return mesh;
+}
+
+std::shared_future<Mesh*> ResourceManager::createMeshAsync(const std::string& lexical_name, MeshLoadFunction loader, MeshCacheOption cache_options,
+                                                           MeshUsageOption usage_option){
+    auto promise = std::make_shared<std::promise<Mesh*> >();
+    std::shared_future<Mesh*> future = promise->get_future().share();
+
+    async_loader_->submit([this, promise, loader, lexical_name, cache_options, usage_option](){
+        auto vertices = std::make_shared<std::vector<VertexData> >();
+        auto indices = std::make_shared<std::vector<GLuint> >();
+
+        if(!loader(*vertices, *indices) || vertices->empty() || indices->empty()){
+            std::cerr << "Error: unable to load mesh data for mesh " << lexical_name << std::endl;
+            promise->set_value(nullptr);
+            return;
+        }
+
+        async_loader_->submitGL([this, promise, vertices, indices, lexical_name, cache_options, usage_option](){
+            std::unique_ptr<std::vector<VertexData> > vertex_data(new std::vector<VertexData>(std::move(*vertices)));
+            std::unique_ptr<std::vector<GLuint> > index_data(new std::vector<GLuint>(std::move(*indices)));
+
+            Mesh* mesh = createMesh(lexical_name, std::move(vertex_data), std::move(index_data), cache_options, usage_option);
+            if(mesh != nullptr){
+                mesh->getVBO();
+            }
+
+            promise->set_value(mesh);
+        });
+    });
+
+    return future;
+}
+
+Mesh* ResourceManager::getMesh(const std::uint64_t& id){
+    return meshes_.get(MeshHandle::unpack(id));
+}
+
+Mesh* ResourceManager::getMesh(MeshHandle handle){
+    return meshes_.get(handle);
 }
 
 Mesh* ResourceManager::getMesh(const std::string& lexical_name){
-    if(mesh_lexical_names_.find(lexical_name) != mesh_lexical_names_.end()){
-        std::uint32_t id = mesh_lexical_names_[lexical_name];
-        return meshes_[id].get();
+    return getMesh(lexical_name.c_str());
+}
+
+Mesh* ResourceManager::getMesh(const char* lexical_name){
+    Mesh* mesh = getMesh(StringId(lexical_name));
+
+    //names are keyed by their hash alone, so a name hashing the same as that of another mesh would find it
+    if(mesh != nullptr && mesh->getLexicalName() != lexical_name){
+        return nullptr;
+    }
+
+    return mesh;
+}
+
+Mesh* ResourceManager::getMesh(StringId lexical_name){
+    auto iter = mesh_lexical_names_.find(lexical_name);
+    if(iter != mesh_lexical_names_.end()){
+        return meshes_.get(iter->second);
     }
     else{
         return nullptr;
     }
 }
 
-bool ResourceManager::freeMesh(const std::uint32_t& id){
-    if(meshes_.find(id) != meshes_.end()){
-        std::string lexical_name = meshes_[id]->getLexicalName();
-
-        meshes_.erase(id);
-        mesh_lexical_names_.erase(lexical_name);
+bool ResourceManager::freeMesh(const std::uint64_t& id){
+    return freeMesh(MeshHandle::unpack(id));
+}
 
-        return true;
-    }
-    else{
+bool ResourceManager::freeMesh(MeshHandle handle){
+    std::unique_ptr<Mesh> mesh = meshes_.remove(handle);
+    if(mesh == nullptr){
         return false;
     }
+
+    mesh_lexical_names_.erase(mesh->getNameId());
+    forgetVertexArrays(std::numeric_limits<std::uint32_t>::max(), handle.index);
+
+    deferFree(std::shared_ptr<Mesh>(std::move(mesh)));
+
+    return true;
 }
 
 Shader* ResourceManager::createShader(const std::string& lexical_name, const std::string& vs, const std::string& fs, ShaderDataType data_type){
-    if(shader_lexical_names_.find(lexical_name) != shader_lexical_names_.end()){
+    if(shader_lexical_names_.find(StringId(lexical_name)) != shader_lexical_names_.end()){
         std::cerr << "Error: Shader lexical names must not be duplicate" << std::endl;
         return nullptr;
     }
-    std::uint32_t id = shader_id_counter_++;
 
     if(data_type == SHADER_FILE){
-        std::ifstream vs_file(vs);
-        if(!vs_file.is_open()){
+        std::string vs_dat;
+        if(!readFile(vs, vs_dat)){
             std::cerr << "Error: unable to find vertex shader file" << std::endl;
             return nullptr;
         }
 
-        std::stringstream vs_stream;
-        vs_stream << vs_file.rdbuf();
-        std::string vs_dat = vs_stream.str();
-
-        std::ifstream fs_file(fs);
-        if(!fs_file.is_open()){
+        std::string fs_dat;
+        if(!readFile(fs, fs_dat)){
             std::cerr << "Error: unable to find fragment shader file" << std::endl;
             return nullptr;
         }
 
-        std::stringstream fs_stream;
-        fs_stream << fs_file.rdbuf();
-        std::string fs_dat = vs_stream.str();
+        Shader* shader = createShader(lexical_name, vs_dat, fs_dat, SHADER_RAW);
+        if(shader != nullptr){
+            addShaderFiles(shader, vs, fs);
+        }
 
-        std::unique_ptr<Shader> shader;
-        try{
-            shader = std::unique_ptr<Shader>(new Shader(lexical_name, id, vs_dat, fs_dat));
+        return shader;
+    }
+
+    std::unique_ptr<Shader> shader = beginShader(lexical_name, vs, fs);
+    if(shader == nullptr){
+        return nullptr;
+    }
+
+    return finishShader(std::move(shader));
+}
+
+std::unique_ptr<Shader> ResourceManager::beginShader(const std::string& lexical_name, const std::string& vs, const std::string& fs){
+    if(shader_lexical_names_.find(StringId(lexical_name)) != shader_lexical_names_.end()){
+        std::cerr << "Error: Shader lexical names must not be duplicate" << std::endl;
+        return nullptr;
+    }
+
+    //several shaders may be compiling at once, so the slot of the shader is only taken once it is finished
+    std::unique_ptr<Shader> shader(new Shader(lexical_name, 0));
+    shader->beginCompile(vs, fs, shader_cache_.get());
+
+    return shader;
+}
+
+Shader* ResourceManager::finishShader(std::unique_ptr<Shader>&& shader){
+    try{
+        shader->finishCompile();
+    }
+    catch(ShaderCompileError e){
+        std::cerr << "Error: " << e.what() << std::endl;
+        return nullptr;
+    }
+
+    StringId name_id = shader->getNameId();
+    if(shader_lexical_names_.find(name_id) != shader_lexical_names_.end()){
+        std::cerr << "Error: Shader lexical names must not be duplicate" << std::endl;
+        return nullptr;
+    }
+
+    ShaderHandle handle = shaders_.nextHandle();
+    shader->id_ = handle.index;
+    shader->generation_ = handle.generation;
+
+    shaders_.insert(std::move(shader));
+    shader_lexical_names_[name_id] = handle;
+
+    return shaders_.get(handle);
+}
+
+std::vector<Shader*> ResourceManager::createShaders(const std::vector<ShaderSource>& sources){
+    std::vector<Shader*> created(sources.size(), nullptr);
+    std::vector<std::pair<size_t, std::unique_ptr<Shader> > > pending;
+
+    //submit every program before finishing any, so that the driver works on all of them at once
+    for(size_t i = 0; i < sources.size(); ++i){
+        const ShaderSource& source = sources[i];
+
+        std::string vs_dat, fs_dat;
+        if(source.data_type == SHADER_FILE && (!readFile(source.vs, vs_dat) || !readFile(source.fs, fs_dat))){
+            std::cerr << "Error: unable to find shader files for shader " << source.lexical_name << std::endl;
+            continue;
         }
-        catch(ShaderCompileError e){
-            std::cerr << "Error: " << e.what() << std::endl;
-            return nullptr;
+
+        bool from_file = source.data_type == SHADER_FILE;
+        std::unique_ptr<Shader> shader = beginShader(source.lexical_name, from_file ? vs_dat : source.vs, from_file ? fs_dat : source.fs);
+
+        if(shader != nullptr){
+            pending.push_back(std::make_pair(i, std::move(shader)));
         }
+    }
+
+    while(!pending.empty()){
+        bool finished = false;
 
-        shaders_[id] = std::move(shader);
+        for(size_t i = 0; i < pending.size();){
+            if(!pending[i].second->isCompileComplete()){
+                ++i;
+                continue;
+            }
+
+            const ShaderSource& source = sources[pending[i].first];
+
+            Shader* shader = finishShader(std::move(pending[i].second));
+            if(shader != nullptr && source.data_type == SHADER_FILE){
+                addShaderFiles(shader, source.vs, source.fs);
+            }
+
+            created[pending[i].first] = shader;
+            pending.erase(pending.begin() + i);
+            finished = true;
+        }
+
+        if(!finished){
+            std::this_thread::yield();
+        }
     }
-    else{
-        std::unique_ptr<Shader> shader;
+
+    return created;
+}
+
+void ResourceManager::finishPendingShaders(){
+    for(size_t i = 0; i < pending_shaders_.size();){
+        if(!pending_shaders_[i].shader->isCompileComplete()){
+            ++i;
+            continue;
+        }
+
+        PendingShader& pending = pending_shaders_[i];
+
+        Shader* shader = finishShader(std::move(pending.shader));
+        if(shader != nullptr && !pending.vs_file.empty()){
+            addShaderFiles(shader, pending.vs_file, pending.fs_file);
+        }
+
+        pending.promise->set_value(shader);
+        pending_shaders_.erase(pending_shaders_.begin() + i);
+    }
+
+    for(size_t i = 0; i < pending_reloads_.size();){
+        if(!pending_reloads_[i]->isCompileComplete()){
+            ++i;
+            continue;
+        }
+
+        std::unique_ptr<Shader> reloaded = std::move(pending_reloads_[i]);
+        pending_reloads_.erase(pending_reloads_.begin() + i);
+
         try{
-            shader = std::unique_ptr<Shader>(new Shader(lexical_name, id, vs, fs));
+            reloaded->finishCompile();
         }
         catch(ShaderCompileError e){
-            std::cerr << "Error: " << e.what() << std::endl;
-            return nullptr;
+            std::cerr << "Error: unable to reload shader " << reloaded->getLexicalName() << ", keeping the previous program: " << e.what() << std::endl;
+            continue;
+        }
+
+        //the shader may have been freed while its program was compiling, in which case the handle no longer refers to it
+        Shader* shader = getShader(reloaded->getHandle());
+        if(shader == nullptr){
+            continue;
         }
 
-        shaders_[id] = std::move(shader);
+        shader->swapProgram(*reloaded);
+
+        //attributes new to the program are missing from the existing vaos, renderables created from here on get vaos of their own
+        forgetVertexArrays(shader->getHandle().index, std::numeric_limits<std::uint32_t>::max());
+
+        //reloaded now holds the previous program, which frames in flight on the render thread may still use
+        deferFree(std::shared_ptr<Shader>(std::move(reloaded)));
     }
+}
+
+void ResourceManager::addShaderFiles(Shader* shader, const std::string& vs, const std::string& fs){
+    std::uint32_t index = shader->getHandle().index;
+    shader_files_[index] = std::make_pair(vs, fs);
 
-    shader_lexical_names_[lexical_name] = id;
+    for(const std::string& file : {vs, fs}){
+        std::vector<std::uint32_t>& shaders = file_shaders_[file];
+        if(std::find(shaders.begin(), shaders.end(), index) == shaders.end()){
+            shaders.push_back(index);
+        }
+
+        if(file_watcher_ != nullptr){
+            file_watcher_->watch(file);
+        }
+    }
 }
 
-Shader* ResourceManager::getShader(const std::uint32_t& id){
-    if(shaders_.find(id) != shaders_.end()){
-        return shaders_[id].get();
+bool ResourceManager::enableHotReload(){
+    if(file_watcher_ == nullptr){
+        file_watcher_ = std::unique_ptr<FileWatcher>(new FileWatcher());
+
+        for(auto& files : file_shaders_){
+            file_watcher_->watch(files.first);
+        }
     }
-    else{
+
+    return file_watcher_->isSupported();
+}
+
+void ResourceManager::reloadChangedFiles(){
+    if(file_watcher_ == nullptr){
+        return;
+    }
+
+    std::vector<std::string> changed = file_watcher_->changedFiles();
+    if(changed.empty()){
+        return;
+    }
+
+    //a shader whose vertex and fragment files both changed is only reloaded once
+    std::vector<std::uint32_t> reload;
+    for(auto& file : changed){
+        auto iter = file_shaders_.find(file);
+        if(iter == file_shaders_.end()){
+            continue;
+        }
+
+        for(std::uint32_t id : iter->second){
+            if(std::find(reload.begin(), reload.end(), id) == reload.end()){
+                reload.push_back(id);
+            }
+        }
+    }
+
+    for(std::uint32_t id : reload){
+        reloadShader(shaders_.handleAt(id));
+    }
+}
+
+void ResourceManager::reloadShader(ShaderHandle handle){
+    auto files = shader_files_[handle.index];
+    std::string lexical_name = getShader(handle)->getLexicalName();
+
+    async_loader_->submit([this, handle, files, lexical_name](){
+        auto sources = std::make_shared<std::pair<std::string, std::string> >();
+
+        if(!readFile(files.first, sources->first) || !readFile(files.second, sources->second)){
+            std::cerr << "Error: unable to read shader files for reloading shader " << lexical_name << std::endl;
+            return;
+        }
+
+        async_loader_->submitGL([this, handle, sources, lexical_name](){
+            Shader* previous = getShader(handle);
+            if(previous == nullptr){
+                return;
+            }
+
+            //the attributes keep their locations, so that the vaos of renderables using the shader stay valid. Binaries from the cache keep the
+            //locations they were linked with instead, so the cache is not used
+            std::unique_ptr<Shader> shader(new Shader(lexical_name, handle.index));
+            shader->generation_ = handle.generation;
+            shader->beginCompile(sources->first, sources->second, nullptr, previous->getAttributes());
+
+            pending_reloads_.push_back(std::move(shader));
+        });
+    });
+}
+
+std::shared_future<Shader*> ResourceManager::createShaderAsync(const std::string& lexical_name, const std::string& vs, const std::string& fs, ShaderDataType data_type){
+    auto promise = std::make_shared<std::promise<Shader*> >();
+    std::shared_future<Shader*> future = promise->get_future().share();
+
+    auto sources = std::make_shared<std::pair<std::string, std::string> >(vs, fs);
+
+    //the files are kept to reload the shader from once they change
+    std::string vs_file = data_type == SHADER_FILE ? vs : "";
+    std::string fs_file = data_type == SHADER_FILE ? fs : "";
+
+    async_loader_->submit([this, promise, sources, lexical_name, data_type, vs_file, fs_file](){
+        if(data_type == SHADER_FILE){
+            std::string vs_dat, fs_dat;
+
+            if(!readFile(sources->first, vs_dat) || !readFile(sources->second, fs_dat)){
+                std::cerr << "Error: unable to find shader files for shader " << lexical_name << std::endl;
+                promise->set_value(nullptr);
+                return;
+            }
+
+            sources->first = std::move(vs_dat);
+            sources->second = std::move(fs_dat);
+        }
+
+        async_loader_->submitGL([this, promise, sources, lexical_name, vs_file, fs_file](){
+            std::unique_ptr<Shader> shader = beginShader(lexical_name, sources->first, sources->second);
+            if(shader == nullptr){
+                promise->set_value(nullptr);
+                return;
+            }
+
+            //finished during a later frame, once the driver is done with it
+            pending_shaders_.push_back(PendingShader{std::move(shader), promise, vs_file, fs_file});
+        });
+    });
+
+    return future;
+}
+
+ShaderPermutations* ResourceManager::createShaderPermutations(const std::string& lexical_name, const std::string& vs, const std::string& fs,
+                                                              ShaderDataType data_type){
+    if(shader_permutations_.find(StringId(lexical_name)) != shader_permutations_.end()){
+        std::cerr << "Error: Shader lexical names must not be duplicate" << std::endl;
+        return nullptr;
+    }
+
+    std::string vs_dat = vs;
+    std::string fs_dat = fs;
+    if(data_type == SHADER_FILE && (!readFile(vs, vs_dat) || !readFile(fs, fs_dat))){
+        std::cerr << "Error: unable to find shader files for shader " << lexical_name << std::endl;
+        return nullptr;
+    }
+
+    std::unique_ptr<ShaderPermutations> permutations;
+    try{
+        permutations = std::unique_ptr<ShaderPermutations>(new ShaderPermutations(this, lexical_name, vs_dat, fs_dat));
+    }
+    catch(ShaderCompileError e){
+        std::cerr << "Error: " << e.what() << std::endl;
         return nullptr;
     }
+
+    StringId name_id = StringId::intern(lexical_name);
+    shader_permutations_[name_id] = std::move(permutations);
+
+    return shader_permutations_[name_id].get();
 }
 
-Shader* ResourceManager::getShader(const std::string& lexical_name){
-    if(shader_lexical_names_.find(lexical_name) != shader_lexical_names_.end()){
-        std::uint32_t id = shader_lexical_names_[lexical_name];
+ShaderPermutations* ResourceManager::getShaderPermutations(const std::string& lexical_name){
+    return getShaderPermutations(StringId(lexical_name));
+}
 
-        return shaders_[id].get();
+ShaderPermutations* ResourceManager::getShaderPermutations(StringId lexical_name){
+    auto iter = shader_permutations_.find(lexical_name);
+    if(iter != shader_permutations_.end()){
+        return iter->second.get();
     }
     else{
         return nullptr;
     }
 }
 
-bool ResourceManager::freeShader(const std::uint32_t& id){
-    if(shaders_.find(id) != shaders_.end()){
-        std::string lexical_name = shaders_[id]->getLexicalName();
-        shader_lexical_names_.erase(lexical_name);
-        shaders_.erase(id);
-        return true;
+ShaderPermutationStats ResourceManager::getShaderPermutationStats(){
+    ShaderPermutationStats total;
+
+    for(auto& permutations : shader_permutations_){
+        ShaderPermutationStats stats = permutations.second->getStats();
+
+        total.variants += stats.variants;
+        total.hits += stats.hits;
+        total.misses += stats.misses;
+        total.compile_ms += stats.compile_ms;
+    }
+
+    return total;
+}
+
+Shader* ResourceManager::getShader(const std::uint64_t& id){
+    return shaders_.get(ShaderHandle::unpack(id));
+}
+
+Shader* ResourceManager::getShader(ShaderHandle handle){
+    return shaders_.get(handle);
+}
+
+Shader* ResourceManager::getShader(const std::string& lexical_name){
+    return getShader(lexical_name.c_str());
+}
+
+Shader* ResourceManager::getShader(const char* lexical_name){
+    Shader* shader = getShader(StringId(lexical_name));
+
+    //names are keyed by their hash alone, so a name hashing the same as that of another shader would find it
+    if(shader != nullptr && shader->getLexicalName() != lexical_name){
+        return nullptr;
+    }
+
+    return shader;
+}
+
+Shader* ResourceManager::getShader(StringId lexical_name){
+    auto iter = shader_lexical_names_.find(lexical_name);
+    if(iter != shader_lexical_names_.end()){
+        return shaders_.get(iter->second);
     }
     else{
+        return nullptr;
+    }
+}
+
+bool ResourceManager::freeShader(const std::uint64_t& id){
+    return freeShader(ShaderHandle::unpack(id));
+}
+
+bool ResourceManager::freeShader(ShaderHandle handle){
+    std::unique_ptr<Shader> shader = shaders_.remove(handle);
+    if(shader == nullptr){
         return false;
     }
+
+    std::uint32_t id = handle.index;
+    shader_lexical_names_.erase(shader->getNameId());
+
+    auto files = shader_files_.find(id);
+    if(files != shader_files_.end()){
+        for(const std::string& file : {files->second.first, files->second.second}){
+            std::vector<std::uint32_t>& shaders = file_shaders_[file];
+            shaders.erase(std::remove(shaders.begin(), shaders.end(), id), shaders.end());
+        }
+
+        shader_files_.erase(files);
+    }
+
+    forgetVertexArrays(id, std::numeric_limits<std::uint32_t>::max());
+    deferFree(std::shared_ptr<Shader>(std::move(shader)));
+
+    return true;
 }
 
 std::unique_ptr<Renderable> ResourceManager::createRenderable(std::unique_ptr<Material>&& mat, Mesh* mesh){
     assert(mat != nullptr && mesh != nullptr);
 
-    std::uint64_t shader_id = (std::uint64_t)mat->getShader()->getID();
-    std::uint64_t mesh_id = (std::uint64_t)mesh->getID();
+    Shader* shader = mat->getShader();
+    if(shader == nullptr){
+        std::cerr << "Error: the shader of material " << mat->getMaterialName() << " has been freed" << std::endl;
+        return nullptr;
+    }
+
+    //slot indices are enough, as the vaos of a mesh or shader are forgotten when it is freed
+    std::uint64_t shader_id = (std::uint64_t)shader->getHandle().index;
+    std::uint64_t mesh_id = (std::uint64_t)mesh->getHandle().index;
 
     std::uint64_t hash = (shader_id << 32) | mesh_id;
 
-    if(existing_vaos_.find(hash) != existing_vaos_.end()){
-        GLuint vao_name = existing_vaos_[hash];
+    auto existing = existing_vaos_.find(hash);
+    if(existing != existing_vaos_.end()){
+        VertexArrayHandle handle = existing->second;
+        VertexArray* vertex_array = vertex_arrays_.get(handle);
 
         try{
-            return std::unique_ptr<Renderable>(new Renderable(std::move(mat), mesh, vao_name));
+            std::unique_ptr<Renderable> renderable(new Renderable(std::move(mat), mesh, vertex_array->name, handle));
+            vertex_array->references++;
+
+            return renderable;
         }
         catch(RenderableError e){
             std::cerr << e.what() << std::endl;
@@ -198,7 +723,10 @@ std::unique_ptr<Renderable> ResourceManager::createRenderable(std::unique_ptr<Ma
 
     try{
         std::unique_ptr<Renderable> renderable(new Renderable(std::move(mat), mesh));
-        existing_vaos_[hash] = renderable->getVAOName();
+
+        VertexArrayHandle handle = vertex_arrays_.insert(std::unique_ptr<VertexArray>(new VertexArray(renderable->getVAOName(), hash)));
+        renderable->vao_handle_ = handle;
+        existing_vaos_[hash] = handle;
 
         return renderable;
     }
@@ -207,6 +735,37 @@ std::unique_ptr<Renderable> ResourceManager::createRenderable(std::unique_ptr<Ma
 
         return nullptr;
     }
+}
+
+void ResourceManager::acquireVertexArray(VertexArrayHandle handle){
+    VertexArray* vertex_array = vertex_arrays_.get(handle);
+    if(vertex_array != nullptr){
+        vertex_array->references++;
+    }
+}
 
+void ResourceManager::releaseVertexArray(VertexArrayHandle handle){
+    VertexArray* vertex_array = vertex_arrays_.get(handle);
+    if(vertex_array == nullptr || --vertex_array->references > 0){
+        return;
+    }
 
+    //the key may already have been taken over by a vao created after the mesh or shader of this one was freed
+    auto existing = existing_vaos_.find(vertex_array->key);
+    if(existing != existing_vaos_.end() && existing->second == handle){
+        existing_vaos_.erase(existing);
+    }
+
+    deferFree(std::shared_ptr<VertexArray>(vertex_arrays_.remove(handle)));
+}
+
+void ResourceManager::forgetVertexArrays(std::uint32_t shader_id, std::uint32_t mesh_id){
+    for(auto iter = existing_vaos_.begin(); iter != existing_vaos_.end();){
+        if((std::uint32_t)(iter->first >> 32) == shader_id || (std::uint32_t)iter->first == mesh_id){
+            iter = existing_vaos_.erase(iter);
+        }
+        else{
+            ++iter;
+        }
+    }
 }
@@ -6,27 +6,95 @@
 #include <fstream>
 #include <iostream>
 #include <sstream>
+#include <future>
+#include <functional>
+#include <thread>
+#include <algorithm>
+#include <deque>
 
 #include "mesh.h"
 #include "shader.h"
 #include "renderable.h"
+#include "asyncloader.h"
+#include "meshfile.h"
+#include "texturemanager.h"
+#include "shadercache.h"
+#include "shaderpermutations.h"
+#include "filewatcher.h"
 
 enum ShaderDataType{SHADER_FILE, SHADER_RAW};
 
+/**
+ * @brief The ShaderSource struct describes a shader created by ResourceManager::createShaders(), see createShader() for its members
+ */
+struct ShaderSource{
+    std::string lexical_name;
+    std::string vs;
+    std::string fs;
+    ShaderDataType data_type;
+};
+
+/**
+ * @brief Function used to produce the vertex and index data of an asynchronously created mesh. It is run on a worker thread, so it must not make any
+ * OpenGL calls. It should fill in the passed vectors and return true, or return false if the data could not be produced.
+ */
+typedef std::function<bool(std::vector<VertexData>& vertices, std::vector<GLuint>& indices)> MeshLoadFunction;
+
+/**
+ * @brief Function used to produce the data of an asynchronously created texture, for example by decoding an image and running processTexture() on it,
+ * or by reading a texture file. It is run on a worker thread, so it must not make any OpenGL calls. It should fill in the passed texture and return true,
+ * or return false if the data could not be produced.
+ */
+typedef std::function<bool(ProcessedTexture& texture)> TextureLoadFunction;
+
 class ResourceManager
 {
 friend std::unique_ptr<ResourceManager>::deleter_type;
 friend class Engine;
+friend class Renderable;
+friend class RenderThread;
 private:
-    std::uint32_t mesh_id_counter_;
-    std::unordered_map<std::uint32_t, std::unique_ptr<Mesh> > meshes_;
-    std::unordered_map<std::string, std::uint32_t> mesh_lexical_names_;
+    ResourcePool<Mesh> meshes_;
+    std::unordered_map<StringId, MeshHandle> mesh_lexical_names_;
+
+    ResourcePool<Shader> shaders_;
+    std::unordered_map<StringId, ShaderHandle> shader_lexical_names_;
+    std::unique_ptr<ShaderCache> shader_cache_;
+
+    //asynchronously created shaders whose programs have been submitted to the driver
+    struct PendingShader{
+        std::unique_ptr<Shader> shader;
+        std::shared_ptr<std::promise<Shader*> > promise;
+        //source files, empty if created from raw sources
+        std::string vs_file;
+        std::string fs_file;
+    };
+    std::vector<PendingShader> pending_shaders_;
+
+    //source files of the shaders created from files, and the shaders created from each file
+    std::unordered_map<std::uint32_t, std::pair<std::string, std::string> > shader_files_;
+    std::unordered_map<std::string, std::vector<std::uint32_t> > file_shaders_;
+    std::unique_ptr<FileWatcher> file_watcher_;
 
-    std::uint32_t shader_id_counter_;
-    std::unordered_map<std::uint32_t, std::unique_ptr<Shader> > shaders_;
-    std::unordered_map<std::string, std::uint32_t> shader_lexical_names_;
+    //reloaded programs being compiled, which are swapped into the shader with the same handle once finished
+    std::vector<std::unique_ptr<Shader> > pending_reloads_;
 
-    std::unordered_map<std::uint64_t, GLuint> existing_vaos_;
+    std::unordered_map<StringId, std::unique_ptr<ShaderPermutations> > shader_permutations_;
+
+    //vertex arrays shared by the renderables with the same shader and mesh, looked up by the slot indices of both
+    ResourcePool<VertexArray> vertex_arrays_;
+    std::unordered_map<std::uint64_t, VertexArrayHandle> existing_vaos_;
+
+    //freed resources, with the frame they were freed in, whose GL objects are deleted once no frame in flight may use them
+    std::deque<std::pair<std::uint64_t, std::shared_ptr<void> > > freed_resources_;
+    std::uint64_t frame_;
+
+    std::unique_ptr<TextureManager> texture_manager_;
+
+    float upload_budget_ms_;
+
+    //declared last so that it is destroyed first, joining the worker threads before the resources they might reference are freed
+    std::unique_ptr<AsyncLoader> async_loader_;
 
     static std::unique_ptr<ResourceManager> resource_manager_;
 
@@ -37,6 +105,39 @@ private:
     static bool initialize();
     static bool shutdown();
 
+    //runs the queued asynchronous GL work within the upload budget, called once per frame by the engine, or by the render thread when there is one
+    void frame();
+
+    //submits the compile of a shader, returns nullptr if its name is taken
+    std::unique_ptr<Shader> beginShader(const std::string& lexical_name, const std::string& vs, const std::string& fs);
+
+    //waits for a submitted shader and adds it to the manager, returns nullptr if it failed to compile
+    Shader* finishShader(std::unique_ptr<Shader>&& shader);
+
+    //keeps a freed resource alive for RESOURCE_FREE_DELAY_FRAMES frames
+    void deferFree(std::shared_ptr<void> resource);
+
+    //adds a reference to a vertex array, for a copied renderable
+    void acquireVertexArray(VertexArrayHandle handle);
+
+    //removes a reference to a vertex array, freeing it once no renderable uses it
+    void releaseVertexArray(VertexArrayHandle handle);
+
+    //forgets the vertex arrays of a freed mesh or shader, so that none are shared with whatever takes its slot
+    void forgetVertexArrays(std::uint32_t shader_id, std::uint32_t mesh_id);
+
+    //finishes the asynchronously created and reloaded shaders the driver is done with
+    void finishPendingShaders();
+
+    //records the source files of a shader, so that it can be reloaded when they change
+    void addShaderFiles(Shader* shader, const std::string& vs, const std::string& fs);
+
+    //starts reloading the shaders whose files changed since the last frame
+    void reloadChangedFiles();
+
+    //reads the files of a shader on a worker thread, and submits the compile of its new program on the GL thread
+    void reloadShader(ShaderHandle handle);
+
 public:
     static ResourceManager* resourceManager();
 
@@ -53,17 +154,46 @@ public:
      * @param vertices vertices of mesh, default value is nullptr
      * @param indices indices of mesh, default value is nullptr
      * @param cache_options caching options of mesh, can be either CACHE, or DELETE_ON_BUFFER_CREATION. Default value is DELETE_ON_BUFFER_CREATION.
+     * @param usage_option usage of the mesh, either STATIC_MESH, or DYNAMIC_MESH for meshes whose vertices are rewritten at runtime. Default value is STATIC_MESH.
      * @return a pointer to the created mesh. The ownership is still held by MeshManager
      */
     Mesh* createMesh(const std::string& lexical_name, std::unique_ptr<std::vector<VertexData> >&& vertices = nullptr, std::unique_ptr<std::vector<GLuint> >&& indices = nullptr,
-                     MeshCacheOption cache_options = DELETE_ON_BUFFER_CREATION);
+                     MeshCacheOption cache_options = DELETE_ON_BUFFER_CREATION, MeshUsageOption usage_option = STATIC_MESH);
+
+    /**
+     * @brief Creates a static mesh from a mesh file (see meshfile.h). The file is memory mapped and its vertex and index sections are uploaded to the GPU
+     * directly from the mapping, without any intermediate copies. No CPU copy of the data is kept.
+     * @param lexical_name The lexical name of the mesh. The same uniqueness rules as createMesh() apply.
+     * @param filename Name of the mesh file
+     * @return a pointer to the created mesh, or nullptr if the file could not be loaded
+     */
+    Mesh* createMeshFromFile(const std::string& lexical_name, const std::string& filename);
+
+    /**
+     * @brief Asynchronously creates a mesh. The mesh data is produced by \p loader on a worker thread, after which the mesh is created and its buffers are
+     * uploaded on the GL thread during a later frame, within the upload budget.
+     * @param lexical_name The lexical name of the mesh. The same uniqueness rules as createMesh() apply, and are checked once the data has been loaded.
+     * @param loader Function producing the vertex and index data of the mesh
+     * @param cache_options caching options of mesh. Default value is DELETE_ON_BUFFER_CREATION.
+     * @param usage_option usage of the mesh. Default value is STATIC_MESH.
+     * @return a future which holds an observer pointer to the created mesh once it is ready, or nullptr if it could not be created
+     */
+    std::shared_future<Mesh*> createMeshAsync(const std::string& lexical_name, MeshLoadFunction loader, MeshCacheOption cache_options = DELETE_ON_BUFFER_CREATION,
+                                              MeshUsageOption usage_option = STATIC_MESH);
 
     /**
      * @brief Gets the mesh with the specified /p id
      * @param id ID of the mesh to search for
-     * @return observer pointer to the mesh requested, or nullptr if not found
+     * @return observer pointer to the mesh requested, or nullptr if not found or freed
+     */
+    Mesh* getMesh(const std::uint64_t& id);
+
+    /**
+     * @brief Gets the mesh referred to by \p handle
+     * @param handle Handle of the mesh
+     * @return observer pointer to the mesh requested, or nullptr if it has been freed
      */
-    Mesh* getMesh(const std::uint32_t& id);
+    Mesh* getMesh(MeshHandle handle);
 
     /**
      * @brief Gets the mesh with the specified /p lexical_name
@@ -73,11 +203,34 @@ public:
     Mesh* getMesh(const std::string& lexical_name);
 
     /**
-     * @brief Deallocates mesh data of the mesh with specified /p id from both CPU and GPU.
+     * @brief Gets the mesh with the specified /p lexical_name, hashing the name without copying it into a string
+     * @param lexical_name Lexical name of the mesh
+     * @return observer pointer to the mesh requested, or nullptr if not found
+     */
+    Mesh* getMesh(const char* lexical_name);
+
+    /**
+     * @brief Gets the mesh with the specified /p lexical_name, without hashing the name, e.g. getMesh("cube"_sid). The id is not checked
+     * against the lexical name of the mesh found, see StringId::intern() for collisions between names
+     * @param lexical_name Id of the lexical name of the mesh
+     * @return observer pointer to the mesh requested, or nullptr if not found
+     */
+    Mesh* getMesh(StringId lexical_name);
+
+    /**
+     * @brief Deallocates mesh data of the mesh with specified /p id from both CPU and GPU. The mesh is removed immediately, but its buffers are only
+     * deleted RESOURCE_FREE_DELAY_FRAMES frames later, once no frame in flight may still use them.
      * @param id ID of the mesh to deallocate
-     * @return true if succeeded, false if Mesh not found in manager
+     * @return true if succeeded, false if Mesh not found in manager or already freed
+     */
+    bool freeMesh(const std::uint64_t& id);
+
+    /**
+     * @brief Deallocates the mesh referred to by \p handle, see the overload taking an id
+     * @param handle Handle of the mesh to deallocate
+     * @return true if succeeded, false if the mesh has already been freed
      */
-    bool freeMesh(const std::uint32_t& id);
+    bool freeMesh(MeshHandle handle);
 
     /**
      * @brief Creates a shader with either specified file names, or actual shader code. The type of data passed is specified with /p data_type,
@@ -91,12 +244,66 @@ public:
      */
     Shader* createShader(const std::string& lexical_name, const std::string& vs, const std::string& fs, ShaderDataType data_type);
 
+    /**
+     * @brief Creates a batch of shaders. Every program is submitted to the driver before the result of any is queried, so that drivers which compile
+     * on several threads work on all of them at once. With KHR_parallel_shader_compile, programs are finished in the order the driver completes them.
+     * @param sources Shaders to create
+     * @return observer pointers to the created shaders, in the order of \p sources, with nullptr for those which could not be created
+     */
+    std::vector<Shader*> createShaders(const std::vector<ShaderSource>& sources);
+
+    /**
+     * @brief Asynchronously creates a shader. When \p data_type is SHADER_FILE the shader files are read on a worker thread, whereas the compilation
+     * is submitted on the GL thread during a later frame, within the upload budget. The shader is finished in the first frame after the driver
+     * completed it, see createShaders(). The parameters are the same as those of createShader().
+     * @return a future which holds an observer pointer to the created shader once it is ready, or nullptr if it could not be created
+     */
+    std::shared_future<Shader*> createShaderAsync(const std::string& lexical_name, const std::string& vs, const std::string& fs, ShaderDataType data_type);
+
+    /**
+     * @brief Creates a set of shader permutations, whose variants are compiled on demand with different features enabled, see ShaderPermutations.
+     * No variant is compiled until one is asked for, or precompiled.
+     * @param lexical_name The lexical name of the permutations, which prefixes the names of its variants. NB: This should be unique!
+     * @param vs Either The file name containing the vertex shader, or the vertex shader code
+     * @param fs Either The file name containing the fragment shader, or the fragment shader code
+     * @param data_type Type of the data strings passed through. SHADER_FILE for filenames, SHADER_RAW for actual shader code.
+     * @return observer pointer to the permutations, or nullptr if they could not be created
+     */
+    ShaderPermutations* createShaderPermutations(const std::string& lexical_name, const std::string& vs, const std::string& fs, ShaderDataType data_type);
+
+    /**
+     * @brief Gets the shader permutations with the specified \p lexical_name
+     * @param lexical_name lexical name of the permutations
+     * @return observer pointer to the permutations, or nullptr if not found
+     */
+    ShaderPermutations* getShaderPermutations(const std::string& lexical_name);
+
+    /**
+     * @brief Gets the shader permutations with the specified \p lexical_name, without hashing the name
+     * @param lexical_name Id of the lexical name of the permutations
+     * @return observer pointer to the permutations, or nullptr if not found
+     */
+    ShaderPermutations* getShaderPermutations(StringId lexical_name);
+
+    /**
+     * @brief Gets the counters of all shader permutations summed up
+     * @return counters of the shader permutations
+     */
+    ShaderPermutationStats getShaderPermutationStats();
+
     /**
      * @brief Gets the shader with the specified \p id
      * @param id ID of the shader to return
-     * @return observer pointer to shader, or nullptr if not found
+     * @return observer pointer to shader, or nullptr if not found or freed
+     */
+    Shader* getShader(const std::uint64_t& id);
+
+    /**
+     * @brief Gets the shader referred to by \p handle
+     * @param handle Handle of the shader
+     * @return observer pointer to shader, or nullptr if it has been freed
      */
-    Shader* getShader(const std::uint32_t& id);
+    Shader* getShader(ShaderHandle handle);
 
     /**
      * @brief Gets a shader with the specified /p lexical_name
@@ -106,22 +313,91 @@ public:
     Shader* getShader(const std::string& lexical_name);
 
     /**
-     * @brief Deallocates shader program with the specified \p id
+     * @brief Gets a shader with the specified /p lexical_name, hashing the name without copying it into a string
+     * @param lexical_name Lexical name of the shader
+     * @return observer pointer to the shader requested, or nullptr if not found
+     */
+    Shader* getShader(const char* lexical_name);
+
+    /**
+     * @brief Gets a shader with the specified /p lexical_name, without hashing the name, e.g. getShader("basic"_sid). The id is not checked
+     * against the lexical name of the shader found, see StringId::intern() for collisions between names
+     * @param lexical_name Id of the lexical name of the shader
+     * @return observer pointer to shader, or nullptr if not found
+     */
+    Shader* getShader(StringId lexical_name);
+
+    /**
+     * @brief Deallocates shader program with the specified \p id. The program is deleted RESOURCE_FREE_DELAY_FRAMES frames later.
      * @param id ID of the shader to delete
      * @return true if success, otherwise false
      */
-    bool freeShader(const std::uint32_t& id);
+    bool freeShader(const std::uint64_t& id);
+
+    /**
+     * @brief Deallocates the shader referred to by \p handle, see the overload taking an id
+     * @param handle Handle of the shader to delete
+     * @return true if success, false if the shader has already been freed
+     */
+    bool freeShader(ShaderHandle handle);
 
     /**
      * @brief Creates and returns a renderable with the given material and mesh. The material's ownership is transfered to the renderable,
      * whereas the mesh is not as it is merely an observer pointer. This method is used to create a renderable instead of allowing users
      * to directly create them as the ResourceManager wants to keep track of existing VAOs, and thus will assign a relevant existing vao to the
-     * Renderable should it exist, instead of creating a new one. This will reduce the number of VAO switches during rendering.
+     * Renderable should it exist, instead of creating a new one. This will reduce the number of VAO switches during rendering. VAOs are reference
+     * counted, and deleted once the last renderable using them is destroyed.
      * @param mat Material of the renderable
      * @param mesh Mesh of the renderable
      * @return a std::unique_ptr containing the created renderable, or nullptr should an error have occurred.
      */
     std::unique_ptr<Renderable> createRenderable(std::unique_ptr<Material>&& mat, Mesh* mesh);
+
+    /**
+     * @brief Gets an observer pointer to the manager owning all textures
+     * @return observer pointer to the texture manager
+     */
+    TextureManager* textureManager();
+
+    /**
+     * @brief Starts watching the source files of shaders created from files, including those created later on. When a file changes, the shaders using
+     * it are read on a worker thread and recompiled, and the new program is swapped into the shader at the start of the frame after it finished
+     * compiling, keeping its id and lexical name. If the new program fails to compile, the error is reported and the shader keeps its previous program.
+     * Costs nothing per frame while no files change.
+     * @return true if succeeded, false if files can not be watched on this platform
+     */
+    bool enableHotReload();
+
+    /**
+     * @brief Gets the cache of linked program binaries used when creating shaders. The cache is disabled until a directory is set on it.
+     * @return observer pointer to the shader cache
+     */
+    ShaderCache* shaderCache();
+
+    /**
+     * @brief Asynchronously creates a 2D texture in the texture manager. The texture data is produced by \p loader on a worker thread, after which the
+     * texture is created on the GL thread during a later frame, and its levels are uploaded through the pixel buffers of the TextureUploader over the
+     * following frames. Until then, Texture::getTextureName() returns 0. Textures with streamed mips are uploaded directly instead.
+     * @param lexical_name The lexical name of the texture. The same uniqueness rules as TextureManager::createTexture() apply, and are checked once
+     * the data has been loaded.
+     * @param loader Function producing the texture data
+     * @param options Options of the texture
+     * @return a future which holds an observer pointer to the created texture once it is ready, or nullptr if it could not be created
+     */
+    std::shared_future<Texture*> createTextureAsync(const std::string& lexical_name, TextureLoadFunction loader, TextureOptions options = TextureOptions());
+
+    /**
+     * @brief Sets the amount of time the GL thread may spend per frame on the GL work of asynchronously created resources. At least one piece of
+     * work is done per frame regardless of the budget.
+     * @param milliseconds Budget in milliseconds. Default is 2 milliseconds.
+     */
+    void setUploadBudget(float milliseconds);
+
+    /**
+     * @brief Gets an observer pointer to the loader used for asynchronous resource creation. This can be used to schedule custom loading work.
+     * @return observer pointer to the loader
+     */
+    AsyncLoader* asyncLoader();
 };
 
 #endif // RESOURCEMANAGER_H
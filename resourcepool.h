@@ -0,0 +1,195 @@
+#ifndef RESOURCEPOOL_H
+#define RESOURCEPOOL_H
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+//number of frames freed resources are kept alive for, so that their GPU objects are not deleted while frames which are still in flight use them
+const unsigned int RESOURCE_FREE_DELAY_FRAMES = 2;
+
+/**
+ * @brief The ResourceHandle struct refers to a resource in a ResourcePool by the index of its slot, and the generation of the slot at the time the
+ * resource was added. Slots are reused once their resource is removed, with their generation incremented, so handles to removed resources are
+ * detected rather than referring to whatever took their slot.
+ */
+template<class T>
+struct ResourceHandle{
+    std::uint32_t index;
+    std::uint32_t generation;
+
+    ResourceHandle() : index(std::numeric_limits<std::uint32_t>::max()), generation(0){
+    }
+
+    ResourceHandle(std::uint32_t idx, std::uint32_t gen) : index(idx), generation(gen){
+    }
+
+    /**
+     * @brief Checks if the handle was never assigned a resource
+     * @return true if the handle is null, otherwise false
+     */
+    bool isNull() const{
+        return index == std::numeric_limits<std::uint32_t>::max();
+    }
+
+    /**
+     * @brief Packs the handle into a single integer, for use as a key
+     * @return the generation in the upper, and the index in the lower 32 bits
+     */
+    std::uint64_t packed() const{
+        return ((std::uint64_t)generation << 32) | index;
+    }
+
+    /**
+     * @brief Unpacks a handle packed with packed()
+     * @param packed_handle The packed handle
+     * @return the handle
+     */
+    static ResourceHandle unpack(std::uint64_t packed_handle){
+        return ResourceHandle((std::uint32_t)packed_handle, (std::uint32_t)(packed_handle >> 32));
+    }
+
+    bool operator == (const ResourceHandle& other) const{
+        return index == other.index && generation == other.generation;
+    }
+
+    bool operator != (const ResourceHandle& other) const{
+        return !(*this == other);
+    }
+};
+
+/**
+ * @brief The ResourcePool class stores resources in a dense array of slots, handing out generational handles to them. Lookups by handle are a bounds
+ * and generation check away from the resource, and the slots of removed resources are reused, so the array only grows to the peak number of resources.
+ */
+template<class T>
+class ResourcePool
+{
+private:
+    struct Slot{
+        std::unique_ptr<T> resource;
+        std::uint32_t generation;
+        std::uint32_t next_free;
+    };
+
+    static const std::uint32_t NO_SLOT = std::numeric_limits<std::uint32_t>::max();
+
+    std::vector<Slot> slots_;
+    std::uint32_t first_free_;
+    size_t size_;
+
+public:
+    ResourcePool() : first_free_(NO_SLOT), size_(0){
+    }
+
+    ResourcePool(const ResourcePool& other) = delete;
+    ResourcePool& operator = (const ResourcePool& other) = delete;
+
+    /**
+     * @brief Gets the handle the next resource added will be given, so that resources can be constructed knowing their own handle
+     * @return handle of the next resource
+     */
+    ResourceHandle<T> nextHandle() const{
+        if(first_free_ != NO_SLOT){
+            return ResourceHandle<T>(first_free_, slots_[first_free_].generation);
+        }
+
+        return ResourceHandle<T>((std::uint32_t)slots_.size(), 0);
+    }
+
+    /**
+     * @brief Adds a resource to the pool
+     * @param resource Resource to add, must not be nullptr
+     * @return handle of the resource, the same as returned by nextHandle() beforehand
+     */
+    ResourceHandle<T> insert(std::unique_ptr<T>&& resource){
+        ResourceHandle<T> handle = nextHandle();
+
+        if(first_free_ != NO_SLOT){
+            first_free_ = slots_[first_free_].next_free;
+        }
+        else{
+            slots_.push_back(Slot{nullptr, 0, NO_SLOT});
+        }
+
+        slots_[handle.index].resource = std::move(resource);
+        size_++;
+
+        return handle;
+    }
+
+    /**
+     * @brief Gets the resource referred to by \p handle
+     * @param handle Handle of the resource
+     * @return observer pointer to the resource, or nullptr if it has been removed
+     */
+    T* get(ResourceHandle<T> handle) const{
+        if(handle.index >= slots_.size() || slots_[handle.index].generation != handle.generation){
+            return nullptr;
+        }
+
+        return slots_[handle.index].resource.get();
+    }
+
+    /**
+     * @brief Gets the resource in the slot \p index, regardless of its generation
+     * @param index Index of the slot
+     * @return observer pointer to the resource, or nullptr if the slot is empty
+     */
+    T* at(std::uint32_t index) const{
+        return index < slots_.size() ? slots_[index].resource.get() : nullptr;
+    }
+
+    /**
+     * @brief Gets the handle of the resource in the slot \p index
+     * @param index Index of the slot
+     * @return handle of the resource, or a null handle if the slot is empty
+     */
+    ResourceHandle<T> handleAt(std::uint32_t index) const{
+        if(at(index) == nullptr){
+            return ResourceHandle<T>();
+        }
+
+        return ResourceHandle<T>(index, slots_[index].generation);
+    }
+
+    /**
+     * @brief Removes the resource referred to by \p handle from the pool, invalidating all handles to it
+     * @param handle Handle of the resource
+     * @return the removed resource, or nullptr if it had already been removed
+     */
+    std::unique_ptr<T> remove(ResourceHandle<T> handle){
+        if(get(handle) == nullptr){
+            return nullptr;
+        }
+
+        Slot& slot = slots_[handle.index];
+        std::unique_ptr<T> resource = std::move(slot.resource);
+
+        slot.generation++;
+        slot.next_free = first_free_;
+        first_free_ = handle.index;
+        size_--;
+
+        return resource;
+    }
+
+    /**
+     * @brief Gets the number of resources in the pool
+     * @return number of resources
+     */
+    size_t size() const{
+        return size_;
+    }
+
+    /**
+     * @brief Gets the number of slots in the pool, resources are in slots 0 to capacity() - 1
+     * @return number of slots
+     */
+    std::uint32_t capacity() const{
+        return (std::uint32_t)slots_.size();
+    }
+};
+
+#endif // RESOURCEPOOL_H
@@ -1,4 +1,5 @@
 #include "scene.h"
+#include "profiler.h"
 
 Scene::Scene() : root_(new SceneNode("Root")){
 }
@@ -11,7 +12,13 @@ SceneNode* Scene::rootNode(){
     return root_.get();
 }
 
+void Scene::fixedFrame(){
+    root_->fixedFrame();
+}
+
 void Scene::frame(){
+    PROFILE_ZONE("Scene");
+
     root_->checkForDeletions();
     root_->frame(Eigen::Affine3f::Identity());
 }
@@ -7,6 +7,8 @@
 class Scene
 {
 friend class Window;
+//forwards scenes without a window, in tools/microbench.cpp
+friend class SceneDriver;
 private:
     std::unique_ptr<SceneNode> root_;
 
@@ -14,6 +16,9 @@ private:
     //forwards entire scene by a frame
     void frame();
 
+    //runs a fixed simulation step of the entire scene
+    void fixedFrame();
+
 public:
     Scene();
     Scene(const Scene& other) = delete;
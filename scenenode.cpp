@@ -1,15 +1,19 @@
 #include "scenenode.h"
-#include <type_traits>
+#include "enginestats.h"
 
 SceneNode::SceneNode() : SceneNode("Nameless"){
 }
 
-SceneNode::SceneNode(std::string name) : parent_(nullptr), name_(name), rotation_(Eigen::Quaternion<float>::Identity()),
+SceneNode::SceneNode(std::string name) : parent_(nullptr), name_(name), name_id_(StringId::intern(name)), rotation_(Eigen::Quaternion<float>::Identity()),
                                          translation_(0.f, 0.f, 0.f), scale_(1.f, 1.f, 1.f), components_sorted_(true), marked_for_delete_(false){
+    EngineStats::add(COUNTER_SCENE_NODES);
 }
 
-SceneNode::SceneNode(const SceneNode& other) : parent_(nullptr), name_(other.name_), rotation_(other.rotation_),
+SceneNode::SceneNode(const SceneNode& other) : parent_(nullptr), name_(other.name_), name_id_(other.name_id_), rotation_(other.rotation_),
                                     translation_(other.translation_), scale_(other.scale_), components_sorted_(other.components_sorted_), marked_for_delete_(other.marked_for_delete_){
+    EngineStats::add(COUNTER_SCENE_NODES);
+    EngineStats::add(COUNTER_COMPONENTS, (std::int64_t)other.components_.size());
+
     for(auto& component : other.components_){
         auto c = std::move(component->clone());
         c->owner_ = this;
@@ -26,12 +30,15 @@ SceneNode::SceneNode(const SceneNode& other) : parent_(nullptr), name_(other.nam
 SceneNode& SceneNode::operator = (const SceneNode& other){
     parent_ = nullptr;
     name_ = other.name_;
+    name_id_ = other.name_id_;
     rotation_ = other.rotation_;
     translation_ = other.translation_;
     scale_ = other.scale_;
     components_sorted_ = other.components_sorted_;
     marked_for_delete_ = other.marked_for_delete_;
 
+    EngineStats::add(COUNTER_COMPONENTS, (std::int64_t)other.components_.size());
+
     for(auto& component : other.components_){
         auto c = std::move(component->clone());
         c->owner_ = this;
@@ -54,13 +61,20 @@ SceneNode::~SceneNode(){
         component->shutdown();
     }
 
+    EngineStats::add(COUNTER_SCENE_NODES, -1);
+    EngineStats::add(COUNTER_COMPONENTS, -(std::int64_t)components_.size());
+
     components_.clear();
 }
 
-std::string SceneNode::name(){
+const std::string& SceneNode::name(){
     return name_;
 }
 
+StringId SceneNode::nameId(){
+    return name_id_;
+}
+
 Eigen::Affine3f SceneNode::worldTransform(){
     Eigen::Affine3f local_transform = Eigen::Translation3f(translation_) * rotation_ * Eigen::Scaling(scale_);
     if(parent_ != nullptr){
@@ -126,15 +140,19 @@ SceneNode* SceneNode::addChild(std::string name){
 }
 
 SceneNode* SceneNode::findChild(const std::string& name){
+    return findChild(StringId(name));
+}
+
+SceneNode* SceneNode::findChild(StringId name){
     for(auto& child : children_){
-        if(child->name() == name){
+        if(child->name_id_ == name){
             return child.get();
         }
 
         auto grand_child = child->findChild(name);
         if(grand_child != nullptr){
             return grand_child;
-        }SceneNode* addChild(std::string name = "Nameless");
+        }
     }
 
     return nullptr;
@@ -158,6 +176,7 @@ bool SceneNode::findChildByPointer(const SceneNode* child){
 void SceneNode::frame(const Eigen::Affine3f& parent_world_transform){
     if(!components_sorted_){
         components_.sort([](const std::unique_ptr<Component>& first, const std::unique_ptr<Component>& second){return first->priority_ < second->priority_;});
+        components_sorted_ = true;
     }
 
     if(!components_.empty()){
@@ -177,15 +196,30 @@ void SceneNode::frame(const Eigen::Affine3f& parent_world_transform){
     }
 }
 
+void SceneNode::fixedFrame(){
+    for(auto& component : components_){
+        component->fixedFrame();
+    }
+
+    for(auto& child : children_){
+        child->fixedFrame();
+    }
+}
+
 void SceneNode::name(std::string nme){
     name_ = nme;
+    name_id_ = StringId::intern(nme);
 }
 
 std::list<SceneNode*> SceneNode::findChildren(const std::string& name){
+    return findChildren(StringId(name));
+}
+
+std::list<SceneNode*> SceneNode::findChildren(StringId name){
     std::list<SceneNode*> children;
 
     for(auto& child : children_){
-        if(child->name() == name){
+        if(child->name_id_ == name){
             children.push_back(child.get());
         }
 
@@ -230,6 +264,8 @@ void SceneNode::addComponent(std::unique_ptr<Component>&& component){
     components_.push_back(std::move(component));
 
     components_sorted_ = false;
+
+    EngineStats::add(COUNTER_COMPONENTS);
 }
 
 void SceneNode::removeComponent(Component* component){
@@ -239,41 +275,10 @@ void SceneNode::removeComponent(Component* component){
 
     if(iter_pos != components_.end()){
         components_.erase(iter_pos);
+        EngineStats::add(COUNTER_COMPONENTS, -1);
     }
 }
 
-template<typename ComponentType>
-Component* SceneNode::getComponent(){
-    static_assert(std::is_base_of<Component, ComponentType>::value, "ComponentType passed to SceneNode getComponent() is not subclass of Component");
-
-    for(auto& component : components_){
-        ComponentType* sub = dynamic_cast<ComponentType*>(component.get());
-
-        if(sub != nullptr){
-            return sub;
-        }
-    }
-
-    return nullptr;
-}
-
-template<typename ComponentType>
-std::vector<Component*> SceneNode::getComponents(){
-    static_assert(std::is_base_of<Component, ComponentType>::value, "ComponentType passed to SceneNode getComponents() is not subclass of Component");
-
-    std::vector<Component*> out;
-
-    for(auto& component : components_){
-        ComponentType* sub = dynamic_cast<ComponentType*>(component.get());
-
-        if(sub != nullptr){
-            out.push_back(component.get());
-        }
-    }
-
-    return out;
-}
-
 SceneNode* SceneNode::getRoot(){
     if(parent_ == nullptr){
         return this;
@@ -6,7 +6,9 @@
 #include <string>
 #include <list>
 #include "component.h"
+#include "stringid.h"
 #include <vector>
+#include <type_traits>
 
 class SceneNode
 {
@@ -17,6 +19,7 @@ private:
     std::list<std::unique_ptr<SceneNode> > children_;
     std::list<std::unique_ptr<Component> > components_;
     std::string name_;
+    StringId name_id_;
 
     Eigen::Quaternion<float> rotation_;
     Eigen::Vector3f translation_;
@@ -29,6 +32,8 @@ private:
     void checkForDeletions();
     //forwards SceneNode, its components, and its children by a frame
     void frame(const Eigen::Affine3f& parent_world_transform);
+    //runs a fixed simulation step of the components of the SceneNode and its children
+    void fixedFrame();
 
 
 public:
@@ -43,7 +48,13 @@ public:
      * @brief Gets name of the SceneNode
      * @return a string containing the name
      */
-    std::string name();
+    const std::string& name();
+
+    /**
+     * @brief Gets the interned id of the name of the SceneNode
+     * @return id of the name
+     */
+    StringId nameId();
 
     /**
      * @brief Sets name of SceneNode to /p nme
@@ -118,6 +129,13 @@ public:
      */
     SceneNode* findChild(const std::string& name);
 
+    /**
+     * @brief Finds the first occurence of a child with the specified /p name, comparing ids instead of strings, e.g. findChild("player"_sid)
+     * @param name Id of the name of the child to find
+     * @return an observer pointer to the first descedant with the given name
+     */
+    SceneNode* findChild(StringId name);
+
     /**
      * @brief Finds all descendants with the given /p name. Search is performed depth first, with the children being in that order.
      * @param name Name of the children to find
@@ -125,6 +143,13 @@ public:
      */
     std::list<SceneNode*> findChildren(const std::string& name);
 
+    /**
+     * @brief Finds all descendants with the given /p name, comparing ids instead of strings
+     * @param name Id of the name of the children to find
+     * @return a list of observer pointers to all the children with the given name
+     */
+    std::list<SceneNode*> findChildren(StringId name);
+
     /**
      * @brief Searches descendants for the passed \p child
      * @param child Child to search for
@@ -188,4 +213,36 @@ public:
     void destroy();
 };
 
+template<typename ComponentType>
+Component* SceneNode::getComponent(){
+    static_assert(std::is_base_of<Component, ComponentType>::value, "ComponentType passed to SceneNode getComponent() is not subclass of Component");
+
+    for(auto& component : components_){
+        ComponentType* sub = dynamic_cast<ComponentType*>(component.get());
+
+        if(sub != nullptr){
+            return sub;
+        }
+    }
+
+    return nullptr;
+}
+
+template<typename ComponentType>
+std::vector<Component*> SceneNode::getComponents(){
+    static_assert(std::is_base_of<Component, ComponentType>::value, "ComponentType passed to SceneNode getComponents() is not subclass of Component");
+
+    std::vector<Component*> out;
+
+    for(auto& component : components_){
+        ComponentType* sub = dynamic_cast<ComponentType*>(component.get());
+
+        if(sub != nullptr){
+            out.push_back(component.get());
+        }
+    }
+
+    return out;
+}
+
 #endif // SCENENODE_H
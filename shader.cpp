@@ -1,51 +1,291 @@
 #include "shader.h"
 
-Shader::Shader(const std::string& lexical_name, std::uint32_t id, const std::string& vs, const std::string& fs) : id_(id), program_(0), lexical_name_(lexical_name){
-    initializeShader(vs, fs);
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+Shader::Shader(const std::string& lexical_name, std::uint32_t id, const std::string& vs, const std::string& fs, ShaderCache* cache) : id_(id), generation_(0), program_(0),
+                                                                                                                                        lexical_name_(lexical_name), name_id_(StringId::intern(lexical_name)),
+                                                                                                                                        vs_name_(0), fs_name_(0),
+                                                                                                                                        pending_(false), cache_(nullptr),
+                                                                                                                                        cache_key_(0), revision_(0){
+    initializeShader(vs, fs, cache);
+}
+
+Shader::Shader(const std::string& lexical_name, std::uint32_t id) : id_(id), generation_(0), program_(0), lexical_name_(lexical_name), name_id_(StringId::intern(lexical_name)), vs_name_(0), fs_name_(0), pending_(false),
+                                                                    cache_(nullptr), cache_key_(0), revision_(0){
 }
 
-void Shader::initializeShader(const std::string& vs, const std::string& fs){
+void Shader::initializeShader(const std::string& vs, const std::string& fs, ShaderCache* cache){
+    beginCompile(vs, fs, cache);
+    finishCompile();
+}
+
+void Shader::beginCompile(const std::string& vs, const std::string& fs, ShaderCache* cache, const std::vector<ShaderVariable>& attributes){
     program_ = glCreateProgram();
 
-    GLuint vs_name = glCreateShader(GL_VERTEX_SHADER);
-    GLuint fs_name = glCreateShader(GL_FRAGMENT_SHADER);
+    if(cache != nullptr && cache->enabled()){
+        cache_key_ = cache->key(vs, fs);
+
+        if(cache->load(cache_key_, program_)){
+            reflect();
+            return;
+        }
+
+        //a rejected binary leaves the program unlinked, start over with a fresh one
+        glDeleteProgram(program_);
+        program_ = glCreateProgram();
+    }
+
+    cache_ = cache;
+    compile_start_ = std::chrono::steady_clock::now();
+
+    vs_name_ = glCreateShader(GL_VERTEX_SHADER);
+    fs_name_ = glCreateShader(GL_FRAGMENT_SHADER);
 
     const char* vs_source = vs.c_str();
     const char* fs_source = fs.c_str();
 
-    glShaderSource(vs_name, 1, &vs_source, NULL);
-    glCompileShader(vs_name);
+    //no status is queried until the program is finished, as that would wait for the driver to complete the compile
+    glShaderSource(vs_name_, 1, &vs_source, NULL);
+    glCompileShader(vs_name_);
 
-    GLint shader_compiled;
-    glGetShaderiv(vs_name, GL_COMPILE_STATUS, &shader_compiled);
-    if(shader_compiled != GL_TRUE){
-        std::string err = queryShaderErrorMsg(vs_name);
-        throw ShaderCompileError(err);
-    }
+    glShaderSource(fs_name_, 1, &fs_source, NULL);
+    glCompileShader(fs_name_);
 
-    glShaderSource(fs_name, 1, &fs_source, NULL);
-    glCompileShader(fs_name);
+    glAttachShader(program_, vs_name_);
+    glAttachShader(program_, fs_name_);
 
-    glGetShaderiv(fs_name, GL_COMPILE_STATUS, &shader_compiled);
-    if(shader_compiled != GL_TRUE){
-        std::string err = queryShaderErrorMsg(fs_name);
-        throw ShaderCompileError(err);
+    for(auto& attribute : attributes){
+        glBindAttribLocation(program_, (GLuint)attribute.location, attribute.name.c_str());
+    }
+
+    //the binary of the program can only be retrieved if asked for before linking
+    if(cache != nullptr && cache->enabled()){
+        glProgramParameteri(program_, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
     }
 
-    glAttachShader(program_, vs_name);
-    glAttachShader(program_, fs_name);
     glLinkProgram(program_);
 
+    pending_ = true;
+}
+
+bool Shader::isCompileComplete(){
+    if(!pending_ || !GLEW_KHR_parallel_shader_compile){
+        return true;
+    }
+
+    GLint complete = GL_FALSE;
+    glGetProgramiv(program_, GL_COMPLETION_STATUS_KHR, &complete);
+
+    return complete == GL_TRUE;
+}
+
+void Shader::finishCompile(){
+    if(!pending_){
+        return;
+    }
+
+    pending_ = false;
+
     GLint program_linked = GL_TRUE;
-    glGetShaderiv(program_, GL_LINK_STATUS, &program_linked);
+    glGetProgramiv(program_, GL_LINK_STATUS, &program_linked);
+
+    std::string err;
+    if(program_linked != GL_TRUE){
+        //the link fails along with the compile of either stage, report whichever failed first
+        GLint shader_compiled;
+
+        glGetShaderiv(vs_name_, GL_COMPILE_STATUS, &shader_compiled);
+        if(shader_compiled != GL_TRUE){
+            err = queryShaderErrorMsg(vs_name_);
+        }
+        else{
+            glGetShaderiv(fs_name_, GL_COMPILE_STATUS, &shader_compiled);
+            err = shader_compiled != GL_TRUE ? queryShaderErrorMsg(fs_name_) : queryProgramErrorMsg(program_);
+        }
+    }
+
+    //the program keeps what it needs, the shader objects are only freed once detached
+    glDetachShader(program_, vs_name_);
+    glDetachShader(program_, fs_name_);
+    glDeleteShader(vs_name_);
+    glDeleteShader(fs_name_);
+    vs_name_ = 0;
+    fs_name_ = 0;
+
     if(program_linked != GL_TRUE){
-        std::string err = queryShaderErrorMsg(program_);
         throw ShaderCompileError(err);
     }
+
+    reflect();
+
+    if(cache_ != nullptr){
+        cache_->stats_.compile_ms += std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - compile_start_).count();
+
+        if(cache_->enabled()){
+            cache_->store(cache_key_, program_);
+        }
+    }
+}
+
+//checks if a uniform of type \p type is a sampler, which are the only opaque types besides images and atomic counters
+bool isSamplerType(GLenum type){
+    switch(type){
+        case GL_SAMPLER_1D: case GL_SAMPLER_2D: case GL_SAMPLER_3D: case GL_SAMPLER_CUBE:
+        case GL_SAMPLER_1D_SHADOW: case GL_SAMPLER_2D_SHADOW: case GL_SAMPLER_CUBE_SHADOW:
+        case GL_SAMPLER_1D_ARRAY: case GL_SAMPLER_2D_ARRAY: case GL_SAMPLER_1D_ARRAY_SHADOW: case GL_SAMPLER_2D_ARRAY_SHADOW:
+        case GL_SAMPLER_2D_MULTISAMPLE: case GL_SAMPLER_2D_MULTISAMPLE_ARRAY: case GL_SAMPLER_BUFFER: case GL_SAMPLER_2D_RECT:
+        case GL_SAMPLER_2D_RECT_SHADOW:
+        case GL_INT_SAMPLER_1D: case GL_INT_SAMPLER_2D: case GL_INT_SAMPLER_3D: case GL_INT_SAMPLER_CUBE:
+        case GL_INT_SAMPLER_1D_ARRAY: case GL_INT_SAMPLER_2D_ARRAY: case GL_INT_SAMPLER_2D_MULTISAMPLE:
+        case GL_INT_SAMPLER_2D_MULTISAMPLE_ARRAY: case GL_INT_SAMPLER_BUFFER: case GL_INT_SAMPLER_2D_RECT:
+        case GL_UNSIGNED_INT_SAMPLER_1D: case GL_UNSIGNED_INT_SAMPLER_2D: case GL_UNSIGNED_INT_SAMPLER_3D: case GL_UNSIGNED_INT_SAMPLER_CUBE:
+        case GL_UNSIGNED_INT_SAMPLER_1D_ARRAY: case GL_UNSIGNED_INT_SAMPLER_2D_ARRAY: case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE:
+        case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE_ARRAY: case GL_UNSIGNED_INT_SAMPLER_BUFFER: case GL_UNSIGNED_INT_SAMPLER_2D_RECT:
+            return true;
+        default:
+            return false;
+    }
+}
+
+void Shader::reflect(){
+    GLint count = 0;
+    GLint max_length = 0;
+
+    glGetProgramiv(program_, GL_ACTIVE_ATTRIBUTES, &count);
+    glGetProgramiv(program_, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &max_length);
+
+    std::vector<GLchar> name(std::max(max_length, 1));
+
+    for(GLint i = 0; i < count; ++i){
+        ShaderVariable attribute;
+        glGetActiveAttrib(program_, (GLuint)i, (GLsizei)name.size(), NULL, &attribute.size, &attribute.type, name.data());
+
+        attribute.name = name.data();
+        attribute.location = glGetAttribLocation(program_, name.data());
+
+        attribute_locations_[StringId::intern(attribute.name)] = attribute.location;
+        attributes_.push_back(attribute);
+    }
+
+    glGetProgramiv(program_, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(program_, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_length);
+
+    name.resize(std::max(max_length, 1));
+
+    for(GLint i = 0; i < count; ++i){
+        ShaderVariable uniform;
+        glGetActiveUniform(program_, (GLuint)i, (GLsizei)name.size(), NULL, &uniform.size, &uniform.type, name.data());
+
+        uniform.name = name.data();
+        uniform.location = glGetUniformLocation(program_, name.data());
+
+        //members of uniform blocks have no location, they are set through the buffer bound to the block
+        if(uniform.location < 0){
+            continue;
+        }
+
+        uniform_locations_[StringId::intern(uniform.name)] = uniform.location;
+
+        //arrays are reported as name[0], but are just as often looked up by their plain name
+        size_t length = uniform.name.size();
+        if(length > 3 && uniform.name.compare(length - 3, 3, "[0]") == 0){
+            uniform_locations_[StringId::intern(uniform.name.substr(0, length - 3))] = uniform.location;
+        }
+
+        uniforms_.push_back(uniform);
+
+        if(isSamplerType(uniform.type)){
+            samplers_.push_back(uniform);
+        }
+    }
+
+    glGetProgramiv(program_, GL_ACTIVE_UNIFORM_BLOCKS, &count);
+    glGetProgramiv(program_, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &max_length);
+
+    name.resize(std::max(max_length, 1));
+
+    for(GLint i = 0; i < count; ++i){
+        ShaderVariable block;
+        glGetActiveUniformBlockName(program_, (GLuint)i, (GLsizei)name.size(), NULL, name.data());
+        glGetActiveUniformBlockiv(program_, (GLuint)i, GL_UNIFORM_BLOCK_DATA_SIZE, &block.size);
+
+        block.name = name.data();
+        block.location = i;
+        block.type = 0;
+
+        uniform_block_indices_[StringId::intern(block.name)] = block.location;
+        uniform_blocks_.push_back(block);
+    }
+}
+
+void Shader::swapProgram(Shader& other){
+    std::swap(program_, other.program_);
+    std::swap(attributes_, other.attributes_);
+    std::swap(uniforms_, other.uniforms_);
+    std::swap(uniform_blocks_, other.uniform_blocks_);
+    std::swap(samplers_, other.samplers_);
+    std::swap(attribute_locations_, other.attribute_locations_);
+    std::swap(uniform_locations_, other.uniform_locations_);
+    std::swap(uniform_block_indices_, other.uniform_block_indices_);
+
+    revision_++;
+}
+
+std::uint32_t Shader::getRevision(){
+    return revision_;
+}
+
+GLint Shader::getAttributeLocation(StringId name){
+    auto iter = attribute_locations_.find(name);
+    return iter != attribute_locations_.end() ? iter->second : -1;
+}
+
+GLint Shader::getAttributeLocation(const std::string& name){
+    return getAttributeLocation(StringId(name));
+}
+
+GLint Shader::getUniformLocation(StringId name){
+    auto iter = uniform_locations_.find(name);
+    return iter != uniform_locations_.end() ? iter->second : -1;
+}
+
+GLint Shader::getUniformLocation(const std::string& name){
+    return getUniformLocation(StringId(name));
+}
+
+GLint Shader::getUniformBlockIndex(StringId name){
+    auto iter = uniform_block_indices_.find(name);
+    return iter != uniform_block_indices_.end() ? iter->second : -1;
+}
+
+GLint Shader::getUniformBlockIndex(const std::string& name){
+    return getUniformBlockIndex(StringId(name));
+}
+
+const std::vector<ShaderVariable>& Shader::getAttributes(){
+    return attributes_;
+}
+
+const std::vector<ShaderVariable>& Shader::getUniforms(){
+    return uniforms_;
+}
+
+const std::vector<ShaderVariable>& Shader::getUniformBlocks(){
+    return uniform_blocks_;
+}
+
+const std::vector<ShaderVariable>& Shader::getSamplers(){
+    return samplers_;
 }
 
-std::uint32_t Shader::getID(){
-    return id_;
+std::uint64_t Shader::getID(){
+    return getHandle().packed();
+}
+
+ShaderHandle Shader::getHandle(){
+    return ShaderHandle(id_, generation_);
 }
 
 GLuint Shader::getProgram(){
@@ -64,12 +304,32 @@ std::string Shader::queryShaderErrorMsg(GLuint name){
     return msg;
 }
 
+std::string Shader::queryProgramErrorMsg(GLuint name){
+    GLint log_length;
+    glGetProgramiv(name, GL_INFO_LOG_LENGTH, &log_length);
+
+    std::string msg(log_length + 1, '\0');
+    glGetProgramInfoLog(name, log_length, NULL, &msg[0]);
+    msg.resize(std::strlen(msg.c_str()));
+
+    return msg;
+}
+
 Shader::~Shader(){
+    if(vs_name_ != 0){
+        glDeleteShader(vs_name_);
+        glDeleteShader(fs_name_);
+    }
+
     if(program_ != 0){
         glDeleteProgram(program_);
     }
 }
 
-std::string Shader::getLexicalName(){
+const std::string& Shader::getLexicalName(){
     return lexical_name_;
 }
+
+StringId Shader::getNameId(){
+    return name_id_;
+}
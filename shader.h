@@ -2,8 +2,14 @@
 #define SHADER_H
 
 #include "common.h"
+#include "shadercache.h"
+#include "resourcepool.h"
+#include "stringid.h"
 #include <string>
 #include <exception>
+#include <chrono>
+#include <vector>
+#include <unordered_map>
 
 class ShaderCompileError : public std::exception{
 private:
@@ -19,23 +25,77 @@ public:
     }
 };
 
+/**
+ * @brief The ShaderVariable struct describes an active attribute, uniform, or uniform block of a linked program
+ */
+struct ShaderVariable{
+    std::string name;
+    //location of attributes and uniforms, index of uniform blocks
+    GLint location;
+    //GL type of attributes and uniforms, 0 for uniform blocks
+    GLenum type;
+    //number of array elements of attributes and uniforms, data size in bytes of uniform blocks
+    GLint size;
+};
+
+class Shader;
+typedef ResourceHandle<Shader> ShaderHandle;
+
 class Shader
 {
 friend class ResourceManager;
 private:
     std::uint32_t id_;
+    //generation of the slot of the shader in the ResourceManager, which together with the id makes up its handle
+    std::uint32_t generation_;
 
     GLuint program_;
 
     std::string lexical_name_;
+    StringId name_id_;
+
+    //stages of a program whose compile has been submitted, but not yet finished
+    GLuint vs_name_;
+    GLuint fs_name_;
+    bool pending_;
+    ShaderCache* cache_;
+    std::uint64_t cache_key_;
+    std::chrono::steady_clock::time_point compile_start_;
+
+    //reflection of the linked program, with the variables looked up by name
+    std::vector<ShaderVariable> attributes_;
+    std::vector<ShaderVariable> uniforms_;
+    std::vector<ShaderVariable> uniform_blocks_;
+    std::vector<ShaderVariable> samplers_;
+    std::unordered_map<StringId, GLint> attribute_locations_;
+    std::unordered_map<StringId, GLint> uniform_locations_;
+    std::unordered_map<StringId, GLint> uniform_block_indices_;
+
+    //incremented whenever the program is replaced by a reload
+    std::uint32_t revision_;
 
 private:
     //only callable by ShaderManager
-    Shader(const std::string& lexical_name, std::uint32_t id, const std::string& vs, const std::string& fs);
-    //trhwos ShaderCompileError if compilation or linking fails
-    void initializeShader(const std::string& vs, const std::string& fs);
-    //helper for initializeShader
+    Shader(const std::string& lexical_name, std::uint32_t id, const std::string& vs, const std::string& fs, ShaderCache* cache = nullptr);
+    //creates a shader without a program, which is compiled with beginCompile() and finishCompile()
+    Shader(const std::string& lexical_name, std::uint32_t id);
+    //trhwos ShaderCompileError if compilation or linking fails. Programs are loaded from, and stored to \p cache if not nullptr
+    void initializeShader(const std::string& vs, const std::string& fs, ShaderCache* cache);
+    //submits the compile and link of the program without waiting for either. \p attributes are bound to their locations before linking, which
+    //keeps the locations of a reloaded program those of the one it replaces
+    void beginCompile(const std::string& vs, const std::string& fs, ShaderCache* cache,
+                      const std::vector<ShaderVariable>& attributes = std::vector<ShaderVariable>());
+    //checks if the driver has finished the program, only ever false when KHR_parallel_shader_compile is supported
+    bool isCompileComplete();
+    //waits for the program to be finished if it is not yet, throws ShaderCompileError if compilation or linking failed
+    void finishCompile();
+    //helpers for finishCompile
     std::string queryShaderErrorMsg(GLuint name);
+    std::string queryProgramErrorMsg(GLuint name);
+    //queries the active variables of the linked program
+    void reflect();
+    //takes over the program and reflection of \p other, which receives the previous ones, used to swap in reloaded programs
+    void swapProgram(Shader& other);
 
 public:
     Shader() = delete;
@@ -44,10 +104,17 @@ public:
     ~Shader();
 
     /**
-     * @brief Gets ID of shader. This can be used to query the ShaderManager for the shader later.
-     * @return ID of shader
+     * @brief Gets ID of the shader, which can be used to query the ResourceManager for it later. IDs are never reused, so an ID kept after the shader was freed
+     * does not refer to another one.
+     * @return id of the shader, its packed handle
      */
-    std::uint32_t getID();
+    std::uint64_t getID();
+
+    /**
+     * @brief Gets the handle of the shader. Unlike the id, which is reused after the shader is freed, the handle of a freed shader never refers to another.
+     * @return handle of the shader
+     */
+    ShaderHandle getHandle();
 
     /**
      * @brief Gets program name of shader
@@ -55,11 +122,92 @@ public:
      */
     GLuint getProgram();
 
+    /**
+     * @brief Gets the revision of the program, which is incremented every time the program is replaced after its source files changed, see
+     * ResourceManager::enableHotReload(). Attributes keep their locations across reloads, but uniform locations resolved from the previous program
+     * may differ from those of the new one.
+     * @return revision of the program, 0 for the program the shader was created with
+     */
+    std::uint32_t getRevision();
+
+    /**
+     * @brief Gets the location of an active vertex attribute. This is a lookup into the reflection of the program, and makes no OpenGL calls.
+     * @param name Name of the attribute
+     * @return location of the attribute, or -1 if the program has no such active attribute
+     */
+    GLint getAttributeLocation(StringId name);
+
+    /**
+     * @brief Gets the location of an active vertex attribute, see the overload taking an id. The name is hashed on every call.
+     * @param name Name of the attribute
+     * @return location of the attribute, or -1 if the program has no such active attribute
+     */
+    GLint getAttributeLocation(const std::string& name);
+
+    /**
+     * @brief Gets the location of an active uniform. Arrays can be looked up both with and without the "[0]" suffix. This is a lookup into the
+     * reflection of the program, and makes no OpenGL calls.
+     * @param name Name of the uniform
+     * @return location of the uniform, or -1 if the program has no such active uniform outside of a uniform block
+     */
+    GLint getUniformLocation(StringId name);
+
+    /**
+     * @brief Gets the location of an active uniform, see the overload taking an id. The name is hashed on every call.
+     * @param name Name of the uniform
+     * @return location of the uniform, or -1 if the program has no such active uniform outside of a uniform block
+     */
+    GLint getUniformLocation(const std::string& name);
+
+    /**
+     * @brief Gets the index of an active uniform block. This is a lookup into the reflection of the program, and makes no OpenGL calls.
+     * @param name Name of the uniform block
+     * @return index of the block, or -1 if the program has no such active block
+     */
+    GLint getUniformBlockIndex(StringId name);
+
+    /**
+     * @brief Gets the index of an active uniform block, see the overload taking an id. The name is hashed on every call.
+     * @param name Name of the uniform block
+     * @return index of the block, or -1 if the program has no such active block
+     */
+    GLint getUniformBlockIndex(const std::string& name);
+
+    /**
+     * @brief Gets the active vertex attributes of the program
+     * @return the attributes, in the order the driver reports them
+     */
+    const std::vector<ShaderVariable>& getAttributes();
+
+    /**
+     * @brief Gets the active uniforms of the program, samplers included, but not those in uniform blocks
+     * @return the uniforms, in the order the driver reports them
+     */
+    const std::vector<ShaderVariable>& getUniforms();
+
+    /**
+     * @brief Gets the active uniform blocks of the program
+     * @return the uniform blocks, in the order of their indices
+     */
+    const std::vector<ShaderVariable>& getUniformBlocks();
+
+    /**
+     * @brief Gets the active sampler uniforms of the program
+     * @return the samplers, in the order the driver reports them
+     */
+    const std::vector<ShaderVariable>& getSamplers();
+
     /**
      * @brief Gets the lexical name of the shader
      * @return a string containing the lexical name of the shader
      */
-    std::string getLexicalName();
+    const std::string& getLexicalName();
+
+    /**
+     * @brief Gets the interned id of the lexical name of the shader, which it can be looked up by without hashing the name
+     * @return id of the lexical name
+     */
+    StringId getNameId();
 };
 
 #endif // SHADER_H
@@ -0,0 +1,219 @@
+#include "shadercache.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#ifdef _WIN32
+#include <direct.h>
+#include <sys/stat.h>
+#else
+#include <sys/stat.h>
+#include <sys/types.h>
+#endif
+
+std::uint64_t fnv1a(const void* data, size_t size, std::uint64_t hash){
+    const unsigned char* bytes = (const unsigned char*)data;
+
+    for(size_t i = 0; i < size; ++i){
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+//checks if path is an existing directory
+bool isDirectory(const std::string& path){
+#ifdef _WIN32
+    struct _stat path_stat;
+    return _stat(path.c_str(), &path_stat) == 0 && (path_stat.st_mode & _S_IFDIR) != 0;
+#else
+    struct stat path_stat;
+    return stat(path.c_str(), &path_stat) == 0 && S_ISDIR(path_stat.st_mode);
+#endif
+}
+
+//creates the directory path, but not its parents, returns false if it does not exist afterwards
+bool createDirectory(const std::string& path){
+#ifdef _WIN32
+    _mkdir(path.c_str());
+#else
+    mkdir(path.c_str(), 0755);
+#endif
+
+    return isDirectory(path);
+}
+
+ShaderCache::ShaderCache() : driver_hash_(0), driver_queried_(false), supported_(false){
+}
+
+bool ShaderCache::enabled(){
+    if(directory_.empty()){
+        return false;
+    }
+
+    if(!driver_queried_){
+        driver_queried_ = true;
+
+        GLint num_formats = 0;
+        if(GLEW_ARB_get_program_binary){
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &num_formats);
+        }
+
+        supported_ = num_formats > 0;
+
+        std::uint64_t hash = fnv1a(nullptr, 0);
+
+        const GLenum strings[] = {GL_VENDOR, GL_RENDERER, GL_VERSION};
+        for(GLenum name : strings){
+            const char* value = (const char*)glGetString(name);
+            if(value != nullptr){
+                hash = fnv1a(value, std::strlen(value) + 1, hash);
+            }
+        }
+
+        driver_hash_ = hash;
+    }
+
+    return supported_;
+}
+
+std::uint64_t ShaderCache::key(const std::string& vs, const std::string& fs){
+    //the terminators are hashed along, so that moving text from one stage into the other changes the key
+    std::uint64_t hash = fnv1a(&driver_hash_, sizeof(driver_hash_));
+    hash = fnv1a(vs.c_str(), vs.size() + 1, hash);
+    hash = fnv1a(fs.c_str(), fs.size() + 1, hash);
+
+    return hash;
+}
+
+std::string ShaderCache::filename(std::uint64_t key){
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+
+    return directory_ + "/" + name;
+}
+
+bool ShaderCache::load(std::uint64_t key, GLuint program){
+    if(!enabled()){
+        return false;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::string path = filename(key);
+    std::ifstream file(path, std::ios::binary);
+    if(!file.is_open()){
+        stats_.misses++;
+        return false;
+    }
+
+    ProgramCacheHeader header;
+    file.read((char*)&header, sizeof(ProgramCacheHeader));
+
+    std::vector<char> binary;
+    if(file.good() && header.magic == PROGRAM_CACHE_MAGIC && header.version == PROGRAM_CACHE_VERSION && header.key == key){
+        binary.resize(header.binary_size);
+        file.read(binary.data(), binary.size());
+    }
+
+    if(binary.empty() || !file.good() || fnv1a(binary.data(), binary.size()) != header.checksum){
+        std::cerr << "Error: " << path << " is not a valid program binary, recompiling" << std::endl;
+        stats_.rejected++;
+        return false;
+    }
+
+    glProgramBinary(program, (GLenum)header.binary_format, binary.data(), (GLsizei)binary.size());
+
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if(linked != GL_TRUE){
+        //not an error, drivers reject binaries of other driver builds. The binary is replaced once the program is recompiled
+        stats_.rejected++;
+        return false;
+    }
+
+    stats_.hits++;
+    stats_.load_ms += std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    return true;
+}
+
+void ShaderCache::store(std::uint64_t key, GLuint program){
+    if(!enabled()){
+        return;
+    }
+
+    GLint size = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &size);
+    if(size <= 0){
+        return;
+    }
+
+    std::vector<char> binary(size);
+    GLenum format = 0;
+    GLsizei length = 0;
+    glGetProgramBinary(program, size, &length, &format, binary.data());
+    binary.resize(length);
+
+    ProgramCacheHeader header;
+    std::memset(&header, 0, sizeof(ProgramCacheHeader));
+
+    header.magic = PROGRAM_CACHE_MAGIC;
+    header.version = PROGRAM_CACHE_VERSION;
+    header.key = key;
+    header.binary_format = format;
+    header.binary_size = (std::uint32_t)binary.size();
+    header.checksum = fnv1a(binary.data(), binary.size());
+
+    //write to a temporary file first, so that an interrupted run never leaves a truncated binary behind
+    std::string path = filename(key);
+    std::string temp_path = path + ".tmp";
+
+    std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+    if(!file.is_open()){
+        std::cerr << "Error: unable to open " << temp_path << " for writing" << std::endl;
+        return;
+    }
+
+    file.write((const char*)&header, sizeof(ProgramCacheHeader));
+    file.write(binary.data(), binary.size());
+    file.close();
+
+    //rename does not replace existing files everywhere
+    std::remove(path.c_str());
+
+    if(!file.good() || std::rename(temp_path.c_str(), path.c_str()) != 0){
+        std::cerr << "Error: unable to write program binary " << path << std::endl;
+        std::remove(temp_path.c_str());
+        return;
+    }
+
+    stats_.stored++;
+}
+
+bool ShaderCache::setDirectory(const std::string& directory){
+    directory_.clear();
+
+    if(directory.empty()){
+        return true;
+    }
+
+    //checked once here, rather than failing to write every binary later on
+    if(!isDirectory(directory) && !createDirectory(directory)){
+        std::cerr << "Error: unable to create shader cache directory " << directory << ", the cache is disabled" << std::endl;
+        return false;
+    }
+
+    directory_ = directory;
+
+    return true;
+}
+
+ShaderCacheStats ShaderCache::getStats(){
+    return stats_;
+}
@@ -0,0 +1,108 @@
+#ifndef SHADERCACHE_H
+#define SHADERCACHE_H
+
+#include "common.h"
+
+#include <cstdint>
+#include <string>
+
+const std::uint32_t PROGRAM_CACHE_MAGIC = 0x47525045; //"EPRG"
+const std::uint32_t PROGRAM_CACHE_VERSION = 1;
+
+/**
+ * @brief The ProgramCacheHeader struct is the header of a cached program binary file. The binary follows the header directly.
+ */
+struct ProgramCacheHeader{
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint64_t key;
+    std::uint32_t binary_format;
+    std::uint32_t binary_size;
+    //FNV-1a hash of the binary, to catch truncated or corrupted files
+    std::uint64_t checksum;
+};
+
+/**
+ * @brief The ShaderCacheStats struct holds the counters of the ShaderCache since it was created
+ */
+struct ShaderCacheStats{
+    unsigned int hits;
+    unsigned int misses;
+    //cached binaries the driver rejected, which are recompiled and replaced
+    unsigned int rejected;
+    unsigned int stored;
+    //time spent loading binaries, and compiling and linking programs from source
+    float load_ms;
+    float compile_ms;
+
+    ShaderCacheStats() : hits(0), misses(0), rejected(0), stored(0), load_ms(0.f), compile_ms(0.f){
+    }
+};
+
+/**
+ * @brief Hashes \p size bytes of \p data with 64 bit FNV-1a
+ * @param data Data to hash
+ * @param size Size of the data in bytes
+ * @param hash Hash to continue from, for hashing several pieces of data as one
+ * @return the hash
+ */
+std::uint64_t fnv1a(const void* data, size_t size, std::uint64_t hash = 14695981039346656037ULL);
+
+/**
+ * @brief The ShaderCache class stores linked program binaries on disk, so that programs do not have to be compiled from source on every run. Binaries
+ * are keyed by a hash of the shader sources and the vendor, renderer, and version strings of the driver, as binaries are only valid for the driver which
+ * produced them. The driver may still reject a binary, for example after an update which did not change the version string, in which case the program
+ * is compiled from source and the binary replaced.
+ */
+class ShaderCache
+{
+friend class ResourceManager;
+friend class Shader;
+private:
+    //caching is disabled while the directory is empty
+    std::string directory_;
+
+    //hash of the driver strings, queried on first use as it needs the GL context
+    std::uint64_t driver_hash_;
+    bool driver_queried_;
+    bool supported_;
+
+    ShaderCacheStats stats_;
+
+private:
+    //only constructable by the ResourceManager
+    ShaderCache();
+
+    //computes the key of a program from the sources of its stages
+    std::uint64_t key(const std::string& vs, const std::string& fs);
+
+    //checks if the driver supports program binaries, and if the cache is enabled
+    bool enabled();
+
+    std::string filename(std::uint64_t key);
+
+    //loads the cached binary of \p key into \p program, returns false if there is none or the driver rejected it
+    bool load(std::uint64_t key, GLuint program);
+
+    //stores the binary of the linked \p program under \p key
+    void store(std::uint64_t key, GLuint program);
+
+public:
+    ShaderCache(const ShaderCache& other) = delete;
+    ShaderCache& operator = (const ShaderCache& other) = delete;
+
+    /**
+     * @brief Sets the directory program binaries are stored in. The directory is created if it does not exist, but its parent has to.
+     * @param directory Path of the directory, or an empty string to disable the cache. Default is empty.
+     * @return true if succeeded, false if the directory could not be created, in which case the cache is disabled
+     */
+    bool setDirectory(const std::string& directory);
+
+    /**
+     * @brief Gets the counters of the cache
+     * @return counters of the cache
+     */
+    ShaderCacheStats getStats();
+};
+
+#endif // SHADERCACHE_H
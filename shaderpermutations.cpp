@@ -0,0 +1,212 @@
+#include "shaderpermutations.h"
+#include "resourcemanager.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+
+ShaderPermutations::ShaderPermutations(ResourceManager* resource_manager, const std::string& lexical_name, const std::string& vs, const std::string& fs) :
+                                       resource_manager_(resource_manager), lexical_name_(lexical_name), vs_(vs), fs_(fs){
+    parseFeatures(vs_);
+    parseFeatures(fs_);
+
+    if(features_.size() > MAX_SHADER_FEATURES){
+        throw ShaderCompileError("shader " + lexical_name + " declares more than " + std::to_string(MAX_SHADER_FEATURES) + " features");
+    }
+}
+
+void ShaderPermutations::parseFeatures(const std::string& source){
+    std::istringstream lines(source);
+    std::string line;
+
+    while(std::getline(lines, line)){
+        std::istringstream tokens(line);
+        std::string directive, pragma;
+
+        tokens >> directive;
+        if(directive == "#"){
+            //the preprocessor allows whitespace between the # and the directive
+            tokens >> directive;
+            directive = "#" + directive;
+        }
+
+        if(directive != "#pragma" || !(tokens >> pragma) || pragma != "features"){
+            continue;
+        }
+
+        std::string feature;
+        while(tokens >> feature){
+            //features shared by both stages are declared in both
+            if(std::find(features_.begin(), features_.end(), feature) == features_.end()){
+                features_.push_back(feature);
+            }
+        }
+    }
+}
+
+std::string ShaderPermutations::defineFeatures(const std::string& source, std::uint64_t mask){
+    std::string defines;
+    for(size_t i = 0; i < features_.size(); ++i){
+        if(mask & ((std::uint64_t)1 << i)){
+            defines += "#define " + features_[i] + " 1\n";
+        }
+    }
+
+    if(defines.empty()){
+        return source;
+    }
+
+    //#version has to come before anything but comments and whitespace, so the defines go right after it
+    std::string defined = source;
+    size_t position = 0;
+
+    size_t version = defined.find("#version");
+    if(version != std::string::npos){
+        size_t end = defined.find('\n', version);
+        if(end == std::string::npos){
+            defined += '\n';
+            end = defined.size() - 1;
+        }
+
+        position = end + 1;
+    }
+
+    defined.insert(position, defines);
+
+    return defined;
+}
+
+std::uint64_t ShaderPermutations::declaredMask(){
+    return features_.size() == 64 ? ~(std::uint64_t)0 : ((std::uint64_t)1 << features_.size()) - 1;
+}
+
+std::string ShaderPermutations::variantName(std::uint64_t mask){
+    char name[32];
+    std::snprintf(name, sizeof(name), "#%llx", (unsigned long long)mask);
+
+    return lexical_name_ + name;
+}
+
+bool ShaderPermutations::findVariant(std::uint64_t mask, Shader*& shader){
+    auto iter = variants_.find(mask);
+    if(iter == variants_.end()){
+        return false;
+    }
+
+    if(iter->second.isNull()){
+        shader = nullptr;
+        return true;
+    }
+
+    shader = resource_manager_->getShader(iter->second);
+    if(shader == nullptr){
+        variants_.erase(iter);
+        stats_.variants--;
+        return false;
+    }
+
+    return true;
+}
+
+Shader* ShaderPermutations::getVariant(std::uint64_t mask){
+    mask &= declaredMask();
+
+    Shader* variant;
+    if(findVariant(mask, variant)){
+        stats_.hits++;
+        return variant;
+    }
+
+    stats_.misses++;
+
+    auto start = std::chrono::steady_clock::now();
+    Shader* shader = resource_manager_->createShader(variantName(mask), defineFeatures(vs_, mask), defineFeatures(fs_, mask), SHADER_RAW);
+    stats_.compile_ms += std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    //failed variants are cached as well, so that they are not compiled again every time they are asked for
+    variants_[mask] = shader != nullptr ? shader->getHandle() : ShaderHandle();
+    if(shader != nullptr){
+        stats_.variants++;
+    }
+
+    return shader;
+}
+
+bool ShaderPermutations::precompile(const std::vector<std::uint64_t>& masks){
+    std::uint64_t all = declaredMask();
+
+    std::vector<std::uint64_t> batch_masks;
+    std::vector<ShaderSource> batch;
+
+    for(std::uint64_t mask : masks){
+        mask &= all;
+
+        Shader* variant;
+        if(findVariant(mask, variant) || std::find(batch_masks.begin(), batch_masks.end(), mask) != batch_masks.end()){
+            continue;
+        }
+
+        batch_masks.push_back(mask);
+        batch.push_back(ShaderSource{variantName(mask), defineFeatures(vs_, mask), defineFeatures(fs_, mask), SHADER_RAW});
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<Shader*> shaders = resource_manager_->createShaders(batch);
+    stats_.compile_ms += std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    bool succeeded = true;
+    for(size_t i = 0; i < shaders.size(); ++i){
+        variants_[batch_masks[i]] = shaders[i] != nullptr ? shaders[i]->getHandle() : ShaderHandle();
+
+        if(shaders[i] != nullptr){
+            stats_.variants++;
+        }
+        else{
+            succeeded = false;
+        }
+    }
+
+    for(std::uint64_t mask : masks){
+        succeeded = succeeded && !variants_[mask & all].isNull();
+    }
+
+    return succeeded;
+}
+
+std::uint64_t ShaderPermutations::getFeatureBit(const std::string& feature){
+    auto iter = std::find(features_.begin(), features_.end(), feature);
+    if(iter == features_.end()){
+        return 0;
+    }
+
+    return (std::uint64_t)1 << (iter - features_.begin());
+}
+
+std::uint64_t ShaderPermutations::getFeatureMask(const std::vector<std::string>& features){
+    std::uint64_t mask = 0;
+
+    for(auto& feature : features){
+        std::uint64_t bit = getFeatureBit(feature);
+        if(bit == 0){
+            std::cerr << "Error: shader " << lexical_name_ << " has no feature " << feature << std::endl;
+        }
+
+        mask |= bit;
+    }
+
+    return mask;
+}
+
+const std::vector<std::string>& ShaderPermutations::getFeatures(){
+    return features_;
+}
+
+const std::string& ShaderPermutations::getLexicalName(){
+    return lexical_name_;
+}
+
+ShaderPermutationStats ShaderPermutations::getStats(){
+    return stats_;
+}
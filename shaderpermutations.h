@@ -0,0 +1,122 @@
+#ifndef SHADERPERMUTATIONS_H
+#define SHADERPERMUTATIONS_H
+
+#include "shader.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+class ResourceManager;
+
+const unsigned int MAX_SHADER_FEATURES = 64;
+
+/**
+ * @brief The ShaderPermutationStats struct holds the counters of a set of shader permutations since it was created
+ */
+struct ShaderPermutationStats{
+    unsigned int variants;
+    //variant lookups which found the variant already compiled, and those which had to compile it
+    unsigned int hits;
+    unsigned int misses;
+    //time spent compiling variants, both on demand and precompiled
+    float compile_ms;
+
+    ShaderPermutationStats() : variants(0), hits(0), misses(0), compile_ms(0.f){
+    }
+};
+
+/**
+ * @brief The ShaderPermutations class compiles variants of a shader with different sets of features enabled. The sources declare their features with
+ * lines of the form "#pragma features SKINNING FOG NORMAL_MAP", and every feature becomes a bit of the feature mask, in the order they are declared,
+ * vertex shader first. A variant is compiled with "#define FEATURE 1" inserted after the #version line for every feature set in its mask, and is a
+ * regular shader of the ResourceManager named after the permutations and its mask in hex, e.g. "lit#5". Variants are compiled on first use and cached.
+ */
+class ShaderPermutations
+{
+friend class ResourceManager;
+private:
+    ResourceManager* resource_manager_;
+
+    std::string lexical_name_;
+    std::string vs_;
+    std::string fs_;
+
+    std::vector<std::string> features_;
+    //handles rather than pointers, as variants can be freed through the ResourceManager like any shader. Failed variants have null handles.
+    std::unordered_map<std::uint64_t, ShaderHandle> variants_;
+
+    ShaderPermutationStats stats_;
+
+private:
+    //only constructable by the ResourceManager, throws ShaderCompileError if the sources declare too many features
+    ShaderPermutations(ResourceManager* resource_manager, const std::string& lexical_name, const std::string& vs, const std::string& fs);
+
+    //adds the features declared by the pragmas of \p source
+    void parseFeatures(const std::string& source);
+
+    //inserts the defines of the features in \p mask into \p source
+    std::string defineFeatures(const std::string& source, std::uint64_t mask);
+
+    std::string variantName(std::uint64_t mask);
+
+    //looks up the variant of \p mask, returns false if it has not been compiled yet or has been freed since, forgetting it
+    bool findVariant(std::uint64_t mask, Shader*& shader);
+
+    //mask with the bits of all declared features set
+    std::uint64_t declaredMask();
+
+public:
+    ShaderPermutations(const ShaderPermutations& other) = delete;
+    ShaderPermutations& operator = (const ShaderPermutations& other) = delete;
+
+    /**
+     * @brief Gets the variant with the features in \p mask enabled, compiling it if it does not exist yet. Bits which do not correspond to a
+     * declared feature are ignored.
+     * @param mask Feature mask, see getFeatureMask()
+     * @return observer pointer to the variant, or nullptr if it failed to compile
+     */
+    Shader* getVariant(std::uint64_t mask);
+
+    /**
+     * @brief Compiles the variants of \p masks which do not exist yet, as one batch, see ResourceManager::createShaders()
+     * @param masks Feature masks of the variants
+     * @return true if all variants compiled, otherwise false
+     */
+    bool precompile(const std::vector<std::uint64_t>& masks);
+
+    /**
+     * @brief Gets the bit of the feature named \p feature
+     * @param feature Name of the feature, as declared in the sources
+     * @return the bit of the feature, or 0 if there is no such feature
+     */
+    std::uint64_t getFeatureBit(const std::string& feature);
+
+    /**
+     * @brief Gets the mask of the features named \p features. Unknown features are reported and ignored.
+     * @param features Names of the features
+     * @return the feature mask
+     */
+    std::uint64_t getFeatureMask(const std::vector<std::string>& features);
+
+    /**
+     * @brief Gets the features declared by the sources, in the order of their bits
+     * @return names of the features
+     */
+    const std::vector<std::string>& getFeatures();
+
+    /**
+     * @brief Gets the lexical name of the permutations
+     * @return a string containing the lexical name
+     */
+    const std::string& getLexicalName();
+
+    /**
+     * @brief Gets the counters of the permutations
+     * @return counters of the permutations
+     */
+    ShaderPermutationStats getStats();
+};
+
+#endif // SHADERPERMUTATIONS_H
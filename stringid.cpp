@@ -0,0 +1,61 @@
+#include "stringid.h"
+
+#include <iostream>
+#include <mutex>
+#include <unordered_map>
+
+struct StringTable{
+    std::mutex mutex;
+    std::unordered_map<StringId, std::string> strings;
+    StringTableStats stats;
+};
+
+//constructed on first use, so that names can be interned during static initialization
+StringTable& stringTable(){
+    static StringTable table;
+    return table;
+}
+
+StringId::StringId(const std::string& str) : value_(STRING_ID_OFFSET_BASIS){
+    for(char c : str){
+        value_ = (value_ ^ (std::uint64_t)(unsigned char)c) * STRING_ID_PRIME;
+    }
+}
+
+StringId StringId::intern(const std::string& str){
+    StringId id(str);
+
+    StringTable& table = stringTable();
+    std::lock_guard<std::mutex> lock(table.mutex);
+
+    auto iter = table.strings.find(id);
+    if(iter == table.strings.end()){
+        table.strings.emplace(id, str);
+        table.stats.strings++;
+        table.stats.bytes += str.size();
+    }
+    else if(iter->second != str){
+        std::cerr << "Error: String ids of \"" << iter->second << "\" and \"" << str << "\" collide" << std::endl;
+        table.stats.collisions++;
+    }
+
+    return id;
+}
+
+const std::string& StringId::str() const{
+    static const std::string empty;
+
+    StringTable& table = stringTable();
+    std::lock_guard<std::mutex> lock(table.mutex);
+
+    //references stay valid, as strings are never removed from the table
+    auto iter = table.strings.find(*this);
+    return iter != table.strings.end() ? iter->second : empty;
+}
+
+StringTableStats getStringTableStats(){
+    StringTable& table = stringTable();
+    std::lock_guard<std::mutex> lock(table.mutex);
+
+    return table.stats;
+}
@@ -0,0 +1,112 @@
+#ifndef STRINGID_H
+#define STRINGID_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <functional>
+
+const std::uint64_t STRING_ID_OFFSET_BASIS = 14695981039346656037ULL;
+const std::uint64_t STRING_ID_PRIME = 1099511628211ULL;
+
+/**
+ * @brief Hashes a null terminated string with 64 bit FNV-1a. Evaluated at compile time for literals.
+ * @param str String to hash
+ * @param hash Hash to continue from
+ * @return hash of the string
+ */
+constexpr std::uint64_t hashStringId(const char* str, std::uint64_t hash = STRING_ID_OFFSET_BASIS){
+    return *str == '\0' ? hash : hashStringId(str + 1, (hash ^ (std::uint64_t)(unsigned char)*str) * STRING_ID_PRIME);
+}
+
+/**
+ * @brief The StringId class identifies a name by its hash, so that names can be compared and looked up without comparing, copying, or allocating
+ * strings. Ids of literals are hashed at compile time, either with the constructor in a constexpr context, or with the _sid suffix.
+ * Ids created with intern() also register their string in a global table, so that the string can be retrieved from the id, and so that two names
+ * hashing to the same id are reported. Resources and scene nodes intern their names, so looking them up needs no interning.
+ */
+class StringId
+{
+private:
+    std::uint64_t value_;
+
+public:
+    //id of the empty string
+    constexpr StringId() : value_(STRING_ID_OFFSET_BASIS){
+    }
+
+    constexpr explicit StringId(const char* str) : value_(hashStringId(str)){
+    }
+
+    //only hashes the string, without interning it
+    explicit StringId(const std::string& str);
+
+    /**
+     * @brief Creates the id of \p str, and adds the string to the global table. Thread safe.
+     * @param str String to intern
+     * @return id of the string
+     */
+    static StringId intern(const std::string& str);
+
+    /**
+     * @brief Gets the hash the id consists of
+     * @return hash of the string
+     */
+    constexpr std::uint64_t value() const{
+        return value_;
+    }
+
+    /**
+     * @brief Gets the interned string of the id. Thread safe.
+     * @return the string, or an empty string if the id was never interned
+     */
+    const std::string& str() const;
+
+    constexpr bool operator == (const StringId& other) const{
+        return value_ == other.value_;
+    }
+
+    constexpr bool operator != (const StringId& other) const{
+        return value_ != other.value_;
+    }
+
+    constexpr bool operator < (const StringId& other) const{
+        return value_ < other.value_;
+    }
+};
+
+/**
+ * @brief The StringTableStats struct holds the counters of the global string table
+ */
+struct StringTableStats{
+    size_t strings;
+    size_t bytes;
+    //distinct strings which hashed to the same id
+    unsigned int collisions;
+
+    StringTableStats() : strings(0), bytes(0), collisions(0){
+    }
+};
+
+/**
+ * @brief Gets the counters of the global string table. Thread safe.
+ * @return counters of the string table
+ */
+StringTableStats getStringTableStats();
+
+//creates the id of a literal at compile time, e.g. "position"_sid
+constexpr StringId operator "" _sid(const char* str, size_t){
+    return StringId(str);
+}
+
+namespace std{
+    template<>
+    struct hash<StringId>{
+        size_t operator()(const StringId& id) const{
+            //the id already is a well mixed hash
+            return (size_t)id.value();
+        }
+    };
+}
+
+#endif // STRINGID_H
@@ -1,4 +1,11 @@
 #include "texture.h"
+#include "texturemanager.h"
+#include "texturefile.h"
+#include "enginestats.h"
+
+#include <limits>
+#include <iostream>
+#include <algorithm>
 
 GLenum Texture::textureWrapOption(TextureWrapOption wrap_type){
     switch(wrap_type){
@@ -11,7 +18,7 @@ GLenum Texture::textureWrapOption(TextureWrapOption wrap_type){
 
 GLenum Texture::textureFormat(int channels){
     switch(channels){
-        case 1: return GL_R;
+        case 1: return GL_RED;
         case 2: return GL_RG;
         case 3: return GL_RGB;
         case 4: return GL_RGBA;
@@ -19,26 +26,41 @@ GLenum Texture::textureFormat(int channels){
     }
 }
 
-Texture::Texture(std::uint32_t id, std::unique_ptr<char[]>&& texture_dat, int w, TextureOptions texture_options) : id_(id), texture_name_(0), dimensions_(1),
+Texture::Texture(const std::string& lexical_name, std::uint32_t id, std::unique_ptr<char[]>&& texture_dat, int w, TextureOptions texture_options) : id_(id), generation_(0), texture_name_(0), prepared_name_(0), dimensions_(1),
                                                                                                                    texture_data_(std::move(texture_dat)),
-                                                                                                                   texture_options_(texture_options){
+                                                                                                                   texture_options_(texture_options), lexical_name_(lexical_name), name_id_(StringId::intern(lexical_name)), preprocessed_(false), layered_(false),
+                                                                                                                   atlas_(nullptr), layer_(0), region_count_(0),
+                                                                                                                   manager_(nullptr), gpu_size_(0), last_used_frame_(0), resident_(false),
+                                                                                                                   resident_base_level_(0), requested_level_(0),
+                                                                                                                   requested_frame_(std::numeric_limits<std::uint64_t>::max()), fine_request_frame_(0), uploader_(nullptr),
+                                                                                                                   upload_pending_(false), upload_completed_(false){
     assert(texture_data_ != nullptr);
 
     dimensions_[0] = w;
 }
 
-Texture::Texture(std::uint32_t id, std::unique_ptr<char[]>&& texture_dat, int w, int h, TextureOptions texture_options) : id_(id), texture_name_(0), dimensions_(2),
+Texture::Texture(const std::string& lexical_name, std::uint32_t id, std::unique_ptr<char[]>&& texture_dat, int w, int h, TextureOptions texture_options) : id_(id), generation_(0), texture_name_(0), prepared_name_(0), dimensions_(2),
                                                                                                                           texture_data_(std::move(texture_dat)),
-                                                                                                                          texture_options_(texture_options){
+                                                                                                                          texture_options_(texture_options), lexical_name_(lexical_name), name_id_(StringId::intern(lexical_name)), preprocessed_(false), layered_(false),
+                                                                                                                          atlas_(nullptr), layer_(0), region_count_(0),
+                                                                                                                          manager_(nullptr), gpu_size_(0), last_used_frame_(0), resident_(false),
+                                                                                                                          resident_base_level_(0), requested_level_(0),
+                                                                                                                          requested_frame_(std::numeric_limits<std::uint64_t>::max()), fine_request_frame_(0), uploader_(nullptr),
+                                                                                                                          upload_pending_(false), upload_completed_(false){
     assert(texture_data_ != nullptr);
 
     dimensions_[0] = w;
     dimensions_[1] = h;
 }
 
-Texture::Texture(std::uint32_t id, std::unique_ptr<char[]>&& texture_dat, int w, int h, int d, TextureOptions texture_options) : id_(id), texture_name_(0), dimensions_(3),
+Texture::Texture(const std::string& lexical_name, std::uint32_t id, std::unique_ptr<char[]>&& texture_dat, int w, int h, int d, TextureOptions texture_options) : id_(id), generation_(0), texture_name_(0), prepared_name_(0), dimensions_(3),
                                                                                                                                  texture_data_(std::move(texture_dat)),
-                                                                                                                                 texture_options_(texture_options){
+                                                                                                                                 texture_options_(texture_options), lexical_name_(lexical_name), name_id_(StringId::intern(lexical_name)), preprocessed_(false), layered_(false),
+                                                                                                                                 atlas_(nullptr), layer_(0), region_count_(0),
+                                                                                                                                 manager_(nullptr), gpu_size_(0), last_used_frame_(0), resident_(false),
+                                                                                                                                 resident_base_level_(0), requested_level_(0),
+                                                                                                                                 requested_frame_(std::numeric_limits<std::uint64_t>::max()), fine_request_frame_(0), uploader_(nullptr),
+                                                                                                                                 upload_pending_(false), upload_completed_(false){
     assert(texture_data_ != nullptr);
 
     dimensions_[0] = w;
@@ -46,10 +68,78 @@ Texture::Texture(std::uint32_t id, std::unique_ptr<char[]>&& texture_dat, int w,
     dimensions_[2] = d;
 }
 
+Texture::Texture(const std::string& lexical_name, std::uint32_t id, std::unique_ptr<ProcessedTexture>&& processed_data, const std::string& source_file,
+                 TextureOptions texture_options) : id_(id), generation_(0), texture_name_(0), prepared_name_(0), dimensions_(2), texture_options_(texture_options), lexical_name_(lexical_name), name_id_(StringId::intern(lexical_name)),
+                                                   preprocessed_(true), processed_data_(std::move(processed_data)), source_file_(source_file),
+                                                   layered_(false), atlas_(nullptr), layer_(0), region_count_(0),
+                                                   manager_(nullptr), gpu_size_(0), last_used_frame_(0), resident_(false),
+                                                   resident_base_level_(0), requested_level_(0),
+                                                   requested_frame_(std::numeric_limits<std::uint64_t>::max()), fine_request_frame_(0), uploader_(nullptr),
+                                                   upload_pending_(false), upload_completed_(false){
+    assert(processed_data_ != nullptr && !processed_data_->levels.empty());
+
+    dimensions_[0] = processed_data_->levels[0].width;
+    dimensions_[1] = processed_data_->levels[0].height;
+    texture_options_.channels = (int)processed_data_->channels;
+
+    //finer levels are streamed from the cpu copy whenever they are needed again
+    if(texture_options_.stream_mips){
+        texture_options_.cache_option = CACHE_ON_CPU;
+    }
+}
+
+Texture::Texture(const std::string& lexical_name, std::uint32_t id, Texture* atlas, const AtlasRegion& region) : id_(id), generation_(0), texture_name_(0), prepared_name_(0), dimensions_(2),
+                                                                                                              texture_options_(atlas->texture_options_),
+                                                                                                              lexical_name_(lexical_name), name_id_(StringId::intern(lexical_name)), preprocessed_(false),
+                                                                                                              layered_(false), atlas_(atlas), layer_(region.layer),
+                                                                                                              region_count_(0), manager_(nullptr), gpu_size_(0),
+                                                                                                              last_used_frame_(0), resident_(false),
+                                                                                                              resident_base_level_(0), requested_level_(0),
+                                                                                                              requested_frame_(std::numeric_limits<std::uint64_t>::max()),
+                                                                                                              fine_request_frame_(0), uploader_(nullptr),
+                                                                                                              upload_pending_(false), upload_completed_(false){
+    dimensions_[0] = region.width;
+    dimensions_[1] = region.height;
+
+    for(int axis = 0; axis < 2; ++axis){
+        uv_rect_.min[axis] = region.uv_min[axis];
+        uv_rect_.max[axis] = region.uv_max[axis];
+    }
+
+    atlas_->region_count_++;
+}
+
+Texture::Texture(const std::string& lexical_name, std::uint32_t id, const TextureLayout& layout, TextureFillFunction fill, TextureUploader* uploader,
+                 TextureOptions texture_options) : id_(id), generation_(0), texture_name_(0), prepared_name_(0), dimensions_(2), texture_options_(texture_options), lexical_name_(lexical_name), name_id_(StringId::intern(lexical_name)),
+                                                   preprocessed_(false), layered_(false), atlas_(nullptr), layer_(0), region_count_(0),
+                                                   manager_(nullptr), gpu_size_(0), last_used_frame_(0), resident_(false),
+                                                   resident_base_level_(0), requested_level_(0),
+                                                   requested_frame_(std::numeric_limits<std::uint64_t>::max()), fine_request_frame_(0), uploader_(uploader),
+                                                   upload_layout_(layout), upload_fill_(fill), upload_pending_(false), upload_completed_(false){
+    assert(uploader_ != nullptr && upload_fill_);
+
+    dimensions_[0] = layout.width;
+    dimensions_[1] = layout.height;
+    texture_options_.channels = (int)layout.channels;
+    texture_options_.stream_mips = false;
+}
+
+GLenum Texture::compressedTextureFormat(TextureFormat format, bool srgb){
+    switch(format){
+        case TEXTURE_FORMAT_BC1: return srgb ? GL_COMPRESSED_SRGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+        case TEXTURE_FORMAT_BC3: return srgb ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        case TEXTURE_FORMAT_BC4: return GL_COMPRESSED_RED_RGTC1;
+        case TEXTURE_FORMAT_BC5: return GL_COMPRESSED_RG_RGTC2;
+        case TEXTURE_FORMAT_BC7: return srgb ? GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM : GL_COMPRESSED_RGBA_BPTC_UNORM;
+        default: return 0;
+    }
+}
+
 void Texture::loadTexture(int w){
     assert(texture_data_ != nullptr);
 
     glGenTextures(1, &texture_name_);
+    EngineStats::add(COUNTER_GPU_ALLOCATIONS);
     glBindTexture(GL_TEXTURE_1D, texture_name_);
 
     auto filter_option = texture_options_.filter_type;
@@ -78,7 +168,7 @@ void Texture::loadTexture(int w){
 
     glBindTexture(GL_TEXTURE_1D, 0);
 
-    if(texture_options_.cache_option = DELETE_ON_GPU_TRANSFER){
+    if(texture_options_.cache_option == DELETE_ON_GPU_TRANSFER){
         texture_data_ = nullptr;
     }
 }
@@ -87,6 +177,7 @@ void Texture::loadTexture(int w, int h){
     assert(texture_data_ != nullptr);
 
     glGenTextures(1, &texture_name_);
+    EngineStats::add(COUNTER_GPU_ALLOCATIONS);
     glBindTexture(GL_TEXTURE_2D, texture_name_);
 
     auto filter_option = texture_options_.filter_type;
@@ -126,7 +217,7 @@ void Texture::loadTexture(int w, int h){
 
     glBindTexture(GL_TEXTURE_2D, 0);
 
-    if(texture_options_.cache_option = DELETE_ON_GPU_TRANSFER){
+    if(texture_options_.cache_option == DELETE_ON_GPU_TRANSFER){
         texture_data_ = nullptr;
     }
 }
@@ -134,42 +225,295 @@ void Texture::loadTexture(int w, int h){
 void Texture::loadTexture(int w, int h, int d){
     assert(texture_data_ != nullptr);
 
+    GLenum target = layered_ ? GL_TEXTURE_2D_ARRAY : GL_TEXTURE_3D;
+
     glGenTextures(1, &texture_name_);
-    glBindTexture(GL_TEXTURE_3D, texture_name_);
+    EngineStats::add(COUNTER_GPU_ALLOCATIONS);
+    glBindTexture(target, texture_name_);
 
     auto filter_option = texture_options_.filter_type;
 
     switch(filter_option){
         case BILINEAR:
-            glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-            glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
             break;
         case TRILINEAR:
-            glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-            glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+            glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+            glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR_MIPMAP_LINEAR);
             break;
         default:
             break;
     }
 
     GLenum wrap_mode = textureWrapOption(texture_options_.wrap_type);
-    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, wrap_mode);
-    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, wrap_mode);
-    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, wrap_mode);
+    glTexParameteri(target, GL_TEXTURE_WRAP_S, wrap_mode);
+    glTexParameteri(target, GL_TEXTURE_WRAP_T, wrap_mode);
+    if(!layered_){
+        glTexParameteri(target, GL_TEXTURE_WRAP_R, wrap_mode);
+    }
 
     GLenum format = textureFormat(texture_options_.channels);
 
-    glTexImage3D(GL_TEXTURE_3D, 0, format, (GLsizei)w, (GLsizei)h, (GLsizei)d, 0, format, GL_UNSIGNED_BYTE, texture_data_.get());
+    glTexImage3D(target, 0, format, (GLsizei)w, (GLsizei)h, (GLsizei)d, 0, format, GL_UNSIGNED_BYTE, texture_data_.get());
 
-    glGenerateMipmap(GL_TEXTURE_3D);
+    glGenerateMipmap(target);
 
-    glBindTexture(GL_TEXTURE_3D, 0);
+    glBindTexture(target, 0);
 
-    if(texture_options_.cache_option = DELETE_ON_GPU_TRANSFER){
+    if(texture_options_.cache_option == DELETE_ON_GPU_TRANSFER){
         texture_data_ = nullptr;
     }
 }
 
+void Texture::setSamplerParameters(bool mipmapped){
+    switch(texture_options_.filter_type){
+        case BILINEAR:
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            break;
+        case TRILINEAR:
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, mipmapped ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            break;
+        case ANISOTROPIC:
+            assert(texture_options_.anisotropy_amount > 0);
+
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, mipmapped ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+            float max_aniso;
+            glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &max_aniso);
+            float aniso = std::min(max_aniso, texture_options_.anisotropy_amount);
+
+            glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, aniso);
+            break;
+    }
+
+    GLenum wrap_mode = textureWrapOption(texture_options_.wrap_type);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap_mode);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap_mode);
+}
+
+void Texture::loadProcessedTexture(){
+    assert(processed_data_ != nullptr);
+
+    glGenTextures(1, &texture_name_);
+    EngineStats::add(COUNTER_GPU_ALLOCATIONS);
+    glBindTexture(GL_TEXTURE_2D, texture_name_);
+
+    auto& levels = processed_data_->levels;
+
+    setSamplerParameters(levels.size() > 1);
+
+    //the mip chain is provided as is, so the texture is only complete if the sampler does not look past the last level. Streamed textures start
+    //out with only their coarse levels, the finer ones being specified later on
+    unsigned int first_level = isStreamed() ? streamingTailLevel() : 0;
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, (GLint)first_level);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)levels.size() - 1);
+
+    for(unsigned int level = first_level; level < levels.size(); ++level){
+        uploadLevel(level);
+    }
+
+    resident_base_level_ = first_level;
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    if(texture_options_.cache_option == DELETE_ON_GPU_TRANSFER){
+        processed_data_ = nullptr;
+    }
+}
+
+GLenum Texture::processedInternalFormat(){
+    return internalFormat(processed_data_->format, processed_data_->srgb, texture_options_.channels);
+}
+
+GLenum Texture::internalFormat(TextureFormat format, bool srgb, int channels){
+    if(format != TEXTURE_FORMAT_RAW){
+        return compressedTextureFormat(format, srgb);
+    }
+
+    GLenum raw_format = textureFormat(channels);
+    if(srgb){
+        return channels == 4 ? GL_SRGB8_ALPHA8 : channels == 3 ? GL_SRGB8 : raw_format;
+    }
+
+    return raw_format;
+}
+
+void Texture::beginUpload(){
+    assert(uploader_ != nullptr && upload_fill_ && texture_name_ == 0);
+
+    const TextureLayout& layout = upload_layout_;
+    GLenum internal_format = internalFormat(layout.format, layout.srgb, (int)layout.channels);
+
+    glGenTextures(1, &texture_name_);
+    EngineStats::add(COUNTER_GPU_ALLOCATIONS);
+    glBindTexture(GL_TEXTURE_2D, texture_name_);
+
+    setSamplerParameters(layout.num_levels > 1);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)layout.num_levels - 1);
+
+    //only the storage is allocated here, the data follows chunk by chunk from the pixel buffers
+    if(GLEW_ARB_texture_storage){
+        glTexStorage2D(GL_TEXTURE_2D, (GLsizei)layout.num_levels, internal_format, (GLsizei)layout.width, (GLsizei)layout.height);
+    }
+    else{
+        for(unsigned int level = 0; level < layout.num_levels; ++level){
+            GLsizei width = (GLsizei)layout.levelWidth(level);
+            GLsizei height = (GLsizei)layout.levelHeight(level);
+
+            if(layout.format == TEXTURE_FORMAT_RAW){
+                glTexImage2D(GL_TEXTURE_2D, (GLint)level, internal_format, width, height, 0, textureFormat((int)layout.channels), GL_UNSIGNED_BYTE, NULL);
+            }
+            else{
+                glCompressedTexImage2D(GL_TEXTURE_2D, (GLint)level, internal_format, width, height, 0, (GLsizei)layout.levelSize(level), NULL);
+            }
+        }
+    }
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    upload_pending_ = true;
+    uploader_->upload(this, upload_layout_, upload_fill_);
+}
+
+void Texture::finishUpload(bool succeeded){
+    upload_pending_ = false;
+
+    if(!succeeded){
+        std::cerr << "Error: unable to upload texture " << lexical_name_ << std::endl;
+
+        //the data can not be produced, so do not try again on every use
+        glDeleteTextures(1, &texture_name_);
+        texture_name_ = 0;
+        upload_fill_ = nullptr;
+
+        return;
+    }
+
+    if(manager_ != nullptr){
+        manager_->textureUsed(this, true, upload_completed_);
+    }
+
+    upload_completed_ = true;
+
+    if(texture_options_.cache_option == DELETE_ON_GPU_TRANSFER){
+        upload_fill_ = nullptr;
+    }
+}
+
+void Texture::uploadLevel(unsigned int level){
+    assert(processed_data_ != nullptr && level < processed_data_->levels.size());
+
+    auto& data = processed_data_->levels[level];
+
+    if(processed_data_->format == TEXTURE_FORMAT_RAW){
+        //raw levels are tightly packed, which rows of 1 to 3 channels may not be 4 byte aligned with
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, (GLint)level, processedInternalFormat(), (GLsizei)data.width, (GLsizei)data.height, 0,
+                     textureFormat(texture_options_.channels), GL_UNSIGNED_BYTE, data.data.data());
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    }
+    else{
+        glCompressedTexImage2D(GL_TEXTURE_2D, (GLint)level, processedInternalFormat(), (GLsizei)data.width, (GLsizei)data.height, 0,
+                               (GLsizei)data.data.size(), data.data.data());
+    }
+}
+
+void Texture::releaseLevel(unsigned int level){
+    //levels outside of the base and max level range do not affect completeness, so respecifying them as empty frees their storage
+    if(processed_data_->format == TEXTURE_FORMAT_RAW){
+        glTexImage2D(GL_TEXTURE_2D, (GLint)level, processedInternalFormat(), 0, 0, 0, textureFormat(texture_options_.channels), GL_UNSIGNED_BYTE, NULL);
+    }
+    else{
+        glCompressedTexImage2D(GL_TEXTURE_2D, (GLint)level, processedInternalFormat(), 0, 0, 0, 0, NULL);
+    }
+}
+
+bool Texture::isStreamed(){
+    return preprocessed_ && texture_options_.stream_mips;
+}
+
+unsigned int Texture::streamingTailLevel(){
+    assert(processed_data_ != nullptr);
+
+    unsigned int tail_size = manager_ != nullptr ? manager_->stream_tail_size_ : 64;
+    auto& levels = processed_data_->levels;
+
+    for(unsigned int level = 0; level < levels.size(); ++level){
+        if(std::max(levels[level].width, levels[level].height) <= tail_size){
+            return level;
+        }
+    }
+
+    return (unsigned int)levels.size() - 1;
+}
+
+size_t Texture::streamLevel(){
+    assert(isStreamed() && texture_name_ != 0 && resident_base_level_ > 0);
+
+    unsigned int level = resident_base_level_ - 1;
+
+    glBindTexture(GL_TEXTURE_2D, texture_name_);
+    uploadLevel(level);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, (GLint)level);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    resident_base_level_ = level;
+
+    return processed_data_->levels[level].data.size();
+}
+
+size_t Texture::dropLevel(){
+    assert(isStreamed() && texture_name_ != 0 && resident_base_level_ + 1 < processed_data_->levels.size());
+
+    unsigned int level = resident_base_level_;
+
+    glBindTexture(GL_TEXTURE_2D, texture_name_);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, (GLint)level + 1);
+    releaseLevel(level);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    resident_base_level_ = level + 1;
+
+    return processed_data_->levels[level].data.size();
+}
+
+void Texture::requestLevel(unsigned int level){
+    if(!isStreamed() || manager_ == nullptr){
+        return;
+    }
+
+    if(requested_frame_ != manager_->frame_){
+        requested_frame_ = manager_->frame_;
+        requested_level_ = level;
+    }
+    else{
+        requested_level_ = std::min(requested_level_, level);
+    }
+}
+
+unsigned int Texture::getNumLevels(){
+    if(uploader_ != nullptr){
+        return upload_layout_.num_levels;
+    }
+
+    if(preprocessed_ && processed_data_ != nullptr){
+        return (unsigned int)processed_data_->levels.size();
+    }
+
+    return 1;
+}
+
+unsigned int Texture::getResidentLevel(){
+    return isStreamed() ? resident_base_level_ : 0;
+}
+
 Texture::~Texture(){
     if(texture_name_ != 0){
         glDeleteTextures(1, &texture_name_);
@@ -177,23 +521,232 @@ Texture::~Texture(){
 }
 
 GLuint Texture::getTextureName(){
-    if(texture_name_ == 0 && texture_data_ != nullptr){
-        if(dimensions_.size() == 1){
-            loadTexture(dimensions_[0]);
+    //regions share the texture of their atlas, which takes care of residency
+    if(atlas_ != nullptr){
+        return atlas_->getTextureName();
+    }
+
+    //textures filled by the uploader become usable a few frames after their upload is started
+    if(uploader_ != nullptr){
+        if(texture_name_ == 0 && upload_fill_){
+            if(manager_ != nullptr){
+                manager_->makeRoom(gpu_size_);
+            }
+
+            beginUpload();
+        }
+
+        if(upload_pending_ || texture_name_ == 0){
+            return 0;
+        }
+
+        if(manager_ != nullptr){
+            manager_->textureUsed(this, false, false);
         }
-        else if(dimensions_.size() == 2){
-            loadTexture(dimensions_[0], dimensions_[1]);
+
+        return texture_name_;
+    }
+
+    bool uploaded = false;
+    bool reloaded = false;
+
+    if(texture_name_ == 0){
+        if(!hasData()){
+            if(preprocessed_ && !source_file_.empty()){
+                std::unique_ptr<ProcessedTexture> processed_data(new ProcessedTexture());
+                if(readTextureFile(source_file_, *processed_data)){
+                    processed_data_ = std::move(processed_data);
+                }
+            }
+            else if(!preprocessed_ && reload_function_){
+                texture_data_ = reload_function_();
+            }
+
+            reloaded = hasData();
         }
-        else if(dimensions_.size() == 3){
-            loadTexture(dimensions_[0], dimensions_[1], dimensions_[2]);
+
+        if(hasData()){
+            if(manager_ != nullptr){
+                manager_->makeRoom(gpu_size_);
+            }
+
+            if(preprocessed_){
+                loadProcessedTexture();
+            }
+            else if(dimensions_.size() == 1){
+                loadTexture(dimensions_[0]);
+            }
+            else if(dimensions_.size() == 2){
+                loadTexture(dimensions_[0], dimensions_[1]);
+            }
+            else if(dimensions_.size() == 3){
+                loadTexture(dimensions_[0], dimensions_[1], dimensions_[2]);
+            }
+
+            uploaded = texture_name_ != 0;
         }
     }
 
+    if(manager_ != nullptr && texture_name_ != 0){
+        manager_->textureUsed(this, uploaded, reloaded);
+    }
+
     return texture_name_;
 }
 
-std::uint32_t Texture::getID(){
-    return id_;
+bool Texture::hasData(){
+    if(uploader_ != nullptr){
+        return static_cast<bool>(upload_fill_);
+    }
+
+    return preprocessed_ ? processed_data_ != nullptr : texture_data_ != nullptr;
+}
+
+size_t Texture::calculateGPUSize(){
+    if(atlas_ != nullptr){
+        return 0;
+    }
+
+    if(uploader_ != nullptr){
+        size_t size = 0;
+        for(unsigned int level = 0; level < upload_layout_.num_levels; ++level){
+            size += upload_layout_.levelSize(level);
+        }
+
+        return size;
+    }
+
+    //pre-processed textures take up exactly what is uploaded
+    if(preprocessed_){
+        size_t size = 0;
+
+        if(processed_data_ != nullptr){
+            //streamed textures only account for the levels they start out with, the rest is accounted for as it is streamed in
+            unsigned int first_level = isStreamed() ? streamingTailLevel() : 0;
+
+            for(unsigned int level = first_level; level < processed_data_->levels.size(); ++level){
+                size += processed_data_->levels[level].data.size();
+            }
+        }
+
+        return size;
+    }
+
+    size_t bytes_per_texel = (size_t)texture_options_.channels;
+    std::vector<size_t> level(dimensions_.begin(), dimensions_.end());
+
+    //every texture has a full mip chain, as mipmaps are generated on upload
+    size_t size = 0;
+    while(true){
+        size_t level_size = bytes_per_texel;
+        bool last_level = true;
+
+        for(size_t i = 0; i < level.size(); ++i){
+            level_size *= level[i];
+            last_level = last_level && (level[i] <= 1 || (layered_ && i == 2));
+        }
+
+        size += level_size;
+
+        if(last_level){
+            break;
+        }
+
+        //the layers of arrays are not mipmapped into each other
+        for(size_t i = 0; i < level.size(); ++i){
+            if(!(layered_ && i == 2)){
+                level[i] = std::max<size_t>(level[i] / 2, 1);
+            }
+        }
+    }
+
+    return size;
+}
+
+bool Texture::isReloadable(){
+    if(atlas_ != nullptr){
+        return false;
+    }
+
+    if(uploader_ != nullptr){
+        return static_cast<bool>(upload_fill_);
+    }
+
+    if(preprocessed_){
+        return processed_data_ != nullptr || !source_file_.empty();
+    }
+
+    return texture_data_ != nullptr || static_cast<bool>(reload_function_);
+}
+
+bool Texture::evict(){
+    if(texture_name_ == 0){
+        return false;
+    }
+
+    glDeleteTextures(1, &texture_name_);
+    texture_name_ = 0;
+
+    if(isStreamed()){
+        resident_base_level_ = 0;
+        gpu_size_ = calculateGPUSize();
+    }
+
+    return true;
+}
+
+const std::string& Texture::getLexicalName(){
+    return lexical_name_;
+}
+
+StringId Texture::getNameId(){
+    return name_id_;
+}
+
+size_t Texture::getGPUSize(){
+    return gpu_size_;
+}
+
+bool Texture::isResident(){
+    return texture_name_ != 0;
+}
+
+Texture* Texture::getAtlas(){
+    return atlas_ != nullptr ? atlas_ : this;
+}
+
+bool Texture::isAtlasRegion(){
+    return atlas_ != nullptr;
+}
+
+TextureUVRect Texture::getUVRect(){
+    if(atlas_ != nullptr){
+        return uv_rect_;
+    }
+
+    return TextureUVRect{{0.f, 0.f}, {1.f, 1.f}};
+}
+
+unsigned int Texture::getLayer(){
+    return layer_;
+}
+
+GLenum Texture::getTarget(){
+    Texture* texture = getAtlas();
+
+    switch(texture->dimensions_.size()){
+        case 1: return GL_TEXTURE_1D;
+        case 3: return texture->layered_ ? GL_TEXTURE_2D_ARRAY : GL_TEXTURE_3D;
+        default: return GL_TEXTURE_2D;
+    }
+}
+
+std::uint64_t Texture::getID(){
+    return getHandle().packed();
+}
+
+TextureHandle Texture::getHandle(){
+    return TextureHandle(id_, generation_);
 }
 
 std::vector<unsigned int> Texture::getDimensions(){
@@ -207,3 +760,7 @@ TextureOptions Texture::getOptions(){
 char* Texture::getRawTexDat(){
     return texture_data_.get();
 }
+
+ProcessedTexture* Texture::getProcessedData(){
+    return processed_data_.get();
+}
@@ -2,11 +2,23 @@
 #define TEXTURE_H
 
 #include "common.h"
+#include "textureprocessing.h"
+#include "textureatlas.h"
+#include "textureuploader.h"
+#include "resourcepool.h"
+#include "stringid.h"
 
 #include <vector>
 #include <memory>
+#include <string>
+#include <list>
+#include <functional>
 
-enum TextureCacheOption{DELETE_ON_GPU_TRANSFER, CACHE};
+class TextureManager;
+class Texture;
+typedef ResourceHandle<Texture> TextureHandle;
+
+enum TextureCacheOption{DELETE_ON_GPU_TRANSFER, CACHE_ON_CPU};
 enum TextureFilterOption{BILINEAR, TRILINEAR, ANISOTROPIC};
 enum TextureWrapOption{REPEAT, CLAMP, MIRROR};
 
@@ -16,33 +28,144 @@ struct TextureOptions{
     TextureWrapOption wrap_type;
     float anisotropy_amount;
     int channels;
+    //only the coarse mips of the texture are uploaded at first, with finer levels streamed in as the renderer requests them. This only applies
+    //to textures created from pre-processed data, which always keep their data cached on the CPU when streamed
+    bool stream_mips;
 
     TextureOptions() : cache_option(DELETE_ON_GPU_TRANSFER), filter_type(ANISOTROPIC), wrap_type{CLAMP},
-                        anisotropy_amount(2.f), channels(4){
+                        anisotropy_amount(2.f), channels(4), stream_mips(false){
     }
 };
 
+/**
+ * @brief The TextureUVRect struct holds the texture coordinate range a texture occupies within the GL texture it is part of
+ */
+struct TextureUVRect{
+    float min[2];
+    float max[2];
+};
+
+/**
+ * @brief Function used to reproduce the raw data of a texture after it has been evicted from the GPU, for textures whose data is not cached on the CPU.
+ * It should return the same data that the texture was created with, or nullptr if it can not be reproduced.
+ */
+typedef std::function<std::unique_ptr<char[]>()> TextureReloadFunction;
+
 class Texture
 {
 friend class TextureManager;
+friend class TextureUploader;
+friend class Renderer;
 private:
     std::uint32_t id_;
+    //generation of the slot of the texture in the TextureManager, which together with the id makes up its handle
+    std::uint32_t generation_;
     GLuint texture_name_;
+    //name bound when drawing, resolved with the engine lock held when the renderer last prepared a frame using the texture, as frames may be
+    //executed on the render thread while the main thread changes the residency state
+    GLuint prepared_name_;
     std::vector<unsigned int> dimensions_;
     std::unique_ptr<char[]> texture_data_;
     TextureOptions texture_options_;
 
+    std::string lexical_name_;
+    StringId name_id_;
+
+    //pre-processed 2D textures carry their own mip chain, and may be reloaded from the texture file they were read from
+    bool preprocessed_;
+    std::unique_ptr<ProcessedTexture> processed_data_;
+    std::string source_file_;
+
+    //3D textures may instead be 2D arrays, as used by atlases
+    bool layered_;
+
+    //atlas regions are views into the page of an atlas, and have no GL texture of their own. Pages count the regions referencing them
+    Texture* atlas_;
+    TextureUVRect uv_rect_;
+    unsigned int layer_;
+    unsigned int region_count_;
+
+    //residency state, owned by the TextureManager
+    TextureManager* manager_;
+    TextureReloadFunction reload_function_;
+    size_t gpu_size_;
+    std::uint64_t last_used_frame_;
+    //whether the texture is in the lru list of its manager
+    bool resident_;
+    std::list<Texture*>::iterator lru_position_;
+
+    //mip streaming state, levels from resident_base_level_ to the last level are on the GPU. requested_level_ is the finest level the renderer
+    //asked for during requested_frame_, and fine_request_frame_ the last frame in which the finest resident level was still needed
+    unsigned int resident_base_level_;
+    unsigned int requested_level_;
+    std::uint64_t requested_frame_;
+    std::uint64_t fine_request_frame_;
+
+    //textures filled through the pixel buffers of the TextureUploader, which can not be sampled until every chunk has been uploaded
+    TextureUploader* uploader_;
+    TextureLayout upload_layout_;
+    TextureFillFunction upload_fill_;
+    bool upload_pending_;
+    bool upload_completed_;
+
 private:
-    Texture(std::uint32_t id, std::unique_ptr<char[]>&& texture_dat, int w, TextureOptions texture_options);
-    Texture(std::uint32_t id, std::unique_ptr<char[]>&& texture_dat, int w, int h, TextureOptions texture_options);
-    Texture(std::uint32_t id, std::unique_ptr<char[]>&& texture_dat, int w, int h, int d, TextureOptions texture_options);
+    Texture(const std::string& lexical_name, std::uint32_t id, std::unique_ptr<char[]>&& texture_dat, int w, TextureOptions texture_options);
+    Texture(const std::string& lexical_name, std::uint32_t id, std::unique_ptr<char[]>&& texture_dat, int w, int h, TextureOptions texture_options);
+    Texture(const std::string& lexical_name, std::uint32_t id, std::unique_ptr<char[]>&& texture_dat, int w, int h, int d, TextureOptions texture_options);
+    Texture(const std::string& lexical_name, std::uint32_t id, std::unique_ptr<ProcessedTexture>&& processed_data, const std::string& source_file,
+            TextureOptions texture_options);
+    Texture(const std::string& lexical_name, std::uint32_t id, Texture* atlas, const AtlasRegion& region);
+    Texture(const std::string& lexical_name, std::uint32_t id, const TextureLayout& layout, TextureFillFunction fill, TextureUploader* uploader,
+            TextureOptions texture_options);
+
+    //calculates the size of the texture on the GPU, including its full mip chain
+    size_t calculateGPUSize();
+
+    //checks if the data of the texture can be uploaded again after eviction
+    bool isReloadable();
+
+    //frees the GPU copy of the texture, returns false if the texture is not resident
+    bool evict();
+
+    //checks if the texture streams its mip levels
+    bool isStreamed();
+
+    //gets the finest level which is uploaded when a streamed texture is first used
+    unsigned int streamingTailLevel();
+
+    //uploads the next finer level of a resident streamed texture, returns the size of the level
+    size_t streamLevel();
+
+    //frees the finest resident level of a streamed texture, returns the size of the level
+    size_t dropLevel();
 
     void loadTexture(int w);
     void loadTexture(int w, int h);
     void loadTexture(int w, int h, int d);
+    //uploads the levels of the pre-processed data as is, compressed or not. Streamed textures only upload their coarse levels
+    void loadProcessedTexture();
+
+    //specifies a level of the bound pre-processed texture, either with its data, or empty to release its storage
+    void uploadLevel(unsigned int level);
+    void releaseLevel(unsigned int level);
+    GLenum processedInternalFormat();
+    GLenum internalFormat(TextureFormat format, bool srgb, int channels);
+
+    //sets the filtering and wrapping of the bound 2D texture, whose mip chain is provided rather than generated
+    void setSamplerParameters(bool mipmapped);
+
+    //allocates the storage of the texture and queues its data with the uploader
+    void beginUpload();
+
+    //called by the uploader once every chunk of the texture has been uploaded, or once the upload failed
+    void finishUpload(bool succeeded);
+
+    //checks if the CPU copy of the texture data is available
+    bool hasData();
 
     GLenum textureWrapOption(TextureWrapOption wrap_type);
     GLenum textureFormat(int channels);
+    GLenum compressedTextureFormat(TextureFormat format, bool srgb);
 
 public:
     //disallow external construction
@@ -52,16 +175,104 @@ public:
     ~Texture();
 
     /**
-     * @brief Gets name of texture. The texture is sent to opengl the first time this is actually called, as opposed to on construction
-     * @return name of texture
+     * @brief Gets name of texture. The texture is sent to opengl the first time this is actually called, as opposed to on construction, and again
+     * after it has been evicted by the TextureManager. Calling this marks the texture as used in the current frame. Textures created through
+     * TextureManager::createTextureAsync() instead start their upload here, and return 0 until it has completed.
+     * @return name of texture, or 0 if the texture data is not available
      */
     GLuint getTextureName();
 
     /**
-     * @brief Gets ID of texture
-     * @return id of texture
+     * @brief Records that the texture is sampled at mip level \p level during the current frame. At the start of every frame, the TextureManager
+     * streams in the finest level requested in the previous one, and drops levels that are no longer requested. Does nothing for textures which
+     * are not streamed.
+     * @param level Mip level, with 0 being the most detailed
+     */
+    void requestLevel(unsigned int level);
+
+    /**
+     * @brief Gets the number of mip levels the texture has. Textures which are neither pre-processed nor uploaded asynchronously report 1, as their
+     * mips are generated on upload.
+     * @return number of mip levels
+     */
+    unsigned int getNumLevels();
+
+    /**
+     * @brief Gets the finest mip level currently on the GPU. This is always 0 for textures which are not streamed.
+     * @return finest resident level
      */
-    std::uint32_t getID();
+    unsigned int getResidentLevel();
+
+    /**
+     * @brief Gets the texture which is actually bound when using this texture. For atlas regions this is the atlas page they are part of,
+     * otherwise the texture itself.
+     * @return observer pointer to the texture to bind
+     */
+    Texture* getAtlas();
+
+    /**
+     * @brief Checks if the texture is a region of an atlas
+     * @return true if the texture is an atlas region, otherwise false
+     */
+    bool isAtlasRegion();
+
+    /**
+     * @brief Gets the texture coordinate range of the texture within the texture returned by getAtlas(). This is 0 to 1 for textures which
+     * are not atlas regions.
+     * @return the texture coordinate range
+     */
+    TextureUVRect getUVRect();
+
+    /**
+     * @brief Gets the layer of the texture within the texture returned by getAtlas(), for regions of array atlases. Otherwise this is 0.
+     * @return the layer of the texture
+     */
+    unsigned int getLayer();
+
+    /**
+     * @brief Gets the target the texture returned by getAtlas() is bound to, such as GL_TEXTURE_2D or GL_TEXTURE_2D_ARRAY
+     * @return the texture target
+     */
+    GLenum getTarget();
+
+    /**
+     * @brief Gets ID of the texture, which can be used to query the TextureManager for it later. IDs are never reused, so an ID kept after the texture was freed
+     * does not refer to another one.
+     * @return id of the texture, its packed handle
+     */
+    std::uint64_t getID();
+
+    /**
+     * @brief Gets the handle of the texture. Unlike the id, which is reused after the texture is freed, the handle of a freed texture never refers
+     * to another.
+     * @return handle of the texture
+     */
+    TextureHandle getHandle();
+
+    /**
+     * @brief Gets the lexical name of the texture
+     * @return a string containing the lexical name of the texture
+     */
+    const std::string& getLexicalName();
+
+    /**
+     * @brief Gets the interned id of the lexical name of the texture, which it can be looked up by without hashing the name
+     * @return id of the lexical name
+     */
+    StringId getNameId();
+
+    /**
+     * @brief Gets the size the texture takes up on the GPU, including its mip chain. This is the amount accounted against the texture budget
+     * of the TextureManager.
+     * @return size in bytes
+     */
+    size_t getGPUSize();
+
+    /**
+     * @brief Checks if the texture is currently uploaded to the GPU
+     * @return true if the texture is resident, otherwise false
+     */
+    bool isResident();
 
     /**
      * @brief Gets the dimension data of the texture. 1D textures will be a vector of size 1, and so on.
@@ -82,6 +293,12 @@ public:
      * @return pointer to the first element of the character array containing the raw texture data
      */
     char* getRawTexDat();
+
+    /**
+     * @brief Gets the pre-processed data of the texture, for textures created from a ProcessedTexture. The same caching rules as for the raw data apply.
+     * @return pointer to the processed data, or nullptr if not available
+     */
+    ProcessedTexture* getProcessedData();
 };
 
 #endif // TEXTURE_H
@@ -0,0 +1,328 @@
+#include "textureatlas.h"
+
+#include <iostream>
+#include <algorithm>
+#include <map>
+#include <cstring>
+
+//rounds value up to the next multiple of 4, the grid images are placed on
+unsigned int alignAtlasSize(unsigned int value){
+    return (value + 3) & ~3u;
+}
+
+struct SkylineNode{
+    unsigned int x;
+    unsigned int y;
+    unsigned int width;
+};
+
+/**
+ * @brief The SkylinePacker class packs rectangles into a fixed size area by tracking the top edge of the packed rectangles as a list of
+ * horizontal segments, placing every rectangle at the lowest (then leftmost) position it fits.
+ */
+class SkylinePacker
+{
+private:
+    unsigned int width_;
+    unsigned int height_;
+    std::vector<SkylineNode> skyline_;
+
+private:
+    //checks if a rectangle fits with its left edge at the start of the node, and returns the height it would be placed at
+    bool fits(size_t node, unsigned int width, unsigned int height, unsigned int& y){
+        unsigned int x = skyline_[node].x;
+        if(x + width > width_){
+            return false;
+        }
+
+        y = 0;
+        unsigned int covered = 0;
+
+        for(size_t i = node; covered < width; ++i){
+            if(i == skyline_.size()){
+                return false;
+            }
+
+            y = std::max(y, skyline_[i].y);
+            if(y + height > height_){
+                return false;
+            }
+
+            covered += skyline_[i].width;
+        }
+
+        return true;
+    }
+
+public:
+    SkylinePacker(unsigned int width, unsigned int height) : width_(width), height_(height){
+        skyline_.push_back(SkylineNode{0, 0, width});
+    }
+
+    bool insert(unsigned int width, unsigned int height, unsigned int& x, unsigned int& y){
+        size_t best_node = skyline_.size();
+        unsigned int best_top = height_ + 1;
+
+        for(size_t i = 0; i < skyline_.size(); ++i){
+            unsigned int node_y;
+            if(fits(i, width, height, node_y) && node_y + height < best_top){
+                best_top = node_y + height;
+                best_node = i;
+                y = node_y;
+            }
+        }
+
+        if(best_node == skyline_.size()){
+            return false;
+        }
+
+        x = skyline_[best_node].x;
+
+        //the new segment replaces the parts of the segments it covers
+        skyline_.insert(skyline_.begin() + best_node, SkylineNode{x, y + height, width});
+
+        for(size_t i = best_node + 1; i < skyline_.size();){
+            unsigned int covered_end = x + width;
+            if(skyline_[i].x >= covered_end){
+                break;
+            }
+
+            unsigned int node_end = skyline_[i].x + skyline_[i].width;
+            if(node_end <= covered_end){
+                skyline_.erase(skyline_.begin() + i);
+            }
+            else{
+                skyline_[i].width = node_end - covered_end;
+                skyline_[i].x = covered_end;
+                break;
+            }
+        }
+
+        //merge neighbouring segments of the same height
+        for(size_t i = 0; i + 1 < skyline_.size();){
+            if(skyline_[i].y == skyline_[i + 1].y){
+                skyline_[i].width += skyline_[i + 1].width;
+                skyline_.erase(skyline_.begin() + i + 1);
+            }
+            else{
+                ++i;
+            }
+        }
+
+        return true;
+    }
+
+    //height of the highest segment
+    unsigned int usedHeight(){
+        unsigned int height = 0;
+        for(auto& node : skyline_){
+            height = std::max(height, node.y);
+        }
+
+        return height;
+    }
+};
+
+TextureAtlasBuilder::TextureAtlasBuilder(unsigned int page_size, unsigned int padding, unsigned int max_layers) : page_size_(alignAtlasSize(page_size)),
+                                                                                                                   padding_(padding), max_layers_(max_layers),
+                                                                                                                   mode_(ATLAS_PACK_2D), used_texels_(0){
+}
+
+void TextureAtlasBuilder::addImage(AtlasImage&& image){
+    images_.push_back(std::move(image));
+}
+
+bool TextureAtlasBuilder::build(AtlasPackingMode mode){
+    pages_.clear();
+    regions_.clear();
+    used_texels_ = 0;
+    mode_ = mode;
+
+    for(auto& image : images_){
+        if(image.width == 0 || image.height == 0 || image.pixels.size() != (size_t)image.width * image.height * 4){
+            std::cerr << "Error: atlas image " << image.name << " is empty or has the wrong amount of data" << std::endl;
+            return false;
+        }
+
+        used_texels_ += (size_t)image.width * image.height;
+    }
+
+    bool succeeded = mode == ATLAS_PACK_2D ? build2D() : buildArray();
+    if(!succeeded){
+        pages_.clear();
+        regions_.clear();
+        used_texels_ = 0;
+    }
+
+    return succeeded;
+}
+
+bool TextureAtlasBuilder::build2D(){
+    //packing the tallest images first keeps the skyline flat
+    std::vector<size_t> order(images_.size());
+    for(size_t i = 0; i < order.size(); ++i){
+        order[i] = i;
+    }
+
+    std::stable_sort(order.begin(), order.end(), [this](size_t first, size_t second){
+        if(images_[first].height != images_[second].height){
+            return images_[first].height > images_[second].height;
+        }
+
+        return images_[first].width > images_[second].width;
+    });
+
+    std::vector<SkylinePacker> packers;
+    regions_.resize(images_.size());
+
+    for(auto index : order){
+        const AtlasImage& image = images_[index];
+        unsigned int padded_width = alignAtlasSize(image.width + padding_ * 2);
+        unsigned int padded_height = alignAtlasSize(image.height + padding_ * 2);
+
+        if(padded_width > page_size_ || padded_height > page_size_){
+            std::cerr << "Error: atlas image " << image.name << " does not fit into a page" << std::endl;
+            return false;
+        }
+
+        AtlasRegion& region = regions_[index];
+        region.name = image.name;
+        region.layer = 0;
+        region.width = image.width;
+        region.height = image.height;
+
+        bool placed = false;
+        for(size_t page = 0; page < packers.size() && !placed; ++page){
+            placed = packers[page].insert(padded_width, padded_height, region.x, region.y);
+            region.page = (unsigned int)page;
+        }
+
+        if(!placed){
+            packers.push_back(SkylinePacker(page_size_, page_size_));
+            packers.back().insert(padded_width, padded_height, region.x, region.y);
+            region.page = (unsigned int)packers.size() - 1;
+        }
+
+        region.x += padding_;
+        region.y += padding_;
+    }
+
+    //pages are only as tall as they need to be, rounded up to a power of two
+    pages_.resize(packers.size());
+    for(size_t page = 0; page < packers.size(); ++page){
+        unsigned int height = 4;
+        while(height < packers[page].usedHeight()){
+            height *= 2;
+        }
+
+        pages_[page].width = page_size_;
+        pages_[page].height = std::min(height, page_size_);
+        pages_[page].layers = 1;
+        pages_[page].pixels.assign((size_t)pages_[page].width * pages_[page].height * 4, 0);
+    }
+
+    for(size_t i = 0; i < regions_.size(); ++i){
+        AtlasRegion& region = regions_[i];
+        AtlasPage& page = pages_[region.page];
+
+        blitPadded(images_[i], page, 0, region.x, region.y);
+
+        region.uv_min[0] = (float)region.x / page.width;
+        region.uv_min[1] = (float)region.y / page.height;
+        region.uv_max[0] = (float)(region.x + region.width) / page.width;
+        region.uv_max[1] = (float)(region.y + region.height) / page.height;
+    }
+
+    return true;
+}
+
+bool TextureAtlasBuilder::buildArray(){
+    //layers of an array share their size, so images are grouped by it
+    std::map<std::pair<unsigned int, unsigned int>, std::vector<size_t> > sizes;
+    for(size_t i = 0; i < images_.size(); ++i){
+        sizes[std::make_pair(images_[i].width, images_[i].height)].push_back(i);
+    }
+
+    regions_.resize(images_.size());
+
+    for(auto& size : sizes){
+        auto& indices = size.second;
+
+        for(size_t first = 0; first < indices.size(); first += max_layers_){
+            size_t count = std::min<size_t>(max_layers_, indices.size() - first);
+
+            AtlasPage page;
+            page.width = size.first.first;
+            page.height = size.first.second;
+            page.layers = (unsigned int)count;
+            page.pixels.resize((size_t)page.width * page.height * 4 * count);
+
+            for(size_t layer = 0; layer < count; ++layer){
+                size_t index = indices[first + layer];
+                const AtlasImage& image = images_[index];
+
+                std::memcpy(&page.pixels[(size_t)page.width * page.height * 4 * layer], image.pixels.data(), image.pixels.size());
+
+                AtlasRegion& region = regions_[index];
+                region.name = image.name;
+                region.page = (unsigned int)pages_.size();
+                region.layer = (unsigned int)layer;
+                region.x = region.y = 0;
+                region.width = image.width;
+                region.height = image.height;
+                region.uv_min[0] = region.uv_min[1] = 0.f;
+                region.uv_max[0] = region.uv_max[1] = 1.f;
+            }
+
+            pages_.push_back(std::move(page));
+        }
+    }
+
+    return true;
+}
+
+void TextureAtlasBuilder::blitPadded(const AtlasImage& image, AtlasPage& page, unsigned int layer, unsigned int x, unsigned int y){
+    int padding = (int)padding_;
+    unsigned char* layer_pixels = &page.pixels[(size_t)page.width * page.height * 4 * layer];
+
+    for(int row = -padding; row < (int)image.height + padding; ++row){
+        int page_y = (int)y + row;
+        if(page_y < 0 || page_y >= (int)page.height){
+            continue;
+        }
+
+        int source_y = std::min(std::max(row, 0), (int)image.height - 1);
+
+        for(int column = -padding; column < (int)image.width + padding; ++column){
+            int page_x = (int)x + column;
+            if(page_x < 0 || page_x >= (int)page.width){
+                continue;
+            }
+
+            int source_x = std::min(std::max(column, 0), (int)image.width - 1);
+
+            std::memcpy(layer_pixels + ((size_t)page_y * page.width + page_x) * 4, &image.pixels[((size_t)source_y * image.width + source_x) * 4], 4);
+        }
+    }
+}
+
+AtlasPackingMode TextureAtlasBuilder::mode(){
+    return mode_;
+}
+
+std::vector<AtlasPage>& TextureAtlasBuilder::pages(){
+    return pages_;
+}
+
+const std::vector<AtlasRegion>& TextureAtlasBuilder::regions(){
+    return regions_;
+}
+
+float TextureAtlasBuilder::efficiency(){
+    size_t total_texels = 0;
+    for(auto& page : pages_){
+        total_texels += (size_t)page.width * page.height * page.layers;
+    }
+
+    return total_texels > 0 ? (float)used_texels_ / (float)total_texels : 0.f;
+}
@@ -0,0 +1,124 @@
+#ifndef TEXTUREATLAS_H
+#define TEXTUREATLAS_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * @brief The AtlasPackingMode enum specifies how the images of an atlas are combined. ATLAS_PACK_2D packs images of any size into 2D pages,
+ * whereas ATLAS_PACK_ARRAY stacks images of the same size as the layers of 2D array textures, one array per size.
+ */
+enum AtlasPackingMode{ATLAS_PACK_2D, ATLAS_PACK_ARRAY};
+
+/**
+ * @brief The AtlasImage struct holds an RGBA image, 4 bytes per texel, to be packed into an atlas
+ */
+struct AtlasImage{
+    std::string name;
+    unsigned int width;
+    unsigned int height;
+    std::vector<unsigned char> pixels;
+};
+
+/**
+ * @brief The AtlasRegion struct describes where an image ended up in the atlas. The uv rectangle excludes the padding around the image.
+ */
+struct AtlasRegion{
+    std::string name;
+    unsigned int page;
+    unsigned int layer;
+    unsigned int x;
+    unsigned int y;
+    unsigned int width;
+    unsigned int height;
+    float uv_min[2];
+    float uv_max[2];
+};
+
+/**
+ * @brief The AtlasPage struct holds the RGBA texels of an atlas page. Pages of 2D atlases have a single layer, whereas those of arrays
+ * store their layers one after another.
+ */
+struct AtlasPage{
+    unsigned int width;
+    unsigned int height;
+    unsigned int layers;
+    std::vector<unsigned char> pixels;
+};
+
+/**
+ * @brief The TextureAtlasBuilder class packs many small images into a few larger textures, so that objects using different images can share
+ * a texture binding. 2D pages are packed with a skyline bottom-left packer. Every image is surrounded by a border of its own edge texels, and
+ * placed on a 4 texel grid, so that neither bilinear filtering nor the first few mip levels bleed neighbouring images into it.
+ * This makes no OpenGL calls, see TextureManager::createAtlas() for turning the result into textures.
+ */
+class TextureAtlasBuilder
+{
+private:
+    unsigned int page_size_;
+    unsigned int padding_;
+    unsigned int max_layers_;
+    AtlasPackingMode mode_;
+
+    std::vector<AtlasImage> images_;
+
+    std::vector<AtlasPage> pages_;
+    std::vector<AtlasRegion> regions_;
+    size_t used_texels_;
+
+private:
+    bool build2D();
+    bool buildArray();
+
+    //copies the image into the page at the given position, extruding its edges into the padding around it
+    void blitPadded(const AtlasImage& image, AtlasPage& page, unsigned int layer, unsigned int x, unsigned int y);
+
+public:
+    /**
+     * @brief Constructs an atlas builder
+     * @param page_size Width and height of the pages of 2D atlases, and the maximum size of images
+     * @param padding Number of border texels around every image in 2D atlases. Filtering stays clean for mip levels up to log2(padding).
+     * @param max_layers Maximum number of layers of array pages
+     */
+    TextureAtlasBuilder(unsigned int page_size = 2048, unsigned int padding = 4, unsigned int max_layers = 256);
+
+    /**
+     * @brief Adds an image to be packed by the next build
+     * @param image Image to add, its name is used for the texture created for it
+     */
+    void addImage(AtlasImage&& image);
+
+    /**
+     * @brief Packs all added images into pages
+     * @param mode Packing mode
+     * @return true if succeeded, false if an image is empty, or does not fit into a page
+     */
+    bool build(AtlasPackingMode mode);
+
+    /**
+     * @brief Gets the packing mode of the last build
+     * @return the packing mode
+     */
+    AtlasPackingMode mode();
+
+    /**
+     * @brief Gets the pages of the last build
+     * @return the pages
+     */
+    std::vector<AtlasPage>& pages();
+
+    /**
+     * @brief Gets the regions of the last build, in the order the images were added
+     * @return the regions
+     */
+    const std::vector<AtlasRegion>& regions();
+
+    /**
+     * @brief Gets the fraction of the texels of all pages which are covered by images, excluding their padding
+     * @return packing efficiency between 0 and 1
+     */
+    float efficiency();
+};
+
+#endif // TEXTUREATLAS_H
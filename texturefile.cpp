@@ -0,0 +1,119 @@
+#include "texturefile.h"
+
+#include <fstream>
+#include <iostream>
+#include <vector>
+#include <cstring>
+
+//rounds offset up to the next multiple of TEXTURE_FILE_ALIGNMENT
+std::uint64_t alignTextureFileOffset(std::uint64_t offset){
+    return (offset + TEXTURE_FILE_ALIGNMENT - 1) / TEXTURE_FILE_ALIGNMENT * TEXTURE_FILE_ALIGNMENT;
+}
+
+bool writeTextureFile(const std::string& filename, const ProcessedTexture& texture){
+    if(texture.levels.empty()){
+        std::cerr << "Error: texture file must contain at least one level" << std::endl;
+        return false;
+    }
+
+    TextureFileHeader header;
+    std::memset(&header, 0, sizeof(TextureFileHeader));
+
+    header.magic = TEXTURE_FILE_MAGIC;
+    header.version = TEXTURE_FILE_VERSION;
+    header.format = (std::uint32_t)texture.format;
+    header.srgb = texture.srgb ? 1 : 0;
+    header.channels = texture.channels;
+    header.level_count = (std::uint32_t)texture.levels.size();
+
+    std::vector<TextureFileLevel> level_table(texture.levels.size());
+    std::uint64_t offset = alignTextureFileOffset(sizeof(TextureFileHeader) + sizeof(TextureFileLevel) * level_table.size());
+
+    for(size_t i = 0; i < level_table.size(); ++i){
+        level_table[i].offset = offset;
+        level_table[i].size = texture.levels[i].data.size();
+        level_table[i].width = texture.levels[i].width;
+        level_table[i].height = texture.levels[i].height;
+
+        offset = alignTextureFileOffset(offset + level_table[i].size);
+    }
+
+    header.file_size = offset;
+
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    if(!file.is_open()){
+        std::cerr << "Error: unable to open texture file " << filename << " for writing" << std::endl;
+        return false;
+    }
+
+    static const char zeroes[TEXTURE_FILE_ALIGNMENT] = {0};
+
+    file.write((const char*)&header, sizeof(TextureFileHeader));
+    file.write((const char*)&level_table[0], sizeof(TextureFileLevel) * level_table.size());
+
+    for(size_t i = 0; i < level_table.size(); ++i){
+        file.write(zeroes, level_table[i].offset - (std::uint64_t)file.tellp());
+        file.write((const char*)texture.levels[i].data.data(), level_table[i].size);
+    }
+
+    file.write(zeroes, header.file_size - (std::uint64_t)file.tellp());
+
+    return file.good();
+}
+
+bool readTextureFile(const std::string& filename, ProcessedTexture& texture){
+    std::ifstream file(filename, std::ios::binary);
+    if(!file.is_open()){
+        std::cerr << "Error: unable to open texture file " << filename << std::endl;
+        return false;
+    }
+
+    TextureFileHeader header;
+    file.read((char*)&header, sizeof(TextureFileHeader));
+
+    if(!file.good() || header.magic != TEXTURE_FILE_MAGIC || header.version != TEXTURE_FILE_VERSION || header.format > TEXTURE_FORMAT_BC7 ||
+       header.channels < 1 || header.channels > 4 || header.level_count == 0){
+        std::cerr << "Error: " << filename << " is not a valid texture file" << std::endl;
+        return false;
+    }
+
+    std::vector<TextureFileLevel> level_table(header.level_count);
+    file.read((char*)&level_table[0], sizeof(TextureFileLevel) * level_table.size());
+
+    if(!file.good()){
+        std::cerr << "Error: " << filename << " is not a valid texture file" << std::endl;
+        return false;
+    }
+
+    texture.format = (TextureFormat)header.format;
+    texture.srgb = header.srgb != 0;
+    texture.channels = header.channels;
+    texture.levels.resize(level_table.size());
+
+    for(size_t i = 0; i < level_table.size(); ++i){
+        const TextureFileLevel& entry = level_table[i];
+
+        if(entry.width == 0 || entry.height == 0 || entry.offset + entry.size > header.file_size ||
+           entry.size != textureLevelSize(texture.format, entry.width, entry.height, texture.channels)){
+            std::cerr << "Error: " << filename << " is not a valid texture file" << std::endl;
+            texture.levels.clear();
+            return false;
+        }
+
+        TextureLevelData& level = texture.levels[i];
+        level.width = entry.width;
+        level.height = entry.height;
+        level.data.resize(entry.size);
+
+        file.seekg(entry.offset);
+        file.read((char*)level.data.data(), entry.size);
+
+        if(!file.good()){
+            std::cerr << "Error: unable to read texture file " << filename << std::endl;
+            texture.levels.clear();
+            return false;
+        }
+    }
+
+    return true;
+}
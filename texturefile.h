@@ -0,0 +1,56 @@
+#ifndef TEXTUREFILE_H
+#define TEXTUREFILE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+#include "textureprocessing.h"
+
+//"ETEX" when read as bytes
+const std::uint32_t TEXTURE_FILE_MAGIC = 0x58455445;
+const std::uint32_t TEXTURE_FILE_VERSION = 1;
+//every level starts at a multiple of this
+const std::uint64_t TEXTURE_FILE_ALIGNMENT = 16;
+
+/**
+ * @brief The TextureFileHeader struct is found at the start of every texture file, and is followed by level_count TextureFileLevel entries,
+ * the first being the largest level.
+ */
+struct TextureFileHeader{
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint32_t format;
+    std::uint32_t srgb;
+    std::uint32_t channels;
+    std::uint32_t level_count;
+    std::uint64_t file_size;
+};
+
+/**
+ * @brief The TextureFileLevel struct describes where a level is found in the texture file. Offsets are in bytes from the start of the file.
+ */
+struct TextureFileLevel{
+    std::uint64_t offset;
+    std::uint64_t size;
+    std::uint32_t width;
+    std::uint32_t height;
+};
+
+/**
+ * @brief Writes a processed texture to a texture file
+ * @param filename Name of the file to write
+ * @param texture Texture to write
+ * @return true if succeeded, otherwise false
+ */
+bool writeTextureFile(const std::string& filename, const ProcessedTexture& texture);
+
+/**
+ * @brief Reads a texture file, validating the size of every level against its format
+ * @param filename Name of the file to read
+ * @param texture Receives the texture
+ * @return true if succeeded, otherwise false
+ */
+bool readTextureFile(const std::string& filename, ProcessedTexture& texture);
+
+#endif // TEXTUREFILE_H
@@ -0,0 +1,455 @@
+#include "texturemanager.h"
+#include "profiler.h"
+#include "enginestats.h"
+
+#include "texturefile.h"
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <iterator>
+#include <cstring>
+#include <cassert>
+
+TextureManager::TextureManager(AsyncLoader* loader) : budget_bytes_(0), resident_bytes_(0), eviction_age_(2), frame_(0),
+                                                     stream_budget_bytes_(4 * 1024 * 1024), stream_tail_size_(64), uploader_(new TextureUploader(loader)){
+}
+
+TextureManager::~TextureManager(){
+    //textures are freed along with the pool, clear the lru list first so that it does not hold dangling pointers
+    lru_.clear();
+}
+
+void TextureManager::frame(){
+    PROFILE_ZONE("Textures");
+
+    uploader_->frame();
+    streamMips();
+    makeRoom(0);
+
+    frame_stats_.resident_bytes = resident_bytes_;
+    frame_stats_.budget_bytes = budget_bytes_;
+    frame_stats_.resident_textures = (unsigned int)lru_.size();
+    frame_stats_.total_textures = (unsigned int)textures_.size();
+
+    EngineStats::set(COUNTER_TEXTURES, (std::int64_t)textures_.size());
+    EngineStats::set(COUNTER_TEXTURE_BYTES, (std::int64_t)resident_bytes_);
+
+    last_frame_stats_ = frame_stats_;
+    frame_stats_ = TextureStats();
+
+    while(!freed_textures_.empty() && freed_textures_.front().first + RESOURCE_FREE_DELAY_FRAMES <= frame_){
+        freed_textures_.pop_front();
+    }
+
+    frame_++;
+}
+
+void TextureManager::streamMips(){
+    std::vector<std::pair<Texture*, unsigned int> > wanted_levels;
+
+    for(auto texture : lru_){
+        if(!texture->isStreamed()){
+            continue;
+        }
+
+        unsigned int tail_level = texture->streamingTailLevel();
+        unsigned int wanted_level = texture->requested_frame_ == frame_ ? std::min(texture->requested_level_, tail_level) : tail_level;
+
+        if(wanted_level <= texture->resident_base_level_){
+            texture->fine_request_frame_ = frame_;
+        }
+        else if(texture->fine_request_frame_ + eviction_age_ <= frame_){
+            //only drop a level per frame, so that textures shrink gradually as they move away
+            size_t size = texture->dropLevel();
+            texture->gpu_size_ -= size;
+            resident_bytes_ -= size;
+            frame_stats_.dropped_levels++;
+        }
+
+        unsigned int num_levels = texture->getNumLevels();
+        frame_stats_.requested_mips += num_levels - wanted_level;
+        frame_stats_.resident_mips += num_levels - texture->resident_base_level_;
+
+        if(wanted_level < texture->resident_base_level_){
+            wanted_levels.push_back(std::make_pair(texture, wanted_level));
+        }
+    }
+
+    //stream a level per texture per pass, so that the budget is shared between textures rather than spent on the first one
+    size_t streamed = 0;
+    bool progress = true;
+
+    while(progress && (streamed < stream_budget_bytes_ || frame_stats_.streamed_levels == 0)){
+        progress = false;
+
+        for(auto& wanted : wanted_levels){
+            Texture* texture = wanted.first;
+
+            if(!texture->resident_ || texture->resident_base_level_ <= wanted.second){
+                continue;
+            }
+
+            size_t size = texture->processed_data_->levels[texture->resident_base_level_ - 1].data.size();
+            if(streamed + size > stream_budget_bytes_ && frame_stats_.streamed_levels > 0){
+                continue;
+            }
+
+            makeRoom(size);
+            if(!texture->resident_ || (budget_bytes_ != 0 && resident_bytes_ + size > budget_bytes_)){
+                continue;
+            }
+
+            texture->streamLevel();
+            texture->gpu_size_ += size;
+            resident_bytes_ += size;
+
+            streamed += size;
+            frame_stats_.streamed_levels++;
+            frame_stats_.streamed_bytes += size;
+            progress = true;
+        }
+    }
+}
+
+Texture* TextureManager::addTexture(std::unique_ptr<Texture>&& texture, TextureReloadFunction reload_function){
+    texture->manager_ = this;
+    texture->reload_function_ = reload_function;
+    texture->gpu_size_ = texture->calculateGPUSize();
+
+    //textures are constructed with the index of the next slot as their id
+    TextureHandle handle = textures_.nextHandle();
+    assert(texture->id_ == handle.index);
+    texture->generation_ = handle.generation;
+
+    texture_lexical_names_[texture->getNameId()] = handle;
+    textures_.insert(std::move(texture));
+
+    return textures_.get(handle);
+}
+
+Texture* TextureManager::createTexture(const std::string& lexical_name, std::unique_ptr<char[]>&& texture_data, int w, TextureOptions options,
+                                       TextureReloadFunction reload_function){
+    if(texture_lexical_names_.find(StringId(lexical_name)) != texture_lexical_names_.end()){
+        std::cerr << "Error: Texture lexical names must not be duplicate" << std::endl;
+        return nullptr;
+    }
+
+    if(texture_data == nullptr || w <= 0){
+        std::cerr << "Error: Texture data must not be empty" << std::endl;
+        return nullptr;
+    }
+
+    std::uint32_t id = textures_.nextHandle().index;
+    std::unique_ptr<Texture> texture(new Texture(lexical_name, id, std::move(texture_data), w, options));
+
+    return addTexture(std::move(texture), reload_function);
+}
+
+Texture* TextureManager::createTexture(const std::string& lexical_name, std::unique_ptr<char[]>&& texture_data, int w, int h, TextureOptions options,
+                                       TextureReloadFunction reload_function){
+    if(texture_lexical_names_.find(StringId(lexical_name)) != texture_lexical_names_.end()){
+        std::cerr << "Error: Texture lexical names must not be duplicate" << std::endl;
+        return nullptr;
+    }
+
+    if(texture_data == nullptr || w <= 0 || h <= 0){
+        std::cerr << "Error: Texture data must not be empty" << std::endl;
+        return nullptr;
+    }
+
+    std::uint32_t id = textures_.nextHandle().index;
+    std::unique_ptr<Texture> texture(new Texture(lexical_name, id, std::move(texture_data), w, h, options));
+
+    return addTexture(std::move(texture), reload_function);
+}
+
+Texture* TextureManager::createTexture(const std::string& lexical_name, std::unique_ptr<char[]>&& texture_data, int w, int h, int d, TextureOptions options,
+                                       TextureReloadFunction reload_function){
+    if(texture_lexical_names_.find(StringId(lexical_name)) != texture_lexical_names_.end()){
+        std::cerr << "Error: Texture lexical names must not be duplicate" << std::endl;
+        return nullptr;
+    }
+
+    if(texture_data == nullptr || w <= 0 || h <= 0 || d <= 0){
+        std::cerr << "Error: Texture data must not be empty" << std::endl;
+        return nullptr;
+    }
+
+    std::uint32_t id = textures_.nextHandle().index;
+    std::unique_ptr<Texture> texture(new Texture(lexical_name, id, std::move(texture_data), w, h, d, options));
+
+    return addTexture(std::move(texture), reload_function);
+}
+
+Texture* TextureManager::createTexture(const std::string& lexical_name, ProcessedTexture&& processed_data, TextureOptions options){
+    if(texture_lexical_names_.find(StringId(lexical_name)) != texture_lexical_names_.end()){
+        std::cerr << "Error: Texture lexical names must not be duplicate" << std::endl;
+        return nullptr;
+    }
+
+    if(processed_data.levels.empty()){
+        std::cerr << "Error: Texture data must not be empty" << std::endl;
+        return nullptr;
+    }
+
+    std::unique_ptr<ProcessedTexture> data(new ProcessedTexture(std::move(processed_data)));
+
+    std::uint32_t id = textures_.nextHandle().index;
+    std::unique_ptr<Texture> texture(new Texture(lexical_name, id, std::move(data), "", options));
+
+    return addTexture(std::move(texture), nullptr);
+}
+
+Texture* TextureManager::createTextureFromFile(const std::string& lexical_name, const std::string& filename, TextureOptions options){
+    if(texture_lexical_names_.find(StringId(lexical_name)) != texture_lexical_names_.end()){
+        std::cerr << "Error: Texture lexical names must not be duplicate" << std::endl;
+        return nullptr;
+    }
+
+    std::unique_ptr<ProcessedTexture> data(new ProcessedTexture());
+    if(!readTextureFile(filename, *data)){
+        return nullptr;
+    }
+
+    std::uint32_t id = textures_.nextHandle().index;
+    std::unique_ptr<Texture> texture(new Texture(lexical_name, id, std::move(data), filename, options));
+
+    return addTexture(std::move(texture), nullptr);
+}
+
+Texture* TextureManager::createTextureAsync(const std::string& lexical_name, const TextureLayout& layout, TextureFillFunction fill, TextureOptions options){
+    if(texture_lexical_names_.find(StringId(lexical_name)) != texture_lexical_names_.end()){
+        std::cerr << "Error: Texture lexical names must not be duplicate" << std::endl;
+        return nullptr;
+    }
+
+    unsigned int max_levels = 1;
+    while(std::max(layout.width, layout.height) >> max_levels > 0){
+        max_levels++;
+    }
+
+    if(!fill || layout.width == 0 || layout.height == 0 || layout.num_levels == 0 || layout.num_levels > max_levels){
+        std::cerr << "Error: Texture data must not be empty" << std::endl;
+        return nullptr;
+    }
+
+    std::uint32_t id = textures_.nextHandle().index;
+    std::unique_ptr<Texture> texture(new Texture(lexical_name, id, layout, fill, uploader_.get(), options));
+
+    return addTexture(std::move(texture), nullptr);
+}
+
+bool TextureManager::createAtlas(const std::string& lexical_name, TextureAtlasBuilder& builder, TextureOptions options){
+    auto& pages = builder.pages();
+    auto& regions = builder.regions();
+
+    if(pages.empty()){
+        std::cerr << "Error: Texture atlas " << lexical_name << " has not been built" << std::endl;
+        return false;
+    }
+
+    std::vector<std::string> page_names;
+    for(size_t i = 0; i < pages.size(); ++i){
+        page_names.push_back(lexical_name + "#" + std::to_string(i));
+    }
+
+    std::vector<std::string> names(page_names);
+    for(auto& region : regions){
+        names.push_back(region.name);
+    }
+
+    std::sort(names.begin(), names.end());
+    for(size_t i = 0; i < names.size(); ++i){
+        if(texture_lexical_names_.find(StringId(names[i])) != texture_lexical_names_.end() || (i > 0 && names[i] == names[i - 1])){
+            std::cerr << "Error: Texture lexical names must not be duplicate" << std::endl;
+            return false;
+        }
+    }
+
+    options.channels = 4;
+
+    std::vector<Texture*> page_textures;
+    for(size_t i = 0; i < pages.size(); ++i){
+        AtlasPage& page = pages[i];
+
+        std::unique_ptr<char[]> data(new char[page.pixels.size()]);
+        std::memcpy(data.get(), page.pixels.data(), page.pixels.size());
+        std::vector<unsigned char>().swap(page.pixels);
+
+        std::uint32_t id = textures_.nextHandle().index;
+        std::unique_ptr<Texture> texture;
+
+        if(builder.mode() == ATLAS_PACK_ARRAY){
+            texture.reset(new Texture(page_names[i], id, std::move(data), page.width, page.height, page.layers, options));
+            texture->layered_ = true;
+        }
+        else{
+            texture.reset(new Texture(page_names[i], id, std::move(data), page.width, page.height, options));
+        }
+
+        page_textures.push_back(addTexture(std::move(texture), nullptr));
+    }
+
+    for(auto& region : regions){
+        std::uint32_t id = textures_.nextHandle().index;
+        std::unique_ptr<Texture> texture(new Texture(region.name, id, page_textures[region.page], region));
+
+        addTexture(std::move(texture), nullptr);
+    }
+
+    return true;
+}
+
+Texture* TextureManager::getTexture(const std::uint64_t& id){
+    return textures_.get(TextureHandle::unpack(id));
+}
+
+Texture* TextureManager::getTexture(TextureHandle handle){
+    return textures_.get(handle);
+}
+
+Texture* TextureManager::getTexture(const std::string& lexical_name){
+    return getTexture(lexical_name.c_str());
+}
+
+Texture* TextureManager::getTexture(const char* lexical_name){
+    Texture* texture = getTexture(StringId(lexical_name));
+
+    //names are keyed by their hash alone, so a name hashing the same as that of another texture would find it
+    if(texture != nullptr && texture->getLexicalName() != lexical_name){
+        return nullptr;
+    }
+
+    return texture;
+}
+
+Texture* TextureManager::getTexture(StringId lexical_name){
+    auto iter = texture_lexical_names_.find(lexical_name);
+    if(iter != texture_lexical_names_.end()){
+        return textures_.get(iter->second);
+    }
+    else{
+        return nullptr;
+    }
+}
+
+bool TextureManager::freeTexture(const std::uint64_t& id){
+    return freeTexture(TextureHandle::unpack(id));
+}
+
+bool TextureManager::freeTexture(TextureHandle handle){
+    Texture* texture = textures_.get(handle);
+    if(texture == nullptr){
+        return false;
+    }
+
+    if(texture->region_count_ > 0){
+        std::cerr << "Error: Texture atlas pages can only be freed after all of their regions" << std::endl;
+        return false;
+    }
+
+    if(texture->atlas_ != nullptr){
+        texture->atlas_->region_count_--;
+    }
+
+    if(texture->upload_pending_){
+        uploader_->cancel(texture);
+    }
+
+    //the GL texture stays alive with the texture until it is destroyed, only the residency bookkeeping goes now
+    if(texture->resident_){
+        lru_.erase(texture->lru_position_);
+        texture->resident_ = false;
+        resident_bytes_ -= texture->gpu_size_;
+    }
+
+    texture_lexical_names_.erase(texture->getNameId());
+    freed_textures_.push_back(std::make_pair(frame_, textures_.remove(handle)));
+
+    return true;
+}
+
+void TextureManager::makeRoom(size_t bytes){
+    if(budget_bytes_ == 0){
+        return;
+    }
+
+    //walks from the least recently used texture, next being the one after the texture looked at, which eviction leaves valid
+    auto next = lru_.end();
+    while(resident_bytes_ + bytes > budget_bytes_ && next != lru_.begin()){
+        auto iter = std::prev(next);
+        Texture* texture = *iter;
+
+        //the list is ordered by use, so every texture from here on has been used recently as well
+        if(texture->last_used_frame_ + eviction_age_ > frame_){
+            break;
+        }
+
+        if(texture->isReloadable()){
+            evict(texture);
+            frame_stats_.evictions++;
+        }
+        else{
+            next = iter;
+        }
+    }
+}
+
+void TextureManager::textureUsed(Texture* texture, bool uploaded, bool reloaded){
+    texture->last_used_frame_ = frame_;
+
+    if(texture->resident_){
+        lru_.splice(lru_.begin(), lru_, texture->lru_position_);
+    }
+    else{
+        lru_.push_front(texture);
+        texture->lru_position_ = lru_.begin();
+        texture->resident_ = true;
+        resident_bytes_ += texture->gpu_size_;
+    }
+
+    if(uploaded){
+        frame_stats_.uploads++;
+    }
+
+    if(reloaded){
+        frame_stats_.reloads++;
+    }
+}
+
+void TextureManager::evict(Texture* texture){
+    lru_.erase(texture->lru_position_);
+    texture->resident_ = false;
+    resident_bytes_ -= texture->gpu_size_;
+
+    texture->evict();
+}
+
+void TextureManager::setBudget(size_t bytes){
+    budget_bytes_ = bytes;
+}
+
+size_t TextureManager::getBudget(){
+    return budget_bytes_;
+}
+
+void TextureManager::setEvictionAge(unsigned int frames){
+    eviction_age_ = frames;
+}
+
+void TextureManager::setStreamingBudget(size_t bytes){
+    stream_budget_bytes_ = bytes;
+}
+
+void TextureManager::setStreamingTailSize(unsigned int size){
+    stream_tail_size_ = size;
+}
+
+TextureUploader* TextureManager::uploader(){
+    return uploader_.get();
+}
+
+TextureStats TextureManager::getStats(){
+    return last_frame_stats_;
+}
@@ -0,0 +1,265 @@
+#ifndef TEXTUREMANAGER_H
+#define TEXTUREMANAGER_H
+
+#include <memory>
+#include <unordered_map>
+#include <list>
+#include <deque>
+#include <string>
+
+#include "texture.h"
+#include "textureuploader.h"
+
+/**
+ * @brief The TextureStats struct holds the residency statistics of the TextureManager. The per frame counters are those of the last completed frame.
+ */
+struct TextureStats{
+    size_t resident_bytes;
+    size_t budget_bytes;
+    unsigned int resident_textures;
+    unsigned int total_textures;
+    unsigned int uploads;
+    unsigned int reloads;
+    unsigned int evictions;
+
+    //mip streaming. The mip counts are summed over all resident streamed textures, counting the levels from the finest one requested or
+    //resident down to the last one
+    unsigned int requested_mips;
+    unsigned int resident_mips;
+    unsigned int streamed_levels;
+    unsigned int dropped_levels;
+    size_t streamed_bytes;
+
+    TextureStats() : resident_bytes(0), budget_bytes(0), resident_textures(0), total_textures(0), uploads(0), reloads(0), evictions(0),
+                     requested_mips(0), resident_mips(0), streamed_levels(0), dropped_levels(0), streamed_bytes(0){
+    }
+};
+
+/**
+ * @brief The TextureManager class owns all textures, and keeps the GPU memory used by them within a budget. Textures are uploaded when they are first used,
+ * and when the budget is exceeded, the least recently used textures which have not been used for a number of frames are evicted from the GPU. Evicted
+ * textures are uploaded again the next time they are used, either from their cached data, or from their reload function.
+ */
+class TextureManager
+{
+friend class ResourceManager;
+friend class Texture;
+private:
+    ResourcePool<Texture> textures_;
+    std::unordered_map<StringId, TextureHandle> texture_lexical_names_;
+
+    //freed textures, with the frame they were freed in, whose GL textures are deleted once no frame in flight may use them
+    std::deque<std::pair<std::uint64_t, std::unique_ptr<Texture> > > freed_textures_;
+
+    //resident textures, with the most recently used at the front
+    std::list<Texture*> lru_;
+
+    size_t budget_bytes_;
+    size_t resident_bytes_;
+    unsigned int eviction_age_;
+    std::uint64_t frame_;
+
+    size_t stream_budget_bytes_;
+    unsigned int stream_tail_size_;
+
+    TextureStats frame_stats_;
+    TextureStats last_frame_stats_;
+
+    std::unique_ptr<TextureUploader> uploader_;
+
+private:
+    //only constructable by the ResourceManager, the uploader fills its pixel buffers on the workers of \p loader
+    TextureManager(AsyncLoader* loader);
+
+    //evicts textures which are over budget and closes off the statistics of the frame, called once per frame by the ResourceManager
+    void frame();
+
+    //streams in the mip levels requested by the renderer during the last frame within the streaming budget, and drops the levels which have
+    //not been needed for eviction_age_ frames
+    void streamMips();
+
+    //helper for the createTexture functions
+    Texture* addTexture(std::unique_ptr<Texture>&& texture, TextureReloadFunction reload_function);
+
+    //evicts least recently used textures until \p bytes fit within the budget. Textures used within the last eviction_age_ frames are never evicted,
+    //so the budget may still be exceeded afterwards
+    void makeRoom(size_t bytes);
+
+    //called by textures whenever their name is requested
+    void textureUsed(Texture* texture, bool uploaded, bool reloaded);
+
+    //removes a texture from the lru list and frees its GPU copy
+    void evict(Texture* texture);
+
+public:
+    //no copy allowed
+    TextureManager(const TextureManager& other) = delete;
+    TextureManager& operator = (const TextureManager& other) = delete;
+    ~TextureManager();
+
+    /**
+     * @brief Creates a 1D texture with the specified lexical name. The texture is uploaded to the GPU the first time it is used.
+     * @param lexical_name The lexical name of the texture. NB: This should be unique! as it is used for lookup purposes.
+     * @param texture_data Raw texture data, with options.channels bytes per texel
+     * @param w Width of the texture
+     * @param options Options of the texture
+     * @param reload_function Function used to reproduce the texture data after it has been evicted, should the data not be cached. Textures without
+     * cached data or a reload function are never evicted.
+     * @return observer pointer to the created texture, or nullptr if it could not be created
+     */
+    Texture* createTexture(const std::string& lexical_name, std::unique_ptr<char[]>&& texture_data, int w, TextureOptions options = TextureOptions(),
+                           TextureReloadFunction reload_function = nullptr);
+
+    /**
+     * @brief Creates a 2D texture with the specified lexical name. See the 1D overload for details.
+     */
+    Texture* createTexture(const std::string& lexical_name, std::unique_ptr<char[]>&& texture_data, int w, int h, TextureOptions options = TextureOptions(),
+                           TextureReloadFunction reload_function = nullptr);
+
+    /**
+     * @brief Creates a 3D texture with the specified lexical name. See the 1D overload for details.
+     */
+    Texture* createTexture(const std::string& lexical_name, std::unique_ptr<char[]>&& texture_data, int w, int h, int d, TextureOptions options = TextureOptions(),
+                           TextureReloadFunction reload_function = nullptr);
+
+    /**
+     * @brief Creates a 2D texture from pre-processed data, see processTexture(). Every level of the data is uploaded as is, so compressed
+     * formats stay compressed on the GPU and no mipmaps are generated on upload. As there is no file to reload from, the texture is only
+     * evicted if its data is cached.
+     * @param lexical_name The lexical name of the texture. NB: This should be unique! as it is used for lookup purposes.
+     * @param processed_data Processed texture data, with at least one level
+     * @param options Options of the texture, the channels are taken from \p processed_data
+     * @return observer pointer to the created texture, or nullptr if it could not be created
+     */
+    Texture* createTexture(const std::string& lexical_name, ProcessedTexture&& processed_data, TextureOptions options = TextureOptions());
+
+    /**
+     * @brief Creates a 2D texture from a texture file written by writeTextureFile(). After eviction, the texture is reloaded from the file.
+     * @param lexical_name The lexical name of the texture. NB: This should be unique! as it is used for lookup purposes.
+     * @param filename Name of the texture file
+     * @param options Options of the texture, the channels are taken from the file
+     * @return observer pointer to the created texture, or nullptr if it could not be created
+     */
+    Texture* createTextureFromFile(const std::string& lexical_name, const std::string& filename, TextureOptions options = TextureOptions());
+
+    /**
+     * @brief Creates a 2D texture whose data is uploaded through the pixel buffers of the TextureUploader. The upload starts the first time the texture
+     * is used, and its data is produced by \p fill on worker threads, a chunk of rows at a time. Until every level has been uploaded, which takes at
+     * least a frame, Texture::getTextureName() returns 0. After eviction the texture is uploaded again, provided its data is cached, in which case
+     * \p fill is kept around to produce it.
+     * @param lexical_name The lexical name of the texture. NB: This should be unique! as it is used for lookup purposes.
+     * @param layout Format and mip chain of the texture
+     * @param fill Function producing the data of the texture, see TextureFillFunction
+     * @param options Options of the texture, the channels are taken from \p layout and mips are never streamed
+     * @return observer pointer to the created texture, or nullptr if it could not be created
+     */
+    Texture* createTextureAsync(const std::string& lexical_name, const TextureLayout& layout, TextureFillFunction fill,
+                                TextureOptions options = TextureOptions());
+
+    /**
+     * @brief Creates textures from an atlas built by \p builder. Every page becomes a 2D texture, or a 2D array texture for ATLAS_PACK_ARRAY
+     * atlases, named \p lexical_name followed by '#' and the index of the page. Every image of the atlas becomes a region texture named after the
+     * image, which binds the texture of its page, see Texture::getAtlas(). Pages can only be freed after all of their regions.
+     * @param lexical_name The lexical name prefix of the pages
+     * @param builder Builder of the atlas, its pages are moved from
+     * @param options Options of the pages
+     * @return true if succeeded, false if the atlas has not been built or any of the names are taken, in which case no textures are created
+     */
+    bool createAtlas(const std::string& lexical_name, TextureAtlasBuilder& builder, TextureOptions options = TextureOptions());
+
+    /**
+     * @brief Gets the texture with the specified \p id
+     * @param id ID of the texture
+     * @return observer pointer to the texture, or nullptr if not found or freed
+     */
+    Texture* getTexture(const std::uint64_t& id);
+
+    /**
+     * @brief Gets the texture referred to by \p handle
+     * @param handle Handle of the texture
+     * @return observer pointer to the texture, or nullptr if it has been freed
+     */
+    Texture* getTexture(TextureHandle handle);
+
+    /**
+     * @brief Gets the texture with the specified \p lexical_name
+     * @param lexical_name Lexical name of the texture
+     * @return observer pointer to the texture, or nullptr if not found
+     */
+    Texture* getTexture(const std::string& lexical_name);
+
+    /**
+     * @brief Gets the texture with the specified \p lexical_name, hashing the name without copying it into a string
+     * @param lexical_name Lexical name of the texture
+     * @return observer pointer to the texture requested, or nullptr if not found
+     */
+    Texture* getTexture(const char* lexical_name);
+
+    /**
+     * @brief Gets the texture with the specified \p lexical_name, without hashing the name, e.g. getTexture("grass"_sid). The id is not checked
+     * against the lexical name of the texture found, see StringId::intern() for collisions between names
+     * @param lexical_name Id of the lexical name of the texture
+     * @return observer pointer to the texture, or nullptr if not found
+     */
+    Texture* getTexture(StringId lexical_name);
+
+    /**
+     * @brief Deallocates the texture with the specified \p id from both CPU and GPU. The texture is removed immediately, but its GL texture is only
+     * deleted RESOURCE_FREE_DELAY_FRAMES frames later, once no frame in flight may still use it.
+     * @param id ID of the texture to deallocate
+     * @return true if succeeded, false if the texture was not found, or is an atlas page which still has regions
+     */
+    bool freeTexture(const std::uint64_t& id);
+
+    /**
+     * @brief Deallocates the texture referred to by \p handle, see the overload taking an id
+     * @param handle Handle of the texture to deallocate
+     * @return true if succeeded, false if the texture has already been freed, or is an atlas page which still has regions
+     */
+    bool freeTexture(TextureHandle handle);
+
+    /**
+     * @brief Sets the amount of GPU memory textures may use. Textures are evicted at the end of every frame, and before uploads, until the budget is met.
+     * @param bytes Budget in bytes, 0 for no limit. Default is 0.
+     */
+    void setBudget(size_t bytes);
+
+    /**
+     * @brief Gets the GPU memory budget for textures
+     * @return budget in bytes, 0 if there is no limit
+     */
+    size_t getBudget();
+
+    /**
+     * @brief Sets the number of frames a texture has to go unused before it may be evicted
+     * @param frames Number of frames. Default is 2.
+     */
+    void setEvictionAge(unsigned int frames);
+
+    /**
+     * @brief Sets the amount of mip level data streamed to the GPU per frame. At least one level is streamed per frame if any are requested.
+     * @param bytes Budget in bytes. Default is 4 MB.
+     */
+    void setStreamingBudget(size_t bytes);
+
+    /**
+     * @brief Sets the size of the levels streamed textures start out with. All levels whose width and height are at most \p size are uploaded when a
+     * streamed texture is first used, and are never dropped.
+     * @param size Size in texels. Default is 64.
+     */
+    void setStreamingTailSize(unsigned int size);
+
+    /**
+     * @brief Gets the uploader used by textures created through createTextureAsync(), to configure it or query its statistics
+     * @return observer pointer to the uploader
+     */
+    TextureUploader* uploader();
+
+    /**
+     * @brief Gets the residency statistics of the textures. The per frame counters are those of the last completed frame.
+     * @return statistics of the textures
+     */
+    TextureStats getStats();
+};
+
+#endif // TEXTUREMANAGER_H
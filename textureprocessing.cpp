@@ -0,0 +1,708 @@
+#include "textureprocessing.h"
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <functional>
+#include <thread>
+#include <limits>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+//4 channel texel in linear space. Every image is filtered as RGBA, with missing channels being 0 (1 for alpha)
+struct LinearTexel{
+    float c[4];
+};
+
+struct LinearImage{
+    unsigned int width;
+    unsigned int height;
+    std::vector<LinearTexel> texels;
+};
+
+//lookup tables between 8 bit sRGB and linear values
+struct SRGBTables{
+    float to_linear[256];
+    unsigned char to_srgb[4096];
+
+    SRGBTables(){
+        for(int i = 0; i < 256; ++i){
+            float v = (float)i / 255.f;
+            to_linear[i] = v <= 0.04045f ? v / 12.92f : std::pow((v + 0.055f) / 1.055f, 2.4f);
+        }
+
+        for(int i = 0; i < 4096; ++i){
+            float v = (float)i / 4095.f;
+            float s = v <= 0.0031308f ? v * 12.92f : 1.055f * std::pow(v, 1.f / 2.4f) - 0.055f;
+            to_srgb[i] = (unsigned char)std::min(255.f, std::max(0.f, s * 255.f + 0.5f));
+        }
+    }
+};
+
+const SRGBTables& srgbTables(){
+    static SRGBTables tables;
+    return tables;
+}
+
+//splits [0, count) into chunks run on up to threads + 1 threads, including the calling one
+void parallelFor(unsigned int count, unsigned int threads, const std::function<void(unsigned int, unsigned int)>& body){
+    unsigned int chunks = std::min(count, threads + 1);
+    if(chunks <= 1){
+        body(0, count);
+        return;
+    }
+
+    std::vector<std::thread> workers;
+    unsigned int chunk_size = (count + chunks - 1) / chunks;
+
+    for(unsigned int begin = chunk_size; begin < count; begin += chunk_size){
+        workers.push_back(std::thread(body, begin, std::min(count, begin + chunk_size)));
+    }
+
+    body(0, std::min(count, chunk_size));
+
+    for(auto& worker : workers){
+        worker.join();
+    }
+}
+
+//dst += src * weight, on all 4 channels at once
+inline void accumulateTexel(LinearTexel& dst, const LinearTexel& src, float weight){
+#ifdef __SSE2__
+    _mm_storeu_ps(dst.c, _mm_add_ps(_mm_loadu_ps(dst.c), _mm_mul_ps(_mm_loadu_ps(src.c), _mm_set1_ps(weight))));
+#else
+    for(int i = 0; i < 4; ++i){
+        dst.c[i] += src.c[i] * weight;
+    }
+#endif
+}
+
+//averages 4 texels
+inline LinearTexel averageTexels(const LinearTexel& a, const LinearTexel& b, const LinearTexel& c, const LinearTexel& d){
+    LinearTexel out;
+#ifdef __SSE2__
+    __m128 sum = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(a.c), _mm_loadu_ps(b.c)), _mm_add_ps(_mm_loadu_ps(c.c), _mm_loadu_ps(d.c)));
+    _mm_storeu_ps(out.c, _mm_mul_ps(sum, _mm_set1_ps(0.25f)));
+#else
+    for(int i = 0; i < 4; ++i){
+        out.c[i] = (a.c[i] + b.c[i] + c.c[i] + d.c[i]) * 0.25f;
+    }
+#endif
+    return out;
+}
+
+//checks whether the given channel of an image with the given channel count holds colour, as opposed to alpha
+bool isColourChannel(unsigned int channel, unsigned int channels){
+    return !(channels == 4 && channel == 3);
+}
+
+LinearImage toLinear(const unsigned char* pixels, unsigned int width, unsigned int height, unsigned int channels, bool srgb){
+    const SRGBTables& tables = srgbTables();
+
+    LinearImage image;
+    image.width = width;
+    image.height = height;
+    image.texels.resize((size_t)width * height);
+
+    for(size_t i = 0; i < image.texels.size(); ++i){
+        LinearTexel& texel = image.texels[i];
+        texel.c[0] = texel.c[1] = texel.c[2] = 0.f;
+        texel.c[3] = 1.f;
+
+        for(unsigned int c = 0; c < channels; ++c){
+            unsigned char value = pixels[i * channels + c];
+            texel.c[c] = srgb && isColourChannel(c, channels) ? tables.to_linear[value] : (float)value / 255.f;
+        }
+    }
+
+    return image;
+}
+
+//converts the image back to 8 bits per channel, keeping out_channels channels
+std::vector<unsigned char> toBytes(const LinearImage& image, unsigned int channels, unsigned int out_channels, bool srgb){
+    const SRGBTables& tables = srgbTables();
+
+    std::vector<unsigned char> bytes(image.texels.size() * out_channels);
+
+    for(size_t i = 0; i < image.texels.size(); ++i){
+        for(unsigned int c = 0; c < out_channels; ++c){
+            float value = std::min(1.f, std::max(0.f, image.texels[i].c[c]));
+
+            if(srgb && isColourChannel(c, channels)){
+                bytes[i * out_channels + c] = tables.to_srgb[(int)(value * 4095.f + 0.5f)];
+            }
+            else{
+                bytes[i * out_channels + c] = (unsigned char)(value * 255.f + 0.5f);
+            }
+        }
+    }
+
+    return bytes;
+}
+
+LinearImage downsampleBox(const LinearImage& src, unsigned int threads){
+    LinearImage dst;
+    dst.width = std::max(1u, src.width / 2);
+    dst.height = std::max(1u, src.height / 2);
+    dst.texels.resize((size_t)dst.width * dst.height);
+
+    parallelFor(dst.height, threads, [&](unsigned int begin, unsigned int end){
+        for(unsigned int y = begin; y < end; ++y){
+            unsigned int y0 = std::min(y * 2, src.height - 1);
+            unsigned int y1 = std::min(y * 2 + 1, src.height - 1);
+            const LinearTexel* row0 = &src.texels[(size_t)y0 * src.width];
+            const LinearTexel* row1 = &src.texels[(size_t)y1 * src.width];
+
+            for(unsigned int x = 0; x < dst.width; ++x){
+                unsigned int x0 = std::min(x * 2, src.width - 1);
+                unsigned int x1 = std::min(x * 2 + 1, src.width - 1);
+
+                dst.texels[(size_t)y * dst.width + x] = averageTexels(row0[x0], row0[x1], row1[x0], row1[x1]);
+            }
+        }
+    });
+
+    return dst;
+}
+
+//zeroth order modified bessel function of the first kind, used by the kaiser window
+float besselI0(float x){
+    float sum = 1.f;
+    float term = 1.f;
+    float half_x = x / 2.f;
+
+    for(int k = 1; k < 20; ++k){
+        term *= (half_x / k) * (half_x / k);
+        sum += term;
+    }
+
+    return sum;
+}
+
+const int KAISER_TAPS = 6;
+
+//weights of a kaiser windowed sinc for halving an image. The destination texel i is centered between source texels 2i and 2i + 1, so the taps
+//cover source texels 2i - 2 to 2i + 3
+struct KaiserKernel{
+    float weights[KAISER_TAPS];
+
+    KaiserKernel(){
+        const float radius = 3.f;
+        const float beta = 4.f;
+        float total = 0.f;
+
+        for(int tap = 0; tap < KAISER_TAPS; ++tap){
+            float x = (float)tap - 2.5f;
+            float sinc_x = 3.14159265f * x / 2.f;
+            float sinc = std::sin(sinc_x) / sinc_x;
+            float window_x = x / radius;
+            float window = besselI0(beta * std::sqrt(std::max(0.f, 1.f - window_x * window_x))) / besselI0(beta);
+
+            weights[tap] = sinc * window;
+            total += weights[tap];
+        }
+
+        for(int tap = 0; tap < KAISER_TAPS; ++tap){
+            weights[tap] /= total;
+        }
+    }
+};
+
+LinearImage downsampleKaiser(const LinearImage& src, unsigned int threads){
+    static const KaiserKernel kernel;
+
+    //horizontal pass
+    LinearImage half;
+    half.width = std::max(1u, src.width / 2);
+    half.height = src.height;
+    half.texels.resize((size_t)half.width * half.height);
+
+    parallelFor(half.height, threads, [&](unsigned int begin, unsigned int end){
+        for(unsigned int y = begin; y < end; ++y){
+            const LinearTexel* row = &src.texels[(size_t)y * src.width];
+
+            for(unsigned int x = 0; x < half.width; ++x){
+                LinearTexel sum = {{0.f, 0.f, 0.f, 0.f}};
+
+                for(int tap = 0; tap < KAISER_TAPS; ++tap){
+                    int sx = std::min(std::max((int)x * 2 - 2 + tap, 0), (int)src.width - 1);
+                    accumulateTexel(sum, row[sx], kernel.weights[tap]);
+                }
+
+                half.texels[(size_t)y * half.width + x] = sum;
+            }
+        }
+    });
+
+    //vertical pass
+    LinearImage dst;
+    dst.width = half.width;
+    dst.height = std::max(1u, src.height / 2);
+    dst.texels.resize((size_t)dst.width * dst.height);
+
+    parallelFor(dst.height, threads, [&](unsigned int begin, unsigned int end){
+        for(unsigned int y = begin; y < end; ++y){
+            LinearTexel* out_row = &dst.texels[(size_t)y * dst.width];
+
+            for(unsigned int x = 0; x < dst.width; ++x){
+                out_row[x].c[0] = out_row[x].c[1] = out_row[x].c[2] = out_row[x].c[3] = 0.f;
+            }
+
+            for(int tap = 0; tap < KAISER_TAPS; ++tap){
+                int sy = std::min(std::max((int)y * 2 - 2 + tap, 0), (int)half.height - 1);
+                const LinearTexel* in_row = &half.texels[(size_t)sy * half.width];
+
+                for(unsigned int x = 0; x < dst.width; ++x){
+                    accumulateTexel(out_row[x], in_row[x], kernel.weights[tap]);
+                }
+            }
+        }
+    });
+
+    return dst;
+}
+
+std::vector<LinearImage> buildLinearChain(const unsigned char* pixels, unsigned int width, unsigned int height, unsigned int channels, bool srgb,
+                                          MipFilter filter, bool generate_mips, unsigned int threads){
+    std::vector<LinearImage> chain;
+    chain.push_back(toLinear(pixels, width, height, channels, srgb));
+
+    while(generate_mips && (chain.back().width > 1 || chain.back().height > 1)){
+        if(filter == MIP_FILTER_KAISER){
+            chain.push_back(downsampleKaiser(chain.back(), threads));
+        }
+        else{
+            chain.push_back(downsampleBox(chain.back(), threads));
+        }
+    }
+
+    return chain;
+}
+
+std::vector<TextureLevelData> generateMipChain(const unsigned char* pixels, unsigned int width, unsigned int height, unsigned int channels, bool srgb,
+                                               MipFilter filter){
+    std::vector<TextureLevelData> levels;
+    if(pixels == nullptr || width == 0 || height == 0 || channels < 1 || channels > 4){
+        return levels;
+    }
+
+    auto chain = buildLinearChain(pixels, width, height, channels, srgb, filter, true, 0);
+
+    for(auto& image : chain){
+        TextureLevelData level;
+        level.width = image.width;
+        level.height = image.height;
+        level.data = toBytes(image, channels, channels, srgb);
+        levels.push_back(std::move(level));
+    }
+
+    return levels;
+}
+
+size_t textureLevelSize(TextureFormat format, unsigned int width, unsigned int height, unsigned int channels){
+    size_t blocks = (size_t)((width + 3) / 4) * ((height + 3) / 4);
+
+    switch(format){
+        case TEXTURE_FORMAT_RAW: return (size_t)width * height * channels;
+        case TEXTURE_FORMAT_BC1:
+        case TEXTURE_FORMAT_BC4: return blocks * 8;
+        default: return blocks * 16;
+    }
+}
+
+//block encoders, all operating on a 4x4 block of RGBA8 texels
+
+//writes bits to a 128 bit block, least significant bit first
+struct BlockBitWriter{
+    unsigned char* out;
+    unsigned int position;
+
+    BlockBitWriter(unsigned char* block) : out(block), position(0){
+        std::memset(out, 0, 16);
+    }
+
+    void write(unsigned int value, unsigned int bits){
+        for(unsigned int i = 0; i < bits; ++i, ++position){
+            if(value & (1u << i)){
+                out[position / 8] |= (unsigned char)(1u << (position % 8));
+            }
+        }
+    }
+};
+
+//finds the principal axis of the first dims channels of the block, and the extremes of the block along it
+void fitBlockLine(const unsigned char* block, int dims, float start[4], float end[4]){
+    float mean[4] = {0.f, 0.f, 0.f, 0.f};
+    float min_value[4] = {255.f, 255.f, 255.f, 255.f};
+    float max_value[4] = {0.f, 0.f, 0.f, 0.f};
+
+    for(int i = 0; i < 16; ++i){
+        for(int c = 0; c < dims; ++c){
+            float value = block[i * 4 + c];
+            mean[c] += value / 16.f;
+            min_value[c] = std::min(min_value[c], value);
+            max_value[c] = std::max(max_value[c], value);
+        }
+    }
+
+    float covariance[4][4] = {};
+    for(int i = 0; i < 16; ++i){
+        for(int a = 0; a < dims; ++a){
+            for(int b = 0; b < dims; ++b){
+                covariance[a][b] += (block[i * 4 + a] - mean[a]) * (block[i * 4 + b] - mean[b]);
+            }
+        }
+    }
+
+    //power iteration, starting from the diagonal of the bounding box
+    float axis[4] = {0.f, 0.f, 0.f, 0.f};
+    for(int c = 0; c < dims; ++c){
+        axis[c] = max_value[c] - min_value[c];
+    }
+
+    for(int iteration = 0; iteration < 8; ++iteration){
+        float next[4] = {0.f, 0.f, 0.f, 0.f};
+        float length = 0.f;
+
+        for(int a = 0; a < dims; ++a){
+            for(int b = 0; b < dims; ++b){
+                next[a] += covariance[a][b] * axis[b];
+            }
+            length += next[a] * next[a];
+        }
+
+        if(length < 1e-8f){
+            break;
+        }
+
+        length = std::sqrt(length);
+        for(int c = 0; c < dims; ++c){
+            axis[c] = next[c] / length;
+        }
+    }
+
+    float axis_length = 0.f;
+    for(int c = 0; c < dims; ++c){
+        axis_length += axis[c] * axis[c];
+    }
+
+    //flat block, the line degenerates into a point
+    if(axis_length < 1e-8f){
+        for(int c = 0; c < 4; ++c){
+            start[c] = end[c] = c < dims ? mean[c] : 0.f;
+        }
+        return;
+    }
+
+    axis_length = std::sqrt(axis_length);
+
+    float min_t = std::numeric_limits<float>::max();
+    float max_t = std::numeric_limits<float>::lowest();
+    for(int i = 0; i < 16; ++i){
+        float t = 0.f;
+        for(int c = 0; c < dims; ++c){
+            t += (block[i * 4 + c] - mean[c]) * axis[c] / axis_length;
+        }
+        min_t = std::min(min_t, t);
+        max_t = std::max(max_t, t);
+    }
+
+    //inset the endpoints slightly, as the extremes are rarely hit exactly by the interpolated values
+    float inset = (max_t - min_t) / 32.f;
+    min_t += inset;
+    max_t -= inset;
+
+    for(int c = 0; c < 4; ++c){
+        start[c] = c < dims ? std::min(255.f, std::max(0.f, mean[c] + axis[c] / axis_length * min_t)) : 0.f;
+        end[c] = c < dims ? std::min(255.f, std::max(0.f, mean[c] + axis[c] / axis_length * max_t)) : 0.f;
+    }
+}
+
+std::uint16_t packRGB565(const float colour[4]){
+    unsigned int r = (unsigned int)(colour[0] * 31.f / 255.f + 0.5f);
+    unsigned int g = (unsigned int)(colour[1] * 63.f / 255.f + 0.5f);
+    unsigned int b = (unsigned int)(colour[2] * 31.f / 255.f + 0.5f);
+
+    return (std::uint16_t)((r << 11) | (g << 5) | b);
+}
+
+void unpackRGB565(std::uint16_t packed, int colour[3]){
+    int r = (packed >> 11) & 31;
+    int g = (packed >> 5) & 63;
+    int b = packed & 31;
+
+    colour[0] = (r << 3) | (r >> 2);
+    colour[1] = (g << 2) | (g >> 4);
+    colour[2] = (b << 3) | (b >> 2);
+}
+
+void encodeBC1Block(const unsigned char* block, unsigned char* out){
+    float start[4], end[4];
+    fitBlockLine(block, 3, start, end);
+
+    std::uint16_t colour0 = packRGB565(end);
+    std::uint16_t colour1 = packRGB565(start);
+
+    //colour0 must be the larger of the two to select the 4 colour mode
+    if(colour0 < colour1){
+        std::swap(colour0, colour1);
+    }
+
+    std::uint32_t indices = 0;
+
+    if(colour0 != colour1){
+        int palette[4][3];
+        unpackRGB565(colour0, palette[0]);
+        unpackRGB565(colour1, palette[1]);
+
+        for(int c = 0; c < 3; ++c){
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+
+        for(int i = 0; i < 16; ++i){
+            int best_index = 0;
+            int best_error = std::numeric_limits<int>::max();
+
+            for(int p = 0; p < 4; ++p){
+                int error = 0;
+                for(int c = 0; c < 3; ++c){
+                    int diff = (int)block[i * 4 + c] - palette[p][c];
+                    error += diff * diff;
+                }
+
+                if(error < best_error){
+                    best_error = error;
+                    best_index = p;
+                }
+            }
+
+            indices |= (std::uint32_t)best_index << (i * 2);
+        }
+    }
+
+    out[0] = colour0 & 0xff;
+    out[1] = colour0 >> 8;
+    out[2] = colour1 & 0xff;
+    out[3] = colour1 >> 8;
+    for(int i = 0; i < 4; ++i){
+        out[4 + i] = (indices >> (i * 8)) & 0xff;
+    }
+}
+
+//encodes a single channel of the block
+void encodeBC4Block(const unsigned char* block, int channel, unsigned char* out){
+    int min_value = 255;
+    int max_value = 0;
+
+    for(int i = 0; i < 16; ++i){
+        min_value = std::min(min_value, (int)block[i * 4 + channel]);
+        max_value = std::max(max_value, (int)block[i * 4 + channel]);
+    }
+
+    std::uint64_t indices = 0;
+
+    if(min_value != max_value){
+        int palette[8];
+        palette[0] = max_value;
+        palette[1] = min_value;
+        for(int p = 1; p < 7; ++p){
+            palette[p + 1] = ((7 - p) * max_value + p * min_value) / 7;
+        }
+
+        for(int i = 0; i < 16; ++i){
+            int value = block[i * 4 + channel];
+            int best_index = 0;
+            int best_error = std::numeric_limits<int>::max();
+
+            for(int p = 0; p < 8; ++p){
+                int error = std::abs(value - palette[p]);
+                if(error < best_error){
+                    best_error = error;
+                    best_index = p;
+                }
+            }
+
+            indices |= (std::uint64_t)best_index << (i * 3);
+        }
+    }
+
+    out[0] = (unsigned char)max_value;
+    out[1] = (unsigned char)min_value;
+    for(int i = 0; i < 6; ++i){
+        out[2 + i] = (indices >> (i * 8)) & 0xff;
+    }
+}
+
+//encodes the block using BC7 mode 6, a single subset with 7 bit RGBA endpoints, a p-bit per endpoint, and 4 bit indices
+void encodeBC7Block(const unsigned char* block, unsigned char* out){
+    static const int weights[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+    float endpoints[2][4];
+    fitBlockLine(block, 4, endpoints[0], endpoints[1]);
+
+    //quantize the endpoints, picking the p-bit with the lowest error
+    int quantized[2][4];
+    int p_bits[2];
+
+    for(int e = 0; e < 2; ++e){
+        float best_error = std::numeric_limits<float>::max();
+
+        for(int p = 0; p < 2; ++p){
+            int candidate[4];
+            float error = 0.f;
+
+            for(int c = 0; c < 4; ++c){
+                candidate[c] = std::min(127, std::max(0, (int)((endpoints[e][c] - p) / 2.f + 0.5f)));
+                float diff = endpoints[e][c] - (float)((candidate[c] << 1) | p);
+                error += diff * diff;
+            }
+
+            if(error < best_error){
+                best_error = error;
+                p_bits[e] = p;
+                std::memcpy(quantized[e], candidate, sizeof(candidate));
+            }
+        }
+    }
+
+    int palette[16][4];
+    for(int w = 0; w < 16; ++w){
+        for(int c = 0; c < 4; ++c){
+            int e0 = (quantized[0][c] << 1) | p_bits[0];
+            int e1 = (quantized[1][c] << 1) | p_bits[1];
+            palette[w][c] = ((64 - weights[w]) * e0 + weights[w] * e1 + 32) >> 6;
+        }
+    }
+
+    int indices[16];
+    for(int i = 0; i < 16; ++i){
+        int best_error = std::numeric_limits<int>::max();
+
+        for(int w = 0; w < 16; ++w){
+            int error = 0;
+            for(int c = 0; c < 4; ++c){
+                int diff = (int)block[i * 4 + c] - palette[w][c];
+                error += diff * diff;
+            }
+
+            if(error < best_error){
+                best_error = error;
+                indices[i] = w;
+            }
+        }
+    }
+
+    //the most significant bit of the first index is implicit and must be 0, swap the endpoints if it is not
+    if(indices[0] & 8){
+        for(int c = 0; c < 4; ++c){
+            std::swap(quantized[0][c], quantized[1][c]);
+        }
+        std::swap(p_bits[0], p_bits[1]);
+
+        for(int i = 0; i < 16; ++i){
+            indices[i] = 15 - indices[i];
+        }
+    }
+
+    BlockBitWriter writer(out);
+    writer.write(1 << 6, 7);
+
+    for(int c = 0; c < 4; ++c){
+        writer.write(quantized[0][c], 7);
+        writer.write(quantized[1][c], 7);
+    }
+
+    writer.write(p_bits[0], 1);
+    writer.write(p_bits[1], 1);
+
+    writer.write(indices[0], 3);
+    for(int i = 1; i < 16; ++i){
+        writer.write(indices[i], 4);
+    }
+}
+
+//encodes an RGBA8 level into the given block format
+std::vector<unsigned char> encodeLevel(const std::vector<unsigned char>& rgba, unsigned int width, unsigned int height, TextureFormat format, unsigned int threads){
+    unsigned int blocks_x = (width + 3) / 4;
+    unsigned int blocks_y = (height + 3) / 4;
+    size_t block_size = (format == TEXTURE_FORMAT_BC1 || format == TEXTURE_FORMAT_BC4) ? 8 : 16;
+
+    std::vector<unsigned char> out((size_t)blocks_x * blocks_y * block_size);
+
+    parallelFor(blocks_y, threads, [&](unsigned int begin, unsigned int end){
+        unsigned char block[64];
+
+        for(unsigned int by = begin; by < end; ++by){
+            for(unsigned int bx = 0; bx < blocks_x; ++bx){
+                //gather the block, clamping at the edges of levels smaller than a block
+                for(unsigned int y = 0; y < 4; ++y){
+                    unsigned int sy = std::min(by * 4 + y, height - 1);
+                    for(unsigned int x = 0; x < 4; ++x){
+                        unsigned int sx = std::min(bx * 4 + x, width - 1);
+                        std::memcpy(block + (y * 4 + x) * 4, &rgba[((size_t)sy * width + sx) * 4], 4);
+                    }
+                }
+
+                unsigned char* dest = &out[((size_t)by * blocks_x + bx) * block_size];
+
+                switch(format){
+                    case TEXTURE_FORMAT_BC1:
+                        encodeBC1Block(block, dest);
+                        break;
+                    case TEXTURE_FORMAT_BC3:
+                        encodeBC4Block(block, 3, dest);
+                        encodeBC1Block(block, dest + 8);
+                        break;
+                    case TEXTURE_FORMAT_BC4:
+                        encodeBC4Block(block, 0, dest);
+                        break;
+                    case TEXTURE_FORMAT_BC5:
+                        encodeBC4Block(block, 0, dest);
+                        encodeBC4Block(block, 1, dest + 8);
+                        break;
+                    case TEXTURE_FORMAT_BC7:
+                        encodeBC7Block(block, dest);
+                        break;
+                    default:
+                        break;
+                }
+            }
+        }
+    });
+
+    return out;
+}
+
+bool processTexture(const unsigned char* pixels, unsigned int width, unsigned int height, unsigned int channels, const TextureProcessOptions& options,
+                    ProcessedTexture& out){
+    if(pixels == nullptr || width == 0 || height == 0 || channels < 1 || channels > 4){
+        return false;
+    }
+
+    auto chain = buildLinearChain(pixels, width, height, channels, options.srgb, options.mip_filter, options.generate_mips, options.threads);
+
+    out.format = options.format;
+    out.srgb = options.srgb;
+    out.channels = channels;
+    out.levels.clear();
+
+    for(auto& image : chain){
+        TextureLevelData level;
+        level.width = image.width;
+        level.height = image.height;
+
+        if(options.format == TEXTURE_FORMAT_RAW){
+            level.data = toBytes(image, channels, channels, options.srgb);
+        }
+        else{
+            level.data = encodeLevel(toBytes(image, channels, 4, options.srgb), image.width, image.height, options.format, options.threads);
+        }
+
+        out.levels.push_back(std::move(level));
+    }
+
+    return true;
+}
@@ -0,0 +1,85 @@
+#ifndef TEXTUREPROCESSING_H
+#define TEXTUREPROCESSING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief The TextureFormat enum specifies how the texels of processed texture levels are stored. TEXTURE_FORMAT_RAW stores 1 byte per channel,
+ * whereas the BC formats store 4x4 blocks of 8 (BC1, BC4) or 16 (BC3, BC5, BC7) bytes.
+ */
+enum TextureFormat{TEXTURE_FORMAT_RAW, TEXTURE_FORMAT_BC1, TEXTURE_FORMAT_BC3, TEXTURE_FORMAT_BC4, TEXTURE_FORMAT_BC5, TEXTURE_FORMAT_BC7};
+
+enum MipFilter{MIP_FILTER_BOX, MIP_FILTER_KAISER};
+
+struct TextureLevelData{
+    unsigned int width;
+    unsigned int height;
+    std::vector<unsigned char> data;
+};
+
+/**
+ * @brief The ProcessedTexture struct holds a 2D texture along with its mip chain, ready to be uploaded level by level
+ */
+struct ProcessedTexture{
+    TextureFormat format;
+    bool srgb;
+    unsigned int channels;
+    std::vector<TextureLevelData> levels;
+
+    ProcessedTexture() : format(TEXTURE_FORMAT_RAW), srgb(false), channels(4){
+    }
+};
+
+struct TextureProcessOptions{
+    TextureFormat format;
+    MipFilter mip_filter;
+    //whether the colour channels are sRGB encoded. Mips are filtered in linear space, and the result is uploaded as an sRGB texture
+    bool srgb;
+    bool generate_mips;
+    //number of threads used for filtering and encoding, 0 uses the calling thread only
+    unsigned int threads;
+
+    TextureProcessOptions() : format(TEXTURE_FORMAT_BC1), mip_filter(MIP_FILTER_BOX), srgb(true), generate_mips(true), threads(0){
+    }
+};
+
+/**
+ * @brief Builds the mip chain of an image and encodes every level into the requested format. This makes no OpenGL calls, so it can be used
+ * offline, or on worker threads.
+ * @param pixels Image data, with \p channels bytes per pixel, rows tightly packed
+ * @param width Width of the image
+ * @param height Height of the image
+ * @param channels Number of channels of the image, between 1 and 4
+ * @param options Processing options
+ * @param out Receives the processed texture
+ * @return true if succeeded, otherwise false
+ */
+bool processTexture(const unsigned char* pixels, unsigned int width, unsigned int height, unsigned int channels, const TextureProcessOptions& options,
+                    ProcessedTexture& out);
+
+/**
+ * @brief Builds the mip chain of an image, without encoding it. The levels are stored as TEXTURE_FORMAT_RAW with the same number of channels as the image.
+ * @param pixels Image data, with \p channels bytes per pixel, rows tightly packed
+ * @param width Width of the image
+ * @param height Height of the image
+ * @param channels Number of channels of the image, between 1 and 4
+ * @param srgb Whether the colour channels are sRGB encoded, in which case they are filtered in linear space
+ * @param filter Filter used for downsampling
+ * @return the levels of the mip chain, with level 0 being a copy of the image
+ */
+std::vector<TextureLevelData> generateMipChain(const unsigned char* pixels, unsigned int width, unsigned int height, unsigned int channels, bool srgb,
+                                               MipFilter filter);
+
+/**
+ * @brief Calculates the size of a texture level
+ * @param format Format of the level
+ * @param width Width of the level
+ * @param height Height of the level
+ * @param channels Number of channels, only used by TEXTURE_FORMAT_RAW
+ * @return size in bytes
+ */
+size_t textureLevelSize(TextureFormat format, unsigned int width, unsigned int height, unsigned int channels);
+
+#endif // TEXTUREPROCESSING_H
@@ -0,0 +1,318 @@
+#include "textureuploader.h"
+#include "texture.h"
+#include "profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+unsigned int TextureLayout::levelWidth(unsigned int level) const{
+    return std::max(1u, width >> level);
+}
+
+unsigned int TextureLayout::levelHeight(unsigned int level) const{
+    return std::max(1u, height >> level);
+}
+
+unsigned int TextureLayout::levelRows(unsigned int level) const{
+    return format == TEXTURE_FORMAT_RAW ? levelHeight(level) : (levelHeight(level) + 3) / 4;
+}
+
+size_t TextureLayout::rowSize(unsigned int level) const{
+    return levelSize(level) / levelRows(level);
+}
+
+size_t TextureLayout::levelSize(unsigned int level) const{
+    return textureLevelSize(format, levelWidth(level), levelHeight(level), channels);
+}
+
+TextureLayout processedTextureLayout(const ProcessedTexture& texture){
+    TextureLayout layout;
+    layout.format = texture.format;
+    layout.srgb = texture.srgb;
+    layout.channels = texture.channels;
+    layout.width = texture.levels.empty() ? 0 : texture.levels[0].width;
+    layout.height = texture.levels.empty() ? 0 : texture.levels[0].height;
+    layout.num_levels = (unsigned int)texture.levels.size();
+
+    return layout;
+}
+
+TextureFillFunction processedTextureFill(std::shared_ptr<const ProcessedTexture> texture){
+    TextureLayout layout = processedTextureLayout(*texture);
+
+    return [texture, layout](unsigned int level, unsigned int first_row, unsigned int num_rows, unsigned char* dest){
+        size_t row_size = layout.rowSize(level);
+        std::memcpy(dest, texture->levels[level].data.data() + row_size * first_row, row_size * num_rows);
+
+        return true;
+    };
+}
+
+TextureUploader::TextureUploader(AsyncLoader* loader) : loader_(loader), buffer_size_(16 * 1024 * 1024), buffer_count_(4), persistent_(false),
+                                                        budget_ms_(1.f){
+}
+
+TextureUploader::~TextureUploader(){
+    for(auto& slot : slots_){
+        if(slot->fence != 0){
+            glDeleteSync(slot->fence);
+        }
+
+        glDeleteBuffers(1, &slot->pbo);
+    }
+}
+
+void TextureUploader::createBuffers(){
+    //persistently mapped buffers can be written to by the workers at any time, otherwise every fill is mapped and unmapped on the GL thread
+    persistent_ = GLEW_ARB_buffer_storage != 0;
+
+    for(unsigned int i = 0; i < buffer_count_; ++i){
+        std::unique_ptr<UploadSlot> slot(new UploadSlot());
+        slot->mapped = nullptr;
+        slot->fence = 0;
+        slot->state = SLOT_FREE;
+
+        glGenBuffers(1, &slot->pbo);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot->pbo);
+
+        if(persistent_){
+            GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            glBufferStorage(GL_PIXEL_UNPACK_BUFFER, buffer_size_, NULL, flags);
+            slot->mapped = (unsigned char*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, buffer_size_, flags);
+        }
+        else{
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, buffer_size_, NULL, GL_STREAM_DRAW);
+        }
+
+        slots_.push_back(std::move(slot));
+    }
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+void TextureUploader::upload(Texture* texture, const TextureLayout& layout, TextureFillFunction fill){
+    for(unsigned int level = 0; level < layout.num_levels; ++level){
+        if(layout.rowSize(level) > buffer_size_){
+            std::cerr << "Error: rows of texture " << texture->getLexicalName() << " do not fit into the upload buffers" << std::endl;
+            texture->finishUpload(false);
+            return;
+        }
+    }
+
+    std::shared_ptr<UploadJob> job(new UploadJob());
+    job->texture = texture;
+    job->layout = layout;
+    job->fill = fill;
+    job->next_level = 0;
+    job->next_row = 0;
+    job->chunks_in_progress = 0;
+    job->failed = false;
+
+    jobs_.push_back(job);
+}
+
+void TextureUploader::cancel(Texture* texture){
+    auto iter = jobs_.begin();
+    while(iter != jobs_.end()){
+        std::shared_ptr<UploadJob> job = *iter;
+
+        if(job->texture != texture){
+            ++iter;
+            continue;
+        }
+
+        //chunks which are being filled still hold on to the job, and drop it once they are done
+        job->texture = nullptr;
+        job->failed = true;
+        job->next_level = job->layout.num_levels;
+
+        iter = job->chunks_in_progress == 0 ? jobs_.erase(iter) : iter + 1;
+    }
+}
+
+void TextureUploader::frame(){
+    PROFILE_ZONE("Texture uploads");
+
+    auto start = std::chrono::steady_clock::now();
+
+    if(slots_.empty() && !jobs_.empty()){
+        createBuffers();
+    }
+
+    //retire the uploads the GPU has consumed
+    for(auto& slot : slots_){
+        if(slot->state == SLOT_IN_FLIGHT){
+            GLenum result = glClientWaitSync(slot->fence, 0, 0);
+            if(result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED){
+                glDeleteSync(slot->fence);
+                slot->fence = 0;
+                slot->state = SLOT_FREE;
+            }
+        }
+    }
+
+    //issue the filled chunks, oldest job first, within the budget
+    auto budget = std::chrono::duration<float, std::milli>(budget_ms_);
+
+    for(auto& slot : slots_){
+        int state = slot->state.load(std::memory_order_acquire);
+
+        if(state == SLOT_FAILED){
+            slot->job->failed = true;
+            issueSlot(*slot);
+        }
+        else if(state == SLOT_READY){
+            if(frame_stats_.chunks_uploaded > 0 && std::chrono::steady_clock::now() - start > budget){
+                continue;
+            }
+
+            issueSlot(*slot);
+        }
+    }
+
+    //hand the free buffers to the workers
+    for(auto& slot : slots_){
+        if(slot->state == SLOT_FREE && !fillSlot(*slot)){
+            break;
+        }
+    }
+
+    bool waiting = false;
+    for(auto& job : jobs_){
+        waiting = waiting || job->next_level < job->layout.num_levels;
+    }
+
+    frame_stats_.pending_textures = (unsigned int)jobs_.size();
+    frame_stats_.starved = waiting;
+    frame_stats_.upload_ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    last_frame_stats_ = frame_stats_;
+    frame_stats_ = TextureUploadStats();
+}
+
+bool TextureUploader::fillSlot(UploadSlot& slot){
+    std::shared_ptr<UploadJob> job;
+    for(auto& candidate : jobs_){
+        if(candidate->next_level < candidate->layout.num_levels){
+            job = candidate;
+            break;
+        }
+    }
+
+    if(job == nullptr){
+        return false;
+    }
+
+    const TextureLayout& layout = job->layout;
+    unsigned int rows_per_buffer = (unsigned int)(buffer_size_ / layout.rowSize(job->next_level));
+
+    slot.job = job;
+    slot.level = job->next_level;
+    slot.first_row = job->next_row;
+    slot.num_rows = std::min(rows_per_buffer, layout.levelRows(job->next_level) - job->next_row);
+
+    job->next_row += slot.num_rows;
+    if(job->next_row == layout.levelRows(job->next_level)){
+        job->next_level++;
+        job->next_row = 0;
+    }
+
+    job->chunks_in_progress++;
+
+    if(!persistent_){
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.pbo);
+        slot.mapped = (unsigned char*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, buffer_size_, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+
+    slot.state = SLOT_FILLING;
+
+    UploadSlot* slot_pointer = &slot;
+    loader_->submit([slot_pointer, job](){
+        bool filled = slot_pointer->mapped != nullptr && job->fill(slot_pointer->level, slot_pointer->first_row, slot_pointer->num_rows, slot_pointer->mapped);
+
+        slot_pointer->state.store(filled ? SLOT_READY : SLOT_FAILED, std::memory_order_release);
+    });
+
+    return true;
+}
+
+void TextureUploader::issueSlot(UploadSlot& slot){
+    std::shared_ptr<UploadJob> job = slot.job;
+    const TextureLayout& layout = job->layout;
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.pbo);
+
+    if(!persistent_){
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        slot.mapped = nullptr;
+    }
+
+    if(job->texture != nullptr && !job->failed){
+        unsigned int rows_per_unit = layout.format == TEXTURE_FORMAT_RAW ? 1 : 4;
+        unsigned int y = slot.first_row * rows_per_unit;
+        unsigned int height = std::min(slot.num_rows * rows_per_unit, layout.levelHeight(slot.level) - y);
+        size_t size = layout.rowSize(slot.level) * slot.num_rows;
+
+        glBindTexture(GL_TEXTURE_2D, job->texture->texture_name_);
+
+        if(layout.format == TEXTURE_FORMAT_RAW){
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            glTexSubImage2D(GL_TEXTURE_2D, (GLint)slot.level, 0, (GLint)y, (GLsizei)layout.levelWidth(slot.level), (GLsizei)height,
+                            job->texture->textureFormat((int)layout.channels), GL_UNSIGNED_BYTE, (const GLvoid*)0);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        }
+        else{
+            glCompressedTexSubImage2D(GL_TEXTURE_2D, (GLint)slot.level, 0, (GLint)y, (GLsizei)layout.levelWidth(slot.level), (GLsizei)height,
+                                      job->texture->compressedTextureFormat(layout.format, layout.srgb), (GLsizei)size, (const GLvoid*)0);
+        }
+
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        frame_stats_.chunks_uploaded++;
+        frame_stats_.bytes_uploaded += size;
+    }
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.state = SLOT_IN_FLIGHT;
+
+    finishSlot(slot);
+}
+
+void TextureUploader::finishSlot(UploadSlot& slot){
+    std::shared_ptr<UploadJob> job = slot.job;
+    slot.job = nullptr;
+
+    job->chunks_in_progress--;
+
+    bool issued = job->next_level >= job->layout.num_levels;
+    if(!issued || job->chunks_in_progress > 0){
+        return;
+    }
+
+    //every chunk has been issued, the texture can be sampled as the GL orders the uploads before any later draws
+    if(job->texture != nullptr){
+        job->texture->finishUpload(!job->failed);
+    }
+
+    jobs_.erase(std::find(jobs_.begin(), jobs_.end(), job));
+}
+
+void TextureUploader::setBudget(float milliseconds){
+    budget_ms_ = milliseconds;
+}
+
+void TextureUploader::setBuffers(size_t size, unsigned int count){
+    if(slots_.empty()){
+        buffer_size_ = size;
+        buffer_count_ = std::max(1u, count);
+    }
+}
+
+TextureUploadStats TextureUploader::getStats(){
+    return last_frame_stats_;
+}
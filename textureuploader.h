@@ -0,0 +1,175 @@
+#ifndef TEXTUREUPLOADER_H
+#define TEXTUREUPLOADER_H
+
+#include "common.h"
+#include "textureprocessing.h"
+#include "asyncloader.h"
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+class Texture;
+
+/**
+ * @brief The TextureLayout struct describes the format and mip chain of a 2D texture, without its data
+ */
+struct TextureLayout{
+    TextureFormat format;
+    bool srgb;
+    unsigned int channels;
+    unsigned int width;
+    unsigned int height;
+    unsigned int num_levels;
+
+    TextureLayout() : format(TEXTURE_FORMAT_RAW), srgb(false), channels(4), width(0), height(0), num_levels(1){
+    }
+
+    unsigned int levelWidth(unsigned int level) const;
+    unsigned int levelHeight(unsigned int level) const;
+
+    //number of rows a level is filled in, rows of texels for TEXTURE_FORMAT_RAW and rows of 4x4 blocks for compressed formats
+    unsigned int levelRows(unsigned int level) const;
+    size_t rowSize(unsigned int level) const;
+    size_t levelSize(unsigned int level) const;
+};
+
+/**
+ * @brief Function used to write the data of rows \p first_row to \p first_row + \p num_rows of mip level \p level of a texture into \p dest, which
+ * points into mapped pixel buffer memory. Rows are as described by TextureLayout::levelRows(), tightly packed. It is run on worker threads, possibly
+ * for several ranges at once, so it must be thread safe and must not make any OpenGL calls. It should return false if the data could not be produced.
+ */
+typedef std::function<bool(unsigned int level, unsigned int first_row, unsigned int num_rows, unsigned char* dest)> TextureFillFunction;
+
+/**
+ * @brief Gets the layout of a processed texture
+ * @param texture Processed texture
+ * @return layout of the texture
+ */
+TextureLayout processedTextureLayout(const ProcessedTexture& texture);
+
+/**
+ * @brief Creates a fill function copying from a processed texture, which is kept alive by the function
+ * @param texture Processed texture
+ * @return fill function
+ */
+TextureFillFunction processedTextureFill(std::shared_ptr<const ProcessedTexture> texture);
+
+/**
+ * @brief The TextureUploadStats struct holds the counters of the TextureUploader. The per frame counters are those of the last completed frame.
+ */
+struct TextureUploadStats{
+    unsigned int pending_textures;
+    unsigned int chunks_uploaded;
+    size_t bytes_uploaded;
+    //time spent on the GL thread issuing uploads
+    float upload_ms;
+    //whether chunks were waiting for a free pixel buffer
+    bool starved;
+
+    TextureUploadStats() : pending_textures(0), chunks_uploaded(0), bytes_uploaded(0), upload_ms(0.f), starved(false){
+    }
+};
+
+/**
+ * @brief The TextureUploader class uploads textures through a ring of pixel unpack buffers. Textures are split into chunks of rows that fit into a
+ * buffer, which worker threads fill straight into mapped buffer memory. The GL thread then issues glTexSubImage2D from the buffer, and fences it
+ * before the buffer is reused, so it never waits on the driver copying client memory. At most a budget of time per frame is spent issuing uploads.
+ */
+class TextureUploader
+{
+friend class TextureManager;
+friend class Texture;
+private:
+    enum SlotState{SLOT_FREE, SLOT_FILLING, SLOT_READY, SLOT_FAILED, SLOT_IN_FLIGHT};
+
+    struct UploadJob{
+        Texture* texture;
+        TextureLayout layout;
+        TextureFillFunction fill;
+        unsigned int next_level;
+        unsigned int next_row;
+        unsigned int chunks_in_progress;
+        bool failed;
+    };
+
+    struct UploadSlot{
+        GLuint pbo;
+        unsigned char* mapped;
+        GLsync fence;
+        std::atomic<int> state;
+
+        std::shared_ptr<UploadJob> job;
+        unsigned int level;
+        unsigned int first_row;
+        unsigned int num_rows;
+    };
+
+    AsyncLoader* loader_;
+
+    size_t buffer_size_;
+    unsigned int buffer_count_;
+    bool persistent_;
+    std::vector<std::unique_ptr<UploadSlot> > slots_;
+
+    std::deque<std::shared_ptr<UploadJob> > jobs_;
+
+    float budget_ms_;
+
+    TextureUploadStats frame_stats_;
+    TextureUploadStats last_frame_stats_;
+
+private:
+    //only constructable by the TextureManager
+    TextureUploader(AsyncLoader* loader);
+
+    //creates the pixel buffers, on first use as they need the GL context
+    void createBuffers();
+
+    //retires uploads the GPU has finished, issues filled chunks within the budget, and hands free buffers to the workers, called once per frame
+    void frame();
+
+    //queues the upload of the data of a texture, whose storage has been allocated by Texture::beginUpload()
+    void upload(Texture* texture, const TextureLayout& layout, TextureFillFunction fill);
+
+    //stops uploading to the texture, as it is about to be freed
+    void cancel(Texture* texture);
+
+    //assigns the next chunk of a job to the slot and hands it to a worker, returns false if no job has chunks left
+    bool fillSlot(UploadSlot& slot);
+
+    //issues the upload of a filled slot
+    void issueSlot(UploadSlot& slot);
+
+    //completes the chunk of a slot, finishing its texture if it was the last one
+    void finishSlot(UploadSlot& slot);
+
+public:
+    TextureUploader(const TextureUploader& other) = delete;
+    TextureUploader& operator = (const TextureUploader& other) = delete;
+    ~TextureUploader();
+
+    /**
+     * @brief Sets the amount of time the GL thread may spend per frame issuing uploads. At least one chunk is issued per frame regardless.
+     * @param milliseconds Budget in milliseconds. Default is 1 millisecond.
+     */
+    void setBudget(float milliseconds);
+
+    /**
+     * @brief Sets the size and number of pixel buffers. This only has an effect before the first upload. Every row of a mip level has to fit into
+     * a buffer.
+     * @param size Size of each buffer in bytes. Default is 16 MB.
+     * @param count Number of buffers. Default is 4.
+     */
+    void setBuffers(size_t size, unsigned int count);
+
+    /**
+     * @brief Gets the counters of the last completed frame
+     * @return counters of the uploader
+     */
+    TextureUploadStats getStats();
+};
+
+#endif // TEXTUREUPLOADER_H
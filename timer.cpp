@@ -1,8 +1,61 @@
 #include "timer.h"
 #include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 std::unique_ptr<Timer> Timer::timer_ = nullptr;
 
+FixedTimestep::FixedTimestep(double step_seconds, unsigned int max_steps) : step_ns_((std::int64_t)(step_seconds * 1e9)), accumulator_ns_(0),
+                                                                            max_steps_(std::max(max_steps, 1u)), total_steps_(0), dropped_steps_(0){
+}
+
+unsigned int FixedTimestep::advance(std::int64_t elapsed_ns){
+    if(step_ns_ <= 0){
+        return 0;
+    }
+
+    accumulator_ns_ += elapsed_ns;
+
+    std::int64_t steps = accumulator_ns_ / step_ns_;
+    accumulator_ns_ -= steps * step_ns_;
+
+    //falling this far behind means a step costs more than it simulates, catching up would only make the next frame slower
+    if(steps > (std::int64_t)max_steps_){
+        dropped_steps_ += (std::uint64_t)(steps - max_steps_);
+        steps = max_steps_;
+    }
+
+    total_steps_ += (std::uint64_t)steps;
+
+    return (unsigned int)steps;
+}
+
+double FixedTimestep::alpha() const{
+    return step_ns_ > 0 ? (double)accumulator_ns_ / (double)step_ns_ : 1.0;
+}
+
+void FixedTimestep::setStep(double step_seconds){
+    step_ns_ = (std::int64_t)(step_seconds * 1e9);
+    accumulator_ns_ = step_ns_ > 0 ? accumulator_ns_ % step_ns_ : 0;
+}
+
+void FixedTimestep::setMaxSteps(unsigned int max_steps){
+    max_steps_ = std::max(max_steps, 1u);
+}
+
+double FixedTimestep::stepSeconds() const{
+    return (double)step_ns_ / 1e9;
+}
+
+std::uint64_t FixedTimestep::totalSteps() const{
+    return total_steps_;
+}
+
+std::uint64_t FixedTimestep::droppedSteps() const{
+    return dropped_steps_;
+}
+
 bool Timer::initialize(){
     if(Timer::timer_ != nullptr){
         return false;
@@ -27,49 +80,37 @@ Timer* Timer::timer(){
     return Timer::timer_.get();
 }
 
-Timer::Timer() : total_time_elapsed_ms_(SDL_GetTicks()), actual_time_elapsed_ms_(0),
-                paused_time_ms_(0), time_since_last_frame_ms_(0),
-                total_time_elapsed_(toSeconds(total_time_elapsed_ms_)),
-                actual_time_elapsed_(0.f), paused_time_(0.f),
-                time_since_last_frame_(0.f), paused_(false){
-}
-
-Timer::Timer(const Timer& other){
-    total_time_elapsed_ms_ = other.total_time_elapsed_ms_;
-    actual_time_elapsed_ms_ = other.actual_time_elapsed_ms_;
-    paused_time_ms_ = other.paused_time_ms_;
-    time_since_last_frame_ms_ = other.time_since_last_frame_ms_;
-
-    total_time_elapsed_ = other.total_time_elapsed_;
-    actual_time_elapsed_ = other.actual_time_elapsed_;
-    paused_time_ = other.paused_time_;
-    time_since_last_frame_ = other.time_since_last_frame_;
-
-    paused_ = other.paused_;
+Timer::Timer() : last_frame_(Clock::now()), total_time_elapsed_ns_(0), actual_time_elapsed_ns_(0), paused_time_ns_(0), time_since_last_frame_ns_(0),
+                 paused_(false), fixed_enabled_(false), fixed_timestep_(), fixed_steps_(0){
+    resetPacingStats();
 }
 
 Timer::~Timer(){
 
 }
 
-float Timer::toSeconds(int ms){
-    return ((float)ms / 1000.f);
+float Timer::toSeconds(std::int64_t ns){
+    return (float)((double)ns / 1e9);
 }
 
 float Timer::deltaTime(){
-    return time_since_last_frame_;
+    return toSeconds(time_since_last_frame_ns_);
+}
+
+std::int64_t Timer::deltaTimeNs(){
+    return time_since_last_frame_ns_;
 }
 
 float Timer::totalTime(){
-    return total_time_elapsed_;
+    return toSeconds(total_time_elapsed_ns_);
 }
 
 float Timer::timePaused(){
-    return paused_time_;
+    return toSeconds(paused_time_ns_);
 }
 
 float Timer::actualTime(){
-    return actual_time_elapsed_;
+    return toSeconds(actual_time_elapsed_ns_);
 }
 
 void Timer::pause(){
@@ -78,8 +119,7 @@ void Timer::pause(){
 
 void Timer::unpause(){
     paused_ = false;
-    paused_time_ms_ = 0;
-    paused_time_ = 0.f;
+    paused_time_ns_ = 0;
 }
 
 bool Timer::isPaused(){
@@ -87,35 +127,85 @@ bool Timer::isPaused(){
 }
 
 void Timer::frame(){
-    int new_tick_time = SDL_GetTicks();
-    int diff = new_tick_time - actual_time_elapsed_;
-    actual_time_elapsed_ = new_tick_time;
+    Clock::time_point now = Clock::now();
+    std::int64_t diff = std::chrono::duration_cast<std::chrono::nanoseconds>(now - last_frame_).count();
+    last_frame_ = now;
+
+    actual_time_elapsed_ns_ += diff;
+    fixed_steps_ = 0;
 
     if(paused_){
-        paused_time_ms_ += diff;
-        paused_time_ = toSeconds(paused_time_ms_);
-        time_since_last_frame_ms_ = 0;
+        paused_time_ns_ += diff;
+        time_since_last_frame_ns_ = 0;
     }
     else{
-        total_time_elapsed_ms_ += diff;
-        time_since_last_frame_ms_ = diff;
+        total_time_elapsed_ns_ += diff;
+        time_since_last_frame_ns_ = diff;
 
-        total_time_elapsed_ = toSeconds(total_time_elapsed_ms_);
+        if(fixed_enabled_){
+            fixed_steps_ = fixed_timestep_.advance(diff);
+        }
     }
 
-    time_since_last_frame_ = toSeconds(time_since_last_frame_ms_);
+    double frame_ms = (double)diff / 1e6;
+    pacing_frames_++;
+    pacing_sum_ms_ += frame_ms;
+    pacing_sum_squares_ms_ += frame_ms * frame_ms;
+    pacing_min_ms_ = std::min(pacing_min_ms_, frame_ms);
+    pacing_max_ms_ = std::max(pacing_max_ms_, frame_ms);
 }
 
 void Timer::reset(){
-    total_time_elapsed_ms_ = SDL_GetTicks();
-    actual_time_elapsed_ms_ = 0;
-    paused_time_ms_ = 0;
-    time_since_last_frame_ms_ = 0;
-
-    total_time_elapsed_ = toSeconds(total_time_elapsed_ms_);
-    actual_time_elapsed_ = 0.f;
-    paused_time_ = 0.f;
-    time_since_last_frame_ = 0.f;
+    total_time_elapsed_ns_ = 0;
+    paused_time_ns_ = 0;
+    time_since_last_frame_ns_ = 0;
 
     paused_ = false;
 }
+
+void Timer::setFixedTimestep(float step_seconds, unsigned int max_steps){
+    fixed_enabled_ = step_seconds > 0.f;
+
+    if(fixed_enabled_){
+        fixed_timestep_.setStep(step_seconds);
+        fixed_timestep_.setMaxSteps(max_steps);
+    }
+}
+
+float Timer::fixedDeltaTime(){
+    return fixed_enabled_ ? (float)fixed_timestep_.stepSeconds() : 0.f;
+}
+
+unsigned int Timer::fixedSteps(){
+    return fixed_steps_;
+}
+
+float Timer::interpolationAlpha(){
+    return fixed_enabled_ ? (float)fixed_timestep_.alpha() : 1.f;
+}
+
+FramePacingStats Timer::getPacingStats(){
+    FramePacingStats stats;
+    stats.frames = pacing_frames_;
+    stats.fixed_steps = fixed_timestep_.totalSteps() - pacing_first_step_;
+    stats.dropped_steps = fixed_timestep_.droppedSteps() - pacing_first_dropped_;
+
+    if(pacing_frames_ > 0){
+        stats.mean_ms = pacing_sum_ms_ / pacing_frames_;
+        stats.min_ms = pacing_min_ms_;
+        stats.max_ms = pacing_max_ms_;
+        stats.stddev_ms = std::sqrt(std::max(pacing_sum_squares_ms_ / pacing_frames_ - stats.mean_ms * stats.mean_ms, 0.0));
+    }
+
+    return stats;
+}
+
+void Timer::resetPacingStats(){
+    pacing_frames_ = 0;
+    pacing_sum_ms_ = 0.0;
+    pacing_sum_squares_ms_ = 0.0;
+    pacing_min_ms_ = std::numeric_limits<double>::max();
+    pacing_max_ms_ = 0.0;
+    pacing_first_step_ = fixed_timestep_.totalSteps();
+    pacing_first_dropped_ = fixed_timestep_.droppedSteps();
+}
@@ -1,31 +1,130 @@
 #ifndef TIMER
 #define TIMER
 
-#include <SDL.h>
 #include <memory>
+#include <chrono>
+#include <cstdint>
+
+/**
+ * @brief The FixedTimestep class splits variable frame times into fixed simulation steps. Elapsed time is accumulated, and every whole step in
+ * the accumulator is run, so the number of steps over a period only depends on its length, not on how it was split into frames. The remainder
+ * gives the interpolation alpha between the last two simulated states for rendering. To keep a slow frame from requiring ever more steps to
+ * catch up, at most a maximum number of steps is run per frame, and the time beyond it is dropped.
+ */
+class FixedTimestep
+{
+private:
+    std::int64_t step_ns_;
+    std::int64_t accumulator_ns_;
+    unsigned int max_steps_;
+
+    std::uint64_t total_steps_;
+    std::uint64_t dropped_steps_;
+
+public:
+    /**
+     * @brief Creates a fixed timestep
+     * @param step_seconds Length of a step in seconds
+     * @param max_steps Maximum number of steps run per frame
+     */
+    FixedTimestep(double step_seconds = 1.0 / 60.0, unsigned int max_steps = 8);
+
+    /**
+     * @brief Adds the time elapsed since the last frame
+     * @param elapsed_ns Elapsed time in nanoseconds
+     * @return the number of steps to run this frame
+     */
+    unsigned int advance(std::int64_t elapsed_ns);
+
+    /**
+     * @brief Gets how far the accumulated time is into the next step, which is the interpolation factor between the state before and after the
+     * last step
+     * @return the fraction of a step accumulated, between 0 and 1
+     */
+    double alpha() const;
+
+    /**
+     * @brief Sets the length of a step, keeping the accumulated time
+     * @param step_seconds Length of a step in seconds
+     */
+    void setStep(double step_seconds);
+
+    /**
+     * @brief Sets the maximum number of steps run per frame
+     * @param max_steps Maximum number of steps, at least 1
+     */
+    void setMaxSteps(unsigned int max_steps);
+
+    /**
+     * @brief Gets the length of a step
+     * @return the length of a step in seconds
+     */
+    double stepSeconds() const;
+
+    /**
+     * @brief Gets the number of steps run since creation
+     * @return number of steps
+     */
+    std::uint64_t totalSteps() const;
+
+    /**
+     * @brief Gets the number of steps dropped because a frame would have needed more than the maximum
+     * @return number of dropped steps
+     */
+    std::uint64_t droppedSteps() const;
+};
+
+/**
+ * @brief The FramePacingStats struct summarizes the frame times measured by the Timer since its pacing stats were last reset
+ */
+struct FramePacingStats{
+    std::uint64_t frames;
+    double mean_ms;
+    double min_ms;
+    double max_ms;
+    double stddev_ms;
+    std::uint64_t fixed_steps;
+    std::uint64_t dropped_steps;
+
+    FramePacingStats() : frames(0), mean_ms(0.0), min_ms(0.0), max_ms(0.0), stddev_ms(0.0), fixed_steps(0), dropped_steps(0){
+    }
+};
 
 class Timer{
 friend class Engine;
 friend std::unique_ptr<Timer>::deleter_type;
 
 private:
-    int total_time_elapsed_ms_;
-    int actual_time_elapsed_ms_;
-    int paused_time_ms_;
-    int time_since_last_frame_ms_;
+    typedef std::chrono::steady_clock Clock;
 
-    float total_time_elapsed_;
-    float actual_time_elapsed_;
-    float paused_time_;
-    float time_since_last_frame_;
+    Clock::time_point last_frame_;
+
+    //all times are kept in integer nanoseconds, and only converted to seconds when queried
+    std::int64_t total_time_elapsed_ns_;
+    std::int64_t actual_time_elapsed_ns_;
+    std::int64_t paused_time_ns_;
+    std::int64_t time_since_last_frame_ns_;
 
     bool paused_;
 
+    bool fixed_enabled_;
+    FixedTimestep fixed_timestep_;
+    unsigned int fixed_steps_;
+
+    //running sums of the frame times since the pacing stats were reset
+    std::uint64_t pacing_frames_;
+    double pacing_sum_ms_;
+    double pacing_sum_squares_ms_;
+    double pacing_min_ms_;
+    double pacing_max_ms_;
+    std::uint64_t pacing_first_step_;
+    std::uint64_t pacing_first_dropped_;
+
     static std::unique_ptr<Timer> timer_;
 
 private:
     Timer();
-    Timer(const Timer& other);
+    Timer(const Timer& other) = delete;
     ~Timer();
 
     static bool initialize();
@@ -34,8 +133,8 @@ private:
     //forwards timer by a frame
     void frame();
 
-    //helper for frame(), converts int ms value to float second value
-    float toSeconds(int ms);
+    //helper for the getters, converts nanoseconds to seconds
+    static float toSeconds(std::int64_t ns);
 
 public:
     /**
@@ -50,6 +149,12 @@ public:
      */
     float deltaTime();
 
+    /**
+     * @brief Gets the time since the last frame at full precision
+     * @return the time in nanoseconds
+     */
+    std::int64_t deltaTimeNs();
+
     /**
      * @brief Calculates the total amount of elapsed. This does not include pause time, and can be reset
      * @return the elapsed time in seconds
@@ -89,7 +194,43 @@ public:
      * @brief Resets all the timers except the actual time elapsed. Also unpauses the timer.
      */
     void reset();
+
+    /**
+     * @brief Enables the fixed timestep simulation of the engine loop. Every frame, Component::fixedFrame() is called once for every whole step
+     * of time elapsed, before the frame is rendered, see FixedTimestep. Disabled by default. No steps are run while paused.
+     * @param step_seconds Length of a step in seconds, 0 disables fixed steps
+     * @param max_steps Maximum number of steps run per frame. Default is 8.
+     */
+    void setFixedTimestep(float step_seconds, unsigned int max_steps = 8);
+
+    /**
+     * @brief Gets the length of a fixed step, to be used as the time step in Component::fixedFrame()
+     * @return the length of a step in seconds, or 0 if fixed steps are disabled
+     */
+    float fixedDeltaTime();
+
+    /**
+     * @brief Gets the number of fixed steps run in the current frame
+     * @return number of steps
+     */
+    unsigned int fixedSteps();
+
+    /**
+     * @brief Gets how far the current frame is between the last two fixed steps, for rendering the simulated state interpolated between them
+     * @return the interpolation factor between 0 and 1, or 1 if fixed steps are disabled
+     */
+    float interpolationAlpha();
+
+    /**
+     * @brief Gets the frame pacing measured since the last call to resetPacingStats(), or since the timer was created
+     * @return the frame pacing
+     */
+    FramePacingStats getPacingStats();
+
+    /**
+     * @brief Restarts the measurement of the frame pacing
+     */
+    void resetPacingStats();
 };
 
 #endif // TIMER
-
@@ -0,0 +1,131 @@
+#include "alloccount.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+//counts every allocation, from any thread, as the engine allocates on its worker and record threads too
+static std::atomic<std::uint64_t> allocation_count(0);
+
+//every form of new and delete is replaced, so that all memory is taken from and returned to malloc. They are kept out of line, as GCC takes
+//free() inlined into a caller as freeing memory from the global new it knows of
+#if defined(__GNUC__)
+#define ALLOCATION_NOINLINE __attribute__((noinline))
+#else
+#define ALLOCATION_NOINLINE
+#endif
+
+ALLOCATION_NOINLINE void* operator new(size_t size){
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+
+    void* ptr = std::malloc(size == 0 ? 1 : size);
+    if(ptr == nullptr){
+        throw std::bad_alloc();
+    }
+
+    return ptr;
+}
+
+ALLOCATION_NOINLINE void* operator new[](size_t size){
+    return operator new(size);
+}
+
+ALLOCATION_NOINLINE void operator delete(void* ptr) noexcept{
+    std::free(ptr);
+}
+
+ALLOCATION_NOINLINE void operator delete[](void* ptr) noexcept{
+    std::free(ptr);
+}
+
+ALLOCATION_NOINLINE void operator delete(void* ptr, size_t) noexcept{
+    std::free(ptr);
+}
+
+ALLOCATION_NOINLINE void operator delete[](void* ptr, size_t) noexcept{
+    std::free(ptr);
+}
+
+//the nothrow forms are what drivers such as llvmpipe allocate with, which would otherwise be freed by the replaced delete without having been
+//taken from malloc
+ALLOCATION_NOINLINE void* operator new(size_t size, const std::nothrow_t&) noexcept{
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+ALLOCATION_NOINLINE void* operator new[](size_t size, const std::nothrow_t&) noexcept{
+    return operator new(size, std::nothrow);
+}
+
+ALLOCATION_NOINLINE void operator delete(void* ptr, const std::nothrow_t&) noexcept{
+    std::free(ptr);
+}
+
+ALLOCATION_NOINLINE void operator delete[](void* ptr, const std::nothrow_t&) noexcept{
+    std::free(ptr);
+}
+
+//the aligned forms only exist from C++17 on, and are replaced whenever the benchmarks are built with them
+#if defined(__cpp_aligned_new)
+ALLOCATION_NOINLINE void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept{
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+
+#ifdef _WIN32
+    return _aligned_malloc(size == 0 ? 1 : size, (size_t)alignment);
+#else
+    void* ptr = nullptr;
+    return posix_memalign(&ptr, std::max((size_t)alignment, sizeof(void*)), size == 0 ? 1 : size) == 0 ? ptr : nullptr;
+#endif
+}
+
+ALLOCATION_NOINLINE void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept{
+    return operator new(size, alignment, std::nothrow);
+}
+
+ALLOCATION_NOINLINE void* operator new(size_t size, std::align_val_t alignment){
+    void* ptr = operator new(size, alignment, std::nothrow);
+    if(ptr == nullptr){
+        throw std::bad_alloc();
+    }
+
+    return ptr;
+}
+
+ALLOCATION_NOINLINE void* operator new[](size_t size, std::align_val_t alignment){
+    return operator new(size, alignment);
+}
+
+ALLOCATION_NOINLINE void operator delete(void* ptr, std::align_val_t) noexcept{
+#ifdef _WIN32
+    _aligned_free(ptr);
+#else
+    std::free(ptr);
+#endif
+}
+
+ALLOCATION_NOINLINE void operator delete[](void* ptr, std::align_val_t alignment) noexcept{
+    operator delete(ptr, alignment);
+}
+
+ALLOCATION_NOINLINE void operator delete(void* ptr, size_t, std::align_val_t alignment) noexcept{
+    operator delete(ptr, alignment);
+}
+
+ALLOCATION_NOINLINE void operator delete[](void* ptr, size_t, std::align_val_t alignment) noexcept{
+    operator delete(ptr, alignment);
+}
+
+ALLOCATION_NOINLINE void operator delete(void* ptr, std::align_val_t alignment, const std::nothrow_t&) noexcept{
+    operator delete(ptr, alignment);
+}
+
+ALLOCATION_NOINLINE void operator delete[](void* ptr, std::align_val_t alignment, const std::nothrow_t&) noexcept{
+    operator delete(ptr, alignment);
+}
+#endif
+
+std::uint64_t allocationCount(){
+    return allocation_count.load(std::memory_order_relaxed);
+}
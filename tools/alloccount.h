@@ -0,0 +1,13 @@
+#ifndef ALLOCCOUNT_H
+#define ALLOCCOUNT_H
+
+#include <cstdint>
+
+/**
+ * @brief Gets the number of heap allocations made by any thread so far. Every form of the global operator new is replaced by alloccount.cpp,
+ * which benchmarks counting allocations are linked with. The allocations of a section are the difference of the counts before and after it.
+ * @return allocations made since the program started
+ */
+std::uint64_t allocationCount();
+
+#endif // ALLOCCOUNT_H
@@ -0,0 +1,74 @@
+//Packing benchmark for texture atlases (see textureatlas.h).
+//
+//usage: atlasbench [sprite count] [seed]
+//
+//Generates sprites of random sizes between 8 and 128 texels, packs them as a 2D atlas, and packs power of two sized sprites as arrays.
+//Reports the packing time and efficiency, and the texture binds per frame of drawing every sprite once, with each sprite being its own
+//texture, compared to sprites sorted by the page they are packed into, as the renderer does.
+
+#include "../textureatlas.h"
+
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <set>
+#include <cstdlib>
+
+std::vector<AtlasImage> generateSprites(unsigned int count, unsigned int seed, bool power_of_two){
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<unsigned int> size_distribution(8, 128);
+    std::uniform_int_distribution<unsigned int> exponent_distribution(3, 7);
+
+    std::vector<AtlasImage> sprites(count);
+    for(unsigned int i = 0; i < count; ++i){
+        AtlasImage& sprite = sprites[i];
+        sprite.name = "sprite" + std::to_string(i);
+
+        if(power_of_two){
+            sprite.width = 1u << exponent_distribution(generator);
+            sprite.height = sprite.width;
+        }
+        else{
+            sprite.width = size_distribution(generator);
+            sprite.height = size_distribution(generator);
+        }
+
+        sprite.pixels.assign((size_t)sprite.width * sprite.height * 4, (unsigned char)(i & 0xff));
+    }
+
+    return sprites;
+}
+
+void runBenchmark(const char* label, std::vector<AtlasImage>&& sprites, AtlasPackingMode mode){
+    size_t count = sprites.size();
+
+    TextureAtlasBuilder builder;
+    for(auto& sprite : sprites){
+        builder.addImage(std::move(sprite));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    if(!builder.build(mode)){
+        std::cerr << label << ": packing failed" << std::endl;
+        return;
+    }
+    double elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::set<unsigned int> pages;
+    for(auto& region : builder.regions()){
+        pages.insert(region.page);
+    }
+
+    std::cout << label << ": " << count << " sprites into " << builder.pages().size() << " pages in " << elapsed_ms << " ms, "
+              << builder.efficiency() * 100.f << "% efficiency, " << count << " -> " << pages.size() << " binds per frame" << std::endl;
+}
+
+int main(int argc, char* argv[]){
+    unsigned int count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 5000;
+    unsigned int seed = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1;
+
+    runBenchmark("2D atlas", generateSprites(count, seed, false), ATLAS_PACK_2D);
+    runBenchmark("2D array", generateSprites(count, seed, true), ATLAS_PACK_ARRAY);
+
+    return 0;
+}
@@ -0,0 +1,295 @@
+//Benchmark of the command buffers of the renderer (see commandbuffer.h).
+//
+//usage: commandbench [--renderables N] [--frames N] [--max-threads N] [--gl]
+//
+//Renders a scene of static cubes spread over a number of shaders with 0 up to the maximum number of recording threads, and reports the time the
+//frame spent recording its command buffers and the speedup over recording on the GL thread alone, along with the time per command of executing
+//them. Then fills a command buffer with a single type of command, and reports the time per command of executing it. The engine runs on the null
+//device unless --gl is given, which renders headless through EGL, so that execution times are the cost of the command stream itself rather than
+//of the driver.
+
+#include "../engine.h"
+#include "../renderer.h"
+#include "../renderable.h"
+#include "../camera.h"
+#include "../material.h"
+#include "../mesh.h"
+#include "../commandbuffer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+const char* COMMAND_VERTEX_SHADER =
+    "#version 330 core\n"
+    "in vec3 position;\n"
+    "uniform mat4 model;\n"
+    "uniform mat4 view;\n"
+    "uniform mat4 projection;\n"
+    "void main(){\n"
+    "    gl_Position = projection * view * model * vec4(position, 1.0);\n"
+    "}\n";
+
+//the variant constant makes every shader a distinct program
+const char* COMMAND_FRAGMENT_SHADER =
+    "#version 330 core\n"
+    "out vec4 frag_colour;\n"
+    "const float variant = VARIANT;\n"
+    "void main(){\n"
+    "    frag_colour = vec4(variant * 0.01);\n"
+    "}\n";
+
+const unsigned int COMMAND_SHADERS = 16;
+
+/**
+ * @brief The FlatMaterial class binds nothing beyond the matrices the renderer sets
+ */
+class FlatMaterial : public Material
+{
+public:
+    FlatMaterial(Shader* shader){
+        setShader(shader);
+        resolveLocations();
+    }
+
+    virtual std::string getMaterialName(){
+        return "flat";
+    }
+
+    virtual std::unique_ptr<Material> clone(){
+        return std::unique_ptr<Material>(new FlatMaterial(*this));
+    }
+
+    virtual void bind(){
+    }
+};
+
+struct CommandOptions{
+    unsigned int renderables;
+    unsigned int frames;
+    unsigned int max_threads;
+    RenderDeviceType device;
+
+    CommandOptions() : renderables(20000), frames(50), max_threads(std::max(std::thread::hardware_concurrency(), 2u) - 1),
+                       device(RENDER_DEVICE_NULL){
+    }
+};
+
+Mesh* createCube(){
+    std::unique_ptr<std::vector<VertexData> > vertices(new std::vector<VertexData>());
+    for(unsigned int i = 0; i < 8; ++i){
+        VertexData vertex = {{(i & 1) ? 0.5f : -0.5f, (i & 2) ? 0.5f : -0.5f, (i & 4) ? 0.5f : -0.5f}, {0.f, 0.f, 1.f}, {1.f, 1.f, 1.f, 1.f}, {0.f, 0.f}};
+        vertices->push_back(vertex);
+    }
+
+    const GLuint faces[] = {0, 2, 1, 1, 2, 3, 4, 5, 6, 5, 7, 6, 0, 1, 4, 1, 5, 4, 2, 6, 3, 3, 6, 7, 0, 4, 2, 2, 4, 6, 1, 3, 5, 3, 7, 5};
+    std::unique_ptr<std::vector<GLuint> > indices(new std::vector<GLuint>(faces, faces + 36));
+
+    return ResourceManager::resourceManager()->createMesh("command_cube", std::move(vertices), std::move(indices));
+}
+
+std::vector<Shader*> createShaders(){
+    std::vector<Shader*> shaders;
+
+    for(unsigned int i = 0; i < COMMAND_SHADERS; ++i){
+        std::string fragment = COMMAND_FRAGMENT_SHADER;
+        fragment.replace(fragment.find("VARIANT"), 7, std::to_string(i) + ".0");
+
+        Shader* shader = ResourceManager::resourceManager()->createShader("command_shader_" + std::to_string(i), COMMAND_VERTEX_SHADER, fragment,
+                                                                          SHADER_RAW);
+        if(shader != nullptr){
+            shaders.push_back(shader);
+        }
+    }
+
+    return shaders;
+}
+
+std::shared_ptr<Scene> buildScene(Mesh* cube, const std::vector<Shader*>& shaders, unsigned int count){
+    std::shared_ptr<Scene> scene = std::make_shared<Scene>();
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> spread(-40.f, 40.f);
+    std::uniform_real_distribution<float> depth(-60.f, -5.f);
+
+    for(unsigned int i = 0; i < count; ++i){
+        SceneNode* node = scene->rootNode()->addChild("object");
+        node->translation(Eigen::Vector3f(spread(random), spread(random), depth(random)));
+
+        Shader* shader = shaders[i % shaders.size()];
+        node->addComponent(ResourceManager::resourceManager()->createRenderable(std::unique_ptr<Material>(new FlatMaterial(shader)), cube));
+    }
+
+    Viewport viewport;
+    viewport.end = std::make_pair(1.0, 1.0);
+    scene->rootNode()->addChild("camera")->addComponent(std::unique_ptr<Component>(new Camera(viewport, PERSPECTIVE, 500.f, 0.1f, 1.f)));
+
+    return scene;
+}
+
+//renders frames with the given number of recording threads, and returns the mean stats of the frames after a few warmup frames
+RendererStats measureFrames(unsigned int threads, unsigned int frames){
+    Engine* engine = Engine::engine();
+    Renderer* renderer = Renderer::renderer();
+
+    renderer->setRecordThreads(threads);
+
+    double record_ms = 0.0, execute_ms = 0.0, commands = 0.0;
+    const unsigned int warmup = 5;
+
+    for(unsigned int frame = 0; frame < warmup + frames; ++frame){
+        engine->frame();
+
+        if(frame >= warmup){
+            RendererStats stats = renderer->getStats();
+            record_ms += stats.record_ms;
+            execute_ms += stats.execute_ms;
+            commands += stats.commands;
+        }
+    }
+
+    RendererStats mean;
+    mean.record_ms = (float)(record_ms / frames);
+    mean.execute_ms = (float)(execute_ms / frames);
+    mean.commands = (unsigned int)(commands / frames);
+
+    return mean;
+}
+
+//executes a buffer holding count commands of a single type, and returns the nanoseconds per command
+double measureExecution(CommandBuffer& buffer, unsigned int repetitions){
+    RendererStats stats;
+    GpuProfiler* profiler = Renderer::renderer()->gpuProfiler();
+
+    buffer.execute(profiler, stats);
+
+    auto start = std::chrono::steady_clock::now();
+    for(unsigned int i = 0; i < repetitions; ++i){
+        buffer.execute(profiler, stats);
+    }
+    double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    return elapsed / ((double)repetitions * buffer.size());
+}
+
+void runCommandTypes(Mesh* cube, Shader* shader){
+    const unsigned int count = 100000;
+    const unsigned int repetitions = 10;
+
+    FlatMaterial material(shader);
+    float matrix[16] = {1.f, 0.f, 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 0.f, 1.f};
+
+    GLuint vao = 0;
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, cube->getIBO());
+    glUseProgram(shader->getProgram());
+
+    std::vector<std::pair<std::string, std::function<void(CommandBuffer&)> > > types = {
+        {"use_program", [&](CommandBuffer& buffer){buffer.useProgram(shader->getProgram());}},
+        {"bind_vertex_array", [&](CommandBuffer& buffer){buffer.bindVertexArray(vao);}},
+        {"bind_buffer", [&](CommandBuffer& buffer){buffer.bindBuffer(GL_ARRAY_BUFFER, cube->getVBO());}},
+        {"bind_material", [&](CommandBuffer& buffer){buffer.bindMaterial(&material);}},
+        {"uniform_matrix4", [&](CommandBuffer& buffer){buffer.uniformMatrix4(material.getModelMatLocation(), matrix);}},
+        {"draw_elements", [&](CommandBuffer& buffer){buffer.drawElements(36, 0, 0);}}
+    };
+
+    std::cout << std::endl << std::left << std::setw(20) << "command" << std::right << std::setw(14) << "execute ns" << std::endl;
+
+    CommandBuffer buffer;
+    for(auto& type : types){
+        buffer.clear();
+        for(unsigned int i = 0; i < count; ++i){
+            type.second(buffer);
+        }
+
+        std::cout << std::left << std::setw(20) << type.first << std::right << std::fixed << std::setprecision(1) << std::setw(14)
+                  << measureExecution(buffer, repetitions) << std::endl;
+    }
+
+    glBindVertexArray(0);
+    glDeleteVertexArrays(1, &vao);
+}
+
+bool parseOptions(int argc, char* argv[], CommandOptions& options){
+    for(int i = 1; i < argc; ++i){
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+
+        if(arg == "--renderables" && has_value){
+            options.renderables = std::max((unsigned int)std::strtoul(argv[++i], nullptr, 10), 1u);
+        }
+        else if(arg == "--frames" && has_value){
+            options.frames = std::max((unsigned int)std::strtoul(argv[++i], nullptr, 10), 1u);
+        }
+        else if(arg == "--max-threads" && has_value){
+            options.max_threads = (unsigned int)std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if(arg == "--gl"){
+            options.device = RENDER_DEVICE_GL;
+        }
+        else{
+            std::cerr << "Error: unknown argument " << arg << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main(int argc, char* argv[]){
+    CommandOptions options;
+    if(!parseOptions(argc, argv, options)){
+        std::cerr << "usage: commandbench [--renderables N] [--frames N] [--max-threads N] [--gl]" << std::endl;
+        return 1;
+    }
+
+    Engine* engine = Engine::engine();
+    if(!engine->startupHeadless(1280, 720, options.device)){
+        return 1;
+    }
+
+    Mesh* cube = createCube();
+    std::vector<Shader*> shaders = createShaders();
+    if(cube == nullptr || shaders.empty()){
+        std::cerr << "Error: unable to create the resources of the scene" << std::endl;
+        engine->shutdown();
+        return 1;
+    }
+
+    engine->window()->setCurrentScene(buildScene(cube, shaders, options.renderables));
+
+    std::cout << options.renderables << " renderables, " << shaders.size() << " shaders, " << options.frames << " frames" << std::endl << std::endl;
+    std::cout << std::setw(8) << "threads" << std::setw(12) << "commands" << std::setw(12) << "record ms" << std::setw(10) << "speedup"
+              << std::setw(12) << "execute ms" << std::setw(14) << "ns/command" << std::endl;
+
+    double single_record_ms = 0.0;
+
+    for(unsigned int threads = 0; threads <= options.max_threads; ++threads){
+        RendererStats stats = measureFrames(threads, options.frames);
+
+        if(threads == 0){
+            single_record_ms = stats.record_ms;
+        }
+
+        std::cout << std::setw(8) << threads << std::setw(12) << stats.commands << std::fixed << std::setprecision(3) << std::setw(12)
+                  << stats.record_ms << std::setprecision(2) << std::setw(10) << single_record_ms / stats.record_ms << std::setprecision(3)
+                  << std::setw(12) << stats.execute_ms << std::setprecision(1) << std::setw(14) << stats.execute_ms * 1e6 / stats.commands
+                  << std::endl;
+    }
+
+    Renderer::renderer()->setRecordThreads(0);
+    engine->window()->setCurrentScene(nullptr);
+
+    runCommandTypes(cube, shaders.front());
+
+    engine->shutdown();
+
+    return 0;
+}
@@ -0,0 +1,1197 @@
+//Rendering benchmark suite, run headless (see Engine::startupHeadless()).
+//
+//usage: engine_bench [--frames N] [--warmup N] [--width W] [--height H] [--scene name] [--output file] [--no-finish] [--null] [--record-threads N]
+//
+//Builds each benchmark scene in turn, renders a number of warmup frames and then a fixed number of measured frames, and writes the results of
+//every scene as JSON, to the output file or stdout, along with a summary table on stderr. Scenes are generated from a fixed seed, so runs are comparable across builds. Frame times
+//include waiting for the GPU to finish the frame, unless --no-finish is given, so that they are not hidden by the driver queueing work. With
+//--null the scenes are rendered on the null device (see RenderDevice), which needs no GPU, so frame times are the CPU cost alone, and the GL
+//calls per frame are counted as well. Heap allocations made by any thread during the measured frames are counted through a replaced global
+//operator new, and reported per frame. --record-threads sets the number of threads recording command buffers along with the GL thread, see
+//Renderer::setRecordThreads().
+//
+//scenes:
+//  static_objects   10000 static cubes sharing one mesh and shader
+//  deep_hierarchy   100 chains of 50 nested nodes, each rotating
+//  many_materials   4000 cubes spread over 64 shaders, each with its own tint
+//  many_cameras     2000 cubes seen by 16 cameras, each with its own viewport
+//  dynamic_meshes   200 grids whose vertices are rewritten every frame
+//  dynamic_update   a grid of 1M vertices, all rewritten every frame through Mesh::editVertices()
+//  dynamic_recreate the same grid and rewrite, with the mesh and its renderable created anew every frame instead
+//  spawn_churn      5000 cubes, of which 250 are destroyed and respawned every frame
+//  async_load       2000 static cubes, while 1000 meshes, textures and shaders are created asynchronously from the first measured frame on
+//  sync_load        the same cubes and loads, with the loads done synchronously in the first measured frame
+//  pbo_upload       2000 static cubes, while 200 2048x2048 textures are streamed in through the pixel buffers of the TextureUploader
+//  sync_upload      the same cubes and textures, each uploaded with glTexImage2D in the frame it is created
+//
+//Scenes which load are rendered until their loads complete, for at least the number of measured frames, and report the time the loads took as
+//load_ms, from the start of the first measured frame to the end of the frame in which the last load completed.
+
+#include "../engine.h"
+#include "../renderer.h"
+#include "../renderable.h"
+#include "../camera.h"
+#include "../material.h"
+#include "../mesh.h"
+#include "../enginestats.h"
+#include "../texture.h"
+#include "../textureprocessing.h"
+#include "../textureuploader.h"
+#include "alloccount.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+const char* BENCH_VERTEX_SHADER =
+    "#version 330 core\n"
+    "in vec3 position;\n"
+    "in vec4 colour;\n"
+    "uniform mat4 model;\n"
+    "uniform mat4 view;\n"
+    "uniform mat4 projection;\n"
+    "out vec4 vertex_colour;\n"
+    "void main(){\n"
+    "    vertex_colour = colour;\n"
+    "    gl_Position = projection * view * model * vec4(position, 1.0);\n"
+    "}\n";
+
+//the variant constant makes every shader of the many_materials scene a distinct program
+const char* BENCH_FRAGMENT_SHADER =
+    "#version 330 core\n"
+    "in vec4 vertex_colour;\n"
+    "uniform vec4 tint;\n"
+    "out vec4 frag_colour;\n"
+    "const float variant = VARIANT;\n"
+    "void main(){\n"
+    "    frag_colour = vertex_colour * tint + vec4(variant * 0.0001);\n"
+    "}\n";
+
+/**
+ * @brief The BenchMaterial class draws vertex colours multiplied by a tint
+ */
+class BenchMaterial : public Material
+{
+private:
+    GLint tint_location_;
+    float tint_[4];
+
+public:
+    BenchMaterial(Shader* shader, float r, float g, float b) : tint_location_(-1){
+        setShader(shader);
+        resolveLocations();
+        tint_location_ = getShader()->getUniformLocation("tint"_sid);
+
+        tint_[0] = r;
+        tint_[1] = g;
+        tint_[2] = b;
+        tint_[3] = 1.f;
+    }
+
+    virtual std::string getMaterialName(){
+        return "bench";
+    }
+
+    virtual std::unique_ptr<Material> clone(){
+        return std::unique_ptr<Material>(new BenchMaterial(*this));
+    }
+
+    virtual void bind(){
+        if(tint_location_ >= 0){
+            glUniform4fv(tint_location_, 1, tint_);
+        }
+    }
+};
+
+/**
+ * @brief The Spinner class rotates its node a little every frame
+ */
+class Spinner : public Component
+{
+private:
+    float radians_per_frame_;
+
+protected:
+    virtual void frameStart(){
+        owner_->rotateBy(Eigen::Quaternion<float>(Eigen::AngleAxisf(radians_per_frame_, Eigen::Vector3f::UnitY())));
+    }
+
+    virtual void frameEnd(){
+    }
+
+    virtual void startup(){
+    }
+
+    virtual void shutdown(){
+    }
+
+public:
+    Spinner(float radians_per_frame) : radians_per_frame_(radians_per_frame){
+    }
+
+    virtual std::unique_ptr<Component> clone(){
+        return std::unique_ptr<Component>(new Spinner(*this));
+    }
+};
+
+std::unique_ptr<std::vector<VertexData> > gridVertices(unsigned int size){
+    std::unique_ptr<std::vector<VertexData> > vertices(new std::vector<VertexData>());
+    vertices->reserve(size * size);
+
+    for(unsigned int y = 0; y < size; ++y){
+        for(unsigned int x = 0; x < size; ++x){
+            float u = (float)x / (size - 1), v = (float)y / (size - 1);
+            VertexData vertex = {{u - 0.5f, v - 0.5f, 0.f}, {0.f, 0.f, 1.f}, {u, v, 1.f, 1.f}, {u, v}};
+            vertices->push_back(vertex);
+        }
+    }
+
+    return vertices;
+}
+
+std::unique_ptr<std::vector<GLuint> > gridIndices(unsigned int size){
+    std::unique_ptr<std::vector<GLuint> > indices(new std::vector<GLuint>());
+    indices->reserve((size - 1) * (size - 1) * 6);
+
+    for(unsigned int y = 0; y + 1 < size; ++y){
+        for(unsigned int x = 0; x + 1 < size; ++x){
+            GLuint i = y * size + x;
+            GLuint quad[] = {i, i + 1, i + size, i + 1, i + size + 1, i + size};
+            indices->insert(indices->end(), quad, quad + 6);
+        }
+    }
+
+    return indices;
+}
+
+//sets the heights of the vertices of a grid to a wave
+void waveGrid(VertexData* vertices, unsigned int size, float phase){
+    for(unsigned int y = 0; y < size; ++y){
+        for(unsigned int x = 0; x < size; ++x){
+            vertices[y * size + x].position[2] = 0.1f * std::sin(phase + 0.5f * (float)(x + y));
+        }
+    }
+}
+
+/**
+ * @brief The Wave class rewrites the heights of the vertices of a dynamic grid mesh every frame
+ */
+class Wave : public Component
+{
+private:
+    Mesh* mesh_;
+    unsigned int size_;
+    float phase_;
+
+protected:
+    virtual void frameStart(){
+        VertexData* vertices = mesh_->editVertices(0, size_ * size_);
+        if(vertices == nullptr){
+            return;
+        }
+
+        waveGrid(vertices, size_, phase_);
+        phase_ += 0.1f;
+    }
+
+    virtual void frameEnd(){
+    }
+
+    virtual void startup(){
+    }
+
+    virtual void shutdown(){
+    }
+
+public:
+    Wave(Mesh* mesh, unsigned int size, float phase) : mesh_(mesh), size_(size), phase_(phase){
+    }
+
+    virtual std::unique_ptr<Component> clone(){
+        return std::unique_ptr<Component>(new Wave(*this));
+    }
+};
+
+struct BenchOptions{
+    unsigned int frames;
+    unsigned int warmup;
+    int width;
+    int height;
+    std::string scene;
+    std::string output;
+    bool finish;
+    RenderDeviceType device;
+    unsigned int record_threads;
+
+    BenchOptions() : frames(300), warmup(30), width(1280), height(720), finish(true), device(RENDER_DEVICE_GL), record_threads(0){
+    }
+};
+
+/**
+ * @brief The BenchScene struct is a scene being benchmarked, along with the resources it created, which are freed once it is done
+ */
+struct BenchScene{
+    std::shared_ptr<Scene> scene;
+    //run before every frame, with the index of the frame
+    std::function<void(unsigned int)> update;
+    //run once the scene is done, to free what update created
+    std::function<void()> cleanup;
+    //if set, run at the start of the first measured frame, after which the scene is rendered until loaded returns true
+    std::function<void()> load;
+    std::function<bool()> loaded;
+    std::vector<Mesh*> meshes;
+    std::vector<Shader*> shaders;
+};
+
+struct BenchResult{
+    std::string name;
+    unsigned int frames;
+    double mean_ms;
+    double p50_ms;
+    double p90_ms;
+    double p99_ms;
+    double max_ms;
+    double gpu_ms;
+    double draw_calls;
+    double triangles;
+    double state_changes;
+    //only counted by the null device
+    double gl_calls;
+    double commands;
+    double record_ms;
+    double execute_ms;
+    std::int64_t gpu_allocations;
+    //heap allocations made by any thread
+    double allocations;
+    std::int64_t scene_nodes;
+    //only for scenes which load, negative otherwise
+    double load_ms;
+};
+
+std::unique_ptr<std::vector<VertexData> > cubeVertices(float r, float g, float b){
+    std::unique_ptr<std::vector<VertexData> > vertices(new std::vector<VertexData>());
+
+    for(unsigned int i = 0; i < 8; ++i){
+        VertexData vertex = {{(i & 1) ? 0.5f : -0.5f, (i & 2) ? 0.5f : -0.5f, (i & 4) ? 0.5f : -0.5f}, {0.f, 0.f, 1.f}, {r, g, b, 1.f}, {0.f, 0.f}};
+        vertices->push_back(vertex);
+    }
+
+    return vertices;
+}
+
+std::unique_ptr<std::vector<GLuint> > cubeIndices(){
+    const GLuint faces[] = {0, 2, 1, 1, 2, 3, 4, 5, 6, 5, 7, 6, 0, 1, 4, 1, 5, 4, 2, 6, 3, 3, 6, 7, 0, 4, 2, 2, 4, 6, 1, 3, 5, 3, 7, 5};
+
+    return std::unique_ptr<std::vector<GLuint> >(new std::vector<GLuint>(faces, faces + 36));
+}
+
+Mesh* createCube(BenchScene& bench, const std::string& name){
+    Mesh* mesh = ResourceManager::resourceManager()->createMesh(name, cubeVertices(0.8f, 0.8f, 0.8f), cubeIndices());
+    bench.meshes.push_back(mesh);
+
+    return mesh;
+}
+
+Mesh* createGrid(BenchScene& bench, const std::string& name, unsigned int size){
+    Mesh* mesh = ResourceManager::resourceManager()->createMesh(name, gridVertices(size), gridIndices(size), CACHE, DYNAMIC_MESH);
+    bench.meshes.push_back(mesh);
+
+    return mesh;
+}
+
+std::string fragmentShader(unsigned int variant){
+    std::string fragment = BENCH_FRAGMENT_SHADER;
+    fragment.replace(fragment.find("VARIANT"), 7, std::to_string(variant) + ".0");
+
+    return fragment;
+}
+
+Shader* createShader(BenchScene& bench, const std::string& name, unsigned int variant){
+    Shader* shader = ResourceManager::resourceManager()->createShader(name, BENCH_VERTEX_SHADER, fragmentShader(variant), SHADER_RAW);
+    if(shader != nullptr){
+        bench.shaders.push_back(shader);
+    }
+
+    return shader;
+}
+
+SceneNode* addCamera(SceneNode* parent, const Viewport& viewport, const Eigen::Vector3f& position){
+    SceneNode* node = parent->addChild("camera");
+    node->translation(position);
+    node->addComponent(std::unique_ptr<Component>(new Camera(viewport, PERSPECTIVE, 500.f, 0.1f, 1.f)));
+
+    return node;
+}
+
+Viewport fullViewport(){
+    Viewport viewport;
+    viewport.end = std::make_pair(1.0, 1.0);
+
+    return viewport;
+}
+
+SceneNode* addObject(SceneNode* parent, Mesh* mesh, Shader* shader, const Eigen::Vector3f& position, float r, float g, float b){
+    SceneNode* node = parent->addChild("object");
+    node->translation(position);
+
+    auto renderable = ResourceManager::resourceManager()->createRenderable(std::unique_ptr<Material>(new BenchMaterial(shader, r, g, b)), mesh);
+    if(renderable != nullptr){
+        node->addComponent(std::move(renderable));
+    }
+
+    return node;
+}
+
+Eigen::Vector3f randomPosition(std::mt19937& random){
+    std::uniform_real_distribution<float> spread(-40.f, 40.f);
+    std::uniform_real_distribution<float> depth(-60.f, 0.f);
+
+    return Eigen::Vector3f(spread(random), spread(random), depth(random));
+}
+
+BenchScene buildStaticObjects(std::mt19937& random){
+    BenchScene bench;
+    bench.scene = std::make_shared<Scene>();
+
+    Mesh* cube = createCube(bench, "static_cube");
+    Shader* shader = createShader(bench, "static_shader", 0);
+
+    SceneNode* root = bench.scene->rootNode();
+    addCamera(root, fullViewport(), Eigen::Vector3f(0.f, 0.f, 60.f));
+
+    for(unsigned int i = 0; i < 10000; ++i){
+        addObject(root, cube, shader, randomPosition(random), 1.f, 1.f, 1.f);
+    }
+
+    return bench;
+}
+
+BenchScene buildDeepHierarchy(std::mt19937& random){
+    BenchScene bench;
+    bench.scene = std::make_shared<Scene>();
+
+    Mesh* cube = createCube(bench, "hierarchy_cube");
+    Shader* shader = createShader(bench, "hierarchy_shader", 0);
+
+    SceneNode* root = bench.scene->rootNode();
+    addCamera(root, fullViewport(), Eigen::Vector3f(0.f, 0.f, 60.f));
+
+    for(unsigned int chain = 0; chain < 100; ++chain){
+        SceneNode* parent = root;
+        Eigen::Vector3f position = randomPosition(random);
+
+        for(unsigned int depth = 0; depth < 50; ++depth){
+            parent = addObject(parent, cube, shader, position, 1.f, 1.f, 1.f);
+            parent->scale(Eigen::Vector3f(0.98f, 0.98f, 0.98f));
+            parent->addComponent(std::unique_ptr<Component>(new Spinner(0.01f)));
+
+            position = Eigen::Vector3f(0.f, 0.6f, 0.f);
+        }
+    }
+
+    return bench;
+}
+
+BenchScene buildManyMaterials(std::mt19937& random){
+    BenchScene bench;
+    bench.scene = std::make_shared<Scene>();
+
+    Mesh* cube = createCube(bench, "materials_cube");
+
+    std::vector<Shader*> shaders;
+    for(unsigned int i = 0; i < 64; ++i){
+        shaders.push_back(createShader(bench, "materials_shader_" + std::to_string(i), i));
+    }
+
+    SceneNode* root = bench.scene->rootNode();
+    addCamera(root, fullViewport(), Eigen::Vector3f(0.f, 0.f, 60.f));
+
+    std::uniform_real_distribution<float> colour(0.f, 1.f);
+    for(unsigned int i = 0; i < 4000; ++i){
+        addObject(root, cube, shaders[i % shaders.size()], randomPosition(random), colour(random), colour(random), colour(random));
+    }
+
+    return bench;
+}
+
+BenchScene buildManyCameras(std::mt19937& random){
+    BenchScene bench;
+    bench.scene = std::make_shared<Scene>();
+
+    Mesh* cube = createCube(bench, "cameras_cube");
+    Shader* shader = createShader(bench, "cameras_shader", 0);
+
+    SceneNode* root = bench.scene->rootNode();
+
+    for(unsigned int y = 0; y < 4; ++y){
+        for(unsigned int x = 0; x < 4; ++x){
+            Viewport viewport;
+            viewport.start = std::make_pair(x / 4.0, y / 4.0);
+            viewport.end = std::make_pair((x + 1) / 4.0, (y + 1) / 4.0);
+
+            addCamera(root, viewport, Eigen::Vector3f((float)x * 5.f - 7.5f, (float)y * 5.f - 7.5f, 60.f));
+        }
+    }
+
+    for(unsigned int i = 0; i < 2000; ++i){
+        addObject(root, cube, shader, randomPosition(random), 1.f, 1.f, 1.f);
+    }
+
+    return bench;
+}
+
+BenchScene buildDynamicMeshes(std::mt19937& random){
+    BenchScene bench;
+    bench.scene = std::make_shared<Scene>();
+
+    Shader* shader = createShader(bench, "dynamic_shader", 0);
+
+    SceneNode* root = bench.scene->rootNode();
+    addCamera(root, fullViewport(), Eigen::Vector3f(0.f, 0.f, 60.f));
+
+    const unsigned int grid_size = 32;
+    std::uniform_real_distribution<float> phase(0.f, 6.28f);
+
+    for(unsigned int i = 0; i < 200; ++i){
+        Mesh* grid = createGrid(bench, "dynamic_grid_" + std::to_string(i), grid_size);
+
+        SceneNode* node = addObject(root, grid, shader, randomPosition(random), 1.f, 1.f, 1.f);
+        node->scale(Eigen::Vector3f(4.f, 4.f, 4.f));
+        node->addComponent(std::unique_ptr<Component>(new Wave(grid, grid_size, phase(random))));
+    }
+
+    return bench;
+}
+
+//side of the grids of the dynamic_update and dynamic_recreate scenes, 1M vertices
+const unsigned int LARGE_GRID_SIZE = 1000;
+
+BenchScene buildDynamicUpdate(std::mt19937&){
+    BenchScene bench;
+    bench.scene = std::make_shared<Scene>();
+
+    Shader* shader = createShader(bench, "update_shader", 0);
+
+    SceneNode* root = bench.scene->rootNode();
+    addCamera(root, fullViewport(), Eigen::Vector3f(0.f, 0.f, 60.f));
+
+    Mesh* grid = createGrid(bench, "update_grid", LARGE_GRID_SIZE);
+
+    SceneNode* node = addObject(root, grid, shader, Eigen::Vector3f::Zero(), 1.f, 1.f, 1.f);
+    node->scale(Eigen::Vector3f(40.f, 40.f, 40.f));
+    node->addComponent(std::unique_ptr<Component>(new Wave(grid, LARGE_GRID_SIZE, 0.f)));
+
+    return bench;
+}
+
+BenchScene buildDynamicRecreate(std::mt19937&){
+    BenchScene bench;
+    bench.scene = std::make_shared<Scene>();
+
+    Shader* shader = createShader(bench, "recreate_shader", 0);
+
+    SceneNode* root = bench.scene->rootNode();
+    addCamera(root, fullViewport(), Eigen::Vector3f(0.f, 0.f, 60.f));
+
+    //the mesh and node of the last frame, replaced every frame as static meshes can not be changed once uploaded
+    std::shared_ptr<std::pair<Mesh*, SceneNode*> > current = std::make_shared<std::pair<Mesh*, SceneNode*> >(nullptr, nullptr);
+
+    bench.update = [=](unsigned int frame){
+        ResourceManager* resource_manager = ResourceManager::resourceManager();
+
+        if(current->first != nullptr){
+            current->second->destroy();
+            resource_manager->freeMesh(current->first->getHandle());
+        }
+
+        std::unique_ptr<std::vector<VertexData> > vertices = gridVertices(LARGE_GRID_SIZE);
+        waveGrid(&(*vertices)[0], LARGE_GRID_SIZE, 0.1f * frame);
+
+        current->first = resource_manager->createMesh("recreate_grid_" + std::to_string(frame), std::move(vertices), gridIndices(LARGE_GRID_SIZE));
+        current->second = addObject(root, current->first, shader, Eigen::Vector3f::Zero(), 1.f, 1.f, 1.f);
+        current->second->scale(Eigen::Vector3f(40.f, 40.f, 40.f));
+    };
+
+    bench.cleanup = [=](){
+        if(current->first != nullptr){
+            ResourceManager::resourceManager()->freeMesh(current->first->getHandle());
+        }
+    };
+
+    return bench;
+}
+
+BenchScene buildSpawnChurn(std::mt19937& random){
+    BenchScene bench;
+    bench.scene = std::make_shared<Scene>();
+
+    Mesh* cube = createCube(bench, "churn_cube");
+    Shader* shader = createShader(bench, "churn_shader", 0);
+
+    SceneNode* root = bench.scene->rootNode();
+    addCamera(root, fullViewport(), Eigen::Vector3f(0.f, 0.f, 60.f));
+
+    std::shared_ptr<std::vector<SceneNode*> > objects = std::make_shared<std::vector<SceneNode*> >();
+    for(unsigned int i = 0; i < 5000; ++i){
+        objects->push_back(addObject(root, cube, shader, randomPosition(random), 1.f, 1.f, 1.f));
+    }
+
+    //the oldest objects are destroyed and replaced, so every object lives for 20 frames
+    std::shared_ptr<std::mt19937> churn_random = std::make_shared<std::mt19937>(random());
+    bench.update = [=](unsigned int frame){
+        const unsigned int churn = 250;
+        size_t first = (frame * churn) % objects->size();
+
+        for(size_t i = first; i < first + churn; ++i){
+            (*objects)[i]->destroy();
+            (*objects)[i] = addObject(root, cube, shader, randomPosition(*churn_random), 1.f, 1.f, 1.f);
+        }
+    };
+
+    return bench;
+}
+
+//number of resources created by the async_load and sync_load scenes, of which every tenth is a shader and three in ten are textures
+const unsigned int LOAD_COUNT = 1000;
+const unsigned int LOAD_GRID_SIZE = 32;
+const unsigned int LOAD_TEXTURE_SIZE = 256;
+
+enum LoadKind{LOAD_MESH, LOAD_TEXTURE, LOAD_SHADER};
+
+LoadKind loadKind(unsigned int index){
+    unsigned int slot = index % 10;
+    return slot == 9 ? LOAD_SHADER : (slot >= 6 ? LOAD_TEXTURE : LOAD_MESH);
+}
+
+//produces the data of a loaded texture, a pattern which differs per texture, with its mip chain
+bool loadTextureData(unsigned int seed, ProcessedTexture& texture){
+    std::vector<unsigned char> pixels(LOAD_TEXTURE_SIZE * LOAD_TEXTURE_SIZE * 4);
+    for(size_t i = 0; i < pixels.size(); ++i){
+        pixels[i] = (unsigned char)((i * 31 + seed * 17) & 0xFF);
+    }
+
+    texture.format = TEXTURE_FORMAT_RAW;
+    texture.channels = 4;
+    texture.levels = generateMipChain(&pixels[0], LOAD_TEXTURE_SIZE, LOAD_TEXTURE_SIZE, 4, false, MIP_FILTER_BOX);
+
+    return true;
+}
+
+/**
+ * @brief The LoadedResources struct holds what the async_load and sync_load scenes created, so that it can be freed once they are done
+ */
+struct LoadedResources{
+    std::vector<std::shared_future<Mesh*> > mesh_futures;
+    std::vector<std::shared_future<Shader*> > shader_futures;
+    std::vector<std::shared_future<Texture*> > texture_futures;
+
+    std::vector<Mesh*> meshes;
+    std::vector<Shader*> shaders;
+    std::vector<Texture*> textures;
+};
+
+//moves the results of the futures which are ready into resources, and returns whether all of them were
+template<class T>
+bool collectReady(std::vector<std::shared_future<T*> >& futures, std::vector<T*>& resources){
+    bool done = true;
+
+    for(size_t i = 0; i < futures.size();){
+        if(futures[i].wait_for(std::chrono::seconds(0)) != std::future_status::ready){
+            done = false;
+            ++i;
+            continue;
+        }
+
+        if(futures[i].get() != nullptr){
+            resources.push_back(futures[i].get());
+        }
+        futures.erase(futures.begin() + i);
+    }
+
+    return done;
+}
+
+bool collectLoads(LoadedResources& loaded){
+    bool meshes = collectReady(loaded.mesh_futures, loaded.meshes);
+    bool shaders = collectReady(loaded.shader_futures, loaded.shaders);
+    bool textures = collectReady(loaded.texture_futures, loaded.textures);
+
+    return meshes && shaders && textures;
+}
+
+void freeLoads(LoadedResources& loaded){
+    ResourceManager* resource_manager = ResourceManager::resourceManager();
+
+    //loads which never completed are left to the resource manager to free on shutdown
+    collectLoads(loaded);
+
+    for(auto mesh : loaded.meshes){
+        resource_manager->freeMesh(mesh->getHandle());
+    }
+
+    for(auto shader : loaded.shaders){
+        resource_manager->freeShader(shader->getHandle());
+    }
+
+    for(auto texture : loaded.textures){
+        resource_manager->textureManager()->freeTexture(texture->getHandle());
+    }
+}
+
+//the cubes rendered while loading
+BenchScene buildLoadScene(std::mt19937& random, const std::string& prefix){
+    BenchScene bench;
+    bench.scene = std::make_shared<Scene>();
+
+    Mesh* cube = createCube(bench, prefix + "_cube");
+    Shader* shader = createShader(bench, prefix + "_shader", 0);
+
+    SceneNode* root = bench.scene->rootNode();
+    addCamera(root, fullViewport(), Eigen::Vector3f(0.f, 0.f, 60.f));
+
+    for(unsigned int i = 0; i < 2000; ++i){
+        addObject(root, cube, shader, randomPosition(random), 1.f, 1.f, 1.f);
+    }
+
+    return bench;
+}
+
+BenchScene buildAsyncLoad(std::mt19937& random){
+    BenchScene bench = buildLoadScene(random, "async_load");
+    std::shared_ptr<LoadedResources> loaded = std::make_shared<LoadedResources>();
+
+    bench.load = [=](){
+        ResourceManager* resource_manager = ResourceManager::resourceManager();
+
+        for(unsigned int i = 0; i < LOAD_COUNT; ++i){
+            std::string name = "async_load_" + std::to_string(i);
+
+            switch(loadKind(i)){
+                case LOAD_MESH:
+                    loaded->mesh_futures.push_back(resource_manager->createMeshAsync(name, [](std::vector<VertexData>& vertices, std::vector<GLuint>& indices){
+                        vertices = std::move(*gridVertices(LOAD_GRID_SIZE));
+                        indices = std::move(*gridIndices(LOAD_GRID_SIZE));
+                        return true;
+                    }));
+                    break;
+                case LOAD_TEXTURE:
+                    loaded->texture_futures.push_back(resource_manager->createTextureAsync(name, [i](ProcessedTexture& texture){
+                        return loadTextureData(i, texture);
+                    }));
+                    break;
+                case LOAD_SHADER:
+                    //variants differ from those of the sync_load scene, so that neither hits shaders the driver cached for the other
+                    loaded->shader_futures.push_back(resource_manager->createShaderAsync(name, BENCH_VERTEX_SHADER, fragmentShader(10000 + i), SHADER_RAW));
+                    break;
+            }
+        }
+    };
+
+    //textures are only loaded once their data has been uploaded through the pixel buffers
+    bench.loaded = [=](){
+        return collectLoads(*loaded) && ResourceManager::resourceManager()->textureManager()->uploader()->getStats().pending_textures == 0;
+    };
+
+    bench.cleanup = [=](){
+        freeLoads(*loaded);
+    };
+
+    return bench;
+}
+
+BenchScene buildSyncLoad(std::mt19937& random){
+    BenchScene bench = buildLoadScene(random, "sync_load");
+    std::shared_ptr<LoadedResources> loaded = std::make_shared<LoadedResources>();
+
+    bench.load = [=](){
+        ResourceManager* resource_manager = ResourceManager::resourceManager();
+
+        for(unsigned int i = 0; i < LOAD_COUNT; ++i){
+            std::string name = "sync_load_" + std::to_string(i);
+
+            switch(loadKind(i)){
+                case LOAD_MESH:{
+                    Mesh* mesh = resource_manager->createMesh(name, gridVertices(LOAD_GRID_SIZE), gridIndices(LOAD_GRID_SIZE));
+                    if(mesh != nullptr){
+                        loaded->meshes.push_back(mesh);
+                    }
+                    break;
+                }
+                case LOAD_TEXTURE:{
+                    ProcessedTexture data;
+                    loadTextureData(i, data);
+
+                    //uploaded right away, as the async textures are counted as loaded once uploaded
+                    Texture* texture = resource_manager->textureManager()->createTexture(name, std::move(data));
+                    if(texture != nullptr){
+                        texture->getTextureName();
+                        loaded->textures.push_back(texture);
+                    }
+                    break;
+                }
+                case LOAD_SHADER:{
+                    Shader* shader = resource_manager->createShader(name, BENCH_VERTEX_SHADER, fragmentShader(20000 + i), SHADER_RAW);
+                    if(shader != nullptr){
+                        loaded->shaders.push_back(shader);
+                    }
+                    break;
+                }
+            }
+        }
+    };
+
+    bench.loaded = [](){
+        return true;
+    };
+
+    bench.cleanup = [=](){
+        freeLoads(*loaded);
+    };
+
+    return bench;
+}
+
+//textures streamed in by the pbo_upload and sync_upload scenes, started a few per frame, with a limit on those still uploading so that the
+//storage allocated for them stays bounded. Textures are freed once uploaded
+const unsigned int UPLOAD_COUNT = 200;
+const unsigned int UPLOAD_TEXTURE_SIZE = 2048;
+const unsigned int UPLOADS_PER_FRAME = 4;
+const unsigned int MAX_PENDING_UPLOADS = 16;
+
+//writes rows of a streamed texture, a pattern which differs per texture
+void fillUploadRows(unsigned int seed, unsigned int first_row, unsigned int num_rows, unsigned char* dest){
+    size_t row_size = UPLOAD_TEXTURE_SIZE * 4;
+
+    for(unsigned int row = 0; row < num_rows; ++row){
+        std::memset(dest + row * row_size, (int)((first_row + row + seed * 13) & 0xFF), row_size);
+    }
+}
+
+/**
+ * @brief The UploadStream struct tracks the textures of the pbo_upload and sync_upload scenes
+ */
+struct UploadStream{
+    bool started;
+    unsigned int next;
+    unsigned int completed;
+    std::deque<Texture*> pending;
+
+    UploadStream() : started(false), next(0), completed(0){
+    }
+};
+
+BenchScene buildPboUpload(std::mt19937& random){
+    BenchScene bench = buildLoadScene(random, "pbo_upload");
+    std::shared_ptr<UploadStream> stream = std::make_shared<UploadStream>();
+
+    bench.load = [=](){
+        stream->started = true;
+    };
+
+    bench.update = [=](unsigned int){
+        if(!stream->started){
+            return;
+        }
+
+        TextureManager* texture_manager = ResourceManager::resourceManager()->textureManager();
+
+        //textures return their name once every chunk has been uploaded
+        for(size_t i = 0; i < stream->pending.size();){
+            if(stream->pending[i]->getTextureName() == 0){
+                ++i;
+                continue;
+            }
+
+            texture_manager->freeTexture(stream->pending[i]->getHandle());
+            stream->pending.erase(stream->pending.begin() + i);
+            stream->completed++;
+        }
+
+        TextureLayout layout;
+        layout.width = UPLOAD_TEXTURE_SIZE;
+        layout.height = UPLOAD_TEXTURE_SIZE;
+
+        for(unsigned int i = 0; i < UPLOADS_PER_FRAME && stream->next < UPLOAD_COUNT && stream->pending.size() < MAX_PENDING_UPLOADS; ++i){
+            unsigned int seed = stream->next++;
+
+            Texture* texture = texture_manager->createTextureAsync("pbo_upload_" + std::to_string(seed), layout,
+                                                                   [seed](unsigned int, unsigned int first_row, unsigned int num_rows, unsigned char* dest){
+                fillUploadRows(seed, first_row, num_rows, dest);
+                return true;
+            });
+
+            if(texture == nullptr){
+                stream->completed++;
+                continue;
+            }
+
+            //starts the upload
+            texture->getTextureName();
+            stream->pending.push_back(texture);
+        }
+    };
+
+    bench.loaded = [=](){
+        return stream->completed == UPLOAD_COUNT;
+    };
+
+    bench.cleanup = [=](){
+        for(auto texture : stream->pending){
+            ResourceManager::resourceManager()->textureManager()->freeTexture(texture->getHandle());
+        }
+    };
+
+    return bench;
+}
+
+BenchScene buildSyncUpload(std::mt19937& random){
+    BenchScene bench = buildLoadScene(random, "sync_upload");
+    std::shared_ptr<UploadStream> stream = std::make_shared<UploadStream>();
+
+    bench.load = [=](){
+        stream->started = true;
+    };
+
+    bench.update = [=](unsigned int){
+        if(!stream->started){
+            return;
+        }
+
+        TextureManager* texture_manager = ResourceManager::resourceManager()->textureManager();
+
+        for(unsigned int i = 0; i < UPLOADS_PER_FRAME && stream->next < UPLOAD_COUNT; ++i){
+            unsigned int seed = stream->next++;
+
+            ProcessedTexture data;
+            data.levels.resize(1);
+            data.levels[0].width = UPLOAD_TEXTURE_SIZE;
+            data.levels[0].height = UPLOAD_TEXTURE_SIZE;
+            data.levels[0].data.resize(UPLOAD_TEXTURE_SIZE * UPLOAD_TEXTURE_SIZE * 4);
+            fillUploadRows(seed, 0, UPLOAD_TEXTURE_SIZE, &data.levels[0].data[0]);
+
+            //uploaded with glTexImage2D from client memory right away
+            Texture* texture = texture_manager->createTexture("sync_upload_" + std::to_string(seed), std::move(data));
+            if(texture != nullptr){
+                texture->getTextureName();
+                texture_manager->freeTexture(texture->getHandle());
+            }
+
+            stream->completed++;
+        }
+    };
+
+    bench.loaded = [=](){
+        return stream->completed == UPLOAD_COUNT;
+    };
+
+    return bench;
+}
+
+//frames after which a scene stops waiting for its loads to complete
+const unsigned int MAX_LOAD_FRAMES = 100000;
+
+double percentile(const std::vector<double>& sorted, double fraction){
+    size_t index = (size_t)std::ceil(fraction * sorted.size());
+    return sorted[std::min(index > 0 ? index - 1 : 0, sorted.size() - 1)];
+}
+
+BenchResult runScene(const std::string& name, std::function<BenchScene(std::mt19937&)> build, const BenchOptions& options){
+    Engine* engine = Engine::engine();
+    ResourceManager* resource_manager = ResourceManager::resourceManager();
+    EngineStats* stats = EngineStats::engineStats();
+    RenderDevice* device = RenderDevice::renderDevice();
+
+    //same seed for every scene, so that a scene is identical whichever scenes run before it
+    std::mt19937 random(1234);
+    BenchScene bench = build(random);
+
+    engine->window()->setCurrentScene(bench.scene);
+
+    std::vector<double> frame_ms;
+    double gpu_ms = 0.0, draw_calls = 0.0, triangles = 0.0, state_changes = 0.0, commands = 0.0, record_ms = 0.0, execute_ms = 0.0;
+    std::int64_t gpu_allocations = 0;
+    std::uint64_t allocations = 0;
+
+    std::chrono::steady_clock::time_point load_start;
+    double load_ms = -1.0;
+    bool loading = false;
+
+    for(unsigned int frame = 0; frame < options.warmup + options.frames || loading; ++frame){
+        if(frame == options.warmup){
+            device->resetCallCounts();
+        }
+
+        std::uint64_t start_allocations = allocationCount();
+        auto start = std::chrono::steady_clock::now();
+
+        if(frame == options.warmup && bench.load){
+            load_start = start;
+            loading = true;
+            bench.load();
+        }
+
+        if(bench.update){
+            bench.update(frame);
+        }
+
+        engine->frame();
+
+        if(options.finish){
+            glFinish();
+        }
+
+        double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::uint64_t frame_allocations = allocationCount() - start_allocations;
+
+        if(frame < options.warmup){
+            continue;
+        }
+
+        if(loading && bench.loaded()){
+            load_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - load_start).count();
+            loading = false;
+        }
+        else if(loading && frame >= options.warmup + MAX_LOAD_FRAMES){
+            std::cerr << "Error: loads of " << name << " did not complete within " << MAX_LOAD_FRAMES << " frames" << std::endl;
+            loading = false;
+        }
+
+        EngineFrameStats counters = stats->getLastFrame();
+
+        frame_ms.push_back(elapsed);
+        allocations += frame_allocations;
+        gpu_ms += counters.values[COUNTER_GPU_TIME_US] / 1000.0;
+        draw_calls += (double)counters.values[COUNTER_DRAW_CALLS];
+        triangles += (double)counters.values[COUNTER_TRIANGLES];
+        state_changes += (double)counters.values[COUNTER_STATE_CHANGES];
+
+        RendererStats renderer_stats = Renderer::renderer()->getStats();
+        commands += renderer_stats.commands;
+        record_ms += renderer_stats.record_ms;
+        execute_ms += renderer_stats.execute_ms;
+        gpu_allocations += counters.values[COUNTER_GPU_ALLOCATIONS];
+    }
+
+    //scenes which load may have been rendered for more frames than asked for
+    unsigned int frames = (unsigned int)frame_ms.size();
+
+    BenchResult result;
+    result.name = name;
+    result.frames = frames;
+    result.scene_nodes = EngineStats::get(COUNTER_SCENE_NODES);
+
+    std::vector<double> sorted = frame_ms;
+    std::sort(sorted.begin(), sorted.end());
+
+    double sum = 0.0;
+    for(double ms : frame_ms){
+        sum += ms;
+    }
+
+    result.mean_ms = sum / frame_ms.size();
+    result.p50_ms = percentile(sorted, 0.5);
+    result.p90_ms = percentile(sorted, 0.9);
+    result.p99_ms = percentile(sorted, 0.99);
+    result.max_ms = sorted.back();
+    result.gpu_ms = gpu_ms / frames;
+    result.draw_calls = draw_calls / frames;
+    result.triangles = triangles / frames;
+    result.state_changes = state_changes / frames;
+    result.gl_calls = (double)device->getTotalCalls() / frames;
+    result.commands = commands / frames;
+    result.record_ms = record_ms / frames;
+    result.execute_ms = execute_ms / frames;
+    result.gpu_allocations = gpu_allocations;
+    result.allocations = (double)allocations / frames;
+    result.load_ms = load_ms;
+
+    //the scene goes first so that its renderables release their vertex arrays, then a few frames let the deferred frees run
+    engine->window()->setCurrentScene(nullptr);
+    bench.scene = nullptr;
+
+    for(auto mesh : bench.meshes){
+        resource_manager->freeMesh(mesh->getHandle());
+    }
+
+    for(auto shader : bench.shaders){
+        resource_manager->freeShader(shader->getHandle());
+    }
+
+    if(bench.cleanup){
+        bench.cleanup();
+    }
+
+    for(unsigned int i = 0; i <= RESOURCE_FREE_DELAY_FRAMES; ++i){
+        engine->frame();
+    }
+
+    return result;
+}
+
+void writeResults(std::ostream& stream, const BenchOptions& options, const std::vector<BenchResult>& results){
+    const char* renderer = (const char*)glGetString(GL_RENDERER);
+
+    stream << "{\n  \"renderer\": \"" << (renderer != nullptr ? renderer : "unknown") << "\",\n  \"width\": " << options.width << ",\n  \"height\": "
+           << options.height << ",\n  \"frames\": " << options.frames << ",\n  \"warmup\": " << options.warmup << ",\n  \"finish\": "
+           << (options.finish ? "true" : "false") << ",\n  \"device\": \"" << (options.device == RENDER_DEVICE_NULL ? "null" : "gl")
+           << "\",\n  \"record_threads\": " << options.record_threads << ",\n  \"scenes\": [";
+
+    for(size_t i = 0; i < results.size(); ++i){
+        const BenchResult& result = results[i];
+
+        stream << (i > 0 ? "," : "") << "\n    {\"name\": \"" << result.name << "\", \"frames\": " << result.frames << ", \"scene_nodes\": "
+               << result.scene_nodes << ",\n     \"frame_ms\": {\"mean\": " << result.mean_ms << ", \"p50\": " << result.p50_ms << ", \"p90\": "
+               << result.p90_ms << ", \"p99\": " << result.p99_ms << ", \"max\": " << result.max_ms << "},\n     \"gpu_ms\": " << result.gpu_ms
+               << ", \"draw_calls\": " << result.draw_calls << ", \"triangles\": " << result.triangles << ", \"state_changes\": "
+               << result.state_changes << ", \"gl_calls\": " << result.gl_calls << ",\n     \"commands\": " << result.commands << ", \"record_ms\": " << result.record_ms
+               << ", \"execute_ms\": " << result.execute_ms << ", \"gpu_allocations\": " << result.gpu_allocations
+               << ", \"allocations_per_frame\": " << result.allocations;
+
+        if(result.load_ms >= 0.0){
+            stream << ", \"load_ms\": " << result.load_ms;
+        }
+
+        stream << "}";
+    }
+
+    stream << "\n  ]\n}\n";
+}
+
+void writeTable(std::ostream& stream, const std::vector<BenchResult>& results){
+    stream << std::left << std::setw(18) << "scene" << std::right << std::setw(10) << "mean ms" << std::setw(10) << "p99 ms" << std::setw(10)
+           << "max ms" << std::setw(14) << "allocs/frame" << std::setw(12) << "load ms" << std::endl;
+
+    for(auto& result : results){
+        stream << std::left << std::setw(18) << result.name << std::right << std::fixed << std::setprecision(2) << std::setw(10) << result.mean_ms
+               << std::setw(10) << result.p99_ms << std::setw(10) << result.max_ms << std::setprecision(1) << std::setw(14) << result.allocations
+               << std::setw(12);
+
+        if(result.load_ms >= 0.0){
+            stream << result.load_ms << std::endl;
+        }
+        else{
+            stream << "-" << std::endl;
+        }
+    }
+}
+
+bool parseOptions(int argc, char* argv[], BenchOptions& options){
+    for(int i = 1; i < argc; ++i){
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+
+        if(arg == "--frames" && has_value){
+            options.frames = std::max((unsigned int)std::strtoul(argv[++i], nullptr, 10), 1u);
+        }
+        else if(arg == "--warmup" && has_value){
+            options.warmup = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if(arg == "--width" && has_value){
+            options.width = std::max(std::atoi(argv[++i]), 1);
+        }
+        else if(arg == "--height" && has_value){
+            options.height = std::max(std::atoi(argv[++i]), 1);
+        }
+        else if(arg == "--scene" && has_value){
+            options.scene = argv[++i];
+        }
+        else if(arg == "--output" && has_value){
+            options.output = argv[++i];
+        }
+        else if(arg == "--no-finish"){
+            options.finish = false;
+        }
+        else if(arg == "--null"){
+            options.device = RENDER_DEVICE_NULL;
+        }
+        else if(arg == "--record-threads" && has_value){
+            options.record_threads = (unsigned int)std::strtoul(argv[++i], nullptr, 10);
+        }
+        else{
+            std::cerr << "Error: unknown argument " << arg << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main(int argc, char* argv[]){
+    BenchOptions options;
+    if(!parseOptions(argc, argv, options)){
+        std::cerr << "usage: engine_bench [--frames N] [--warmup N] [--width W] [--height H] [--scene name] [--output file] [--no-finish] [--null] [--record-threads N]"
+                  << std::endl;
+        return 1;
+    }
+
+    std::vector<std::pair<std::string, std::function<BenchScene(std::mt19937&)> > > scenes = {
+        {"static_objects", buildStaticObjects},
+        {"deep_hierarchy", buildDeepHierarchy},
+        {"many_materials", buildManyMaterials},
+        {"many_cameras", buildManyCameras},
+        {"dynamic_meshes", buildDynamicMeshes},
+        {"dynamic_update", buildDynamicUpdate},
+        {"dynamic_recreate", buildDynamicRecreate},
+        {"spawn_churn", buildSpawnChurn},
+        {"async_load", buildAsyncLoad},
+        {"sync_load", buildSyncLoad},
+        {"pbo_upload", buildPboUpload},
+        {"sync_upload", buildSyncUpload}
+    };
+
+    Engine* engine = Engine::engine();
+    if(!engine->startupHeadless(options.width, options.height, options.device)){
+        return 1;
+    }
+
+    glEnable(GL_DEPTH_TEST);
+    Renderer::renderer()->gpuProfiler()->setEnabled(true);
+    Renderer::renderer()->setRecordThreads(options.record_threads);
+
+    std::vector<BenchResult> results;
+    for(auto& scene : scenes){
+        if(!options.scene.empty() && options.scene != scene.first){
+            continue;
+        }
+
+        std::cerr << "running " << scene.first << std::endl;
+        results.push_back(runScene(scene.first, scene.second, options));
+    }
+
+    if(results.empty()){
+        std::cerr << "Error: unknown scene " << options.scene << std::endl;
+    }
+    else if(options.output.empty()){
+        writeResults(std::cout, options, results);
+    }
+    else{
+        std::ofstream file(options.output);
+        if(!file.is_open()){
+            std::cerr << "Error: unable to write results to " << options.output << std::endl;
+        }
+        else{
+            writeResults(file, options, results);
+        }
+    }
+
+    if(!results.empty()){
+        writeTable(std::cerr, results);
+    }
+
+    engine->shutdown();
+
+    return results.empty() ? 1 : 0;
+}
@@ -0,0 +1,290 @@
+//Offline converter from Wavefront OBJ files to the engine's binary mesh format (see meshfile.h).
+//
+//usage: meshconvert output.emsh lod0.obj [lod1.obj ...]
+//       meshconvert --time-obj model.obj
+//       meshconvert --time-mesh model.emsh
+//
+//Each OBJ passed is stored as a level of detail, most detailed first. All levels share the vertex section of the output file.
+//The timing modes load a single file the way the engine would and report the load time and peak resident set size, run them as separate
+//processes to compare the two formats.
+
+#include "../meshfile.h"
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+struct ObjIndex{
+    long position;
+    long texcoord;
+    long normal;
+
+    bool operator == (const ObjIndex& other) const{
+        return position == other.position && texcoord == other.texcoord && normal == other.normal;
+    }
+};
+
+struct ObjIndexHash{
+    size_t operator () (const ObjIndex& index) const{
+        std::uint64_t hash = 14695981039346656037ULL;
+        hash = (hash ^ (std::uint64_t)index.position) * 1099511628211ULL;
+        hash = (hash ^ (std::uint64_t)index.texcoord) * 1099511628211ULL;
+        hash = (hash ^ (std::uint64_t)index.normal) * 1099511628211ULL;
+        return (size_t)hash;
+    }
+};
+
+struct MeshData{
+    std::vector<float> vertices;
+    std::vector<std::uint32_t> indices;
+    std::vector<MeshFileLOD> lods;
+    std::uint32_t attributes;
+
+    MeshData() : attributes(MESH_ATTRIBUTE_POSITION){
+    }
+};
+
+//resolves a possibly negative (relative) OBJ index into a zero based index, returns -1 if out of range or absent
+long resolveObjIndex(long index, size_t count){
+    if(index > 0 && (size_t)index <= count){
+        return index - 1;
+    }
+
+    if(index < 0 && (size_t)(-index) <= count){
+        return (long)count + index;
+    }
+
+    return -1;
+}
+
+//parses a face vertex of the form p, p/t, p//n or p/t/n
+ObjIndex parseFaceVertex(const char*& cursor){
+    ObjIndex index = {0, 0, 0};
+    char* end;
+
+    index.position = std::strtol(cursor, &end, 10);
+    cursor = end;
+
+    if(*cursor == '/'){
+        cursor++;
+        if(*cursor != '/'){
+            index.texcoord = std::strtol(cursor, &end, 10);
+            cursor = end;
+        }
+
+        if(*cursor == '/'){
+            cursor++;
+            index.normal = std::strtol(cursor, &end, 10);
+            cursor = end;
+        }
+    }
+
+    return index;
+}
+
+//appends the OBJ file as a new level of detail of mesh
+bool loadObj(const std::string& filename, MeshData& mesh){
+    std::ifstream file(filename);
+    if(!file.is_open()){
+        std::cerr << "Error: unable to open " << filename << std::endl;
+        return false;
+    }
+
+    std::vector<float> positions;
+    std::vector<float> texcoords;
+    std::vector<float> normals;
+    std::unordered_map<ObjIndex, std::uint32_t, ObjIndexHash> vertex_lookup;
+
+    MeshFileLOD lod;
+    lod.first_index = mesh.indices.size();
+
+    std::vector<std::uint32_t> face;
+    std::string line;
+
+    while(std::getline(file, line)){
+        const char* cursor = line.c_str();
+        char* end;
+
+        if(line.compare(0, 2, "v ") == 0){
+            cursor += 2;
+            for(int i = 0; i < 3; ++i){
+                positions.push_back(std::strtof(cursor, &end));
+                cursor = end;
+            }
+        }
+        else if(line.compare(0, 3, "vt ") == 0){
+            cursor += 3;
+            for(int i = 0; i < 2; ++i){
+                texcoords.push_back(std::strtof(cursor, &end));
+                cursor = end;
+            }
+        }
+        else if(line.compare(0, 3, "vn ") == 0){
+            cursor += 3;
+            for(int i = 0; i < 3; ++i){
+                normals.push_back(std::strtof(cursor, &end));
+                cursor = end;
+            }
+        }
+        else if(line.compare(0, 2, "f ") == 0){
+            cursor += 2;
+            face.clear();
+
+            while(*cursor != '\0'){
+                while(*cursor == ' ' || *cursor == '\t' || *cursor == '\r'){
+                    cursor++;
+                }
+
+                if(*cursor == '\0'){
+                    break;
+                }
+
+                ObjIndex raw = parseFaceVertex(cursor);
+                ObjIndex index;
+                index.position = resolveObjIndex(raw.position, positions.size() / 3);
+                index.texcoord = resolveObjIndex(raw.texcoord, texcoords.size() / 2);
+                index.normal = resolveObjIndex(raw.normal, normals.size() / 3);
+
+                if(index.position < 0){
+                    std::cerr << "Error: invalid face in " << filename << ": " << line << std::endl;
+                    return false;
+                }
+
+                auto existing = vertex_lookup.find(index);
+                if(existing != vertex_lookup.end()){
+                    face.push_back(existing->second);
+                    continue;
+                }
+
+                std::uint32_t vertex_index = (std::uint32_t)(mesh.vertices.size() / MESH_FILE_VERTEX_FLOATS);
+                float vertex[MESH_FILE_VERTEX_FLOATS] = {0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 1.f, 1.f, 1.f, 1.f, 0.f, 0.f};
+
+                std::memcpy(vertex, &positions[index.position * 3], sizeof(float) * 3);
+
+                if(index.normal >= 0){
+                    std::memcpy(vertex + 3, &normals[index.normal * 3], sizeof(float) * 3);
+                    mesh.attributes |= MESH_ATTRIBUTE_NORMAL;
+                }
+
+                if(index.texcoord >= 0){
+                    std::memcpy(vertex + 10, &texcoords[index.texcoord * 2], sizeof(float) * 2);
+                    mesh.attributes |= MESH_ATTRIBUTE_TEXCOORD;
+                }
+
+                mesh.vertices.insert(mesh.vertices.end(), vertex, vertex + MESH_FILE_VERTEX_FLOATS);
+                vertex_lookup[index] = vertex_index;
+                face.push_back(vertex_index);
+            }
+
+            //triangulate polygons as fans
+            for(size_t i = 2; i < face.size(); ++i){
+                mesh.indices.push_back(face[0]);
+                mesh.indices.push_back(face[i - 1]);
+                mesh.indices.push_back(face[i]);
+            }
+        }
+    }
+
+    lod.index_count = mesh.indices.size() - lod.first_index;
+    mesh.lods.push_back(lod);
+
+    return true;
+}
+
+//prints the elapsed time since start and the peak resident set size of the process
+void reportLoad(const std::string& label, std::chrono::steady_clock::time_point start, std::uint64_t vertices, std::uint64_t indices){
+    double elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << label << ": " << vertices << " vertices, " << indices / 3 << " triangles loaded in " << elapsed_ms << " ms";
+
+#ifndef _WIN32
+    struct rusage usage;
+    if(getrusage(RUSAGE_SELF, &usage) == 0){
+        std::cout << ", peak RSS " << usage.ru_maxrss / 1024 << " MB";
+    }
+#endif
+
+    std::cout << std::endl;
+}
+
+int timeObj(const std::string& filename){
+    auto start = std::chrono::steady_clock::now();
+
+    MeshData mesh;
+    if(!loadObj(filename, mesh)){
+        return 1;
+    }
+
+    reportLoad("obj", start, mesh.vertices.size() / MESH_FILE_VERTEX_FLOATS, mesh.indices.size());
+
+    return 0;
+}
+
+int timeMesh(const std::string& filename){
+    auto start = std::chrono::steady_clock::now();
+
+    MappedMeshFile file;
+    if(!file.open(filename)){
+        return 1;
+    }
+
+    //touch every page the way a buffer upload would
+    const MeshFileHeader* header = file.header();
+    const volatile char* bytes = (const volatile char*)header;
+    std::uint64_t checksum = 0;
+    for(std::uint64_t offset = 0; offset < header->file_size; offset += 4096){
+        checksum += bytes[offset];
+    }
+
+    reportLoad("mesh", start, header->vertex_count, header->index_count);
+
+    return checksum == 0xffffffffffffffffULL ? 1 : 0;
+}
+
+int main(int argc, char* argv[]){
+    if(argc == 3 && std::strcmp(argv[1], "--time-obj") == 0){
+        return timeObj(argv[2]);
+    }
+
+    if(argc == 3 && std::strcmp(argv[1], "--time-mesh") == 0){
+        return timeMesh(argv[2]);
+    }
+
+    if(argc < 3){
+        std::cerr << "usage: " << argv[0] << " output.emsh lod0.obj [lod1.obj ...]" << std::endl;
+        std::cerr << "       " << argv[0] << " --time-obj model.obj" << std::endl;
+        std::cerr << "       " << argv[0] << " --time-mesh model.emsh" << std::endl;
+        return 1;
+    }
+
+    MeshData mesh;
+    for(int i = 2; i < argc; ++i){
+        if(!loadObj(argv[i], mesh)){
+            return 1;
+        }
+    }
+
+    std::uint64_t vertex_count = mesh.vertices.size() / MESH_FILE_VERTEX_FLOATS;
+    if(vertex_count > 0xffffffffULL){
+        std::cerr << "Error: too many vertices for 32 bit indices" << std::endl;
+        return 1;
+    }
+
+    if(!writeMeshFile(argv[1], mesh.vertices.data(), vertex_count, mesh.indices.data(), mesh.indices.size(), mesh.lods, mesh.attributes)){
+        return 1;
+    }
+
+    std::cout << "wrote " << argv[1] << ": " << vertex_count << " vertices, " << mesh.indices.size() / 3 << " triangles, "
+              << mesh.lods.size() << " levels of detail" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,644 @@
+//Microbenchmarks of the hot CPU paths of the engine, run without a GL context. The engine is started on the null render device, so that
+//renderer and resource benchmarks measure the CPU side only.
+//
+//usage: microbench [--filter text] [--min-time ms] [--repetitions N] [--output file]
+//
+//Every benchmark sets up its data for each of its sizes, then runs its operation in batches. The number of operations in a batch is doubled until a
+//batch takes at least the minimum time, and the batch is then repeated. The median and fastest time per operation of the repetitions are printed,
+//along with the GL calls the null device counted and the heap allocations made per operation, and written as JSON to the output file if one is given. Only benchmarks whose name
+//contains the filter text are run.
+
+#include "../engine.h"
+#include "../scene.h"
+#include "../scenenode.h"
+#include "../camera.h"
+#include "../renderer.h"
+#include "../renderable.h"
+#include "../material.h"
+#include "../mesh.h"
+#include "alloccount.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief The SceneDriver class forwards scenes by a frame, as Window does
+ */
+class SceneDriver
+{
+public:
+    static void frame(Scene& scene){
+        scene.frame();
+    }
+};
+
+/**
+ * @brief The RendererDriver class removes the renderables added to the renderer, as building a frame does
+ */
+class RendererDriver
+{
+public:
+    static void clearRenderables(Renderer& renderer){
+        renderer.renderables_.clear();
+    }
+};
+
+//keeps the compiler from optimising away a result which is otherwise unused
+template<class T>
+void keep(const T& value){
+#if defined(__GNUC__)
+    asm volatile("" : : "r"(&value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+//sets up a benchmark for a size, and returns the operation to time. Whatever the operation uses is captured by it.
+typedef std::function<std::function<void()>(unsigned int size)> BenchmarkSetup;
+
+struct Benchmark{
+    std::string name;
+    std::vector<unsigned int> sizes;
+    BenchmarkSetup setup;
+};
+
+struct BenchmarkResult{
+    std::string name;
+    unsigned int size;
+    std::uint64_t batch;
+    double median_ns;
+    double min_ns;
+    double gl_calls;
+    double allocations;
+};
+
+struct BenchmarkOptions{
+    std::string filter;
+    double min_time_ms;
+    unsigned int repetitions;
+    std::string output;
+
+    BenchmarkOptions() : min_time_ms(20.0), repetitions(5){
+    }
+};
+
+/**
+ * @brief The Idle class is a component with nothing to do, so that frames measure the cost of visiting components
+ */
+class Idle : public Component
+{
+protected:
+    virtual void frameStart(){
+    }
+
+    virtual void frameEnd(){
+    }
+
+    virtual void startup(){
+    }
+
+    virtual void shutdown(){
+    }
+
+public:
+    virtual std::unique_ptr<Component> clone(){
+        return std::unique_ptr<Component>(new Idle(*this));
+    }
+};
+
+//a second type, so that getComponent() has to look past the idle components
+class Marker : public Idle
+{
+public:
+    virtual std::unique_ptr<Component> clone(){
+        return std::unique_ptr<Component>(new Marker(*this));
+    }
+};
+
+const char* MICROBENCH_VERTEX_SHADER =
+    "#version 330 core\n"
+    "in vec3 position;\n"
+    "uniform mat4 model;\n"
+    "uniform mat4 view;\n"
+    "uniform mat4 projection;\n"
+    "void main(){\n"
+    "    gl_Position = projection * view * model * vec4(position, 1.0);\n"
+    "}\n";
+
+const char* MICROBENCH_FRAGMENT_SHADER =
+    "#version 330 core\n"
+    "out vec4 frag_colour;\n"
+    "void main(){\n"
+    "    frag_colour = vec4(1.0);\n"
+    "}\n";
+
+/**
+ * @brief The FlatMaterial class binds nothing beyond the matrices the renderer sets
+ */
+class FlatMaterial : public Material
+{
+public:
+    FlatMaterial(Shader* shader){
+        setShader(shader);
+        resolveLocations();
+    }
+
+    virtual std::string getMaterialName(){
+        return "flat";
+    }
+
+    virtual std::unique_ptr<Material> clone(){
+        return std::unique_ptr<Material>(new FlatMaterial(*this));
+    }
+
+    virtual void bind(){
+    }
+};
+
+//fragment shader with count float uniforms, named u0, u1 and so on
+std::string uniformsFragmentShader(unsigned int count){
+    std::string declarations, sum = "0.0";
+    for(unsigned int i = 0; i < count; ++i){
+        declarations += "uniform float u" + std::to_string(i) + ";\n";
+        sum += " + u" + std::to_string(i);
+    }
+
+    return "#version 330 core\n" + declarations + "out vec4 frag_colour;\nvoid main(){\n    frag_colour = vec4(" + sum + ");\n}\n";
+}
+
+/**
+ * @brief The QueryMaterial class looks up the locations of its uniforms with glGetUniformLocation every time it is bound, as materials did before
+ * their locations were resolved from the reflection of the shader
+ */
+class QueryMaterial : public Material
+{
+private:
+    std::vector<std::string> names_;
+
+public:
+    QueryMaterial(Shader* shader, unsigned int count){
+        setShader(shader);
+        resolveLocations();
+
+        for(unsigned int i = 0; i < count; ++i){
+            names_.push_back("u" + std::to_string(i));
+        }
+    }
+
+    virtual std::string getMaterialName(){
+        return "query";
+    }
+
+    virtual std::unique_ptr<Material> clone(){
+        return std::unique_ptr<Material>(new QueryMaterial(*this));
+    }
+
+    virtual void bind(){
+        GLuint program = getShader()->getProgram();
+
+        for(size_t i = 0; i < names_.size(); ++i){
+            glUniform1f(glGetUniformLocation(program, names_[i].c_str()), (float)i);
+        }
+    }
+};
+
+/**
+ * @brief The CachedMaterial class sets its uniforms through the locations it resolved from the reflection of the shader when it was created
+ */
+class CachedMaterial : public Material
+{
+private:
+    std::vector<GLint> locations_;
+
+public:
+    CachedMaterial(Shader* shader, unsigned int count){
+        setShader(shader);
+        resolveLocations();
+
+        for(unsigned int i = 0; i < count; ++i){
+            locations_.push_back(getShader()->getUniformLocation(StringId("u" + std::to_string(i))));
+        }
+    }
+
+    virtual std::string getMaterialName(){
+        return "cached";
+    }
+
+    virtual std::unique_ptr<Material> clone(){
+        return std::unique_ptr<Material>(new CachedMaterial(*this));
+    }
+
+    virtual void bind(){
+        for(size_t i = 0; i < locations_.size(); ++i){
+            glUniform1f(locations_[i], (float)i);
+        }
+    }
+};
+
+//the shader with count uniforms the material benchmarks share, created by the first of them
+Shader* uniformsShader(unsigned int count){
+    ResourceManager* resource_manager = ResourceManager::resourceManager();
+    std::string name = "microbench_uniforms_" + std::to_string(count);
+
+    Shader* shader = resource_manager->getShader(name);
+    return shader != nullptr ? shader : resource_manager->createShader(name, MICROBENCH_VERTEX_SHADER, uniformsFragmentShader(count), SHADER_RAW);
+}
+
+//creates a triangle mesh, the same data for every name
+Mesh* createTriangle(const std::string& name){
+    std::unique_ptr<std::vector<VertexData> > vertices(new std::vector<VertexData>());
+    for(unsigned int i = 0; i < 3; ++i){
+        VertexData vertex = {{(float)(i == 1), (float)(i == 2), 0.f}, {0.f, 0.f, 1.f}, {1.f, 1.f, 1.f, 1.f}, {0.f, 0.f}};
+        vertices->push_back(vertex);
+    }
+
+    std::unique_ptr<std::vector<GLuint> > indices(new std::vector<GLuint>{0, 1, 2});
+
+    return ResourceManager::resourceManager()->createMesh(name, std::move(vertices), std::move(indices));
+}
+
+//the mesh and shader the renderer benchmarks share, created by the first of them
+Mesh* sharedMesh(){
+    Mesh* mesh = ResourceManager::resourceManager()->getMesh("microbench_mesh");
+    return mesh != nullptr ? mesh : createTriangle("microbench_mesh");
+}
+
+Shader* sharedShader(){
+    ResourceManager* resource_manager = ResourceManager::resourceManager();
+
+    Shader* shader = resource_manager->getShader("microbench_shader");
+    return shader != nullptr ? shader : resource_manager->createShader("microbench_shader", MICROBENCH_VERTEX_SHADER, MICROBENCH_FRAGMENT_SHADER,
+                                                                       SHADER_RAW);
+}
+
+//builds a chain of depth nodes under root, and returns the last one
+SceneNode* buildChain(SceneNode* root, unsigned int depth){
+    SceneNode* node = root;
+
+    for(unsigned int i = 0; i < depth; ++i){
+        node = node->addChild("link");
+        node->translation(Eigen::Vector3f(0.f, 1.f, 0.f));
+        node->rotation(Eigen::Quaternion<float>(Eigen::AngleAxisf(0.1f, Eigen::Vector3f::UnitZ())));
+    }
+
+    return node;
+}
+
+//builds a tree of count nodes under root, each with 4 children, breadth first, and returns the last one
+SceneNode* buildTree(SceneNode* root, unsigned int count, bool components){
+    std::vector<SceneNode*> nodes(1, root);
+
+    for(size_t parent = 0; nodes.size() <= count; ++parent){
+        for(unsigned int i = 0; i < 4 && nodes.size() <= count; ++i){
+            SceneNode* node = nodes[parent]->addChild("node" + std::to_string(nodes.size()));
+            node->translation(Eigen::Vector3f((float)i, 0.f, 0.f));
+
+            if(components){
+                node->addComponent(std::unique_ptr<Component>(new Idle()));
+            }
+
+            nodes.push_back(node);
+        }
+    }
+
+    return nodes.back();
+}
+
+std::vector<Benchmark> createBenchmarks(){
+    std::vector<Benchmark> benchmarks;
+
+    benchmarks.push_back(Benchmark{"scenenode/world_transform", {1, 8, 64}, [](unsigned int depth){
+        std::shared_ptr<Scene> scene = std::make_shared<Scene>();
+        SceneNode* leaf = buildChain(scene->rootNode(), depth);
+
+        return [scene, leaf](){
+            keep(leaf->worldTransform());
+        };
+    }});
+
+    benchmarks.push_back(Benchmark{"scenenode/frame", {100, 1000, 10000}, [](unsigned int count){
+        std::shared_ptr<Scene> scene = std::make_shared<Scene>();
+        buildTree(scene->rootNode(), count, true);
+
+        return [scene](){
+            SceneDriver::frame(*scene);
+        };
+    }});
+
+    //the node searched for is the last one created, which a depth first search reaches last
+    benchmarks.push_back(Benchmark{"scenenode/find_child_string", {100, 1000, 10000}, [](unsigned int count){
+        std::shared_ptr<Scene> scene = std::make_shared<Scene>();
+        std::string name = buildTree(scene->rootNode(), count, false)->name();
+
+        return [scene, name](){
+            keep(scene->rootNode()->findChild(name));
+        };
+    }});
+
+    benchmarks.push_back(Benchmark{"scenenode/find_child_id", {100, 1000, 10000}, [](unsigned int count){
+        std::shared_ptr<Scene> scene = std::make_shared<Scene>();
+        StringId name = buildTree(scene->rootNode(), count, false)->nameId();
+
+        return [scene, name](){
+            keep(scene->rootNode()->findChild(name));
+        };
+    }});
+
+    benchmarks.push_back(Benchmark{"scenenode/get_component", {1, 4, 16}, [](unsigned int components){
+        std::shared_ptr<Scene> scene = std::make_shared<Scene>();
+        SceneNode* node = scene->rootNode()->addChild("node");
+
+        for(unsigned int i = 1; i < components; ++i){
+            node->addComponent(std::unique_ptr<Component>(new Idle()));
+        }
+        node->addComponent(std::unique_ptr<Component>(new Marker()));
+
+        return [scene, node](){
+            keep(node->getComponent<Marker>());
+        };
+    }});
+
+    benchmarks.push_back(Benchmark{"camera/view_matrix", {1, 8, 64}, [](unsigned int depth){
+        std::shared_ptr<Scene> scene = std::make_shared<Scene>();
+        SceneNode* node = buildChain(scene->rootNode(), depth);
+
+        Viewport viewport;
+        viewport.end = std::make_pair(1.0, 1.0);
+
+        Camera* camera = new Camera(viewport, PERSPECTIVE, 100.f, 0.1f, 1.f);
+        node->addComponent(std::unique_ptr<Component>(camera));
+
+        return [scene, camera](){
+            keep(camera->viewMatrix());
+        };
+    }});
+
+    //sizes are the projection mode, 0 for perspective and 1 for orthographic
+    benchmarks.push_back(Benchmark{"camera/projection_matrix", {0, 1}, [](unsigned int mode){
+        std::shared_ptr<Scene> scene = std::make_shared<Scene>();
+        SceneNode* node = scene->rootNode()->addChild("camera");
+
+        Viewport viewport;
+        viewport.end = std::make_pair(1.0, 1.0);
+
+        Camera* camera = new Camera(viewport, mode == 0 ? PERSPECTIVE : ORTHO, 100.f, 0.1f, 1.f);
+        node->addComponent(std::unique_ptr<Component>(camera));
+
+        std::pair<std::uint32_t, std::uint32_t> resolution(1280, 720);
+
+        return [scene, camera, resolution](){
+            keep(camera->projectionMatrix(resolution));
+        };
+    }});
+
+    //a frame of the engine, with count renderables in view of a camera. Renderables are culled and sorted, and their draws recorded by the
+    //null device
+    benchmarks.push_back(Benchmark{"renderer/frame", {100, 1000, 10000}, [](unsigned int count){
+        std::shared_ptr<Scene> scene = std::make_shared<Scene>();
+        Mesh* mesh = sharedMesh();
+        Shader* shader = sharedShader();
+
+        for(unsigned int i = 0; i < count; ++i){
+            SceneNode* node = scene->rootNode()->addChild("object");
+            node->translation(Eigen::Vector3f((float)(i % 100) - 50.f, (float)(i / 100 % 100) - 50.f, -100.f));
+            node->addComponent(ResourceManager::resourceManager()->createRenderable(std::unique_ptr<Material>(new FlatMaterial(shader)), mesh));
+        }
+
+        Viewport viewport;
+        viewport.end = std::make_pair(1.0, 1.0);
+        scene->rootNode()->addChild("camera")->addComponent(std::unique_ptr<Component>(new Camera(viewport, PERSPECTIVE, 500.f, 0.1f, 1.f)));
+
+        Engine::engine()->window()->setCurrentScene(scene);
+
+        return [scene](){
+            Engine::engine()->frame();
+        };
+    }});
+
+    //sizes are the number of renderables added to the renderer and removed again per operation, as happens every frame
+    benchmarks.push_back(Benchmark{"renderer/add_renderable", {100, 1000, 10000}, [](unsigned int count){
+        Mesh* mesh = sharedMesh();
+        Shader* shader = sharedShader();
+
+        std::shared_ptr<std::vector<std::unique_ptr<Renderable> > > renderables = std::make_shared<std::vector<std::unique_ptr<Renderable> > >();
+        for(unsigned int i = 0; i < count; ++i){
+            renderables->push_back(ResourceManager::resourceManager()->createRenderable(std::unique_ptr<Material>(new FlatMaterial(shader)), mesh));
+        }
+
+        return [renderables](){
+            Renderer* renderer = Renderer::renderer();
+
+            for(auto& renderable : *renderables){
+                renderer->addRenderable(renderable.get());
+            }
+
+            RendererDriver::clearRenderables(*renderer);
+        };
+    }});
+
+    //sizes are the number of meshes loaded, the last of which is looked up
+    benchmarks.push_back(Benchmark{"resources/get_mesh_name", {16, 256, 4096}, [](unsigned int count){
+        std::string name;
+        for(unsigned int i = 0; i < count; ++i){
+            name = "mesh_name_" + std::to_string(count) + "_" + std::to_string(i);
+            createTriangle(name);
+        }
+
+        return [name](){
+            keep(ResourceManager::resourceManager()->getMesh(name));
+        };
+    }});
+
+    benchmarks.push_back(Benchmark{"resources/get_mesh_id", {16, 256, 4096}, [](unsigned int count){
+        StringId name;
+        for(unsigned int i = 0; i < count; ++i){
+            std::string lexical_name = "mesh_id_" + std::to_string(count) + "_" + std::to_string(i);
+            createTriangle(lexical_name);
+            name = StringId(lexical_name);
+        }
+
+        return [name](){
+            keep(ResourceManager::resourceManager()->getMesh(name));
+        };
+    }});
+
+    benchmarks.push_back(Benchmark{"resources/get_mesh_handle", {16, 256, 4096}, [](unsigned int count){
+        MeshHandle handle;
+        for(unsigned int i = 0; i < count; ++i){
+            handle = createTriangle("mesh_handle_" + std::to_string(count) + "_" + std::to_string(i))->getHandle();
+        }
+
+        return [handle](){
+            keep(ResourceManager::resourceManager()->getMesh(handle));
+        };
+    }});
+
+    benchmarks.push_back(Benchmark{"resources/get_shader_name", {1}, [](unsigned int){
+        sharedShader();
+
+        return [](){
+            keep(ResourceManager::resourceManager()->getShader("microbench_shader"));
+        };
+    }});
+
+    benchmarks.push_back(Benchmark{"resources/get_shader_id", {1}, [](unsigned int){
+        sharedShader();
+
+        return [](){
+            keep(ResourceManager::resourceManager()->getShader("microbench_shader"_sid));
+        };
+    }});
+
+    //sizes are the number of uniforms the material sets per bind, with the locations queried from GL on every bind, or resolved once
+    benchmarks.push_back(Benchmark{"material/bind_query_locations", {1, 4, 16}, [](unsigned int count){
+        std::shared_ptr<Material> material(new QueryMaterial(uniformsShader(count), count));
+
+        return [material](){
+            material->bind();
+        };
+    }});
+
+    benchmarks.push_back(Benchmark{"material/bind_cached_locations", {1, 4, 16}, [](unsigned int count){
+        std::shared_ptr<Material> material(new CachedMaterial(uniformsShader(count), count));
+
+        return [material](){
+            material->bind();
+        };
+    }});
+
+    return benchmarks;
+}
+
+double runBatch(const std::function<void()>& operation, std::uint64_t batch){
+    auto start = std::chrono::steady_clock::now();
+
+    for(std::uint64_t i = 0; i < batch; ++i){
+        operation();
+    }
+
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+BenchmarkResult runBenchmark(const Benchmark& benchmark, unsigned int size, const BenchmarkOptions& options){
+    std::function<void()> operation = benchmark.setup(size);
+
+    std::uint64_t batch = 1;
+    while(runBatch(operation, batch) < options.min_time_ms * 1e6 && batch < (1ull << 40)){
+        batch *= 2;
+    }
+
+    RenderDevice* device = RenderDevice::renderDevice();
+    device->resetCallCounts();
+
+    std::uint64_t start_allocations = allocationCount();
+
+    std::vector<double> times;
+    for(unsigned int i = 0; i < options.repetitions; ++i){
+        times.push_back(runBatch(operation, batch) / batch);
+    }
+
+    double operations = (double)batch * options.repetitions;
+    double gl_calls = (double)device->getTotalCalls() / operations;
+    double allocations = (double)(allocationCount() - start_allocations) / operations;
+
+    std::sort(times.begin(), times.end());
+
+    return BenchmarkResult{benchmark.name, size, batch, times[times.size() / 2], times.front(), gl_calls, allocations};
+}
+
+void writeResults(std::ostream& stream, const std::vector<BenchmarkResult>& results){
+    stream << "{\n  \"benchmarks\": [";
+
+    for(size_t i = 0; i < results.size(); ++i){
+        const BenchmarkResult& result = results[i];
+
+        stream << (i > 0 ? "," : "") << "\n    {\"name\": \"" << result.name << "\", \"size\": " << result.size << ", \"batch\": " << result.batch
+               << ", \"median_ns\": " << result.median_ns << ", \"min_ns\": " << result.min_ns << ", \"gl_calls\": " << result.gl_calls
+               << ", \"allocations\": " << result.allocations << "}";
+    }
+
+    stream << "\n  ]\n}\n";
+}
+
+bool parseOptions(int argc, char* argv[], BenchmarkOptions& options){
+    for(int i = 1; i < argc; ++i){
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+
+        if(arg == "--filter" && has_value){
+            options.filter = argv[++i];
+        }
+        else if(arg == "--min-time" && has_value){
+            options.min_time_ms = std::max(std::atof(argv[++i]), 0.001);
+        }
+        else if(arg == "--repetitions" && has_value){
+            options.repetitions = std::max((unsigned int)std::strtoul(argv[++i], nullptr, 10), 1u);
+        }
+        else if(arg == "--output" && has_value){
+            options.output = argv[++i];
+        }
+        else{
+            std::cerr << "Error: unknown argument " << arg << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main(int argc, char* argv[]){
+    BenchmarkOptions options;
+    if(!parseOptions(argc, argv, options)){
+        std::cerr << "usage: microbench [--filter text] [--min-time ms] [--repetitions N] [--output file]" << std::endl;
+        return 1;
+    }
+
+    //the window and renderer are needed by the renderer and resource benchmarks
+    Engine* engine = Engine::engine();
+    if(!engine->startupHeadless(1280, 720, RENDER_DEVICE_NULL)){
+        return 1;
+    }
+
+    std::vector<BenchmarkResult> results;
+
+    std::cout << std::left << std::setw(32) << "benchmark" << std::right << std::setw(8) << "size" << std::setw(14) << "median ns" << std::setw(14)
+              << "min ns" << std::setw(12) << "gl calls" << std::setw(12) << "allocs" << std::endl;
+
+    for(auto& benchmark : createBenchmarks()){
+        if(benchmark.name.find(options.filter) == std::string::npos){
+            continue;
+        }
+
+        for(unsigned int size : benchmark.sizes){
+            BenchmarkResult result = runBenchmark(benchmark, size, options);
+            results.push_back(result);
+
+            std::cout << std::left << std::setw(32) << result.name << std::right << std::setw(8) << result.size << std::fixed << std::setprecision(1)
+                      << std::setw(14) << result.median_ns << std::setw(14) << result.min_ns << std::setw(12) << result.gl_calls << std::setw(12) << result.allocations << std::endl;
+        }
+    }
+
+    engine->window()->setCurrentScene(nullptr);
+    engine->shutdown();
+
+    if(!options.output.empty()){
+        std::ofstream file(options.output);
+        if(!file.is_open()){
+            std::cerr << "Error: unable to write results to " << options.output << std::endl;
+            return 1;
+        }
+
+        writeResults(file, results);
+    }
+
+    return 0;
+}
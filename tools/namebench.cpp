@@ -0,0 +1,130 @@
+//Name lookup benchmark for interned string ids (see stringid.h).
+//
+//usage: namebench [resources] [lookups per frame] [frames]
+//
+//Simulates the name based lookups of a frame, once as before with resources in maps keyed by std::string, looked up with strings built from
+//literals and with names returned by value, and once with maps keyed by StringId and names returned by reference. Reports the time per frame
+//and the allocations per frame of both, and does the same for finding scene nodes by name.
+
+#include "../stringid.h"
+#include "../scenenode.h"
+#include "alloccount.h"
+
+#include <iostream>
+#include <chrono>
+#include <unordered_map>
+#include <vector>
+#include <cstdlib>
+
+struct BenchResource{
+    std::string lexical_name;
+
+    //accessors as they were, and as they are
+    std::string nameByValue(){
+        return lexical_name;
+    }
+
+    const std::string& nameByReference(){
+        return lexical_name;
+    }
+};
+
+struct FrameResult{
+    double ms_per_frame;
+    double allocations_per_frame;
+};
+
+template<class Function>
+FrameResult runFrames(unsigned int frames, Function frame){
+    std::uint64_t start_allocations = allocationCount();
+
+    auto start = std::chrono::steady_clock::now();
+    for(unsigned int i = 0; i < frames; ++i){
+        frame();
+    }
+    double elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    return FrameResult{elapsed_ms / frames, (double)(allocationCount() - start_allocations) / frames};
+}
+
+void printResult(const char* label, const FrameResult& before, const FrameResult& after){
+    std::cout << label << ": strings " << before.ms_per_frame << " ms, " << before.allocations_per_frame << " allocations per frame, ids "
+              << after.ms_per_frame << " ms, " << after.allocations_per_frame << " allocations per frame" << std::endl;
+}
+
+int main(int argc, char* argv[]){
+    unsigned int count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10000;
+    unsigned int lookups = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1000;
+    unsigned int frames = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 1000;
+
+    //names longer than the small string buffer, as resource paths usually are
+    std::vector<std::string> names;
+    std::vector<BenchResource> resources;
+    std::unordered_map<std::string, std::uint32_t> string_map;
+    std::unordered_map<StringId, std::uint32_t> id_map;
+
+    for(unsigned int i = 0; i < count; ++i){
+        names.push_back("resources/meshes/mesh_" + std::to_string(i) + ".mesh");
+        resources.push_back(BenchResource{names.back()});
+        string_map[names.back()] = i;
+        id_map[StringId::intern(names.back())] = i;
+    }
+
+    //the names looked up in a frame, as literals would be
+    std::vector<const char*> frame_names;
+    for(unsigned int i = 0; i < lookups; ++i){
+        frame_names.push_back(names[(i * 7919u) % count].c_str());
+    }
+
+    size_t checksum = 0;
+
+    FrameResult before = runFrames(frames, [&](){
+        for(const char* name : frame_names){
+            BenchResource& resource = resources[string_map.find(name)->second];
+            checksum += resource.nameByValue().size();
+        }
+    });
+
+    //ids of literals are computed at compile time, the runtime hash here is the worst case
+    FrameResult after = runFrames(frames, [&](){
+        for(const char* name : frame_names){
+            BenchResource& resource = resources[id_map.find(StringId(name))->second];
+            checksum += resource.nameByReference().size();
+        }
+    });
+
+    printResult("resource lookups", before, after);
+
+    //a flat scene, searched for its last node
+    SceneNode root("root");
+    std::vector<SceneNode*> nodes;
+    for(unsigned int i = 0; i < 1000; ++i){
+        nodes.push_back(root.addChild(names[i % count]));
+    }
+
+    std::string last_name = nodes.back()->name();
+    StringId last_id = nodes.back()->nameId();
+
+    //emulates the previous search, which compared the name of every node returned by value
+    before = runFrames(frames, [&](){
+        for(SceneNode* node : nodes){
+            std::string name = std::string(node->name());
+            if(name == last_name){
+                checksum++;
+                break;
+            }
+        }
+    });
+
+    after = runFrames(frames, [&](){
+        checksum += root.findChild(last_id) != nullptr ? 1 : 0;
+    });
+
+    printResult("scene node lookups", before, after);
+
+    StringTableStats stats = getStringTableStats();
+    std::cout << stats.strings << " interned strings, " << stats.bytes << " bytes, " << stats.collisions << " collisions (checksum " << checksum << ")"
+              << std::endl;
+
+    return 0;
+}
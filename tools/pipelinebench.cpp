@@ -0,0 +1,388 @@
+//Benchmark of rendering on a render thread (see Engine::enableRenderThread()) against rendering in lockstep with the scene.
+//
+//usage: pipelinebench [--renderables N] [--dynamic N] [--sim-ms MS] [--frames N] [--gl]
+//
+//Renders a scene of spinning cubes and rippling dynamic grids, along with a component standing in for the game logic which keeps the main thread
+//busy for --sim-ms every frame, first in lockstep, then on a render thread with 1 and 2 frames in flight. Reports the throughput, and the latency
+//from reading the input of a frame until it has been presented, see COUNTER_INPUT_LATENCY_US. The engine runs on the null device unless --gl is
+//given, which renders headless through EGL. The render thread can only overlap the main thread with a hardware thread of its own.
+
+#include "../engine.h"
+#include "../renderer.h"
+#include "../renderable.h"
+#include "../camera.h"
+#include "../material.h"
+#include "../mesh.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+const char* PIPELINE_VERTEX_SHADER =
+    "#version 330 core\n"
+    "in vec3 position;\n"
+    "uniform mat4 model;\n"
+    "uniform mat4 view;\n"
+    "uniform mat4 projection;\n"
+    "void main(){\n"
+    "    gl_Position = projection * view * model * vec4(position, 1.0);\n"
+    "}\n";
+
+const char* PIPELINE_FRAGMENT_SHADER =
+    "#version 330 core\n"
+    "out vec4 frag_colour;\n"
+    "void main(){\n"
+    "    frag_colour = vec4(1.0);\n"
+    "}\n";
+
+const unsigned int PIPELINE_GRID_SIZE = 64;
+
+/**
+ * @brief The FlatMaterial class binds nothing beyond the matrices the renderer sets
+ */
+class FlatMaterial : public Material
+{
+public:
+    FlatMaterial(Shader* shader){
+        setShader(shader);
+        resolveLocations();
+    }
+
+    virtual std::string getMaterialName(){
+        return "flat";
+    }
+
+    virtual std::unique_ptr<Material> clone(){
+        return std::unique_ptr<Material>(new FlatMaterial(*this));
+    }
+
+    virtual void bind(){
+    }
+};
+
+/**
+ * @brief The Spinner class rotates its node a little every frame
+ */
+class Spinner : public Component
+{
+private:
+    float radians_per_frame_;
+
+protected:
+    virtual void frameStart(){
+        owner_->rotateBy(Eigen::Quaternion<float>(Eigen::AngleAxisf(radians_per_frame_, Eigen::Vector3f::UnitY())));
+    }
+
+    virtual void frameEnd(){
+    }
+
+    virtual void startup(){
+    }
+
+    virtual void shutdown(){
+    }
+
+public:
+    Spinner(float radians_per_frame) : radians_per_frame_(radians_per_frame){
+    }
+
+    virtual std::unique_ptr<Component> clone(){
+        return std::unique_ptr<Component>(new Spinner(*this));
+    }
+};
+
+/**
+ * @brief The Ripple class rewrites the heights of the vertices of a dynamic grid mesh every frame
+ */
+class Ripple : public Component
+{
+private:
+    Mesh* mesh_;
+    float phase_;
+
+protected:
+    virtual void frameStart(){
+        VertexData* vertices = mesh_->editVertices(0, PIPELINE_GRID_SIZE * PIPELINE_GRID_SIZE);
+        if(vertices == nullptr){
+            return;
+        }
+
+        for(unsigned int y = 0; y < PIPELINE_GRID_SIZE; ++y){
+            for(unsigned int x = 0; x < PIPELINE_GRID_SIZE; ++x){
+                vertices[y * PIPELINE_GRID_SIZE + x].position[2] = 0.1f * std::sin(phase_ + 0.5f * (float)(x + y));
+            }
+        }
+
+        phase_ += 0.1f;
+    }
+
+    virtual void frameEnd(){
+    }
+
+    virtual void startup(){
+    }
+
+    virtual void shutdown(){
+    }
+
+public:
+    Ripple(Mesh* mesh, float phase) : mesh_(mesh), phase_(phase){
+    }
+
+    virtual std::unique_ptr<Component> clone(){
+        return std::unique_ptr<Component>(new Ripple(*this));
+    }
+};
+
+/**
+ * @brief The Simulation class stands in for the game logic of a frame, keeping the main thread busy for a set time
+ */
+class Simulation : public Component
+{
+private:
+    std::chrono::nanoseconds duration_;
+
+protected:
+    virtual void frameStart(){
+        auto end = std::chrono::steady_clock::now() + duration_;
+        while(std::chrono::steady_clock::now() < end){
+        }
+    }
+
+    virtual void frameEnd(){
+    }
+
+    virtual void startup(){
+    }
+
+    virtual void shutdown(){
+    }
+
+public:
+    Simulation(float milliseconds) : duration_((std::int64_t)(milliseconds * 1e6f)){
+    }
+
+    virtual std::unique_ptr<Component> clone(){
+        return std::unique_ptr<Component>(new Simulation(*this));
+    }
+};
+
+struct PipelineOptions{
+    unsigned int renderables;
+    unsigned int dynamic;
+    float sim_ms;
+    unsigned int frames;
+    RenderDeviceType device;
+
+    PipelineOptions() : renderables(5000), dynamic(16), sim_ms(4.f), frames(200), device(RENDER_DEVICE_NULL){
+    }
+};
+
+struct PipelineResult{
+    double fps;
+    double frame_ms;
+    double latency_mean_ms;
+    double latency_p50_ms;
+    double latency_p99_ms;
+};
+
+Mesh* createCube(){
+    std::unique_ptr<std::vector<VertexData> > vertices(new std::vector<VertexData>());
+    for(unsigned int i = 0; i < 8; ++i){
+        VertexData vertex = {{(i & 1) ? 0.5f : -0.5f, (i & 2) ? 0.5f : -0.5f, (i & 4) ? 0.5f : -0.5f}, {0.f, 0.f, 1.f}, {1.f, 1.f, 1.f, 1.f}, {0.f, 0.f}};
+        vertices->push_back(vertex);
+    }
+
+    const GLuint faces[] = {0, 2, 1, 1, 2, 3, 4, 5, 6, 5, 7, 6, 0, 1, 4, 1, 5, 4, 2, 6, 3, 3, 6, 7, 0, 4, 2, 2, 4, 6, 1, 3, 5, 3, 7, 5};
+    std::unique_ptr<std::vector<GLuint> > indices(new std::vector<GLuint>(faces, faces + 36));
+
+    return ResourceManager::resourceManager()->createMesh("pipeline_cube", std::move(vertices), std::move(indices));
+}
+
+Mesh* createGrid(const std::string& name){
+    std::unique_ptr<std::vector<VertexData> > vertices(new std::vector<VertexData>());
+    std::unique_ptr<std::vector<GLuint> > indices(new std::vector<GLuint>());
+
+    for(unsigned int y = 0; y < PIPELINE_GRID_SIZE; ++y){
+        for(unsigned int x = 0; x < PIPELINE_GRID_SIZE; ++x){
+            float u = (float)x / (PIPELINE_GRID_SIZE - 1), v = (float)y / (PIPELINE_GRID_SIZE - 1);
+            VertexData vertex = {{u - 0.5f, v - 0.5f, 0.f}, {0.f, 0.f, 1.f}, {u, v, 1.f, 1.f}, {u, v}};
+            vertices->push_back(vertex);
+        }
+    }
+
+    for(unsigned int y = 0; y + 1 < PIPELINE_GRID_SIZE; ++y){
+        for(unsigned int x = 0; x + 1 < PIPELINE_GRID_SIZE; ++x){
+            GLuint i = y * PIPELINE_GRID_SIZE + x;
+            GLuint quad[] = {i, i + 1, i + PIPELINE_GRID_SIZE, i + 1, i + PIPELINE_GRID_SIZE + 1, i + PIPELINE_GRID_SIZE};
+            indices->insert(indices->end(), quad, quad + 6);
+        }
+    }
+
+    return ResourceManager::resourceManager()->createMesh(name, std::move(vertices), std::move(indices), CACHE, DYNAMIC_MESH);
+}
+
+//builds the scene before the render thread is enabled, as creating renderables makes GL calls
+std::shared_ptr<Scene> buildScene(const PipelineOptions& options){
+    ResourceManager* resource_manager = ResourceManager::resourceManager();
+
+    Mesh* cube = createCube();
+    Shader* shader = resource_manager->createShader("pipeline_shader", PIPELINE_VERTEX_SHADER, PIPELINE_FRAGMENT_SHADER, SHADER_RAW);
+    if(cube == nullptr || shader == nullptr){
+        return nullptr;
+    }
+
+    std::shared_ptr<Scene> scene = std::make_shared<Scene>();
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> spread(-40.f, 40.f);
+    std::uniform_real_distribution<float> depth(-60.f, -5.f);
+
+    for(unsigned int i = 0; i < options.renderables; ++i){
+        SceneNode* node = scene->rootNode()->addChild("object");
+        node->translation(Eigen::Vector3f(spread(random), spread(random), depth(random)));
+        node->addComponent(resource_manager->createRenderable(std::unique_ptr<Material>(new FlatMaterial(shader)), cube));
+        node->addComponent(std::unique_ptr<Component>(new Spinner(0.01f)));
+    }
+
+    for(unsigned int i = 0; i < options.dynamic; ++i){
+        Mesh* grid = createGrid("pipeline_grid_" + std::to_string(i));
+        if(grid == nullptr){
+            return nullptr;
+        }
+
+        SceneNode* node = scene->rootNode()->addChild("grid");
+        node->translation(Eigen::Vector3f(spread(random), spread(random), depth(random)));
+        node->addComponent(resource_manager->createRenderable(std::unique_ptr<Material>(new FlatMaterial(shader)), grid));
+        node->addComponent(std::unique_ptr<Component>(new Ripple(grid, (float)i)));
+    }
+
+    scene->rootNode()->addComponent(std::unique_ptr<Component>(new Simulation(options.sim_ms)));
+
+    Viewport viewport;
+    viewport.end = std::make_pair(1.0, 1.0);
+    scene->rootNode()->addChild("camera")->addComponent(std::unique_ptr<Component>(new Camera(viewport, PERSPECTIVE, 500.f, 0.1f, 1.f)));
+
+    return scene;
+}
+
+//renders frames with the given number of frames in flight, 0 rendering in lockstep, and returns their throughput and latency
+PipelineResult measureFrames(unsigned int frames_in_flight, unsigned int frames){
+    Engine* engine = Engine::engine();
+
+    if(frames_in_flight > 0){
+        engine->enableRenderThread(frames_in_flight);
+    }
+
+    const unsigned int warmup = 10;
+    for(unsigned int frame = 0; frame < warmup; ++frame){
+        engine->frame();
+    }
+
+    std::vector<double> latencies;
+    auto start = std::chrono::steady_clock::now();
+
+    for(unsigned int frame = 0; frame < frames; ++frame){
+        engine->frame();
+
+        //the latency of the last frame presented, which on a render thread is one or more frames behind the one just built
+        latencies.push_back(EngineStats::get(COUNTER_INPUT_LATENCY_US) / 1000.0);
+    }
+
+    //the frames still in flight are part of the run
+    engine->disableRenderThread();
+
+    double elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::sort(latencies.begin(), latencies.end());
+
+    PipelineResult result;
+    result.fps = frames * 1000.0 / elapsed_ms;
+    result.frame_ms = elapsed_ms / frames;
+    result.latency_mean_ms = 0.0;
+    for(double latency : latencies){
+        result.latency_mean_ms += latency;
+    }
+    result.latency_mean_ms /= latencies.size();
+    result.latency_p50_ms = latencies[latencies.size() / 2];
+    result.latency_p99_ms = latencies[std::min(latencies.size() - 1, latencies.size() * 99 / 100)];
+
+    return result;
+}
+
+bool parseOptions(int argc, char* argv[], PipelineOptions& options){
+    for(int i = 1; i < argc; ++i){
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+
+        if(arg == "--renderables" && has_value){
+            options.renderables = (unsigned int)std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if(arg == "--dynamic" && has_value){
+            options.dynamic = (unsigned int)std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if(arg == "--sim-ms" && has_value){
+            options.sim_ms = std::max(std::strtof(argv[++i], nullptr), 0.f);
+        }
+        else if(arg == "--frames" && has_value){
+            options.frames = std::max((unsigned int)std::strtoul(argv[++i], nullptr, 10), 1u);
+        }
+        else if(arg == "--gl"){
+            options.device = RENDER_DEVICE_GL;
+        }
+        else{
+            std::cerr << "Error: unknown argument " << arg << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main(int argc, char* argv[]){
+    PipelineOptions options;
+    if(!parseOptions(argc, argv, options)){
+        std::cerr << "usage: pipelinebench [--renderables N] [--dynamic N] [--sim-ms MS] [--frames N] [--gl]" << std::endl;
+        return 1;
+    }
+
+    Engine* engine = Engine::engine();
+    if(!engine->startupHeadless(1280, 720, options.device)){
+        return 1;
+    }
+
+    std::shared_ptr<Scene> scene = buildScene(options);
+    if(scene == nullptr){
+        std::cerr << "Error: unable to create the resources of the scene" << std::endl;
+        engine->shutdown();
+        return 1;
+    }
+
+    engine->window()->setCurrentScene(scene);
+
+    std::cout << options.renderables << " renderables, " << options.dynamic << " dynamic meshes, " << options.sim_ms << " ms simulated, "
+              << options.frames << " frames, " << std::thread::hardware_concurrency() << " hardware threads" << std::endl << std::endl;
+    std::cout << std::left << std::setw(16) << "mode" << std::right << std::setw(10) << "fps" << std::setw(12) << "frame ms" << std::setw(14)
+              << "latency ms" << std::setw(10) << "p50" << std::setw(10) << "p99" << std::endl;
+
+    const char* modes[] = {"lockstep", "render thread x1", "render thread x2"};
+
+    for(unsigned int frames_in_flight = 0; frames_in_flight < sizeof(modes) / sizeof(modes[0]); ++frames_in_flight){
+        PipelineResult result = measureFrames(frames_in_flight, options.frames);
+
+        std::cout << std::left << std::setw(16) << modes[frames_in_flight] << std::right << std::fixed << std::setprecision(1) << std::setw(10)
+                  << result.fps << std::setprecision(3) << std::setw(12) << result.frame_ms << std::setw(14) << result.latency_mean_ms
+                  << std::setw(10) << result.latency_p50_ms << std::setw(10) << result.latency_p99_ms << std::endl;
+    }
+
+    engine->window()->setCurrentScene(nullptr);
+    engine->shutdown();
+
+    return 0;
+}
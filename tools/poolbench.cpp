@@ -0,0 +1,91 @@
+//Lookup benchmark for resource pools (see resourcepool.h).
+//
+//usage: poolbench [lookups] [seed]
+//
+//Fills a ResourcePool, and an unordered_map from ids to resources as the managers used before, with 1k, 10k and 100k resources, then looks
+//resources up in random order through both, and reports the lookups per second. Also frees and recreates a tenth of the resources, and checks
+//that every handle to a freed resource is rejected.
+
+#include "../resourcepool.h"
+
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <unordered_map>
+#include <cstdlib>
+
+struct BenchResource{
+    std::uint32_t id;
+    float payload[15];
+};
+
+double lookupsPerSecond(unsigned int lookups, double elapsed_ms){
+    return (double)lookups / (elapsed_ms / 1000.0);
+}
+
+void runBenchmark(unsigned int count, unsigned int lookups, unsigned int seed){
+    ResourcePool<BenchResource> pool;
+    std::unordered_map<std::uint32_t, std::unique_ptr<BenchResource> > map;
+    std::vector<ResourceHandle<BenchResource> > handles;
+
+    for(std::uint32_t i = 0; i < count; ++i){
+        handles.push_back(pool.insert(std::unique_ptr<BenchResource>(new BenchResource{i, {}})));
+        map[i] = std::unique_ptr<BenchResource>(new BenchResource{i, {}});
+    }
+
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<std::uint32_t> distribution(0, count - 1);
+
+    std::vector<std::uint32_t> order(lookups);
+    for(auto& index : order){
+        index = distribution(generator);
+    }
+
+    //the sums keep the lookups from being optimized away
+    std::uint64_t pool_sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for(std::uint32_t index : order){
+        pool_sum += pool.get(handles[index])->id;
+    }
+    double pool_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::uint64_t map_sum = 0;
+    start = std::chrono::steady_clock::now();
+    for(std::uint32_t index : order){
+        map_sum += map.find(index)->second->id;
+    }
+    double map_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    if(pool_sum != map_sum){
+        std::cerr << count << " resources: lookups disagree" << std::endl;
+        return;
+    }
+
+    //free and recreate a tenth of the resources, the stale handles must all be rejected
+    std::vector<ResourceHandle<BenchResource> > stale;
+    for(std::uint32_t i = 0; i < count; i += 10){
+        pool.remove(handles[i]);
+        stale.push_back(handles[i]);
+        handles[i] = pool.insert(std::unique_ptr<BenchResource>(new BenchResource{i, {}}));
+    }
+
+    unsigned int rejected = 0;
+    for(auto& handle : stale){
+        rejected += pool.get(handle) == nullptr ? 1 : 0;
+    }
+
+    std::cout << count << " resources: pool " << lookupsPerSecond(lookups, pool_ms) / 1e6 << "M lookups/s, map "
+              << lookupsPerSecond(lookups, map_ms) / 1e6 << "M lookups/s, " << map_ms / pool_ms << "x, " << rejected << "/" << stale.size()
+              << " stale handles rejected, " << pool.capacity() << " slots" << std::endl;
+}
+
+int main(int argc, char* argv[]){
+    unsigned int lookups = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10000000;
+    unsigned int seed = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1;
+
+    for(unsigned int count : {1000u, 10000u, 100000u}){
+        runBenchmark(count, lookups, seed);
+    }
+
+    return 0;
+}
@@ -0,0 +1,103 @@
+//Overhead benchmark for profiler zones (see profiler.h).
+//
+//usage: profilebench [zones] [trace file]
+//
+//Runs a loop of a small amount of work without zones, with a zone around each iteration while the profiler is enabled, and while it is
+//disabled at runtime, and reports the cost of a zone as the difference. Then records nested zones on several threads and writes them as a
+//Chrome trace. Built with ENGINE_PROFILING defined, regardless of the CMake option.
+
+#ifndef ENGINE_PROFILING
+#define ENGINE_PROFILING
+#endif
+
+#include "../profiler.h"
+
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <cstdlib>
+
+//keeps the work from being optimized away
+volatile std::uint64_t sink = 0;
+
+inline void work(std::uint64_t i){
+    sink = sink + i * 2654435761u;
+}
+
+double runLoop(unsigned int zones, bool zoned){
+    auto start = std::chrono::steady_clock::now();
+
+    if(zoned){
+        for(unsigned int i = 0; i < zones; ++i){
+            PROFILE_ZONE("iteration");
+            work(i);
+        }
+    }
+    else{
+        for(unsigned int i = 0; i < zones; ++i){
+            work(i);
+        }
+    }
+
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / zones;
+}
+
+void recordFrames(unsigned int frames){
+    for(unsigned int frame = 0; frame < frames; ++frame){
+        PROFILE_ZONE("frame");
+
+        for(unsigned int pass = 0; pass < 4; ++pass){
+            PROFILE_ZONE("pass");
+
+            for(unsigned int i = 0; i < 1000; ++i){
+                work(i);
+            }
+        }
+    }
+}
+
+int main(int argc, char* argv[]){
+    unsigned int zones = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10000000;
+    std::string trace_file = argc > 2 ? argv[2] : "profilebench.json";
+
+    //warms up the buffer of the main thread
+    runLoop(zones / 10, true);
+
+    double baseline_ns = runLoop(zones, false);
+
+    Profiler::setEnabled(true);
+    double enabled_ns = runLoop(zones, true);
+
+    Profiler::setEnabled(false);
+    double disabled_ns = runLoop(zones, true);
+
+    std::cout << "per iteration: " << baseline_ns << " ns without zones, " << enabled_ns << " ns with zones enabled, " << disabled_ns
+              << " ns with zones disabled at runtime" << std::endl;
+    std::cout << "zone cost: " << enabled_ns - baseline_ns << " ns enabled, " << disabled_ns - baseline_ns << " ns disabled" << std::endl;
+
+    Profiler::setEnabled(true);
+    Profiler::clear();
+    Profiler::setThreadName("Main");
+
+    std::vector<std::thread> threads;
+    for(unsigned int i = 0; i < 3; ++i){
+        threads.push_back(std::thread([i](){
+            Profiler::setThreadName("Worker " + std::to_string(i));
+            recordFrames(100);
+        }));
+    }
+
+    recordFrames(100);
+
+    for(auto& thread : threads){
+        thread.join();
+    }
+
+    if(!Profiler::writeChromeTrace(trace_file)){
+        return 1;
+    }
+
+    std::cout << "wrote trace of 4 threads to " << trace_file << std::endl;
+
+    return 0;
+}
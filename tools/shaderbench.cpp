@@ -0,0 +1,231 @@
+//Benchmark of the startup time of creating shader programs, one at a time, batched (see ResourceManager::createShaders()), and batched with the
+//program binary cache.
+//
+//usage: shaderbench [--programs N] [--cache-dir directory] [--null]
+//
+//Creates a set of distinct programs in every mode, and reports the time each mode took along with the hits and misses of the cache:
+//  serial      every program created with ResourceManager::createShader(), which waits for the driver to finish it before the next is submitted
+//  batched     every program submitted with createShaders() before any is finished, which KHR_parallel_shader_compile drivers compile in parallel
+//  cold cache  batched, with the cache (see ShaderCache) set to a directory which holds none of the binaries
+//  warm cache  batched, with the cache holding the binaries stored by the cold run
+//
+//The serial and batched modes run without the cache. Every mode but the warm one compiles other programs, and the sources are salted differently
+//on every run of the benchmark, so the cold run never finds binaries from an earlier one, but the binaries it stores are left in the cache
+//directory, which defaults to the working directory and is created if missing. The comparison is reported as invalid if the warm run finds none
+//of the binaries. Mesa's own shader cache is disabled through MESA_SHADER_CACHE_DISABLE, as it would hide the cost of compiling programs it has
+//seen before. The engine renders headless through EGL unless --null is given, which runs it on the null device.
+
+#include "../engine.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+const char* SHADER_BENCH_VERTEX_SHADER =
+    "#version 330 core\n"
+    "in vec3 position;\n"
+    "in vec3 normal;\n"
+    "in vec2 uv;\n"
+    "uniform mat4 model;\n"
+    "uniform mat4 view;\n"
+    "uniform mat4 projection;\n"
+    "out vec3 world_normal;\n"
+    "out vec3 world_position;\n"
+    "out vec2 vertex_uv;\n"
+    "void main(){\n"
+    "    vec4 world = model * vec4(position, 1.0);\n"
+    "    world_position = world.xyz;\n"
+    "    world_normal = mat3(model) * normal;\n"
+    "    vertex_uv = uv;\n"
+    "    gl_Position = projection * view * world;\n"
+    "}\n";
+
+//a few lights worth of shading, so that programs take about as long to compile as those of a real material. The salt and variant constants make
+//every program distinct
+const char* SHADER_BENCH_FRAGMENT_SHADER =
+    "#version 330 core\n"
+    "in vec3 world_normal;\n"
+    "in vec3 world_position;\n"
+    "in vec2 vertex_uv;\n"
+    "uniform sampler2D diffuse;\n"
+    "uniform vec3 light_positions[4];\n"
+    "uniform vec3 light_colours[4];\n"
+    "uniform vec3 camera_position;\n"
+    "out vec4 frag_colour;\n"
+    "const float salt = SALT;\n"
+    "const float variant = VARIANT;\n"
+    "void main(){\n"
+    "    vec3 n = normalize(world_normal);\n"
+    "    vec3 v = normalize(camera_position - world_position);\n"
+    "    vec3 albedo = texture(diffuse, vertex_uv * (1.0 + variant * 0.001)).rgb;\n"
+    "    vec3 colour = vec3(0.0);\n"
+    "    for(int i = 0; i < 4; ++i){\n"
+    "        vec3 l = light_positions[i] - world_position;\n"
+    "        float attenuation = 1.0 / (1.0 + dot(l, l));\n"
+    "        l = normalize(l);\n"
+    "        vec3 h = normalize(l + v);\n"
+    "        float specular = pow(max(dot(n, h), 0.0), 16.0 + variant);\n"
+    "        colour += (albedo * max(dot(n, l), 0.0) + vec3(specular)) * light_colours[i] * attenuation;\n"
+    "    }\n"
+    "    frag_colour = vec4(colour + vec3(salt * 1e-9), 1.0);\n"
+    "}\n";
+
+struct ShaderBenchOptions{
+    unsigned int programs;
+    std::string cache_directory;
+    RenderDeviceType device;
+
+    ShaderBenchOptions() : programs(200), cache_directory("."), device(RENDER_DEVICE_GL){
+    }
+};
+
+struct ShaderBenchResult{
+    double startup_ms;
+    unsigned int created;
+    ShaderCacheStats cache;
+};
+
+std::vector<ShaderSource> benchSources(const std::string& prefix, unsigned int count, unsigned int salt){
+    std::vector<ShaderSource> sources;
+
+    for(unsigned int i = 0; i < count; ++i){
+        std::string fragment = SHADER_BENCH_FRAGMENT_SHADER;
+        fragment.replace(fragment.find("SALT"), 4, std::to_string(salt) + ".0");
+        fragment.replace(fragment.find("VARIANT"), 7, std::to_string(i) + ".0");
+
+        sources.push_back(ShaderSource{prefix + "_" + std::to_string(i), SHADER_BENCH_VERTEX_SHADER, fragment, SHADER_RAW});
+    }
+
+    return sources;
+}
+
+//creates the programs of sources, in one batch or one at a time, and frees them again once timed
+ShaderBenchResult measureStartup(const std::vector<ShaderSource>& sources, bool batched){
+    ResourceManager* resource_manager = ResourceManager::resourceManager();
+    ShaderCacheStats before = resource_manager->shaderCache()->getStats();
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<Shader*> shaders;
+    if(batched){
+        shaders = resource_manager->createShaders(sources);
+    }
+    else{
+        for(auto& source : sources){
+            shaders.push_back(resource_manager->createShader(source.lexical_name, source.vs, source.fs, source.data_type));
+        }
+    }
+
+    ShaderBenchResult result;
+    result.startup_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    result.created = 0;
+
+    ShaderCacheStats after = resource_manager->shaderCache()->getStats();
+    result.cache.hits = after.hits - before.hits;
+    result.cache.misses = after.misses - before.misses;
+    result.cache.rejected = after.rejected - before.rejected;
+    result.cache.stored = after.stored - before.stored;
+
+    for(auto shader : shaders){
+        if(shader != nullptr){
+            result.created++;
+            resource_manager->freeShader(shader->getHandle());
+        }
+    }
+
+    //lets the deferred frees run, so that runs do not pile up programs
+    for(unsigned int i = 0; i <= RESOURCE_FREE_DELAY_FRAMES; ++i){
+        Engine::engine()->frame();
+    }
+
+    return result;
+}
+
+bool parseOptions(int argc, char* argv[], ShaderBenchOptions& options){
+    for(int i = 1; i < argc; ++i){
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+
+        if(arg == "--programs" && has_value){
+            options.programs = std::max((unsigned int)std::strtoul(argv[++i], nullptr, 10), 1u);
+        }
+        else if(arg == "--cache-dir" && has_value){
+            options.cache_directory = argv[++i];
+        }
+        else if(arg == "--null"){
+            options.device = RENDER_DEVICE_NULL;
+        }
+        else{
+            std::cerr << "Error: unknown argument " << arg << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main(int argc, char* argv[]){
+    ShaderBenchOptions options;
+    if(!parseOptions(argc, argv, options)){
+        std::cerr << "usage: shaderbench [--programs N] [--cache-dir directory] [--null]" << std::endl;
+        return 1;
+    }
+
+    //read by Mesa when the context is created
+#ifdef _WIN32
+    _putenv_s("MESA_SHADER_CACHE_DISABLE", "true");
+#else
+    setenv("MESA_SHADER_CACHE_DISABLE", "true", 1);
+#endif
+
+    Engine* engine = Engine::engine();
+    if(!engine->startupHeadless(1280, 720, options.device)){
+        return 1;
+    }
+
+    ResourceManager* resource_manager = ResourceManager::resourceManager();
+
+    //differs on every run of the benchmark, and every mode but the warm one adds to it, so that neither the cache nor the driver has seen the
+    //programs before
+    unsigned int salt = (unsigned int)(std::chrono::steady_clock::now().time_since_epoch().count() % 1000000000);
+
+    const char* renderer = (const char*)glGetString(GL_RENDERER);
+    std::cout << options.programs << " programs, " << (renderer != nullptr ? renderer : "unknown renderer") << ", cache in "
+              << options.cache_directory << std::endl << std::endl;
+    std::cout << std::left << std::setw(16) << "mode" << std::right << std::setw(12) << "startup ms" << std::setw(10) << "created" << std::setw(8)
+              << "hits" << std::setw(8) << "misses" << std::setw(10) << "rejected" << std::setw(8) << "stored" << std::endl;
+
+    auto print = [](const char* mode, const ShaderBenchResult& result){
+        std::cout << std::left << std::setw(16) << mode << std::right << std::fixed << std::setprecision(1) << std::setw(12) << result.startup_ms
+                  << std::setw(10) << result.created << std::setw(8) << result.cache.hits << std::setw(8) << result.cache.misses << std::setw(10)
+                  << result.cache.rejected << std::setw(8) << result.cache.stored << std::endl;
+    };
+
+    print("serial", measureStartup(benchSources("serial", options.programs, salt), false));
+    print("batched", measureStartup(benchSources("batched", options.programs, salt + 1), true));
+
+    //the warm run creates the same programs as the cold one under other names, as the cache keys programs by their sources alone
+    if(!resource_manager->shaderCache()->setDirectory(options.cache_directory)){
+        engine->shutdown();
+        return 1;
+    }
+
+    print("cold cache", measureStartup(benchSources("cold", options.programs, salt + 2), true));
+
+    ShaderBenchResult warm = measureStartup(benchSources("warm", options.programs, salt + 2), true);
+    print("warm cache", warm);
+
+    //without hits the warm run compiled from source like the cold one, e.g. as the driver does not support program binaries
+    bool valid = warm.cache.hits > 0;
+    if(!valid){
+        std::cerr << "Error: the warm run found none of the binaries stored by the cold run, so the cache comparison is invalid" << std::endl;
+    }
+
+    engine->shutdown();
+
+    return valid ? 0 : 1;
+}
@@ -0,0 +1,117 @@
+//Frame pacing benchmark for the fixed timestep (see timer.h).
+//
+//usage: timestepbench [seconds] [seed]
+//
+//Feeds simulated frame times at several render rates, with random jitter and occasional hitches, into a 60 Hz FixedTimestep, and reports the
+//number of simulation steps against the number expected for the simulated time, along with the spread of the frame times as measured with
+//millisecond ticks, as the timer used to, and with nanoseconds. Then runs a real paced loop against the steady clock and reports its pacing.
+
+#include "../timer.h"
+
+#include <iostream>
+#include <random>
+#include <thread>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+#include <algorithm>
+
+struct Spread{
+    double mean;
+    double stddev;
+};
+
+Spread spread(const std::vector<double>& values){
+    double sum = 0.0, sum_squares = 0.0;
+    for(double value : values){
+        sum += value;
+        sum_squares += value * value;
+    }
+
+    double mean = sum / values.size();
+    return Spread{mean, std::sqrt(std::max(sum_squares / values.size() - mean * mean, 0.0))};
+}
+
+void runSimulation(double render_hz, double jitter_ms, double hitch_chance, double seconds, unsigned int seed){
+    const double step = 1.0 / 60.0;
+
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<double> jitter(-jitter_ms, jitter_ms);
+    std::uniform_real_distribution<double> chance(0.0, 1.0);
+
+    FixedTimestep timestep(step, 8);
+
+    std::int64_t now_ns = 0;
+    std::int64_t last_ms = 0;
+    std::int64_t end_ns = (std::int64_t)(seconds * 1e9);
+
+    std::vector<double> ms_deltas, ns_deltas;
+    double min_alpha = 1.0, max_alpha = 0.0;
+
+    while(now_ns < end_ns){
+        double frame_ms = 1000.0 / render_hz + jitter(generator);
+        if(chance(generator) < hitch_chance){
+            frame_ms += 100.0;
+        }
+
+        std::int64_t elapsed_ns = (std::int64_t)(frame_ms * 1e6);
+        now_ns += elapsed_ns;
+
+        //what SDL_GetTicks() would have reported
+        std::int64_t now_ms = now_ns / 1000000;
+        ms_deltas.push_back((double)(now_ms - last_ms));
+        last_ms = now_ms;
+
+        ns_deltas.push_back((double)elapsed_ns / 1e6);
+
+        timestep.advance(elapsed_ns);
+        min_alpha = std::min(min_alpha, timestep.alpha());
+        max_alpha = std::max(max_alpha, timestep.alpha());
+    }
+
+    std::uint64_t expected = (std::uint64_t)(now_ns / (std::int64_t)(step * 1e9));
+    Spread ms_spread = spread(ms_deltas);
+    Spread ns_spread = spread(ns_deltas);
+
+    std::cout << render_hz << " Hz render, +-" << jitter_ms << " ms jitter, " << hitch_chance * 100.0 << "% hitches: "
+              << timestep.totalSteps() + timestep.droppedSteps() << " steps for " << expected << " expected (" << timestep.droppedSteps()
+              << " dropped), alpha " << min_alpha << " to " << max_alpha << ", frame time " << ms_spread.mean << " +- " << ms_spread.stddev
+              << " ms with ms ticks, " << ns_spread.mean << " +- " << ns_spread.stddev << " ms with ns ticks" << std::endl;
+}
+
+void runPacedLoop(double target_hz, unsigned int frames){
+    typedef std::chrono::steady_clock Clock;
+
+    auto frame_time = std::chrono::nanoseconds((std::int64_t)(1e9 / target_hz));
+    auto next = Clock::now() + frame_time;
+    auto last = Clock::now();
+
+    std::vector<double> deltas;
+    for(unsigned int i = 0; i < frames; ++i){
+        std::this_thread::sleep_until(next);
+        next += frame_time;
+
+        auto now = Clock::now();
+        deltas.push_back(std::chrono::duration<double, std::milli>(now - last).count());
+        last = now;
+    }
+
+    Spread result = spread(deltas);
+    std::cout << "steady clock loop at " << target_hz << " Hz: " << result.mean << " +- " << result.stddev << " ms over " << frames << " frames"
+              << std::endl;
+}
+
+int main(int argc, char* argv[]){
+    double seconds = argc > 1 ? std::strtod(argv[1], nullptr) : 60.0;
+    unsigned int seed = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1;
+
+    runSimulation(60.0, 0.0, 0.0, seconds, seed);
+    runSimulation(60.0, 2.0, 0.0, seconds, seed);
+    runSimulation(144.0, 1.0, 0.0, seconds, seed);
+    runSimulation(30.0, 3.0, 0.0, seconds, seed);
+    runSimulation(60.0, 2.0, 0.01, seconds, seed);
+
+    runPacedLoop(60.0, 120);
+
+    return 0;
+}
@@ -1,8 +1,95 @@
 #include "window.h"
+#include "renderer.h"
+#include "profiler.h"
 #include <iostream>
 
+#ifdef ENGINE_HEADLESS
+//keeps the X11 headers, and their macros, out
+#define EGL_NO_X11
+#define MESA_EGL_NO_X11_HEADERS
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+struct HeadlessContext{
+    EGLDisplay display;
+    EGLSurface surface;
+    EGLContext context;
+
+    HeadlessContext() : display(EGL_NO_DISPLAY), surface(EGL_NO_SURFACE), context(EGL_NO_CONTEXT){
+    }
+
+    ~HeadlessContext(){
+        if(display == EGL_NO_DISPLAY){
+            return;
+        }
+
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+
+        if(context != EGL_NO_CONTEXT){
+            eglDestroyContext(display, context);
+        }
+
+        if(surface != EGL_NO_SURFACE){
+            eglDestroySurface(display, surface);
+        }
+
+        eglTerminate(display);
+    }
+};
+
+bool hasExtension(const char* extensions, const std::string& extension){
+    if(extensions == nullptr){
+        return false;
+    }
+
+    std::string list = std::string(" ") + extensions + " ";
+    return list.find(" " + extension + " ") != std::string::npos;
+}
+
+//opens a display which needs no window system, preferring devices, which include GPUs as well as Mesa's software rasterizer, then Mesa's
+//surfaceless platform, and the default display last
+EGLDisplay openHeadlessDisplay(){
+    const char* client_extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    auto get_platform_display = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+
+    if(get_platform_display != nullptr && hasExtension(client_extensions, "EGL_EXT_platform_device")){
+        auto query_devices = (PFNEGLQUERYDEVICESEXTPROC)eglGetProcAddress("eglQueryDevicesEXT");
+
+        const EGLint max_devices = 16;
+        EGLDeviceEXT devices[max_devices];
+        EGLint num_devices = 0;
+
+        if(query_devices != nullptr && query_devices(max_devices, devices, &num_devices)){
+            for(EGLint i = 0; i < num_devices; ++i){
+                EGLDisplay display = get_platform_display(EGL_PLATFORM_DEVICE_EXT, devices[i], nullptr);
+                if(display != EGL_NO_DISPLAY && eglInitialize(display, nullptr, nullptr)){
+                    return display;
+                }
+            }
+        }
+    }
+
+    if(get_platform_display != nullptr && hasExtension(client_extensions, "EGL_MESA_platform_surfaceless")){
+        EGLDisplay display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+        if(display != EGL_NO_DISPLAY && eglInitialize(display, nullptr, nullptr)){
+            return display;
+        }
+    }
+
+    EGLDisplay display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if(display != EGL_NO_DISPLAY && eglInitialize(display, nullptr, nullptr)){
+        return display;
+    }
+
+    return EGL_NO_DISPLAY;
+}
+#else
+struct HeadlessContext{
+};
+#endif
+
 Window::Window(std::string title, int width, int height, int x_pos, int y_pos, bool maximized,
-       bool fullscreen, bool resizable, bool focus) : current_scene_(nullptr){
+       bool fullscreen, bool resizable, bool focus) : headless_(false), headless_width_(0), headless_height_(0), frame_count_(0), current_scene_(nullptr){
     assert(width >= 0 && height >= 0);
 
     Uint32 flags = SDL_WINDOW_OPENGL;
@@ -57,12 +144,88 @@ Window::Window(std::string title, int width, int height, int x_pos, int y_pos, b
     context_ = SDL_GL_CreateContext(window_);
 }
 
+Window::Window(int width, int height, RenderDeviceType device) : window_(nullptr), context_(nullptr), headless_(true), headless_width_(width),
+                                                                 headless_height_(height), frame_count_(0), current_scene_(nullptr){
+    assert(width > 0 && height > 0);
+
+    if(device == RENDER_DEVICE_NULL){
+        return;
+    }
+
+#ifdef ENGINE_HEADLESS
+    std::unique_ptr<HeadlessContext> headless(new HeadlessContext());
+
+    headless->display = openHeadlessDisplay();
+    if(headless->display == EGL_NO_DISPLAY){
+        throw WindowError("no EGL display is available");
+    }
+
+    if(!eglBindAPI(EGL_OPENGL_API)){
+        throw WindowError("EGL does not support OpenGL");
+    }
+
+    const EGLint config_attributes[] = {EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE};
+    EGLConfig config;
+    EGLint num_configs = 0;
+    if(!eglChooseConfig(headless->display, config_attributes, &config, 1, &num_configs) || num_configs == 0){
+        throw WindowError("no EGL config supports OpenGL");
+    }
+
+    //same version and profile as the SDL windows ask for
+    const EGLint context_attributes[] = {EGL_CONTEXT_MAJOR_VERSION, 3, EGL_CONTEXT_MINOR_VERSION, 3,
+                                         EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT, EGL_NONE};
+    headless->context = eglCreateContext(headless->display, config, EGL_NO_CONTEXT, context_attributes);
+    if(headless->context == EGL_NO_CONTEXT){
+        throw WindowError("unable to create an OpenGL 3.3 core context");
+    }
+
+    //rendering goes into the render target, so a surface is only created where contexts cannot be made current without one
+    if(!hasExtension(eglQueryString(headless->display, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context")){
+        const EGLint surface_attributes[] = {EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE};
+        headless->surface = eglCreatePbufferSurface(headless->display, config, surface_attributes);
+        if(headless->surface == EGL_NO_SURFACE){
+            throw WindowError("unable to create a pbuffer surface");
+        }
+    }
+
+    if(!eglMakeCurrent(headless->display, headless->surface, headless->surface, headless->context)){
+        throw WindowError("unable to make the context current");
+    }
+
+    headless_context_ = std::move(headless);
+#else
+    throw WindowError("headless windows need the engine to be built with the ENGINE_HEADLESS option");
+#endif
+}
+
 Window::~Window(){
-    SDL_GL_DeleteContext(context_);
-    SDL_DestroyWindow(window_);
+    //the GL objects go before the context they belong to
+    readback_ = nullptr;
+    target_ = nullptr;
+
+    if(!headless_){
+        SDL_GL_DeleteContext(context_);
+        SDL_DestroyWindow(window_);
+    }
+
+    headless_context_ = nullptr;
 }
 
 void Window::makeCurrent(){
+#ifdef ENGINE_HEADLESS
+    if(headless_context_ != nullptr){
+        if(!eglMakeCurrent(headless_context_->display, headless_context_->surface, headless_context_->surface, headless_context_->context)){
+            std::cerr << "Error: unable to make window current" << std::endl;
+        }
+
+        return;
+    }
+#endif
+
+    if(headless_){
+        return;
+    }
+
     int success = SDL_GL_MakeCurrent(window_, context_);
 
     if(success < 0){
@@ -70,13 +233,76 @@ void Window::makeCurrent(){
     }
 }
 
+void Window::releaseCurrent(){
+#ifdef ENGINE_HEADLESS
+    if(headless_context_ != nullptr){
+        if(!eglMakeCurrent(headless_context_->display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT)){
+            std::cerr << "Error: unable to release window context" << std::endl;
+        }
+
+        return;
+    }
+#endif
+
+    if(headless_){
+        return;
+    }
+
+    if(SDL_GL_MakeCurrent(window_, NULL) < 0){
+        std::cerr << "Error: unable to release window context" << std::endl;
+    }
+}
+
+bool Window::isCurrent(){
+#ifdef ENGINE_HEADLESS
+    if(headless_context_ != nullptr){
+        return eglGetCurrentContext() == headless_context_->context;
+    }
+#endif
+
+    //the null device has no context to make current
+    if(headless_){
+        return true;
+    }
+
+    return SDL_GL_GetCurrentContext() == context_;
+}
+
+Uint32 Window::windowFlags(){
+    return window_ != nullptr ? SDL_GetWindowFlags(window_) : 0;
+}
+
+bool Window::isHeadless(){
+    return headless_;
+}
+
+RenderTarget* Window::getRenderTarget(){
+    return target_.get();
+}
+
+void Window::setReadback(unsigned int buffers){
+    readback_ = buffers > 0 ? std::unique_ptr<FrameReadback>(new FrameReadback(buffers)) : nullptr;
+}
+
+FrameReadback* Window::getReadback(){
+    return readback_.get();
+}
+
 Uint32 Window::getID(){
+    if(window_ == nullptr){
+        return 0;
+    }
+
     Uint32 id = SDL_GetWindowID(window_);
 
     return id;
 }
 
 std::pair<int, int> Window::getResolution(){
+    if(isHeadless()){
+        return std::make_pair(headless_width_, headless_height_);
+    }
+
     std::pair<int, int> resolution;
 
     SDL_GetWindowSize(window_, &resolution.first, &resolution.second);
@@ -85,63 +311,65 @@ std::pair<int, int> Window::getResolution(){
 }
 
 std::pair<int, int> Window::getPosition(){
-    std::pair<int, int> position;
+    std::pair<int, int> position(0, 0);
 
-    SDL_GetWindowPosition(window_, &position.first, &position.second);
+    if(window_ != nullptr){
+        SDL_GetWindowPosition(window_, &position.first, &position.second);
+    }
 
     return position;
 }
 
 bool Window::isVisible(){
-    Uint32 flags = SDL_GetWindowFlags(window_);
+    Uint32 flags = windowFlags();
 
     return flags & SDL_WINDOW_SHOWN;
 }
 
 bool Window::isMinimized(){
-    Uint32 flags = SDL_GetWindowFlags(window_);
+    Uint32 flags = windowFlags();
 
     return flags & SDL_WINDOW_MINIMIZED;
 }
 
 bool Window::isMaximized(){
-    Uint32 flags = SDL_GetWindowFlags(window_);
+    Uint32 flags = windowFlags();
 
     return flags & SDL_WINDOW_MAXIMIZED;
 }
 
 bool Window::inputGrabbed(){
-    Uint32 flags = SDL_GetWindowFlags(window_);
+    Uint32 flags = windowFlags();
 
     return flags & SDL_WINDOW_INPUT_GRABBED;
 }
 
 bool Window::isInputFocused(){
-    Uint32 flags = SDL_GetWindowFlags(window_);
+    Uint32 flags = windowFlags();
 
     return flags & SDL_WINDOW_INPUT_FOCUS;
 }
 
 bool Window::isMouseOver(){
-    Uint32 flags = SDL_GetWindowFlags(window_);
+    Uint32 flags = windowFlags();
 
     return flags & SDL_WINDOW_MOUSE_CAPTURE;
 }
 
 bool Window::isResizable(){
-    Uint32 flags = SDL_GetWindowFlags(window_);
+    Uint32 flags = windowFlags();
 
     return flags & SDL_WINDOW_RESIZABLE;
 }
 
 bool Window::isBorderless(){
-    Uint32 flags = SDL_GetWindowFlags(window_);
+    Uint32 flags = windowFlags();
 
     return flags & SDL_WINDOW_BORDERLESS;
 }
 
 bool Window::isFullScreen(){
-    Uint32 flags = SDL_GetWindowFlags(window_);
+    Uint32 flags = windowFlags();
 
     return flags & SDL_WINDOW_FULLSCREEN;
 }
@@ -149,6 +377,17 @@ bool Window::isFullScreen(){
 void Window::resizeWindow(int width, int height){
     assert(width > 0 && height > 0);
 
+    if(isHeadless()){
+        headless_width_ = width;
+        headless_height_ = height;
+
+        if(target_ != nullptr){
+            target_->resize(width, height);
+        }
+
+        return;
+    }
+
     bool fullscreen = isFullScreen();
     if(fullscreen){
         SDL_SetWindowFullscreen(window_, 0);
@@ -163,13 +402,68 @@ void Window::resizeWindow(int width, int height){
 
 void Window::frame(){
     if(current_scene_ != nullptr){
-        SDL_GLContext current_context = SDL_GL_GetCurrentContext();
-        if(current_context != context_){
+        if(!isCurrent()){
             makeCurrent();
         }
+
+        bindTarget();
+
         current_scene_->frame();
+        Renderer::renderer()->frame();
+
+        present();
+    }
+}
+
+bool Window::beginFrame(FramePacket& packet){
+    if(current_scene_ == nullptr){
+        return false;
+    }
+
+    current_scene_->frame();
+    Renderer::renderer()->buildFrame(packet);
+
+    return true;
+}
+
+void Window::renderFrame(FramePacket& packet){
+    bindTarget();
+
+    Renderer::renderer()->executeFrame(packet);
+
+    present();
+}
+
+void Window::bindTarget(){
+    if(isHeadless()){
+        //created on the first frame, as the GL functions are only loaded after the window
+        if(target_ == nullptr){
+            target_ = std::unique_ptr<RenderTarget>(new RenderTarget(headless_width_, headless_height_));
+        }
+
+        target_->bind();
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+    }
+}
+
+void Window::present(){
+    if(readback_ != nullptr){
+        auto resolution = getResolution();
+        readback_->capture(frame_count_, resolution.first, resolution.second);
+    }
+
+    if(!isHeadless()){
+        PROFILE_ZONE("Swap");
         SDL_GL_SwapWindow(window_);
     }
+
+    frame_count_++;
+}
+
+void Window::fixedFrame(){
+    if(current_scene_ != nullptr){
+        current_scene_->fixedFrame();
+    }
 }
 
 void Window::setCurrentScene(std::shared_ptr<Scene> scene){
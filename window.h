@@ -6,26 +6,87 @@
 
 #include <string>
 #include <memory>
+#include <exception>
+#include <cstdint>
 
 #include "scene.h"
+#include "rendertarget.h"
+#include "framereadback.h"
+#include "renderdevice.h"
 
 const int CENTER_WINDOW_POS = -1;
 const int UNDEFINED_WINDOW_POS = -2;
 
+class WindowError : public std::exception{
+private:
+    std::string error_log_;
+
+public:
+    WindowError(std::string log){
+        error_log_ = log;
+    }
+
+    virtual const char* what() const throw(){
+        return error_log_.c_str();
+    }
+};
+
+//EGL state of a headless window, defined in window.cpp so that the EGL headers are only included there
+struct HeadlessContext;
+
+struct FramePacket;
+
 class Window
 {
 friend class Engine;
+friend class RenderThread;
 private:
     SDL_Window* window_;
     SDL_GLContext context_;
 
+    //headless windows have no SDL window or default framebuffer, and render into the target instead
+    bool headless_;
+    //context of a headless window, none for the null device
+    std::unique_ptr<HeadlessContext> headless_context_;
+    int headless_width_;
+    int headless_height_;
+    std::unique_ptr<RenderTarget> target_;
+
+    std::unique_ptr<FrameReadback> readback_;
+    std::uint64_t frame_count_;
+
     std::shared_ptr<Scene> current_scene_;
 
 private:
+    //creates a headless window, with an offscreen OpenGL context which renders into a RenderTarget of the given size. No context is created for
+    //the null device. Throws WindowError if no context could be created, or the engine was built without ENGINE_HEADLESS
+    Window(int width, int height, RenderDeviceType device);
+
     //forwards window by a frame, the main point of this function is to just swap buffers, so this would get called at the end of the
     //engine frame function
     void frame();
 
+    //advances the current scene and builds its frame into the packet, without any GL calls, see RenderThread. Returns false if there is no scene
+    bool beginFrame(FramePacket& packet);
+
+    //renders and presents a frame built by beginFrame(), on the thread the context is current on
+    void renderFrame(FramePacket& packet);
+
+    //binds and clears the render target of a headless window, creating it on the first frame
+    void bindTarget();
+
+    //captures the frame rendered if frames are read back, and presents it
+    void present();
+
+    //checks if the context of the window is the current one
+    bool isCurrent();
+
+    //gets the SDL flags of the window, none for headless windows
+    Uint32 windowFlags();
+
+    //runs a fixed simulation step of the current scene, called before frame() as many times as the timer has steps for the frame
+    void fixedFrame();
+
 public:
     Window(std::string title = "Engine", int width = 0, int height = 0, int x_pos = UNDEFINED_WINDOW_POS, int y_pos = UNDEFINED_WINDOW_POS, bool maximized = true,
            bool fullscreen = true, bool resizable = true, bool focus = true);
@@ -40,14 +101,44 @@ public:
      */
     void makeCurrent();
 
+    /**
+     * @brief Releases the window's opengl context from the calling thread, so that it can be made current on another one
+     */
+    void releaseCurrent();
+
+    /**
+     * @brief Checks if the window is headless, see Engine::startupHeadless()
+     * @return true if the window renders offscreen, otherwise false
+     */
+    bool isHeadless();
+
+    /**
+     * @brief Gets the target a headless window renders into
+     * @return render target, or nullptr if the window is not headless or has not rendered a frame yet
+     */
+    RenderTarget* getRenderTarget();
+
+    /**
+     * @brief Starts capturing every rendered frame into memory, see FrameReadback. Works for both headless and regular windows. Must be called
+     * through Engine::runOnGLThread() while the engine has a render thread.
+     * @param buffers Number of frames which may be in flight, 0 stops capturing
+     */
+    void setReadback(unsigned int buffers);
+
+    /**
+     * @brief Gets the readback the frames are captured into
+     * @return readback, or nullptr if frames are not captured
+     */
+    FrameReadback* getReadback();
+
     /**
      * @brief Acquires SDL window ID for the window
-     * @return the window ID
+     * @return the window ID, 0 for headless windows
      */
     Uint32 getID();
 
     /**
-     * @brief Calculates the resolution of the window
+     * @brief Calculates the resolution of the window, which for headless windows is the size of their render target
      * @return a pair containing the width and height of the window
      */
     std::pair<int, int> getResolution();
@@ -113,7 +204,8 @@ public:
     bool isFullScreen();
 
     /**
-     * @brief Resizes the window to the specified \p width and \p height. This works for both windowed and fullscreen modes
+     * @brief Resizes the window to the specified \p width and \p height. This works for both windowed and fullscreen modes. Headless windows
+     * resize their render target, so must be resized through Engine::runOnGLThread() while the engine has a render thread.
      * @param width The new width of the window
      * @param height The new height of the window
      */